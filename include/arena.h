@@ -0,0 +1,81 @@
+/*
+    arena.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_ARENA_H
+#define SATYR_ARENA_H
+
+/**
+ * @file
+ * @brief Memory arenas for parsed stacktraces.
+ *
+ * A stacktrace parsed by sr_stacktrace_parse_arena() or
+ * sr_stacktrace_from_json_text_arena() has its frames, threads and
+ * strings allocated from an arena instead of being allocated one by one.
+ * Releasing the arena releases the whole stacktrace at once, without
+ * walking it.
+ *
+ * The stacktrace can be used as any other stacktrace until the arena is
+ * released.  It can also be modified, e.g. normalized, but the strings
+ * and frames added to it by the modification are not allocated from the
+ * arena.  A modified stacktrace must be released by its free function
+ * before the arena is released, the free function skips the memory of
+ * the arena.
+ *
+ * The strings of the stacktrace are not interned even if the pool of
+ * sr_intern_pool_enable() is enabled, they belong to the arena.
+ *
+ * An arena must not be used by more threads at once.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+struct sr_arena;
+
+/**
+ * Creates a new empty arena.
+ * @returns
+ * It never returns NULL. The returned pointer must be released by
+ * calling the function sr_arena_free().
+ */
+struct sr_arena *
+sr_arena_new(void);
+
+/**
+ * Releases the arena and all the stacktraces allocated from it.
+ * @param arena
+ * If the arena is NULL, no operation is performed.
+ */
+void
+sr_arena_free(struct sr_arena *arena);
+
+/**
+ * Returns the number of bytes allocated from the arena.
+ */
+size_t
+sr_arena_size(const struct sr_arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <sys/types.h>
 
 struct sr_core_stacktrace;
@@ -40,6 +41,33 @@ sr_parse_coredump(const char *coredump_filename,
                   const char *executable_filename,
                   char **error_message);
 
+/* The same as sr_parse_coredump(), but the threads of the process are
+ * unwound in parallel by the given number of system threads. If nthreads
+ * is 0, the number of processors is used. The threads of the stacktrace
+ * are in the same order as the ones returned by sr_parse_coredump().
+ *
+ * Every system thread opens the coredump on its own, so that the
+ * unwinding does not need to be serialized. With libunwind, the threads
+ * are always unwound one by one.
+ */
+struct sr_core_stacktrace *
+sr_parse_coredump_parallel(const char *coredump_filename,
+                           const char *executable_filename,
+                           unsigned nthreads,
+                           char **error_message);
+
+/* Makes the unwinding functions keep the symbol tables of the binaries in
+ * the directory, in files named by the build ids of the binaries.  The
+ * function names of the frames are then found in the stored tables, the
+ * symbol tables of the binaries seen in an earlier coredump are not loaded
+ * again.  The directory is created when the first table is stored.
+ *
+ * NULL, the default, disables the cache.  The unwinding already in
+ * progress is not affected by the change.
+ */
+void
+sr_core_unwind_set_symbol_cache_dir(const char *directory);
+
 struct sr_core_stacktrace *
 sr_core_stacktrace_from_gdb(const char *gdb_output,
                             const char *coredump_filename,
@@ -72,6 +100,36 @@ sr_core_stacktrace_from_core_hook_generate(pid_t tid,
                                            struct sr_core_stracetrace_unwind_state *state,
                                            char **error_msg);
 
+/* The same as sr_core_stacktrace_from_core_hook_generate(), but only the
+ * addresses of the frames and their modules are found while the thread is
+ * stopped.  The thread is released as soon as it is unwound, so that the
+ * dying process does not wait for the function names to be looked up.
+ *
+ * The function names are filled in by sr_core_stacktrace_symbolize(), the
+ * frames below __libc_start_main are removed by it too.  The unwinding
+ * stops after four times as many frames as a thread keeps, the least
+ * recent frames of a deeper stack are not included.  The state is not
+ * released by this function, it must be passed to
+ * sr_core_stacktrace_symbolize() and released by
+ * sr_core_stacktrace_unwind_state_free() afterwards.
+ */
+struct sr_core_stacktrace *
+sr_core_stacktrace_from_core_hook_generate_deferred(pid_t tid,
+                                                    const char *executable,
+                                                    int signum,
+                                                    struct sr_core_stracetrace_unwind_state *state,
+                                                    char **error_msg);
+
+/* Fills in the function names of a stacktrace returned by
+ * sr_core_stacktrace_from_core_hook_generate_deferred(), the state must be
+ * the one passed to it.  The frames of the stacktrace must not be modified
+ * before.  Returns false on error.
+ */
+bool
+sr_core_stacktrace_symbolize(struct sr_core_stacktrace *stacktrace,
+                             struct sr_core_stracetrace_unwind_state *state,
+                             char **error_msg);
+
 void
 sr_core_stacktrace_unwind_state_free(struct sr_core_stracetrace_unwind_state *state);
 
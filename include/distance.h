@@ -34,19 +34,26 @@ extern "C" {
 #include <stdlib.h>
 
 struct sr_thread;
+struct sr_frozen_thread;
 
 enum sr_distance_type
 {
+    /* Type of the distance matrices filled by the caller.  The value is
+     * stored in the matrix files, it does not change when a type is
+     * added. */
+    SR_DISTANCE_UNKNOWN = -1,
+
     /* Jaro-Winkler distance:
      *
      * Gets number of matching function names(match_count) from both
-     * threads and number of transpositions in place(trans_count) if
-     * the transpositioned function names are not farther away than
-     * frame_count/2 - 1.  Then computes the Jaro-Winkler distance
-     * according to the formula.  NOTE: The Jaro-Winkler distance is
-     * not a metric distance as it does not satisfy the triangle
-     * inequality.  Returns a number between 0 and 1: 0 = no
-     * similarity, 1 = similar threads.
+     * threads, every frame matching at most one frame of the other
+     * thread not farther away than frame_count/2 - 1, and the number
+     * of transpositions (trans_count), which is half the number of
+     * matching function names out of order.  Then computes the
+     * Jaro-Winkler distance according to the formula.  NOTE: The
+     * Jaro-Winkler distance is not a metric distance as it does not
+     * satisfy the triangle inequality.  Returns a number between 0 and
+     * 1: 0 = no similarity, 1 = similar threads.
      */
     SR_DISTANCE_JARO_WINKLER,
 
@@ -82,6 +89,17 @@ enum sr_distance_type
      */
     SR_DISTANCE_DAMERAU_LEVENSHTEIN,
 
+    /* Jaro-Winkler distance as computed by the older versions of the
+     * library:
+     *
+     * Like the Jaro-Winkler distance, but a frame may match several
+     * frames of the other thread and every match at a different
+     * position counts as a half of a transposition, so the result
+     * may even exceed 1.  Only for comparing with previously computed
+     * results.
+     */
+    SR_DISTANCE_JARO_WINKLER_COMPAT,
+
     /* Sentinel, keep it the last entry. */
     SR_DISTANCE_NUM
 };
@@ -91,6 +109,40 @@ sr_distance(enum sr_distance_type distance_type,
             struct sr_thread *thread1,
             struct sr_thread *thread2);
 
+/**
+ * Computes the distance of two threads like sr_distance(), but stops as
+ * soon as the distance is known to be greater than max_dist.  This is
+ * much cheaper when most of the threads are far apart.
+ * @param max_dist
+ * The largest distance of interest.  For the Jaro-Winkler distances,
+ * which return similarity, the bound is 1 - max_dist on the similarity.
+ * @returns
+ * The same value as sr_distance() if the distance is within the bound.
+ * Otherwise a value beyond the bound, either the distance itself or 1.0
+ * (0.0 for the Jaro-Winkler distances).
+ */
+float
+sr_distance_bounded(enum sr_distance_type distance_type,
+                    struct sr_thread *thread1,
+                    struct sr_thread *thread2,
+                    float max_dist);
+
+/**
+ * How the entries of a distance matrix are stored.
+ */
+enum sr_distances_storage
+{
+    /* Single precision floats. */
+    SR_DISTANCES_FLOAT,
+    /* Half precision floats, with the relative error at most 2^-11. */
+    SR_DISTANCES_FLOAT16,
+    /* Bytes holding the distance in [0, 1] with the step 1/255, other
+     * values are clamped to the interval. */
+    SR_DISTANCES_UINT8,
+    /* Number of storage types. Must be last. */
+    SR_DISTANCES_STORAGE_NUM
+};
+
 /**
  * @brief A distance matrix of stack trace threads.
  *
@@ -101,7 +153,22 @@ struct sr_distances
 {
     int m;
     int n;
+    /* The entries if the storage is SR_DISTANCES_FLOAT, NULL otherwise.
+     * Use sr_distances_get_distance() to access the entries of
+     * matrices with any storage. */
     float *distances;
+    enum sr_distances_storage storage;
+    /* Private, the stored entries. */
+    void *cells;
+    /* Type of the distances and the checksum of the compared threads
+     * (see sr_threads_checksum()), they are set by sr_threads_compare().
+     * The matrices created by sr_distances_new() have the type
+     * SR_DISTANCE_UNKNOWN and zero checksum. */
+    enum sr_distance_type dist_type;
+    uint32_t checksum;
+    /* Private, memory mapping of the file the matrix was loaded from. */
+    void *mapping;
+    size_t mapping_size;
 };
 
 /**
@@ -117,6 +184,23 @@ struct sr_distances
 struct sr_distances *
 sr_distances_new(int m, int n);
 
+/**
+ * Creates and initializes a new distances structure with the given
+ * storage of the entries. The reduced precision storage types need two
+ * or four times less memory than the floats, the entries are rounded
+ * when they are set.
+ * @param m
+ * Number of rows.
+ * @param n
+ * Number of columns.
+ * @param storage
+ * Storage of the entries.
+ * @returns
+ * This function never returns NULL.
+ */
+struct sr_distances *
+sr_distances_new_ext(int m, int n, enum sr_distances_storage storage);
+
 /**
  * Creates a duplicate of the distances structure.
  * @param distances
@@ -136,6 +220,57 @@ sr_distances_dup(struct sr_distances *distances);
 void
 sr_distances_free(struct sr_distances *distances);
 
+/**
+ * Saves the distance matrix to a binary file, which can be loaded by
+ * sr_distances_load(). The file contains the dimensions, the distance
+ * type and the checksum of the matrix. It is written in the byte order
+ * of the machine and it is replaced atomically.
+ * @param distances
+ * It must be non-NULL pointer. The structure is not modified by calling
+ * this function.
+ * @param filename
+ * Name of the file to be written.
+ * @param error_message
+ * If the file cannot be written, it is set to a newly allocated error
+ * message, which must be released by g_free().
+ * @returns
+ * True on success.
+ */
+bool
+sr_distances_save(struct sr_distances *distances,
+                  const char *filename,
+                  char **error_message);
+
+/**
+ * Loads the distance matrix saved by sr_distances_save(). The file is
+ * mapped to the memory instead of being read, so even huge matrices
+ * are loaded instantly and only the pages actually used are read from
+ * the disk. Changing the loaded matrix does not change the file.
+ * @param filename
+ * Name of the file to be loaded.
+ * @param error_message
+ * If the file cannot be loaded, it is set to a newly allocated error
+ * message, which must be released by g_free().
+ * @returns
+ * The matrix which must be released by calling sr_distances_free(), or
+ * NULL on failure.
+ */
+struct sr_distances *
+sr_distances_load(const char *filename, char **error_message);
+
+/**
+ * Computes a checksum of the threads, stored in the distance matrices to
+ * detect when a matrix is used with a different array of threads than
+ * it was computed from. Only the number of frames of the threads is
+ * taken into account.
+ * @param threads
+ * Array of threads. They are not modified by calling this function.
+ * @param n
+ * Number of threads in the passed array.
+ */
+uint32_t
+sr_threads_checksum(struct sr_thread **threads, int n);
+
 /**
  * Gets the entry (i, j) from the distance matrix.
  * @param distances
@@ -185,6 +320,175 @@ struct sr_distances *
 sr_threads_compare(struct sr_thread **threads, int m, int n,
                    enum sr_distance_type dist_type);
 
+/**
+ * Creates a distances structure by comparing threads in several threads
+ * of execution. The rows of the matrix are spread across the workers,
+ * which steal rows from each other when they run out of work. The result
+ * is identical to the one of sr_threads_compare().
+ * @param threads
+ * Array of threads. They are not modified by calling this function.
+ * @param m
+ * Compare first m threads from the array with other threads.
+ * @param n
+ * Number of threads in the passed array.
+ * @param dist_type
+ * Type of distance to compute.
+ * @param nthreads
+ * Number of worker threads to use, including the calling one. If zero,
+ * the number of available processors is used.
+ * @returns
+ * This function never returns NULL.
+ */
+struct sr_distances *
+sr_threads_compare_parallel(struct sr_thread **threads, int m, int n,
+                            enum sr_distance_type dist_type,
+                            unsigned nthreads);
+
+/**
+ * Creates a distances structure by comparing threads, storing the
+ * entries with the given precision.
+ * @param storage
+ * Storage of the entries, see sr_distances_new_ext().
+ * The other parameters are the same as for sr_threads_compare_parallel().
+ * @returns
+ * This function never returns NULL.
+ */
+struct sr_distances *
+sr_threads_compare_ext(struct sr_thread **threads, int m, int n,
+                       enum sr_distance_type dist_type,
+                       unsigned nthreads,
+                       enum sr_distances_storage storage);
+
+/**
+ * Computes the distance of two frozen threads (see frozen_thread.h).
+ * The result is the same as sr_distance() of the threads they were made
+ * from.
+ */
+float
+sr_frozen_thread_distance(enum sr_distance_type distance_type,
+                          struct sr_frozen_thread *thread1,
+                          struct sr_frozen_thread *thread2);
+
+/**
+ * Computes the checksum of frozen threads, which is the same as
+ * sr_threads_checksum() of the threads they were made from.
+ */
+uint32_t
+sr_frozen_threads_checksum(struct sr_frozen_thread **threads, int n);
+
+/**
+ * Creates a distances structure by comparing frozen threads. The matrix
+ * is the same as the one sr_threads_compare_parallel() computes from the
+ * threads they were made from, including the checksum, so it can be
+ * clustered and stored the same way.
+ * @param threads
+ * Array of frozen threads. They are not modified by calling this
+ * function.
+ * The other parameters are the same as for sr_threads_compare_parallel().
+ * @returns
+ * This function never returns NULL.
+ */
+struct sr_distances *
+sr_frozen_threads_compare(struct sr_frozen_thread **threads, int m, int n,
+                          enum sr_distance_type dist_type,
+                          unsigned nthreads);
+
+/**
+ * Extends a distance matrix by new threads. The distances which are
+ * already in the matrix are copied, only the distances between the new
+ * threads and all the threads (and the distances missing in the matrix
+ * if it has fewer than n - 1 rows) are computed.
+ * @param distances
+ * The matrix computed from the old threads. It is not modified by
+ * calling this function.
+ * @param old_threads
+ * The threads the matrix was computed from, there must be distances->n
+ * of them. They are not modified by calling this function.
+ * @param new_threads
+ * Array of the added threads. They are not modified by calling this
+ * function.
+ * @param new_count
+ * Number of threads in the new_threads array.
+ * @param dist_type
+ * Type of distance to compute. It must be the type of the matrix.
+ * @param nthreads
+ * Number of worker threads to use, see sr_threads_compare_parallel().
+ * @returns
+ * A new full matrix of the old threads followed by the new ones, the
+ * indices of the old threads do not change. It has the same storage as
+ * the old matrix. NULL if the distance type
+ * or the checksum of the old threads do not match the matrix.
+ */
+struct sr_distances *
+sr_distances_extend(struct sr_distances *distances,
+                    struct sr_thread **old_threads,
+                    struct sr_thread **new_threads,
+                    int new_count,
+                    enum sr_distance_type dist_type,
+                    unsigned nthreads);
+
+/**
+ * @brief A thread found by sr_threads_nearest().
+ */
+struct sr_thread_neighbor
+{
+    /* Index of the thread in the corpus. */
+    int index;
+    /* Distance of the thread from the query (the similarity for the
+     * Jaro-Winkler distances). */
+    float distance;
+};
+
+/**
+ * Finds the k threads of the corpus nearest to the query thread.  The
+ * distances are computed only up to the distance of the k-th nearest
+ * thread found so far (see sr_distance_bounded()), which is much
+ * cheaper than comparing the query to all the threads completely.  The
+ * distances are the same as the ones computed by sr_threads_compare().
+ * @param query
+ * The thread to find the neighbors of. It is not modified by calling this
+ * function.
+ * @param corpus
+ * Array of threads. They are not modified by calling this function.
+ * @param ncorpus
+ * Number of threads in the corpus.
+ * @param dist_type
+ * Type of distance to compute.
+ * @param k
+ * The maximal number of threads to find.
+ * @param results
+ * Array of at least k entries. The found threads are stored there from
+ * the nearest one, the threads with the same distance are ordered by
+ * their index.
+ * @returns
+ * Number of the found threads, which is the smaller of k and ncorpus.
+ */
+int
+sr_threads_nearest(struct sr_thread *query,
+                   struct sr_thread **corpus,
+                   int ncorpus,
+                   enum sr_distance_type dist_type,
+                   int k,
+                   struct sr_thread_neighbor *results);
+
+/**
+ * Finds the k threads of the corpus nearest to the query thread, scanning
+ * the corpus in several threads of execution. The result is identical to
+ * the one of sr_threads_nearest().
+ * @param nthreads
+ * Number of worker threads to use, including the calling one. If zero,
+ * the number of available processors is used.
+ * The other parameters are the same as for sr_threads_nearest().
+ */
+int
+sr_threads_nearest_parallel(struct sr_thread *query,
+                            struct sr_thread **corpus,
+                            int ncorpus,
+                            enum sr_distance_type dist_type,
+                            int k,
+                            struct sr_thread_neighbor *results,
+                            unsigned nthreads);
+
 /**
  * @brief A part of a distance matrix to be computed (possibly in different
  * threads/processes and even different machines provided they have the same
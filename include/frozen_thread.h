@@ -0,0 +1,154 @@
+/*
+    frozen_thread.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_FROZEN_THREAD_H
+#define SATYR_FROZEN_THREAD_H
+
+/**
+ * @file
+ * @brief Compact immutable copies of stack trace threads.
+ *
+ * A frozen thread holds everything the distance and duplication hash
+ * functions need to know about a thread in a single block of memory.
+ * The frames are stored as arrays of the function, library and source
+ * file names, interned in a string table of the thread, and of the
+ * addresses.  Comparing frozen threads gives the same results as
+ * comparing the threads they were made from, see sr_frozen_threads_compare()
+ * and sr_frozen_thread_distance() in distance.h.
+ *
+ * The block contains no pointers, so it can be stored as it is, e.g. to
+ * cache the threads of a large set of reports between runs.  The stored
+ * data can only be loaded on machines with the same byte order.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "report_type.h"
+#include "thread.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A frozen thread.
+ */
+struct sr_frozen_thread;
+
+/**
+ * Creates a frozen copy of the thread.
+ * @param thread
+ * It is not modified by calling this function.
+ * @returns
+ * It never returns NULL. The returned pointer must be released by
+ * calling the function sr_frozen_thread_free().
+ */
+struct sr_frozen_thread *
+sr_thread_freeze(struct sr_thread *thread);
+
+/**
+ * Releases the memory held by the frozen thread.
+ * @param thread
+ * If the thread is NULL, no operation is performed.
+ */
+void
+sr_frozen_thread_free(struct sr_frozen_thread *thread);
+
+/**
+ * Returns the type of the thread the frozen thread was made from.
+ */
+enum sr_report_type
+sr_frozen_thread_type(const struct sr_frozen_thread *thread);
+
+/**
+ * Returns the number of frames of the thread.
+ */
+int
+sr_frozen_thread_frame_count(const struct sr_frozen_thread *thread);
+
+/**
+ * Returns the function name of the frame with the given index, or NULL
+ * if the frame has none.  The returned string is owned by the thread.
+ */
+const char *
+sr_frozen_thread_function_name(const struct sr_frozen_thread *thread,
+                               int frame);
+
+/**
+ * Returns the library, module or class of the function of the frame, or
+ * NULL if it is not known.  The returned string is owned by the thread.
+ */
+const char *
+sr_frozen_thread_library_name(const struct sr_frozen_thread *thread,
+                              int frame);
+
+/**
+ * Returns the source file name of the frame, or NULL if it is not known.
+ * The returned string is owned by the thread.
+ */
+const char *
+sr_frozen_thread_file_name(const struct sr_frozen_thread *thread,
+                           int frame);
+
+/**
+ * Returns the address of the frame, or 0 for the frames of the report
+ * types without addresses.
+ */
+uint64_t
+sr_frozen_thread_address(const struct sr_frozen_thread *thread, int frame);
+
+/**
+ * Returns the same duplication hash as sr_thread_get_duphash() of the
+ * thread the frozen thread was made from.
+ */
+char *
+sr_frozen_thread_get_duphash(const struct sr_frozen_thread *thread,
+                             int nframes, char *prefix,
+                             enum sr_duphash_flags flags);
+
+/**
+ * Returns the serialized form of the frozen thread.
+ * @param size
+ * The size of the data in bytes is stored there.
+ * @returns
+ * The data are owned by the thread, they are valid until the thread is
+ * released.
+ */
+const void *
+sr_frozen_thread_data(const struct sr_frozen_thread *thread, size_t *size);
+
+/**
+ * Creates a frozen thread from the data returned by
+ * sr_frozen_thread_data(). The data are copied and validated.
+ * @param error_message
+ * If the data are not valid, it is set to a newly allocated error
+ * message, which must be released by g_free().
+ * @returns
+ * The thread which must be released by calling sr_frozen_thread_free(),
+ * or NULL on failure.
+ */
+struct sr_frozen_thread *
+sr_frozen_thread_from_data(const void *data, size_t size,
+                           char **error_message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
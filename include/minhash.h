@@ -0,0 +1,135 @@
+/*
+    minhash.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_MINHASH_H
+#define SATYR_MINHASH_H
+
+/**
+ * @file
+ * @brief Index of similar stack trace threads.
+ *
+ * The index finds threads which are likely to be close in the Jaccard
+ * distance without comparing them to all the other threads.  Every
+ * thread gets a MinHash signature of its set of frames, the signature
+ * is split into bands and the threads with an identical band end up in
+ * the same bucket (locality-sensitive hashing).  Threads sharing
+ * a bucket with the queried thread are the candidates, which should be
+ * verified by computing the actual distance.
+ *
+ * With b bands of r rows, two threads with Jaccard similarity s (that
+ * is 1 - distance) become candidates with probability 1 - (1 - s^r)^b.
+ * The threshold, where the probability rises steeply, is about
+ * (1/b)^(1/r).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "distance.h"
+
+struct sr_thread;
+
+/**
+ * @brief A MinHash index of threads.
+ */
+struct sr_minhash_index;
+
+/**
+ * Creates a new empty index.
+ * @param bands
+ * Number of bands of the signatures, it must be positive.
+ * @param rows
+ * Number of rows in each band, it must be positive.
+ * @returns
+ * It never returns NULL. The returned pointer must be released by
+ * calling the function sr_minhash_index_free().
+ */
+struct sr_minhash_index *
+sr_minhash_index_new(int bands, int rows);
+
+/**
+ * Releases the memory held by the index. The inserted threads are not
+ * released.
+ * @param index
+ * If the index is NULL, no operation is performed.
+ */
+void
+sr_minhash_index_free(struct sr_minhash_index *index);
+
+/**
+ * Adds a thread to the index.
+ * @param thread
+ * The thread is not copied, it must not be modified or released while
+ * the index is used.  Threads without any frame that could be equal to
+ * another frame (e.g. only unknown GDB frames) are never returned as
+ * candidates.
+ * @returns
+ * Identifier of the thread in the index, the threads are numbered from
+ * zero in the order of insertion.
+ */
+int
+sr_minhash_index_insert(struct sr_minhash_index *index,
+                        struct sr_thread *thread);
+
+/**
+ * Returns the number of threads in the index.
+ */
+int
+sr_minhash_index_size(struct sr_minhash_index *index);
+
+/**
+ * Finds the candidates for threads similar to the given one.
+ * @param thread
+ * It is not modified by calling this function.
+ * @param count
+ * Number of the returned candidates.
+ * @returns
+ * Sorted array of identifiers of the candidate threads, or NULL if there
+ * are none.  It must be released by g_free().
+ */
+int *
+sr_minhash_index_query(struct sr_minhash_index *index,
+                       struct sr_thread *thread,
+                       int *count);
+
+/**
+ * Finds the threads within the given distance from the thread.  Only the
+ * candidates from sr_minhash_index_query() are compared, using
+ * sr_distance_bounded().
+ * @param distances
+ * If not NULL, the distances of the found threads are stored to a newly
+ * allocated array, which must be released by g_free().
+ * @returns
+ * Sorted array of identifiers of the found threads, or NULL if there are
+ * none.  It must be released by g_free().
+ */
+int *
+sr_minhash_index_query_distance(struct sr_minhash_index *index,
+                                struct sr_thread *thread,
+                                enum sr_distance_type dist_type,
+                                float max_dist,
+                                int *count,
+                                float **distances);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -46,6 +46,8 @@ extern "C" {
 
 #include <json.h>
 
+struct sr_arena;
+
 struct sr_stacktrace
 {
     enum sr_report_type type;
@@ -62,6 +64,11 @@ enum sr_bthash_flags
     /* Return the plaintext that would be hashed. Useful mainly for debugging.
      */
     SR_BTHASH_NOHASH = 1 << 1,
+
+    /* Use a fast non-cryptographic 128-bit hash (MurmurHash3 x64_128)
+     * instead of SHA-1. The hashes are not compatible with the SHA-1 ones.
+     */
+    SR_BTHASH_FAST = 1 << 2,
 };
 
 /**
@@ -114,6 +121,25 @@ sr_stacktrace_from_json(enum sr_report_type, json_object *root, char **error_mes
 struct sr_stacktrace*
 sr_stacktrace_from_json_text(enum sr_report_type, const char *input, char **error_message);
 
+/**
+ * Parses the stacktrace like sr_stacktrace_parse(), but allocates it from
+ * the arena.  The stacktrace is released together with the arena, see
+ * arena.h.
+ */
+struct sr_stacktrace *
+sr_stacktrace_parse_arena(struct sr_arena *arena, enum sr_report_type type,
+                          const char *input, char **error_message);
+
+/**
+ * Deserializes the stacktrace like sr_stacktrace_from_json_text(), but
+ * allocates it from the arena.  The stacktrace is released together with
+ * the arena, see arena.h.
+ */
+struct sr_stacktrace *
+sr_stacktrace_from_json_text_arena(struct sr_arena *arena,
+                                   enum sr_report_type type,
+                                   const char *input, char **error_message);
+
 /**
  * Returns brief, human-readable explanation of the stacktrace.
  */
@@ -73,6 +73,11 @@ enum sr_duphash_flags
     /* Hashing compatible with koops hashing in ABRT <= 2.1.10.
      */
     SR_DUPHASH_KOOPS_COMPAT = 1 << 3,
+
+    /* Use a fast non-cryptographic 128-bit hash (MurmurHash3 x64_128)
+     * instead of SHA-1. The hashes are not compatible with the SHA-1 ones.
+     */
+    SR_DUPHASH_FAST = 1 << 4,
 };
 
 /**
@@ -170,6 +175,31 @@ char *
 sr_thread_get_duphash(struct sr_thread *thread, int frames, char *prefix,
                       enum sr_duphash_flags flags);
 
+/**
+ * Computes the duplication hashes of many threads at once, using as many
+ * system threads as there are processors.  The result for threads[i] is
+ * stored to out[i], it is the same as the one returned by
+ * sr_thread_get_duphash() and must be released by g_free().
+ *
+ * The threads are not modified, but they must not be modified by other
+ * threads during the call.  A thread may be present in the array more
+ * times.
+ */
+void
+sr_threads_get_duphash_batch(struct sr_thread **threads, int n, int frames,
+                             char *prefix, enum sr_duphash_flags flags,
+                             char **out);
+
+/**
+ * The same as sr_threads_get_duphash_batch(), the number of the system
+ * threads is given.  If nthreads is 0, the number of processors is used.
+ */
+void
+sr_threads_get_duphash_batch_parallel(struct sr_thread **threads, int n,
+                                      int frames, char *prefix,
+                                      enum sr_duphash_flags flags,
+                                      char **out, unsigned nthreads);
+
 #ifdef __cplusplus
 }
 #endif
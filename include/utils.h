@@ -116,6 +116,30 @@ char *
 sr_file_to_string(const char *filename,
                   char **error_message);
 
+/**
+ * Maps file contents to memory.  Unlike sr_file_to_string(), the contents
+ * are not copied and the size of the file is not limited.  The contents
+ * are read-only and terminated by '\0', so they can be passed to the
+ * parsers directly.  The file must not be truncated while it is mapped.
+ * @param size
+ * Receives the size of the file, it must be passed to sr_file_unmap().
+ * @returns
+ * File contents. If file opening/mapping fails, NULL is returned.
+ */
+const char *
+sr_file_map(const char *filename,
+            size_t *size,
+            char **error_message);
+
+/**
+ * Releases the contents returned by sr_file_map().
+ * @param contents
+ * If the contents are NULL, no operation is performed.
+ */
+void
+sr_file_unmap(const char *contents,
+              size_t size);
+
 bool
 sr_string_to_file(const char *filename,
                   char *contents,
@@ -357,6 +381,51 @@ anonymize_path(char *file_name);
 char *
 sr_demangle_symbol(const char *sym);
 
+/**
+ * Starts interning the strings of the frames created by the frame
+ * parsers (the *_frame_parse and *_frame_from_json functions).  Every
+ * distinct function, file, library, module and build id string is then
+ * stored only once in a process-wide pool and shared by all the frames,
+ * which saves a lot of memory when many reports are held at once.  The
+ * pool is thread-safe.  The calls nest, the strings are interned until
+ * sr_intern_pool_disable() has been called as many times.
+ */
+void
+sr_intern_pool_enable(void);
+
+/**
+ * Stops interning the strings of new frames.  The strings already in the
+ * pool stay there until all the frames using them are released.
+ */
+void
+sr_intern_pool_disable(void);
+
+/**
+ * Returns the number of distinct strings in the pool.
+ */
+unsigned
+sr_intern_pool_size(void);
+
+/**
+ * Returns a copy of the string to be stored in a frame.  If the pool is
+ * enabled, the copy is shared with the other frames and its reference
+ * count is increased, otherwise it is an ordinary copy.  The string
+ * must not be modified and it must be released by sr_intern_free().
+ * @param str
+ * If it is NULL, NULL is returned.
+ */
+char *
+sr_intern_strdup(const char *str);
+
+/**
+ * Releases a string of a frame, which may be an interned string or an
+ * ordinary string allocated by g_malloc().
+ * @param str
+ * If it is NULL, no operation is performed.
+ */
+void
+sr_intern_free(char *str);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,6 +51,18 @@ file_contents(const char *directory, const char *file, char **error_message)
     return contents;
 }
 
+/* Large files are mapped to be parsed without copying them. */
+static const char *
+mapped_file_contents(const char *directory, const char *file, size_t *size,
+                     char **error_message)
+{
+    char *path = sr_build_path(directory, file, NULL);
+    const char *contents = sr_file_map(path, size, error_message);
+
+    g_free(path);
+    return contents;
+}
+
 bool
 sr_abrt_print_report_from_dir(const char *directory,
                                char **error_message)
@@ -105,8 +117,8 @@ create_core_stacktrace(const char *directory, const char *gdb_output,
         core_stacktrace = sr_core_stacktrace_from_gdb(gdb_output,
                 coredump_filename, executable_contents, error_message);
     else
-        core_stacktrace = sr_parse_coredump(coredump_filename,
-                executable_contents, error_message);
+        core_stacktrace = sr_parse_coredump_parallel(coredump_filename,
+                executable_contents, 0, error_message);
 
     g_free(executable_contents);
     g_free(coredump_filename);
@@ -639,8 +651,10 @@ sr_abrt_report_from_dir(const char *directory,
     /* Core stacktrace. */
     if (report->report_type == SR_REPORT_CORE)
     {
-        char *core_backtrace_contents = file_contents(directory, "core_backtrace",
-                                                      error_message);
+        size_t core_backtrace_size;
+        const char *core_backtrace_contents =
+            mapped_file_contents(directory, "core_backtrace",
+                                 &core_backtrace_size, error_message);
         if (!core_backtrace_contents)
         {
             sr_report_free(report);
@@ -650,7 +664,7 @@ sr_abrt_report_from_dir(const char *directory,
         report->stacktrace = (struct sr_stacktrace *)sr_core_stacktrace_from_json_text(
                 core_backtrace_contents, error_message);
 
-        g_free(core_backtrace_contents);
+        sr_file_unmap(core_backtrace_contents, core_backtrace_size);
         if (!report->stacktrace)
         {
             sr_report_free(report);
@@ -661,8 +675,10 @@ sr_abrt_report_from_dir(const char *directory,
     /* Python stacktrace. */
     if (report->report_type == SR_REPORT_PYTHON)
     {
-        char *backtrace_contents = file_contents(directory, "backtrace",
-                                                 error_message);
+        size_t backtrace_size;
+        const char *backtrace_contents =
+            mapped_file_contents(directory, "backtrace", &backtrace_size,
+                                 error_message);
         if (!backtrace_contents)
         {
             sr_report_free(report);
@@ -677,7 +693,7 @@ sr_abrt_report_from_dir(const char *directory,
             &contents_pointer,
             &location);
 
-        g_free(backtrace_contents);
+        sr_file_unmap(backtrace_contents, backtrace_size);
         if (!report->stacktrace)
         {
             *error_message = sr_location_to_string(&location);
@@ -699,7 +715,10 @@ sr_abrt_report_from_dir(const char *directory,
         }
 
         /* Load the Kerneloops stacktrace */
-        char *backtrace_contents = file_contents(directory, "backtrace", error_message);
+        size_t backtrace_size;
+        const char *backtrace_contents =
+            mapped_file_contents(directory, "backtrace", &backtrace_size,
+                                 error_message);
         if (!backtrace_contents)
         {
             sr_report_free(report);
@@ -717,7 +736,7 @@ sr_abrt_report_from_dir(const char *directory,
         stacktrace->version = kernel_contents;
         report->stacktrace = (struct sr_stacktrace *)stacktrace;
 
-        g_free(backtrace_contents);
+        sr_file_unmap(backtrace_contents, backtrace_size);
         if (!report->stacktrace)
         {
             *error_message = sr_location_to_string(&location);
@@ -729,7 +748,10 @@ sr_abrt_report_from_dir(const char *directory,
     /* Java stacktrace. */
     if (report->report_type == SR_REPORT_JAVA)
     {
-        char *backtrace_contents = file_contents(directory, "backtrace", error_message);
+        size_t backtrace_size;
+        const char *backtrace_contents =
+            mapped_file_contents(directory, "backtrace", &backtrace_size,
+                                 error_message);
         if (!backtrace_contents)
         {
             sr_report_free(report);
@@ -744,7 +766,7 @@ sr_abrt_report_from_dir(const char *directory,
             &contents_pointer,
             &location);
 
-        g_free(backtrace_contents);
+        sr_file_unmap(backtrace_contents, backtrace_size);
         if (!report->stacktrace)
         {
             *error_message = sr_location_to_string(&location);
@@ -756,8 +778,10 @@ sr_abrt_report_from_dir(const char *directory,
     /* Ruby stacktrace. */
     if (report->report_type == SR_REPORT_RUBY)
     {
-        char *backtrace_contents = file_contents(directory, "backtrace",
-                                                 error_message);
+        size_t backtrace_size;
+        const char *backtrace_contents =
+            mapped_file_contents(directory, "backtrace", &backtrace_size,
+                                 error_message);
         if (!backtrace_contents)
         {
             sr_report_free(report);
@@ -772,7 +796,7 @@ sr_abrt_report_from_dir(const char *directory,
             &contents_pointer,
             &location);
 
-        g_free(backtrace_contents);
+        sr_file_unmap(backtrace_contents, backtrace_size);
         if (!report->stacktrace)
         {
             *error_message = sr_location_to_string(&location);
@@ -784,8 +808,10 @@ sr_abrt_report_from_dir(const char *directory,
     /* JavaScript stacktrace. */
     if (report->report_type == SR_REPORT_JAVASCRIPT)
     {
-        char *backtrace_contents = file_contents(directory, "backtrace",
-                                                     error_message);
+        size_t backtrace_size;
+        const char *backtrace_contents =
+            mapped_file_contents(directory, "backtrace", &backtrace_size,
+                                 error_message);
         if (!backtrace_contents)
         {
             sr_report_free(report);
@@ -797,6 +823,7 @@ sr_abrt_report_from_dir(const char *directory,
                                                 error_message);
         if (!analyzer_contents)
         {
+            sr_file_unmap(backtrace_contents, backtrace_size);
             sr_report_free(report);
             return NULL;
         }
@@ -832,7 +859,7 @@ sr_abrt_report_from_dir(const char *directory,
                 &location);
         }
 
-        g_free(backtrace_contents);
+        sr_file_unmap(backtrace_contents, backtrace_size);
         if (!report->stacktrace)
         {
             *error_message = sr_location_to_string(&location);
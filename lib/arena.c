@@ -0,0 +1,384 @@
+/*
+    arena.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "arena.h"
+#include "internal_utils.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_ROUND(size) (((size) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_MIN_CHUNK 4096
+#define ARENA_MAX_CHUNK (1024 * 1024)
+
+struct arena_chunk
+{
+    struct arena_chunk *next;
+    /* Size of the data following the header, and the used part. */
+    size_t size;
+    size_t used;
+};
+
+#define CHUNK_HEADER ARENA_ROUND(sizeof(struct arena_chunk))
+#define CHUNK_DATA(chunk) ((char *)(chunk) + CHUNK_HEADER)
+
+struct sr_arena
+{
+    /* The first chunk is the one being filled. */
+    struct arena_chunk *chunks;
+    size_t next_chunk_size;
+    size_t size;
+};
+
+/* The data of the chunks of all the arenas, sorted by the start address,
+ * so that arena_free() can tell the memory of the arenas from the
+ * memory allocated by g_malloc(). */
+struct chunk_range
+{
+    char *start;
+    char *end;
+};
+
+struct registry_table
+{
+    /* The retired table this one replaced. */
+    struct registry_table *retired;
+    size_t allocated;
+    struct chunk_range ranges[];
+};
+
+/* The writers hold the lock. The readers do not lock, they retry when the
+ * sequence is odd or has changed while they were reading, which is the case
+ * while a writer is moving the ranges. A table outgrown by the registry is
+ * kept instead of being freed, a reader may still be reading it. Together, the
+ * retired tables take less memory than the current one. */
+static GMutex registry_mutex;
+static struct registry_table *registry;
+static gint registry_sequence;
+/* Number of the ranges, it can be read without the lock to find out that
+ * no memory belongs to an arena. */
+static gint registry_count;
+
+/* The arena the parsers of the calling thread allocate from. */
+static GPrivate current_arena;
+
+/* Returns the index of the first range starting after the address. */
+static size_t
+registry_upper_bound(struct registry_table *table, size_t count,
+                     const char *address)
+{
+    size_t low = 0, high = count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if ((const char *)g_atomic_pointer_get(&table->ranges[middle].start) <= address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+static void
+registry_set(struct registry_table *table, size_t index,
+             char *start, char *end)
+{
+    g_atomic_pointer_set(&table->ranges[index].start, start);
+    g_atomic_pointer_set(&table->ranges[index].end, end);
+}
+
+static void
+registry_add(struct arena_chunk *chunk)
+{
+    char *start = CHUNK_DATA(chunk);
+
+    g_mutex_lock(&registry_mutex);
+
+    size_t count = g_atomic_int_get(&registry_count);
+    if (!registry || count == registry->allocated)
+    {
+        size_t allocated = registry ? 2 * registry->allocated : 16;
+        struct registry_table *table = g_malloc(sizeof(*table) +
+            allocated * sizeof(table->ranges[0]));
+        table->retired = registry;
+        table->allocated = allocated;
+        if (registry)
+        {
+            memcpy(table->ranges, registry->ranges,
+                   count * sizeof(table->ranges[0]));
+        }
+
+        g_atomic_pointer_set(&registry, table);
+    }
+
+    g_atomic_int_inc(&registry_sequence);
+    size_t index = registry_upper_bound(registry, count, start);
+    for (size_t i = count; i > index; --i)
+    {
+        registry_set(registry, i, registry->ranges[i - 1].start,
+                     registry->ranges[i - 1].end);
+    }
+
+    registry_set(registry, index, start, start + chunk->size);
+    g_atomic_int_inc(&registry_count);
+    g_atomic_int_inc(&registry_sequence);
+
+    g_mutex_unlock(&registry_mutex);
+}
+
+static void
+registry_remove(struct arena_chunk *chunk)
+{
+    char *start = CHUNK_DATA(chunk);
+
+    g_mutex_lock(&registry_mutex);
+
+    size_t count = g_atomic_int_get(&registry_count);
+    size_t index = registry_upper_bound(registry, count, start);
+    assert(index > 0 && registry->ranges[index - 1].start == start);
+
+    g_atomic_int_inc(&registry_sequence);
+    for (size_t i = index; i < count; ++i)
+    {
+        registry_set(registry, i - 1, registry->ranges[i].start,
+                     registry->ranges[i].end);
+    }
+
+    g_atomic_int_add(&registry_count, -1);
+    g_atomic_int_inc(&registry_sequence);
+
+    g_mutex_unlock(&registry_mutex);
+}
+
+static bool
+registry_contains(const void *ptr)
+{
+    const char *address = ptr;
+
+    for (;;)
+    {
+        gint sequence = g_atomic_int_get(&registry_sequence);
+        if (sequence & 1)
+            continue;
+
+        struct registry_table *table = g_atomic_pointer_get(&registry);
+        size_t count = MIN((size_t)g_atomic_int_get(&registry_count),
+                           table->allocated);
+        size_t index = registry_upper_bound(table, count, address);
+        bool result = index > 0 &&
+            address < (const char *)g_atomic_pointer_get(&table->ranges[index - 1].end);
+
+        if (g_atomic_int_get(&registry_sequence) == sequence)
+            return result;
+    }
+}
+
+struct sr_arena *
+sr_arena_new(void)
+{
+    struct sr_arena *arena = g_malloc(sizeof(*arena));
+    arena->chunks = NULL;
+    arena->next_chunk_size = ARENA_MIN_CHUNK;
+    arena->size = 0;
+    return arena;
+}
+
+void
+sr_arena_free(struct sr_arena *arena)
+{
+    if (!arena)
+        return;
+
+    struct arena_chunk *chunk = arena->chunks;
+    while (chunk)
+    {
+        struct arena_chunk *next = chunk->next;
+        registry_remove(chunk);
+        g_free(chunk);
+        chunk = next;
+    }
+
+    g_free(arena);
+}
+
+size_t
+sr_arena_size(const struct sr_arena *arena)
+{
+    return arena->size;
+}
+
+static struct arena_chunk *
+arena_chunk_new(size_t size)
+{
+    struct arena_chunk *chunk = g_malloc(CHUNK_HEADER + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    registry_add(chunk);
+    return chunk;
+}
+
+static void *
+arena_alloc(struct sr_arena *arena, size_t size)
+{
+    size = ARENA_ROUND(size);
+    arena->size += size;
+
+    struct arena_chunk *chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        if (size > arena->next_chunk_size / 2)
+        {
+            /* Large blocks get a chunk of their own, the current chunk
+             * keeps being filled. */
+            chunk = arena_chunk_new(size);
+            if (arena->chunks)
+            {
+                chunk->next = arena->chunks->next;
+                arena->chunks->next = chunk;
+            }
+            else
+                arena->chunks = chunk;
+        }
+        else
+        {
+            chunk = arena_chunk_new(arena->next_chunk_size);
+            chunk->next = arena->chunks;
+            arena->chunks = chunk;
+            arena->next_chunk_size = MIN(2 * arena->next_chunk_size,
+                                         ARENA_MAX_CHUNK);
+        }
+    }
+
+    void *result = CHUNK_DATA(chunk) + chunk->used;
+    chunk->used += size;
+    return result;
+}
+
+struct sr_arena *
+arena_set_current(struct sr_arena *arena)
+{
+    struct sr_arena *previous = g_private_get(&current_arena);
+    g_private_set(&current_arena, arena);
+    return previous;
+}
+
+struct sr_arena *
+arena_get_current(void)
+{
+    return g_private_get(&current_arena);
+}
+
+void *
+arena_malloc(size_t size)
+{
+    struct sr_arena *arena = g_private_get(&current_arena);
+    if (!arena || size == 0)
+        return g_malloc(size);
+
+    return arena_alloc(arena, size);
+}
+
+void *
+arena_realloc(void *ptr, size_t old_size, size_t size)
+{
+    struct sr_arena *arena = g_private_get(&current_arena);
+    if (!arena)
+        return g_realloc(ptr, size);
+
+    void *result = arena_alloc(arena, size);
+    if (ptr)
+    {
+        memcpy(result, ptr, MIN(old_size, size));
+        arena_free(ptr);
+    }
+
+    return result;
+}
+
+char *
+arena_strndup(const char *str, size_t length)
+{
+    if (!str)
+        return NULL;
+
+    struct sr_arena *arena = g_private_get(&current_arena);
+    if (!arena)
+        return g_strndup(str, length);
+
+    char *result = arena_alloc(arena, length + 1);
+    strncpy(result, str, length);
+    result[length] = '\0';
+    return result;
+}
+
+char *
+arena_strdup(const char *str)
+{
+    if (!str)
+        return NULL;
+
+    struct sr_arena *arena = g_private_get(&current_arena);
+    if (!arena)
+        return g_strdup(str);
+
+    size_t length = strlen(str);
+    char *result = arena_alloc(arena, length + 1);
+    memcpy(result, str, length + 1);
+    return result;
+}
+
+char *
+arena_strdup_printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    char *result = g_strdup_vprintf(format, args);
+    va_end(args);
+
+    if (!g_private_get(&current_arena))
+        return result;
+
+    char *copy = arena_strdup(result);
+    g_free(result);
+    return copy;
+}
+
+char *
+arena_string_free(GString *string)
+{
+    if (!g_private_get(&current_arena))
+        return g_string_free(string, FALSE);
+
+    char *result = arena_strndup(string->str, string->len);
+    g_string_free(string, TRUE);
+    return result;
+}
+
+void
+arena_free(void *ptr)
+{
+    if (!ptr)
+        return;
+
+    if (g_atomic_int_get(&registry_count) == 0 || !registry_contains(ptr))
+        g_free(ptr);
+}
@@ -26,10 +26,10 @@
 
 struct sr_callgraph *
 sr_callgraph_compute(struct sr_disasm_state *disassembler,
-                     struct sr_elf_fde *eh_frame,
+                     struct sr_elf_fde_index *eh_frame,
                      char **error_message)
 {
-    struct sr_elf_fde *fde_entry = eh_frame;
+    struct sr_elf_fde *fde_entry = eh_frame->fdes;
     struct sr_callgraph *result = NULL, *last = NULL;
     while (fde_entry)
     {
@@ -71,15 +71,15 @@ struct sr_callgraph *
 sr_callgraph_extend(struct sr_callgraph *callgraph,
                     uint64_t start_address,
                     struct sr_disasm_state *disassembler,
-                    struct sr_elf_fde *eh_frame,
+                    struct sr_elf_fde_index *eh_frame,
                     char **error_message)
 {
     if (sr_callgraph_find(callgraph, start_address))
         return callgraph;
 
     struct sr_elf_fde *fde =
-        sr_elf_find_fde_for_start_address(eh_frame,
-                                           start_address);
+        sr_elf_fde_index_find_for_start_address(eh_frame,
+                                                start_address);
 
     if (!fde)
     {
@@ -39,7 +39,7 @@ extern "C" {
 #include <inttypes.h>
 
 struct sr_disasm_state;
-struct sr_elf_fde;
+struct sr_elf_fde_index;
 
 /**
  * @brief A call graph representing calling relationships between
@@ -71,7 +71,7 @@ struct sr_callgraph
 
 struct sr_callgraph *
 sr_callgraph_compute(struct sr_disasm_state *disassembler,
-                     struct sr_elf_fde *eh_frame,
+                     struct sr_elf_fde_index *eh_frame,
                      char **error_message);
 
 /// Assumption: when a fde is included in the callgraph, we assume
@@ -80,7 +80,7 @@ struct sr_callgraph *
 sr_callgraph_extend(struct sr_callgraph *callgraph,
                     uint64_t start_address,
                     struct sr_disasm_state *disassembler,
-                    struct sr_elf_fde *eh_frame,
+                    struct sr_elf_fde_index *eh_frame,
                     char **error_message);
 
 void
@@ -21,9 +21,11 @@
 #include "cluster.h"
 #include "distance.h"
 #include "utils.h"
+#include "matrix_file.h"
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
 
 struct sr_dendrogram *
 sr_dendrogram_new(int size)
@@ -36,6 +38,10 @@ sr_dendrogram_new(int size)
     dendrogram->order = g_malloc_n(size, sizeof(*dendrogram->order));
     dendrogram->merge_levels =
         g_malloc_n(size - 1, sizeof(*dendrogram->merge_levels));
+    dendrogram->dist_type = SR_DISTANCE_UNKNOWN;
+    dendrogram->checksum = 0;
+    dendrogram->mapping = NULL;
+    dendrogram->mapping_size = 0;
 
     return dendrogram;
 }
@@ -45,11 +51,106 @@ sr_dendrogram_free(struct sr_dendrogram *dendrogram)
 {
     if (!dendrogram)
         return;
-    g_free(dendrogram->order);
-    g_free(dendrogram->merge_levels);
+    if (dendrogram->mapping)
+    {
+        struct matrix_file_mapping mapping =
+        {
+            .address = dendrogram->mapping,
+            .size = dendrogram->mapping_size,
+        };
+
+        matrix_file_unmap(&mapping);
+    }
+    else
+    {
+        g_free(dendrogram->order);
+        g_free(dendrogram->merge_levels);
+    }
     g_free(dendrogram);
 }
 
+bool
+sr_dendrogram_save(struct sr_dendrogram *dendrogram,
+                   const char *filename,
+                   char **error_message)
+{
+    struct matrix_file_header header =
+    {
+        .magic = MATRIX_FILE_MAGIC_DENDROGRAM,
+        .m = dendrogram->size,
+        .n = dendrogram->size,
+        .dist_type = dendrogram->dist_type,
+        .checksum = dendrogram->checksum,
+    };
+    const void *chunks[] = { dendrogram->order, dendrogram->merge_levels };
+    size_t chunk_sizes[] =
+    {
+        sizeof(*dendrogram->order) * dendrogram->size,
+        sizeof(*dendrogram->merge_levels) * (dendrogram->size - 1),
+    };
+
+    return matrix_file_write(filename, &header, chunks, chunk_sizes, 2,
+                             error_message);
+}
+
+struct sr_dendrogram *
+sr_dendrogram_load(const char *filename, char **error_message)
+{
+    struct matrix_file_mapping mapping;
+    struct matrix_file_header *header =
+        matrix_file_map(filename, MATRIX_FILE_MAGIC_DENDROGRAM, &mapping,
+                        error_message);
+
+    if (!header)
+        return NULL;
+
+    if (header->m <= 1 || header->n != header->m ||
+        !matrix_file_dist_type_valid(header->dist_type) ||
+        header->data_size != sizeof(int) * header->m
+                             + sizeof(float) * (header->m - 1))
+    {
+        *error_message = g_strdup_printf("File '%s' contains an invalid "
+                                         "dendrogram.", filename);
+        matrix_file_unmap(&mapping);
+        return NULL;
+    }
+
+    /* The order is used to index the arrays of the objects, it must be a
+     * permutation of them. */
+    const int *order = (const int *)(header + 1);
+    bool *seen = g_malloc0_n(header->m, sizeof(*seen));
+    bool valid_order = true;
+
+    for (int i = 0; i < header->m && valid_order; i++)
+    {
+        valid_order = order[i] >= 0 && order[i] < header->m && !seen[order[i]];
+        if (valid_order)
+            seen[order[i]] = true;
+    }
+
+    g_free(seen);
+
+    if (!valid_order)
+    {
+        *error_message = g_strdup_printf("File '%s' contains an invalid "
+                                         "dendrogram.", filename);
+        matrix_file_unmap(&mapping);
+        return NULL;
+    }
+
+    struct sr_dendrogram *dendrogram = g_malloc(sizeof(*dendrogram));
+
+    dendrogram->size = header->m;
+    dendrogram->order = (int *)(header + 1);
+    dendrogram->merge_levels = (float *)(dendrogram->order + header->m);
+    dendrogram->dist_type = header->dist_type;
+    dendrogram->checksum = header->checksum;
+    dendrogram->mapping = mapping.address;
+    dendrogram->mapping_size = mapping.size;
+
+    return dendrogram;
+}
+
 struct cluster
 {
     int size;
@@ -104,63 +205,218 @@ cluster_reverse(struct cluster *cluster)
     }
 }
 
-struct sr_dendrogram *
-sr_distances_cluster_objects(struct sr_distances *distances)
+/* Merges the cluster c2 into the cluster c1 at the given level. */
+static void
+clusters_join(struct sr_distances *distances,
+              struct cluster *clusters,
+              float *merge_levels,
+              int c1,
+              int c2,
+              float level)
 {
-    assert(distances->n);
-    int i, j, merges, m = distances->m, n = distances->n;
+    bool reverse1, reverse2;
+    float dists[4];
+    int i;
 
-    struct sr_distances *cluster_distances;
-    struct cluster clusters[n];
-    /* to stop gcc 11 from complaining about uninitialized variables */
-    clusters[0].objects = NULL;
+    /* With full distance matrix, merge the sequences of the two clusters
+     * so outer objects with minimal distance will be next to each other. */
+    if (distances->m + 1 == distances->n)
+    {
+        dists[0] = sr_distances_get_distance(distances,
+                clusters[c1].objects[0], clusters[c2].objects[0]);
+        dists[1] = sr_distances_get_distance(distances,
+                clusters[c1].objects[clusters[c1].size - 1],
+                clusters[c2].objects[0]);
+        dists[2] = sr_distances_get_distance(distances,
+                clusters[c1].objects[0],
+                clusters[c2].objects[clusters[c2].size - 1]);
+        dists[3] = sr_distances_get_distance(distances,
+                clusters[c1].objects[clusters[c1].size - 1],
+                clusters[c2].objects[clusters[c2].size - 1]);
+        if (dists[1] <= dists[0] && dists[1] <= dists[2] &&
+                dists[1] <= dists[3])
+            reverse1 = false, reverse2 = false;
+        else if (dists[0] <= dists[1] && dists[0] <= dists[2] &&
+                dists[0] <= dists[3])
+            reverse1 = true, reverse2 = false;
+        else if (dists[2] <= dists[0] && dists[2] <= dists[1] &&
+                dists[2] <= dists[3])
+            reverse1 = true, reverse2 = true;
+        else
+            reverse1 = false, reverse2 = true;
+    }
+    else
+        reverse1 = false, reverse2 = false;
 
-    float merge_levels[n];
+    /* If the cluster sequences need to be reversed, shift the merge levels
+     * as they will be pointing to the opposide direction. */
+    if (reverse1)
+    {
+        for (i = 1; i < clusters[c1].size; i++)
+            merge_levels[clusters[c1].objects[i - 1]] =
+                merge_levels[clusters[c1].objects[i]];
+        cluster_reverse(&clusters[c1]);
+    }
+    if (reverse2)
+    {
+        for (i = 1; i < clusters[c2].size; i++)
+            merge_levels[clusters[c2].objects[i - 1]] =
+                merge_levels[clusters[c2].objects[i]];
+        cluster_reverse(&clusters[c2]);
+    }
 
-    cluster_distances = sr_distances_dup(distances);
+    /* Save the level at which the cluster is merged. */
+    merge_levels[clusters[c2].objects[0]] = level;
 
-    /* Start with one cluster per each object. */
-    for (i = 0; i < n; i++)
+    /* Merge the two clusters. */
+    cluster_merge(&clusters[c1], &clusters[c2]);
+    cluster_clean(&clusters[c2]);
+}
+
+/* Lance-Williams update of the distance between a cluster of the given
+ * size and the union of clusters 1 and 2. */
+static float
+linkage_distance(enum sr_linkage linkage,
+                 float dist1,
+                 int size1,
+                 float dist2,
+                 int size2,
+                 float dist12,
+                 int size)
+{
+    float dist;
+
+    switch (linkage)
     {
-        cluster_init(&clusters[i]);
-        cluster_add_index(&clusters[i], i);
+        case SR_LINKAGE_SINGLE:
+            return dist1 < dist2 ? dist1 : dist2;
+        case SR_LINKAGE_COMPLETE:
+            return dist1 > dist2 ? dist1 : dist2;
+        case SR_LINKAGE_AVERAGE:
+            return (dist1 * size1 + dist2 * size2) / (size1 + size2);
+        case SR_LINKAGE_WARD:
+            dist = ((size1 + size) * dist1 * dist1 +
+                    (size2 + size) * dist2 * dist2 -
+                    size * dist12 * dist12) / (size1 + size2 + size);
+            /* Rounding errors, or distances which are far from being
+             * euclidean, may end up below zero. */
+            return dist > 0.0 ? sqrtf(dist) : 0.0;
+        default:
+            assert(0 && "Invalid linkage");
+            return 0.0;
+    }
+}
+
+/* The nearest cluster in a row of the cluster distance matrix. */
+struct neighbour
+{
+    /* Index of the cluster, -1 if there is no cluster in the row. */
+    int index;
+    float distance;
+};
+
+static void
+find_neighbour(struct sr_distances *distances,
+               const struct cluster *clusters,
+               int i,
+               struct neighbour *neighbour)
+{
+    neighbour->index = -1;
+    neighbour->distance = 0.0;
+
+    for (int j = i + 1; j < distances->n; j++)
+    {
+        if (!clusters[j].size)
+            continue;
+
+        float dist = sr_distances_get_distance(distances, i, j);
+
+        /* Keep the first of equally distant clusters. */
+        if (neighbour->index < 0 || neighbour->distance > dist)
+        {
+            neighbour->index = j;
+            neighbour->distance = dist;
+        }
+    }
+}
+
+/* Working copy of the distances, in which the distances between the
+ * clusters are updated.  It has the storage of the distances, so that
+ * a reduced precision matrix is not expanded to floats.  The single,
+ * complete and average linkages keep the cluster distances within the
+ * range of the object distances, but Ward's may exceed 1, which the
+ * bytes would clamp, so they are stored as half floats instead. */
+static struct sr_distances *
+distances_dup_working(struct sr_distances *distances,
+                      enum sr_linkage linkage)
+{
+    if (distances->storage != SR_DISTANCES_UINT8 ||
+        linkage != SR_LINKAGE_WARD)
+    {
+        return sr_distances_dup(distances);
     }
 
+    struct sr_distances *copy = sr_distances_new_ext(distances->m,
+                                                     distances->n,
+                                                     SR_DISTANCES_FLOAT16);
+
+    for (int i = 0; i < distances->m; i++)
+    {
+        for (int j = i + 1; j < distances->n; j++)
+        {
+            sr_distances_set_distance(copy, i, j,
+                                      sr_distances_get_distance(distances, i, j));
+        }
+    }
+
+    return copy;
+}
+
+/* Merges the two closest clusters until there is only one left, the
+ * distances of the merged cluster are computed by the linkage. */
+static void
+cluster_matrix(struct sr_distances *distances,
+               enum sr_linkage linkage,
+               struct cluster *clusters,
+               float *merge_levels)
+{
+    int i, merges, m = distances->m, n = distances->n;
+
+    struct sr_distances *cluster_distances =
+        distances_dup_working(distances, linkage);
+    /* Nearest neighbour of every row, so that finding the two closest
+     * clusters does not need to scan the whole matrix. */
+    struct neighbour *neighbours = g_malloc_n(m, sizeof(*neighbours));
+
+    for (i = 0; i < m; i++)
+        find_neighbour(cluster_distances, clusters, i, &neighbours[i]);
+
     /* Merge clusters n - 1 times so there will be only one cluster left. */
     for (merges = 0; merges + 1 < n; merges++)
     {
-        bool first, reverse1, reverse2;
         int c1, c2;
-        float dist, min_dist, dists[4];
+        float dist, min_dist;
 
         /* Quiet compiler. */
-        c1 = c2 = 0;
+        c1 = -1, c2 = 0;
         min_dist = 0.0;
 
-        /* Find two clusters with minimal distance. */
-        for (i = 0, first = true; i < m; i++)
+        /* Find two clusters with minimal distance, the first pair in the
+         * matrix wins if there are more of them. */
+        for (i = 0; i < m; i++)
         {
-            if (!clusters[i].size)
+            if (!clusters[i].size || neighbours[i].index < 0)
                 continue;
 
-            for (j = i + 1; j < n; j++)
+            if (c1 < 0 || min_dist > neighbours[i].distance)
             {
-                if (!clusters[j].size)
-                    continue;
-
-                dist = sr_distances_get_distance(cluster_distances, i, j);
-
-                if (first || min_dist > dist)
-                {
-                    min_dist = dist;
-                    c1 = i;
-                    c2 = j;
-                    first = false;
-                }
+                min_dist = neighbours[i].distance;
+                c1 = i;
+                c2 = neighbours[i].index;
             }
         }
 
-        assert(!first && c1 < c2);
+        assert(c1 >= 0 && c1 < c2);
 
         /* Update distances of the new cluster to other clusters. */
         for (i = 0; i < n; i++)
@@ -172,86 +428,199 @@ sr_distances_cluster_objects(struct sr_distances *distances)
             if (!(c2 < m || i < m))
                 continue;
 
-            dists[0] = sr_distances_get_distance(cluster_distances, i, c1);
-            dists[1] = sr_distances_get_distance(cluster_distances, i, c2);
-
-            /* The cluster distance algorithm is hardcoded for now. */
-            switch (3)
-            {
-                case 1:
-                    /* maximum */
-                    dist = dists[0] > dists[1] ? dists[0] : dists[1];
-                    break;
-                case 2:
-                    /* minimum */
-                    dist = dists[0] < dists[1] ? dists[0] : dists[1];
-                    break;
-                case 3:
-                    /* average */
-                    dist = (dists[0] * clusters[c1].size + dists[1] * clusters[c2].size) / (clusters[c1].size + clusters[c2].size);
-                    break;
-            }
+            dist = linkage_distance(linkage,
+                    sr_distances_get_distance(cluster_distances, i, c1),
+                    clusters[c1].size,
+                    sr_distances_get_distance(cluster_distances, i, c2),
+                    clusters[c2].size,
+                    min_dist,
+                    clusters[i].size);
 
             sr_distances_set_distance(cluster_distances, i, c1, dist);
         }
 
-        /* With full distance matrix, merge the sequences of the two clusters
-         * so outer objects with minimal distance will be next to each other. */
-        if (m + 1 == n)
+        clusters_join(distances, clusters, merge_levels, c1, c2, min_dist);
+
+        /* Only the rows that pointed to one of the merged clusters need to
+         * be searched again, the others can just check the new cluster. */
+        find_neighbour(cluster_distances, clusters, c1, &neighbours[c1]);
+
+        for (i = 0; i < m; i++)
         {
-            dists[0] = sr_distances_get_distance(distances,
-                    clusters[c1].objects[0], clusters[c2].objects[0]);
-            dists[1] = sr_distances_get_distance(distances,
-                    clusters[c1].objects[clusters[c1].size - 1],
-                    clusters[c2].objects[0]);
-            dists[2] = sr_distances_get_distance(distances,
-                    clusters[c1].objects[0],
-                    clusters[c2].objects[clusters[c2].size - 1]);
-            dists[3] = sr_distances_get_distance(distances,
-                    clusters[c1].objects[clusters[c1].size - 1],
-                    clusters[c2].objects[clusters[c2].size - 1]);
-            if (dists[1] <= dists[0] && dists[1] <= dists[2] &&
-                    dists[1] <= dists[3])
-                reverse1 = false, reverse2 = false;
-            else if (dists[0] <= dists[1] && dists[0] <= dists[2] &&
-                    dists[0] <= dists[3])
-                reverse1 = true, reverse2 = false;
-            else if (dists[2] <= dists[0] && dists[2] <= dists[1] &&
-                    dists[2] <= dists[3])
-                reverse1 = true, reverse2 = true;
-            else
-                reverse1 = false, reverse2 = true;
+            if (!clusters[i].size || i == c1)
+                continue;
+
+            if (neighbours[i].index == c1 || neighbours[i].index == c2)
+                find_neighbour(cluster_distances, clusters, i, &neighbours[i]);
+            else if (i < c1)
+            {
+                dist = sr_distances_get_distance(cluster_distances, i, c1);
+
+                if (neighbours[i].index < 0 ||
+                    neighbours[i].distance > dist ||
+                    (neighbours[i].distance == dist &&
+                     neighbours[i].index > c1))
+                {
+                    neighbours[i].index = c1;
+                    neighbours[i].distance = dist;
+                }
+            }
         }
-        else
-            reverse1 = false, reverse2 = false;
+    }
+
+    sr_distances_free(cluster_distances);
+    g_free(neighbours);
+}
+
+/* An edge of the minimum spanning tree, object1 < object2. */
+struct mst_edge
+{
+    int object1;
+    int object2;
+    float distance;
+};
+
+static int
+mst_edge_cmp(const void *ptr1, const void *ptr2)
+{
+    const struct mst_edge *edge1 = ptr1, *edge2 = ptr2;
+
+    if (edge1->distance != edge2->distance)
+        return edge1->distance < edge2->distance ? -1 : 1;
+    if (edge1->object1 != edge2->object1)
+        return edge1->object1 - edge2->object1;
+    return edge1->object2 - edge2->object2;
+}
+
+static int
+mst_find(int *parents, int i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+
+    return i;
+}
+
+/* Single linkage clustering of a full distance matrix. The clusters
+ * are merged along the edges of the minimum spanning tree (found by
+ * Prim's algorithm) in order of increasing length, which takes O(n^2)
+ * time instead of O(n^3) of the matrix updates. */
+static void
+cluster_single_mst(struct sr_distances *distances,
+                   struct cluster *clusters,
+                   float *merge_levels)
+{
+    int i, j, n = distances->n;
 
-        /* If the cluster sequences need to be reversed, shift the merge levels
-         * as they will be pointing to the opposide direction. */
-        if (reverse1)
+    struct mst_edge *edges = g_malloc_n(n - 1, sizeof(*edges));
+    /* Distance of each object not yet in the tree to the tree, and the
+     * tree object it is closest to. */
+    float *tree_distances = g_malloc_n(n, sizeof(*tree_distances));
+    int *tree_objects = g_malloc_n(n, sizeof(*tree_objects));
+    bool *in_tree = g_malloc0_n(n, sizeof(*in_tree));
+    int last = 0;
+
+    in_tree[0] = true;
+    for (i = 1; i < n; i++)
+    {
+        tree_distances[i] = sr_distances_get_distance(distances, 0, i);
+        tree_objects[i] = 0;
+    }
+
+    for (i = 0; i + 1 < n; i++)
+    {
+        int next = -1;
+
+        for (j = 1; j < n; j++)
         {
-            for (i = 1; i < clusters[c1].size; i++)
-                merge_levels[clusters[c1].objects[i - 1]] =
-                    merge_levels[clusters[c1].objects[i]];
-            cluster_reverse(&clusters[c1]);
+            if (in_tree[j])
+                continue;
+
+            float dist = sr_distances_get_distance(distances, last, j);
+            if (dist < tree_distances[j])
+            {
+                tree_distances[j] = dist;
+                tree_objects[j] = last;
+            }
+
+            if (next < 0 || tree_distances[next] > tree_distances[j])
+                next = j;
         }
-        if (reverse2)
+
+        in_tree[next] = true;
+        edges[i].object1 = MIN(next, tree_objects[next]);
+        edges[i].object2 = MAX(next, tree_objects[next]);
+        edges[i].distance = tree_distances[next];
+        last = next;
+    }
+
+    qsort(edges, n - 1, sizeof(*edges), mst_edge_cmp);
+
+    /* Every set of objects is kept in the cluster of its lowest index,
+     * as it is with the matrix updates. */
+    int *parents = tree_objects;
+    for (i = 0; i < n; i++)
+        parents[i] = i;
+
+    for (i = 0; i + 1 < n; i++)
+    {
+        int c1 = mst_find(parents, edges[i].object1);
+        int c2 = mst_find(parents, edges[i].object2);
+
+        if (c1 > c2)
         {
-            for (i = 1; i < clusters[c2].size; i++)
-                merge_levels[clusters[c2].objects[i - 1]] =
-                    merge_levels[clusters[c2].objects[i]];
-            cluster_reverse(&clusters[c2]);
+            int t = c1;
+            c1 = c2, c2 = t;
         }
 
-        /* Save the level at which the cluster is merged. */
-        merge_levels[clusters[c2].objects[0]] = min_dist;
+        clusters_join(distances, clusters, merge_levels, c1, c2,
+                      edges[i].distance);
+        parents[c2] = c1;
+    }
+
+    g_free(in_tree);
+    g_free(tree_objects);
+    g_free(tree_distances);
+    g_free(edges);
+}
+
+struct sr_dendrogram *
+sr_distances_cluster_objects(struct sr_distances *distances)
+{
+    return sr_distances_cluster_objects_ext(distances, SR_LINKAGE_AVERAGE);
+}
+
+struct sr_dendrogram *
+sr_distances_cluster_objects_ext(struct sr_distances *distances,
+                                 enum sr_linkage linkage)
+{
+    assert(distances->n);
+    assert(linkage < SR_LINKAGE_NUM);
+    int i, n = distances->n;
+
+    struct cluster *clusters = g_malloc_n(n, sizeof(*clusters));
+    float *merge_levels = g_malloc_n(n, sizeof(*merge_levels));
 
-        /* Merge the two clusters. */
-        cluster_merge(&clusters[c1], &clusters[c2]);
-        cluster_clean(&clusters[c2]);
+    /* Start with one cluster per each object. */
+    for (i = 0; i < n; i++)
+    {
+        cluster_init(&clusters[i]);
+        cluster_add_index(&clusters[i], i);
     }
 
+    /* The spanning tree needs all the distances. */
+    if (linkage == SR_LINKAGE_SINGLE && distances->m + 1 == n)
+        cluster_single_mst(distances, clusters, merge_levels);
+    else
+        cluster_matrix(distances, linkage, clusters, merge_levels);
+
     struct sr_dendrogram *dendrogram = sr_dendrogram_new(n);
 
+    dendrogram->dist_type = distances->dist_type;
+    dendrogram->checksum = distances->checksum;
     for (i = 0; i < n; i++)
         dendrogram->order[i] = clusters[0].objects[i];
     /* Save the merge levels in the same order as the objects. */
@@ -259,7 +628,8 @@ sr_distances_cluster_objects(struct sr_distances *distances)
         dendrogram->merge_levels[i - 1] = merge_levels[clusters[0].objects[i]];
 
     cluster_clean(&clusters[0]);
-    sr_distances_free(cluster_distances);
+    g_free(merge_levels);
+    g_free(clusters);
 
     return dendrogram;
 }
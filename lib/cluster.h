@@ -32,7 +32,10 @@
 extern "C" {
 #endif
 
-struct sr_distances;
+#include "distance.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief A dendrogram created by clustering.
@@ -49,6 +52,14 @@ struct sr_dendrogram
      * There are (size - 1) levels.
      */
     float *merge_levels;
+    /* Type of the distances and the checksum of the clustered threads,
+     * copied from the distance matrix. */
+    enum sr_distance_type dist_type;
+    uint32_t checksum;
+    /* Private, memory mapping of the file the dendrogram was loaded
+     * from. */
+    void *mapping;
+    size_t mapping_size;
 };
 
 /**
@@ -71,7 +82,59 @@ void
 sr_dendrogram_free(struct sr_dendrogram *dendrogram);
 
 /**
- * Performs hierarchical agglomerative clustering on objects.
+ * Saves the dendrogram to a binary file, which can be loaded by
+ * sr_dendrogram_load(). The file format is described at
+ * sr_distances_save().
+ * @param dendrogram
+ * It must be non-NULL pointer. The structure is not modified by calling
+ * this function.
+ * @param error_message
+ * If the file cannot be written, it is set to a newly allocated error
+ * message, which must be released by g_free().
+ * @returns
+ * True on success.
+ */
+bool
+sr_dendrogram_save(struct sr_dendrogram *dendrogram,
+                   const char *filename,
+                   char **error_message);
+
+/**
+ * Loads the dendrogram saved by sr_dendrogram_save(). The file is mapped
+ * to the memory, see sr_distances_load().
+ * @param error_message
+ * If the file cannot be loaded, it is set to a newly allocated error
+ * message, which must be released by g_free().
+ * @returns
+ * The dendrogram which must be released by calling sr_dendrogram_free(),
+ * or NULL on failure.
+ */
+struct sr_dendrogram *
+sr_dendrogram_load(const char *filename, char **error_message);
+
+/**
+ * How the distance between two clusters is computed from the distances
+ * between their objects.
+ */
+enum sr_linkage
+{
+    /* The distance of the closest pair of objects. */
+    SR_LINKAGE_SINGLE,
+    /* The distance of the farthest pair of objects. */
+    SR_LINKAGE_COMPLETE,
+    /* The average distance of all pairs of objects (UPGMA). */
+    SR_LINKAGE_AVERAGE,
+    /* The increase of the within-cluster variance after the merge
+     * (Ward's method, computed on the distances as if they were
+     * euclidean). */
+    SR_LINKAGE_WARD,
+    /* Number of linkages. Must be last. */
+    SR_LINKAGE_NUM
+};
+
+/**
+ * Performs hierarchical agglomerative clustering on objects, using
+ * the average linkage.
  * @param distances
  * Distances between the objects. The structure is not modified by
  * calling this function.
@@ -79,6 +142,21 @@ sr_dendrogram_free(struct sr_dendrogram *dendrogram);
 struct sr_dendrogram *
 sr_distances_cluster_objects(struct sr_distances *distances);
 
+/**
+ * Performs hierarchical agglomerative clustering on objects.
+ * @param distances
+ * Distances between the objects. The structure is not modified by
+ * calling this function.
+ * @param linkage
+ * The method of computing distances between clusters. The single
+ * linkage with a full distance matrix is computed from the minimum
+ * spanning tree of the objects, which is much faster than the other
+ * linkages.
+ */
+struct sr_dendrogram *
+sr_distances_cluster_objects_ext(struct sr_distances *distances,
+                                 enum sr_linkage linkage);
+
 /**
  * @brief A cluster of objects from a dendrogram.
  */
@@ -36,6 +36,12 @@ core_append_bthash_text(struct sr_core_frame *frame, enum sr_bthash_flags flags,
 static void
 core_append_duphash_text(struct sr_core_frame *frame, enum sr_duphash_flags flags,
                          GString *strbuf);
+static enum frame_symbol_kind
+core_symbol_key(struct sr_core_frame *frame, GString *key,
+                const char **qualifier);
+static void
+core_frozen_fields(struct sr_core_frame *frame,
+                   struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(core_next, struct sr_frame, struct sr_core_frame)
 DEFINE_SET_NEXT_FUNC(core_set_next, struct sr_frame, struct sr_core_frame)
@@ -52,6 +58,8 @@ struct frame_methods core_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) core_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_core_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) core_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) core_frozen_fields,
 };
 
 /* Public functions */
@@ -59,7 +67,7 @@ struct frame_methods core_frame_methods =
 struct sr_core_frame *
 sr_core_frame_new()
 {
-    struct sr_core_frame *frame = g_malloc(sizeof(*frame));
+    struct sr_core_frame *frame = arena_malloc(sizeof(*frame));
     sr_core_frame_init(frame);
     return frame;
 }
@@ -84,11 +92,11 @@ sr_core_frame_free(struct sr_core_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->build_id);
-    g_free(frame->function_name);
-    g_free(frame->file_name);
-    g_free(frame->fingerprint);
-    g_free(frame);
+    sr_intern_free(frame->build_id);
+    sr_intern_free(frame->function_name);
+    sr_intern_free(frame->file_name);
+    arena_free(frame->fingerprint);
+    arena_free(frame);
 }
 
 struct sr_core_frame *
@@ -108,17 +116,27 @@ sr_core_frame_dup(struct sr_core_frame *frame, bool siblings)
 
     /* Duplicate all strings if the copy is not shallow. */
     if (result->build_id)
-        result->build_id = g_strdup(result->build_id);
+        result->build_id = sr_intern_strdup(result->build_id);
     if (result->function_name)
-        result->function_name = g_strdup(result->function_name);
+        result->function_name = sr_intern_strdup(result->function_name);
     if (result->file_name)
-        result->file_name = g_strdup(result->file_name);
+        result->file_name = sr_intern_strdup(result->file_name);
     if (result->fingerprint)
         result->fingerprint = g_strdup(result->fingerprint);
 
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_core_frame *
+core_frame_intern(struct sr_core_frame *frame)
+{
+    frame->build_id = intern_take(frame->build_id);
+    frame->function_name = intern_take(frame->function_name);
+    frame->file_name = intern_take(frame->file_name);
+    return frame;
+}
+
 bool
 sr_core_frame_calls_func(struct sr_core_frame *frame,
                           const char *function_name,
@@ -160,8 +178,8 @@ sr_core_frame_cmp(struct sr_core_frame *frame1,
                   struct sr_core_frame *frame2)
 {
     /* Build ID. */
-    int build_id = g_strcmp0(frame1->build_id,
-                              frame2->build_id);
+    int build_id = intern_strcmp0(frame1->build_id,
+                                   frame2->build_id);
     if (build_id != 0)
         return build_id;
 
@@ -171,14 +189,14 @@ sr_core_frame_cmp(struct sr_core_frame *frame1,
         return build_id_offset;
 
     /* Function name. */
-    int function_name = g_strcmp0(frame1->function_name,
-                                    frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                         frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* File name */
-    int file_name = g_strcmp0(frame1->file_name,
-                                frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                     frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -197,11 +215,11 @@ sr_core_frame_cmp_distance(struct sr_core_frame *frame1,
 {
     /* If both function names are present, compare those. */
     if (frame1->function_name && frame2->function_name)
-        return strcmp(frame1->function_name, frame2->function_name);
+        return intern_strcmp0(frame1->function_name, frame2->function_name);
 
     /* Try matching build ID and offset. */
-    int build_id = g_strcmp0(frame1->build_id,
-                              frame2->build_id);
+    int build_id = intern_strcmp0(frame1->build_id,
+                                   frame2->build_id);
 
     int build_id_offset = frame1->build_id_offset - frame2->build_id_offset;
 
@@ -263,7 +281,7 @@ sr_core_frame_from_json(json_object *root,
         return NULL;
     }
 
-    return result;
+    return core_frame_intern(result);
 }
 
 char *
@@ -386,3 +404,28 @@ core_append_duphash_text(struct sr_core_frame *frame, enum sr_duphash_flags flag
     else
         g_string_append_printf(strbuf, "0x%"PRIx64"\n", frame->address);
 }
+
+static enum frame_symbol_kind
+core_symbol_key(struct sr_core_frame *frame, GString *key,
+                const char **qualifier)
+{
+    /* Frames without a function name are compared by build ID, offset and
+     * fingerprint, which is not an equivalence. */
+    if (!frame->function_name)
+        return FRAME_SYMBOL_NONE;
+
+    symbol_key_append_str(key, frame->function_name);
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+core_frozen_fields(struct sr_core_frame *frame,
+                   struct frame_frozen_fields *fields)
+{
+    fields->function = frame->function_name;
+    fields->library = frame->file_name;
+    fields->address = frame->address;
+    fields->build_id = frame->build_id;
+    fields->build_id_offset = frame->build_id_offset;
+    fields->fingerprint = frame->fingerprint;
+}
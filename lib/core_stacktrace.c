@@ -70,7 +70,7 @@ struct stacktrace_methods core_stacktrace_methods =
 struct sr_core_stacktrace *
 sr_core_stacktrace_new()
 {
-    struct sr_core_stacktrace *stacktrace = g_malloc(sizeof(*stacktrace));
+    struct sr_core_stacktrace *stacktrace = arena_malloc(sizeof(*stacktrace));
 
     sr_core_stacktrace_init(stacktrace);
     return stacktrace;
@@ -100,10 +100,8 @@ sr_core_stacktrace_free(struct sr_core_stacktrace *stacktrace)
         sr_core_thread_free(thread);
     }
 
-    if (stacktrace->executable)
-        g_free(stacktrace->executable);
-
-    g_free(stacktrace);
+    arena_free(stacktrace->executable);
+    arena_free(stacktrace);
 }
 
 struct sr_core_stacktrace *
@@ -51,6 +51,8 @@ struct thread_methods core_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) core_dup,
     .normalize = (normalize_fn_t) sr_normalize_core_thread,
+    .normalized_frames =
+        (normalized_frames_fn_t) normalize_core_thread_frames,
 };
 
 /* Public functions */
@@ -58,7 +60,7 @@ struct thread_methods core_thread_methods =
 struct sr_core_thread *
 sr_core_thread_new()
 {
-    struct sr_core_thread *thread = g_malloc(sizeof(*thread));
+    struct sr_core_thread *thread = arena_malloc(sizeof(*thread));
     sr_core_thread_init(thread);
     return thread;
 }
@@ -84,7 +86,7 @@ sr_core_thread_free(struct sr_core_thread *thread)
         sr_core_frame_free(frame);
     }
 
-    g_free(thread);
+    arena_free(thread);
 }
 
 struct sr_core_thread *
@@ -33,6 +33,7 @@
 #include "core/unwind.h"
 #include "internal_unwind.h"
 #include "internal_utils.h"
+#include "matrix_file.h"
 
 #include "location.h"
 #include "gdb/frame.h"
@@ -53,6 +54,16 @@ sr_parse_coredump(const char *coredump_filename,
     return NULL;
 }
 
+struct sr_core_stacktrace *
+sr_parse_coredump_parallel(const char *coredump_filename,
+                           const char *executable_filename,
+                           unsigned nthreads,
+                           char **error_message)
+{
+    return sr_parse_coredump(coredump_filename, executable_filename,
+                             error_message);
+}
+
 #endif /* !defined WITH_LIBDWFL && !defined WITH_LIBUNWIND */
 
 #if (!defined WITH_LIBDWFL || !defined PTRACE_SEIZE)
@@ -85,6 +96,26 @@ sr_core_stacktrace_from_core_hook(pid_t thread_id,
     return NULL;
 }
 
+struct sr_core_stacktrace *
+sr_core_stacktrace_from_core_hook_generate_deferred(pid_t thread_id,
+                                                    const char *executable_filename,
+                                                    int signum,
+                                                    struct sr_core_stracetrace_unwind_state *state,
+                                                    char **error_message)
+{
+    *error_message = g_strdup_printf("satyr is built without live process unwind support");
+    return NULL;
+}
+
+bool
+sr_core_stacktrace_symbolize(struct sr_core_stacktrace *stacktrace,
+                             struct sr_core_stracetrace_unwind_state *state,
+                             char **error_message)
+{
+    *error_message = g_strdup_printf("satyr is built without live process unwind support");
+    return false;
+}
+
 #endif /* !defined WITH_LIBDWFL || !defined PTRACE_SEIZE */
 
 /* FIXME: is there another way to pass the executable name to the find_elf
@@ -119,6 +150,9 @@ core_handle_free(struct core_handle *ch)
             seg = next;
         }
 
+        /* The cache refers to the modules of the dwfl handle. */
+        symbol_cache_free(ch->symbols);
+
         if (ch->dwfl)
             dwfl_end(ch->dwfl);
         if (ch->eh)
@@ -274,6 +308,7 @@ open_coredump(const char *elf_file, const char *exe_file, char **error_msg)
         goto fail_dwfl;
     }
 
+    ch->symbols = symbol_cache_new();
     return ch;
 
 fail_dwfl:
@@ -288,53 +323,704 @@ fail_free:
     return NULL;
 }
 
-struct sr_core_frame *
-resolve_frame(Dwfl *dwfl, Dwarf_Addr ip, bool minus_one)
+/* The disjoint ranges of the function symbols of a binary sorted by their
+ * start addresses, as they are stored in the symbol cache directory. */
+struct symbol_table
 {
-    struct sr_core_frame *frame = sr_core_frame_new();
-    frame->address = frame->build_id_offset = (uint64_t)ip;
+    /* The table is mapped from the directory, or built in the buffer when
+     * it is not stored yet. */
+    struct matrix_file_mapping mapping;
+    void *buffer;
+    const struct matrix_file_symbol *symbols;
+    size_t count;
+    const char *names;
+    size_t names_size;
+    /* See the base_address of struct matrix_file_header. */
+    uint64_t base_address;
+};
+
+/* The data of a module resolve_frame() needs for its frames. */
+struct module_symbols
+{
+    /* Copied to the frames of the module by sr_intern_strdup(). */
+    char *build_id;
+    char *file_name;
+    /* The start is known only if the module info is. */
+    bool has_info;
+    Dwarf_Addr start;
+    /* The stored symbol table used instead of the one of libdwfl.  It is
+     * loaded with the module, the load bias is then computed from it and
+     * the binary is not opened.  Otherwise the table is built on the first
+     * function name lookup and stored to the directory of the cache, which
+     * is NULL if there is no table to build. */
+    const char *table_directory;
+    struct symbol_table *table;
+    GElf_Addr bias;
+    /* Map the start addresses of the symbols to the function names, and
+     * the addresses of the frames to the same names.  The addresses without
+     * a symbol map to NULL.  The frames get copies of the names, see
+     * sr_intern_strdup(). */
+    GHashTable *addresses;
+    GHashTable *symbols;
+};
+
+struct symbol_cache
+{
+    /* Maps the modules to their struct module_symbols. */
+    GHashTable *modules;
+    /* See sr_core_unwind_set_symbol_cache_dir(). */
+    char *directory;
+};
 
-    /* see dwfl_frame_state_pc for meaning of this parameter */
-    Dwarf_Addr ip_adjusted = ip - (minus_one ? 1 : 0);
+static GMutex symbol_cache_dir_mutex;
+static char *symbol_cache_dir;
 
-    Dwfl_Module *mod = dwfl_addrmodule(dwfl, ip_adjusted);
-    if (mod)
+void
+sr_core_unwind_set_symbol_cache_dir(const char *directory)
+{
+    g_mutex_lock(&symbol_cache_dir_mutex);
+    g_free(symbol_cache_dir);
+    symbol_cache_dir = g_strdup(directory);
+    g_mutex_unlock(&symbol_cache_dir_mutex);
+}
+
+static void
+symbol_table_free(struct symbol_table *table)
+{
+    if (!table)
+        return;
+
+    matrix_file_unmap(&table->mapping);
+    g_free(table->buffer);
+    g_free(table);
+}
+
+/* Sets the symbols and names of the table from the data of a symbol file.
+ * Returns false if they do not fit the data. */
+static bool
+symbol_table_set_data(struct symbol_table *table, const void *data,
+                      uint64_t data_size, uint64_t count, uint64_t names_size)
+{
+    if (count > data_size / sizeof(struct matrix_file_symbol)
+        || count * sizeof(struct matrix_file_symbol) + names_size != data_size)
+        return false;
+
+    table->symbols = data;
+    table->count = count;
+    table->names = (const char *)data + count * sizeof(struct matrix_file_symbol);
+    table->names_size = names_size;
+
+    /* The names are terminated, the name offsets are checked on lookup. */
+    return names_size == 0 || table->names[names_size - 1] == '\0';
+}
+
+static struct symbol_table *
+symbol_table_load(const char *filename)
+{
+    struct symbol_table *table = g_malloc0(sizeof(*table));
+    char *error_message = NULL;
+
+    struct matrix_file_header *header =
+        matrix_file_map(filename, MATRIX_FILE_MAGIC_SYMBOLS, &table->mapping,
+                        &error_message);
+    if (!header)
+    {
+        g_free(error_message);
+        g_free(table);
+        return NULL;
+    }
+
+    if (header->m < 0 || header->n < 0
+        || !symbol_table_set_data(table, header + 1, header->data_size,
+                                  header->m, header->n))
+    {
+        warn("Symbol file '%s' is corrupted", filename);
+        symbol_table_free(table);
+        return NULL;
+    }
+
+    table->base_address = header->base_address;
+    return table;
+}
+
+/* A symbol considered for a symbol table.  Of the symbols starting at the
+ * same address, the ones with a size come first, then the ones with the
+ * best binding. */
+struct symbol_candidate
+{
+    uint64_t start;
+    uint64_t size;
+    uint64_t section_end;
+    int binding_rank;
+    const char *name;
+};
+
+static int
+symbol_candidate_cmp(const void *a, const void *b)
+{
+    const struct symbol_candidate *candidate1 = a, *candidate2 = b;
+
+    if (candidate1->start != candidate2->start)
+        return candidate1->start < candidate2->start ? -1 : 1;
+
+    if ((candidate1->size == 0) != (candidate2->size == 0))
+        return candidate1->size == 0 ? 1 : -1;
+
+    if (candidate1->binding_rank != candidate2->binding_rank)
+        return candidate1->binding_rank - candidate2->binding_rank;
+
+    if (candidate1->size != candidate2->size)
+        return candidate1->size > candidate2->size ? -1 : 1;
+
+    return 0;
+}
+
+/* A symbol of a table being built.  The addresses a symbol without a size
+ * names end at the end of its section, as dwfl_module_addrinfo() names
+ * only the addresses in the section of such a symbol. */
+struct table_symbol
+{
+    uint64_t start;
+    uint64_t size;
+    uint64_t section_end;
+    /* Offset of the demangled name in the names of the table. */
+    uint64_t name;
+};
+
+static int
+address_cmp(const void *a, const void *b)
+{
+    uint64_t address1 = *(const uint64_t *)a, address2 = *(const uint64_t *)b;
+
+    if (address1 != address2)
+        return address1 < address2 ? -1 : 1;
+
+    return 0;
+}
+
+static uint64_t
+table_symbol_end(const struct table_symbol *symbol)
+{
+    return symbol->size > UINT64_MAX - symbol->start
+        ? UINT64_MAX : symbol->start + symbol->size;
+}
+
+/* Splits the symbols sorted by their start addresses into disjoint ranges,
+ * named as dwfl_module_addrinfo() names the addresses: by the innermost
+ * symbol with a size containing them, otherwise by the symbol without a
+ * size starting below them in the same section, if no other symbol starts
+ * or ends in between.  The ranges of nested or overlapping symbols need no
+ * search on lookup. */
+static GArray *
+symbol_ranges(GArray *symbols)
+{
+    GArray *points = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+    for (guint i = 0; i < symbols->len; i++)
+    {
+        struct table_symbol *symbol =
+            &g_array_index(symbols, struct table_symbol, i);
+
+        g_array_append_val(points, symbol->start);
+        if (symbol->size != 0)
+        {
+            uint64_t end = table_symbol_end(symbol);
+            g_array_append_val(points, end);
+        }
+        else if (symbol->section_end > symbol->start
+                 && symbol->section_end != UINT64_MAX)
+            g_array_append_val(points, symbol->section_end);
+    }
+
+    g_array_sort(points, address_cmp);
+
+    GArray *ranges = g_array_new(FALSE, FALSE, sizeof(struct matrix_file_symbol));
+    /* The symbols with a size started so far, the innermost one on top.
+     * The ended ones are removed when they get on top. */
+    GPtrArray *open = g_ptr_array_new();
+    guint next = 0;
+
+    for (guint i = 0; i < points->len; i++)
+    {
+        uint64_t point = g_array_index(points, uint64_t, i);
+        if (i > 0 && point == g_array_index(points, uint64_t, i - 1))
+            continue;
+
+        /* The symbols starting at the point, the preferred one of them
+         * ends up on top. */
+        const struct table_symbol *sizeless = NULL;
+        guint first = next;
+        while (next < symbols->len
+               && g_array_index(symbols, struct table_symbol, next).start == point)
+            next++;
+
+        for (guint j = next; j > first; j--)
+        {
+            struct table_symbol *symbol =
+                &g_array_index(symbols, struct table_symbol, j - 1);
+
+            if (symbol->size != 0)
+                g_ptr_array_add(open, symbol);
+            else
+                sizeless = symbol;
+        }
+
+        while (open->len > 0
+               && table_symbol_end(g_ptr_array_index(open, open->len - 1)) <= point)
+            g_ptr_array_set_size(open, open->len - 1);
+
+        if (sizeless && sizeless->section_end <= point)
+            sizeless = NULL;
+
+        const struct table_symbol *owner =
+            open->len > 0 ? g_ptr_array_index(open, open->len - 1) : sizeless;
+        if (!owner)
+            continue;
+
+        /* The points after the last one are in the range of a symbol
+         * without a size and a known section only, the range does not
+         * end. */
+        uint64_t end = point;
+        for (guint j = i + 1; j < points->len && end == point; j++)
+            end = g_array_index(points, uint64_t, j);
+
+        uint64_t size = end != point ? end - point : 0;
+        struct matrix_file_symbol *last = ranges->len > 0
+            ? &g_array_index(ranges, struct matrix_file_symbol, ranges->len - 1)
+            : NULL;
+        if (last && last->name == owner->name && last->size != 0
+            && last->start + last->size == point)
+        {
+            last->size = size != 0 ? last->size + size : 0;
+            continue;
+        }
+
+        struct matrix_file_symbol range =
+        {
+            .start = point,
+            .size = size,
+            .name = owner->name,
+        };
+        g_array_append_val(ranges, range);
+    }
+
+    g_ptr_array_free(open, TRUE);
+    g_array_free(points, TRUE);
+    return ranges;
+}
+
+/* Builds the table from the symbol table of the module, the names are
+ * demangled. */
+static struct symbol_table *
+symbol_table_build(Dwfl_Module *mod, GElf_Addr bias)
+{
+    int symbol_count = dwfl_module_getsymtab(mod);
+    GArray *candidates = g_array_new(FALSE, FALSE,
+                                     sizeof(struct symbol_candidate));
+
+    for (int i = 1; i < symbol_count; i++)
+    {
+        GElf_Sym sym;
+        GElf_Addr address;
+        GElf_Word shndx;
+        Elf *elf;
+        Dwarf_Addr elf_bias;
+        const char *name = dwfl_module_getsym_info(mod, i, &sym, &address,
+                                                   &shndx, &elf, &elf_bias);
+        if (!name || *name == '\0' || shndx == SHN_UNDEF)
+            continue;
+
+        /* The symbols dwfl_module_addrinfo() considers. */
+        int type = GELF_ST_TYPE(sym.st_info);
+        if (type == STT_SECTION || type == STT_FILE || type == STT_TLS)
+            continue;
+
+        int binding = GELF_ST_BIND(sym.st_info);
+        struct symbol_candidate candidate =
+        {
+            .start = address - bias,
+            .size = sym.st_size,
+            .section_end = UINT64_MAX,
+            .binding_rank = binding == STB_GLOBAL ? 0 : binding == STB_WEAK ? 1 : 2,
+            .name = name,
+        };
+
+        /* The absolute symbols without a size name only their address. */
+        if (sym.st_size == 0 && shndx >= SHN_LORESERVE)
+            candidate.section_end = candidate.start + 1;
+        else if (sym.st_size == 0)
+        {
+            Elf_Scn *section = elf ? elf_getscn(elf, shndx) : NULL;
+            GElf_Shdr shdr;
+
+            if (section && gelf_getshdr(section, &shdr))
+            {
+                candidate.section_end =
+                    shdr.sh_addr + shdr.sh_size + elf_bias - bias;
+            }
+        }
+
+        g_array_append_val(candidates, candidate);
+    }
+
+    g_array_sort(candidates, symbol_candidate_cmp);
+
+    GArray *symbols = g_array_new(FALSE, FALSE, sizeof(struct table_symbol));
+    GString *names = g_string_new(NULL);
+
+    for (guint i = 0; i < candidates->len; i++)
     {
-        int ret;
-        const unsigned char *build_id_bits;
-        const char *filename, *funcname;
-        GElf_Addr bias, bid_addr;
-        Dwarf_Addr start;
+        struct symbol_candidate *candidate =
+            &g_array_index(candidates, struct symbol_candidate, i);
 
+        /* The aliases of a preferred symbol, and the symbols without a size
+         * starting with a symbol with a size, name no address. */
+        if (i > 0 && candidate->start == (candidate - 1)->start
+            && (candidate->size == 0 || candidate->size == (candidate - 1)->size))
+            continue;
+
+        struct table_symbol symbol =
+        {
+            .start = candidate->start,
+            .size = candidate->size,
+            .section_end = candidate->section_end,
+            .name = names->len,
+        };
+        g_array_append_val(symbols, symbol);
+
+        char *demangled = sr_demangle_symbol(candidate->name);
+        g_string_append(names, demangled ? demangled : candidate->name);
+        g_string_append_c(names, '\0');
+        free(demangled);
+    }
+
+    g_array_free(candidates, TRUE);
+
+    GArray *ranges = symbol_ranges(symbols);
+    g_array_free(symbols, TRUE);
+    symbols = ranges;
+
+    /* The symbols and names are kept in one buffer, in the layout of the
+     * data of a symbol file. */
+    size_t symbols_size = symbols->len * sizeof(struct matrix_file_symbol);
+    struct symbol_table *table = g_malloc0(sizeof(*table));
+    table->buffer = g_malloc(symbols_size + names->len);
+    if (symbols_size > 0)
+        memcpy(table->buffer, symbols->data, symbols_size);
+    if (names->len > 0)
+        memcpy((char *)table->buffer + symbols_size, names->str, names->len);
+    symbol_table_set_data(table, table->buffer, symbols_size + names->len,
+                          symbols->len, names->len);
+
+    g_array_free(symbols, TRUE);
+    g_string_free(names, TRUE);
+
+    return table;
+}
+
+static void
+symbol_table_store(struct symbol_table *table, const char *directory,
+                   const char *filename)
+{
+    if (table->names_size > INT32_MAX || table->count > INT32_MAX)
+        return;
+
+    if (g_mkdir_with_parents(directory, 0755) != 0)
+    {
+        warn("Unable to create '%s': %s", directory, strerror(errno));
+        return;
+    }
+
+    struct matrix_file_header header =
+    {
+        .magic = MATRIX_FILE_MAGIC_SYMBOLS,
+        .m = table->count,
+        .n = table->names_size,
+        .base_address = table->base_address,
+    };
+    const void *chunks[] = { table->buffer };
+    size_t chunk_sizes[] =
+    {
+        table->count * sizeof(struct matrix_file_symbol) + table->names_size,
+    };
+
+    char *error_message = NULL;
+    if (!matrix_file_write(filename, &header, chunks, chunk_sizes, 1,
+                           &error_message))
+    {
+        warn("%s", error_message);
+        g_free(error_message);
+    }
+}
+
+static char *
+symbol_table_filename(const char *directory, const char *build_id)
+{
+    return g_strdup_printf("%s/%s.symbols", directory, build_id);
+}
+
+/* Returns the range containing the address of the ELF file. */
+static const struct matrix_file_symbol *
+symbol_table_lookup(const struct symbol_table *table, uint64_t address)
+{
+    size_t low = 0, high = table->count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (table->symbols[middle].start <= address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low == 0)
+        return NULL;
+
+    const struct matrix_file_symbol *symbol = &table->symbols[low - 1];
+    if (symbol->size != 0 && address - symbol->start >= symbol->size)
+        return NULL;
+
+    if (symbol->name >= table->names_size)
+        return NULL;
+
+    return symbol;
+}
+
+static void
+module_symbols_free(struct module_symbols *symbols)
+{
+    symbol_table_free(symbols->table);
+    g_free(symbols->build_id);
+    g_free(symbols->file_name);
+    g_hash_table_destroy(symbols->addresses);
+    g_hash_table_destroy(symbols->symbols);
+    g_free(symbols);
+}
+
+struct symbol_cache *
+symbol_cache_new(void)
+{
+    struct symbol_cache *cache = g_malloc(sizeof(*cache));
+    cache->modules = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                           (GDestroyNotify)module_symbols_free);
+
+    g_mutex_lock(&symbol_cache_dir_mutex);
+    cache->directory = g_strdup(symbol_cache_dir);
+    g_mutex_unlock(&symbol_cache_dir_mutex);
+
+    return cache;
+}
+
+void
+symbol_cache_free(struct symbol_cache *cache)
+{
+    if (!cache)
+        return;
+
+    g_hash_table_destroy(cache->modules);
+    g_free(cache->directory);
+    g_free(cache);
+}
+
+static guint64 *
+address_key(Dwarf_Addr address)
+{
+    guint64 *key = g_malloc(sizeof(*key));
+    *key = address;
+    return key;
+}
+
+static void
+module_symbols_read_info(struct module_symbols *symbols, Dwfl_Module *mod)
+{
+    int ret;
+    const unsigned char *build_id_bits;
+    const char *filename;
+    GElf_Addr bid_addr;
+
+    symbols->build_id = NULL;
+    ret = dwfl_module_build_id(mod, &build_id_bits, &bid_addr);
+    if (ret > 0)
+    {
+        symbols->build_id = g_malloc0(2*ret + 1);
+        sr_bin2hex(symbols->build_id, (const char *)build_id_bits, ret);
+    }
+
+    const char *modname = dwfl_module_info(mod, NULL, &symbols->start, NULL,
+                                           NULL, NULL, &filename, NULL);
+
+    symbols->has_info = modname != NULL;
+    symbols->file_name = modname ? g_strdup(filename ? filename : modname)
+                                 : NULL;
+}
+
+static struct module_symbols *
+module_symbols_get(struct symbol_cache *cache, Dwfl_Module *mod)
+{
+    struct module_symbols *symbols = g_hash_table_lookup(cache->modules, mod);
+    if (symbols)
+        return symbols;
+
+    symbols = g_malloc0(sizeof(*symbols));
+
+    /* The build id of a module reported from a core file is known before
+     * its main Elf is opened, and so is the load bias if the symbol table
+     * of the binary is stored already. */
+    module_symbols_read_info(symbols, mod);
+
+    if (cache->directory && symbols->build_id && symbols->has_info)
+    {
+        char *filename = symbol_table_filename(cache->directory,
+                                               symbols->build_id);
+        symbols->table = symbol_table_load(filename);
+        g_free(filename);
+    }
+
+    if (symbols->table)
+        symbols->bias = symbols->start - symbols->table->base_address;
+    else
+    {
         /* Initialize the module's main Elf for dwfl_module_build_id and dwfl_module_info */
         /* No need to deallocate the variable 'bias' and the return value.*/
-        if (NULL == dwfl_module_getelf(mod, &bias))
+        GElf_Addr bias;
+        bool has_elf = dwfl_module_getelf(mod, &bias) != NULL;
+        if (!has_elf)
             warn("The module's main Elf was not found");
 
-        ret = dwfl_module_build_id(mod, &build_id_bits, &bid_addr);
-        if (ret > 0)
+        g_free(symbols->build_id);
+        g_free(symbols->file_name);
+        module_symbols_read_info(symbols, mod);
+
+        if (cache->directory && symbols->build_id && symbols->has_info
+            && has_elf)
         {
-            frame->build_id = g_malloc0(2*ret + 1);
-            sr_bin2hex(frame->build_id, (const char *)build_id_bits, ret);
+            symbols->table_directory = cache->directory;
+            symbols->bias = bias;
         }
+    }
 
-        const char *modname = dwfl_module_info(mod, NULL, &start, NULL, NULL, NULL,
-                                               &filename, NULL);
+    symbols->addresses = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                               g_free, NULL);
+    symbols->symbols = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                             g_free, g_free);
+
+    g_hash_table_insert(cache->modules, mod, symbols);
+    return symbols;
+}
 
-        if (modname)
+/* Returns the demangled name of the function at the address, the name is
+ * owned by the cache. */
+static const char *
+module_symbols_function_name(struct module_symbols *symbols, Dwfl_Module *mod,
+                             Dwarf_Addr address)
+{
+    gpointer name;
+    guint64 key = address;
+
+    if (g_hash_table_lookup_extended(symbols->addresses, &key, NULL, &name))
+        return name;
+
+    /* The stored table has the names demangled already, the table of
+     * libdwfl is used only if there is no stored one. */
+    const char *funcname = NULL;
+    bool demangle = false;
+    if (symbols->table_directory && !symbols->table)
+    {
+        char *filename = symbol_table_filename(symbols->table_directory,
+                                               symbols->build_id);
+        symbols->table = symbol_table_build(mod, symbols->bias);
+        symbols->table->base_address = symbols->start - symbols->bias;
+        symbol_table_store(symbols->table, symbols->table_directory, filename);
+        g_free(filename);
+    }
+
+    if (symbols->table)
+    {
+        const struct matrix_file_symbol *symbol =
+            symbol_table_lookup(symbols->table, address - symbols->bias);
+
+        if (symbol)
         {
-            frame->build_id_offset = ip - start;
-            frame->file_name = filename ? g_strdup(filename) : g_strdup(modname);
+            funcname = symbols->table->names + symbol->name;
+            key = symbol->start + symbols->bias;
         }
+    }
+    else
+    {
+        GElf_Off offset;
+        GElf_Sym sym;
+        funcname = dwfl_module_addrinfo(mod, (GElf_Addr)address, &offset,
+                                        &sym, NULL, NULL, NULL);
+        key = address - offset;
+        demangle = true;
+    }
 
-        funcname = dwfl_module_addrname(mod, (GElf_Addr)ip_adjusted);
-        if (funcname)
+    name = NULL;
+    if (funcname)
+    {
+        /* The addresses in a function share the demangled name. */
+        if (!g_hash_table_lookup_extended(symbols->symbols, &key, NULL, &name))
         {
-            char *demangled = sr_demangle_symbol(funcname);
-            frame->function_name = (demangled ? demangled : g_strdup(funcname));
+            char *demangled = demangle ? sr_demangle_symbol(funcname) : NULL;
+            name = g_strdup(demangled ? demangled : funcname);
+            free(demangled);
+
+            g_hash_table_insert(symbols->symbols, address_key(key), name);
         }
     }
 
+    g_hash_table_insert(symbols->addresses, address_key(address), name);
+    return name;
+}
+
+struct sr_core_frame *
+resolve_frame_module(Dwfl *dwfl, struct symbol_cache *cache, Dwarf_Addr ip,
+                     bool minus_one)
+{
+    struct sr_core_frame *frame = sr_core_frame_new();
+    frame->address = frame->build_id_offset = (uint64_t)ip;
+
+    /* see dwfl_frame_state_pc for meaning of this parameter */
+    Dwarf_Addr ip_adjusted = ip - (minus_one ? 1 : 0);
+
+    Dwfl_Module *mod = dwfl_addrmodule(dwfl, ip_adjusted);
+    if (mod)
+    {
+        struct module_symbols *symbols = module_symbols_get(cache, mod);
+
+        frame->build_id = sr_intern_strdup(symbols->build_id);
+
+        if (symbols->has_info)
+        {
+            frame->build_id_offset = ip - symbols->start;
+            frame->file_name = sr_intern_strdup(symbols->file_name);
+        }
+    }
+
+    return frame;
+}
+
+void
+resolve_frame_function(Dwfl *dwfl, struct symbol_cache *cache,
+                       struct sr_core_frame *frame, Dwarf_Addr ip_adjusted)
+{
+    Dwfl_Module *mod = dwfl_addrmodule(dwfl, ip_adjusted);
+    if (!mod)
+        return;
+
+    struct module_symbols *symbols = module_symbols_get(cache, mod);
+    const char *funcname = module_symbols_function_name(symbols, mod,
+                                                        ip_adjusted);
+    frame->function_name = sr_intern_strdup(funcname);
+}
+
+struct sr_core_frame *
+resolve_frame(Dwfl *dwfl, struct symbol_cache *cache, Dwarf_Addr ip,
+              bool minus_one)
+{
+    struct sr_core_frame *frame = resolve_frame_module(dwfl, cache, ip,
+                                                       minus_one);
+    resolve_frame_function(dwfl, cache, frame, ip - (minus_one ? 1 : 0));
     return frame;
 }
 
@@ -476,7 +1162,7 @@ sr_core_stacktrace_from_gdb(const char *gdb_output, const char *core_file,
                 continue;
 
             struct sr_core_frame *core_frame = resolve_frame(ch->dwfl,
-                    gdb_frame->address, false);
+                    ch->symbols, gdb_frame->address, false);
 
             core_thread->frames = sr_core_frame_append(core_thread->frames,
                     core_frame);
@@ -36,13 +36,18 @@
 
 struct frame_callback_arg
 {
+    struct symbol_cache *symbols;
     struct sr_core_frame **frames_tail;
     char *error_msg;
     unsigned nframes;
+    /* If not NULL, the function names are not looked up, the addresses
+     * they are looked up by later are appended to the array. */
+    GArray *deferred_addresses;
 };
 
 struct thread_callback_arg
 {
+    struct symbol_cache *symbols;
     struct sr_core_thread **threads_tail;
     char *error_msg;
 };
@@ -50,6 +55,11 @@ struct thread_callback_arg
 struct sr_core_stracetrace_unwind_state {
     Dwfl *dwfl;
     Dwfl_Callbacks proc_cb;
+    struct symbol_cache *symbols;
+    /* The Dwarf_Addr addresses sr_core_stacktrace_symbolize() looks up the
+     * function names of the frames by, NULL unless the stacktrace is
+     * waiting to be symbolized. */
+    GArray *deferred_addresses;
 };
 
 static const int CB_STOP_UNWIND = DWARF_CB_ABORT+1;
@@ -69,7 +79,28 @@ frame_callback(Dwfl_Frame *frame, void *data)
     }
 
     Dwfl *dwfl = dwfl_thread_dwfl(dwfl_frame_thread(frame));
-    struct sr_core_frame *result = resolve_frame(dwfl, pc, minus_one);
+    struct sr_core_frame *result;
+
+    if (frame_arg->deferred_addresses)
+    {
+        result = resolve_frame_module(dwfl, frame_arg->symbols, pc, minus_one);
+
+        Dwarf_Addr pc_adjusted = pc - (minus_one ? 1 : 0);
+        g_array_append_val(frame_arg->deferred_addresses, pc_adjusted);
+
+        *frame_arg->frames_tail = result;
+        frame_arg->frames_tail = &result->next;
+        frame_arg->nframes++;
+
+        /* The frames are not known to be below __libc_start_main yet, do
+         * not keep the thread stopped by an endless stack. */
+        if (frame_arg->nframes >= CORE_STACKTRACE_DEFERRED_FRAME_LIMIT)
+            return CB_STOP_UNWIND;
+
+        return DWARF_CB_OK;
+    }
+
+    result = resolve_frame(dwfl, frame_arg->symbols, pc, minus_one);
 
     /* Do not unwind below __libc_start_main. */
     if (0 == g_strcmp0(result->function_name, "__libc_start_main"))
@@ -86,40 +117,46 @@ frame_callback(Dwfl_Frame *frame, void *data)
 }
 
 static void
-truncate_long_thread(struct sr_core_thread *thread, struct frame_callback_arg *frame_arg)
+truncate_long_thread(struct sr_core_thread *thread, unsigned nframes)
 {
     /* Truncate the stacktrace to CORE_STACKTRACE_FRAME_LIMIT least recent frames. */
-    while (thread->frames && frame_arg->nframes > CORE_STACKTRACE_FRAME_LIMIT)
+    while (thread->frames && nframes > CORE_STACKTRACE_FRAME_LIMIT)
     {
         struct sr_core_frame *old_frame = thread->frames;
         thread->frames = old_frame->next;
         sr_core_frame_free(old_frame);
-        frame_arg->nframes--;
+        nframes--;
     }
 }
 
-static int
-unwind_thread(Dwfl_Thread *thread, void *data)
+/* Unwinds the thread given either by its handle, or by the dwfl handle and
+ * its id.  Returns NULL if the unwinding should be aborted. */
+static struct sr_core_thread *
+unwind_thread_frames(Dwfl *dwfl, struct symbol_cache *symbols,
+                     Dwfl_Thread *thread, pid_t tid, char **error_msg)
 {
-    struct thread_callback_arg *thread_arg = data;
-    char **error_msg = &thread_arg->error_msg;
-
     struct sr_core_thread *result = sr_core_thread_new();
     if (!result)
     {
         set_error("Failed to initialize thread memory");
-        return DWARF_CB_ABORT;
+        return NULL;
     }
-    result->id = (int64_t)dwfl_thread_tid(thread);
+    result->id = (int64_t)tid;
 
     struct frame_callback_arg frame_arg =
     {
+        .symbols = symbols,
         .frames_tail = &(result->frames),
         .error_msg = NULL,
         .nframes = 0
     };
 
-    int ret = dwfl_thread_getframes(thread, frame_callback, &frame_arg);
+    int ret;
+    if (thread)
+        ret = dwfl_thread_getframes(thread, frame_callback, &frame_arg);
+    else
+        ret = dwfl_getthread_frames(dwfl, tid, frame_callback, &frame_arg);
+
     if (ret == -1)
     {
         warn("dwfl_thread_getframes failed for thread id %d: %s",
@@ -142,24 +179,208 @@ unwind_thread(Dwfl_Thread *thread, void *data)
         goto abort;
     }
 
-    truncate_long_thread(result, &frame_arg);
+    truncate_long_thread(result, frame_arg.nframes);
+
+    return result;
+
+abort:
+    sr_core_thread_free(result);
+    return NULL;
+}
+
+static int
+unwind_thread(Dwfl_Thread *thread, void *data)
+{
+    struct thread_callback_arg *thread_arg = data;
+
+    struct sr_core_thread *result =
+        unwind_thread_frames(NULL, thread_arg->symbols, thread,
+                             dwfl_thread_tid(thread), &thread_arg->error_msg);
+    if (!result)
+        return DWARF_CB_ABORT;
 
     *thread_arg->threads_tail = result;
     thread_arg->threads_tail = &result->next;
 
     return DWARF_CB_OK;
+}
 
-abort:
-    sr_core_thread_free(result);
-    return DWARF_CB_ABORT;
+static int
+collect_thread_id(Dwfl_Thread *thread, void *data)
+{
+    GArray *tids = data;
+    pid_t tid = dwfl_thread_tid(thread);
+
+    g_array_append_val(tids, tid);
+    return DWARF_CB_OK;
+}
+
+/* The threads of the coredump unwound by the workers of
+ * sr_parse_coredump_parallel. */
+struct unwind_context
+{
+    const pid_t *tids;
+    int count;
+    /* The unwound threads and the errors which aborted the unwinding, in
+     * the order of the ids. */
+    struct sr_core_thread **threads;
+    char **errors;
+    /* Index of the first thread no worker has taken yet. */
+    gint next;
+    gint failed;
+};
+
+struct unwind_worker
+{
+    struct unwind_context *context;
+    /* libdwfl cannot be used by more threads at once, every worker has
+     * the coredump opened on its own. */
+    struct core_handle *ch;
+};
+
+static gpointer
+unwind_worker_run(gpointer data)
+{
+    struct unwind_worker *worker = data;
+    struct unwind_context *context = worker->context;
+    int i;
+
+    while (!g_atomic_int_get(&context->failed) &&
+           (i = g_atomic_int_add(&context->next, 1)) < context->count)
+    {
+        context->threads[i] = unwind_thread_frames(worker->ch->dwfl,
+                                                   worker->ch->symbols, NULL,
+                                                   context->tids[i],
+                                                   &context->errors[i]);
+        if (!context->threads[i])
+            g_atomic_int_set(&context->failed, 1);
+    }
+
+    return NULL;
+}
+
+/* Unwinds the threads with the given ids by the workers, the first worker
+ * uses the handle ch, the others open the coredump again.  Returns the
+ * list of the threads in the order of the ids. */
+static struct sr_core_thread *
+unwind_threads_parallel(struct core_handle *ch, const char *core_file,
+                        const char *exe_file, const pid_t *tids, int count,
+                        unsigned nthreads, char **error_msg)
+{
+    struct unwind_context context =
+    {
+        .tids = tids,
+        .count = count,
+        .threads = g_malloc0_n(count + 1, sizeof(*context.threads)),
+        .errors = g_malloc0_n(count + 1, sizeof(*context.errors)),
+        .next = 0,
+        .failed = 0,
+    };
+
+    struct unwind_worker *workers = g_malloc_n(nthreads, sizeof(*workers));
+    unsigned nworkers = 0;
+
+    workers[nworkers].context = &context;
+    workers[nworkers++].ch = ch;
+
+    /* The handles are opened by the calling thread, the callbacks of
+     * open_coredump() are not reentrant.  A worker which fails to open
+     * the coredump is left out. */
+    while (nworkers < nthreads)
+    {
+        char *open_error = NULL;
+        struct core_handle *worker_ch = open_coredump(core_file, exe_file,
+                                                      &open_error);
+        if (worker_ch && dwfl_core_file_attach(worker_ch->dwfl, worker_ch->eh) < 0)
+        {
+            open_error = g_strdup_printf("dwfl_core_file_attach failed: %s",
+                                         dwfl_errmsg(-1));
+            core_handle_free(worker_ch);
+            worker_ch = NULL;
+        }
+
+        if (!worker_ch)
+        {
+            warn("Unwinding in %u threads only: %s", nworkers,
+                 OR_UNKNOWN(open_error));
+            g_free(open_error);
+            break;
+        }
+
+        workers[nworkers].context = &context;
+        workers[nworkers++].ch = worker_ch;
+    }
+
+    /* The calling thread works as the first worker. */
+    GThread **handles = g_malloc_n(nworkers, sizeof(*handles));
+    for (unsigned w = 1; w < nworkers; w++)
+        handles[w] = g_thread_new("sr_parse_coredump", unwind_worker_run,
+                                  &workers[w]);
+
+    unwind_worker_run(&workers[0]);
+
+    for (unsigned w = 1; w < nworkers; w++)
+    {
+        g_thread_join(handles[w]);
+        core_handle_free(workers[w].ch);
+    }
+
+    struct sr_core_thread *result = NULL, **tail = &result;
+    for (int i = 0; i < count; i++)
+    {
+        if (context.threads[i])
+        {
+            *tail = context.threads[i];
+            tail = &context.threads[i]->next;
+        }
+    }
+
+    if (context.failed)
+    {
+        /* The first error in the order of the threads is reported, the
+         * same one as when the threads are unwound one by one. */
+        int i = 0;
+        while (i < count && !context.errors[i])
+            i++;
+
+        set_error("%s", i < count ? context.errors[i]
+                                  : "Unknown error in dwfl_getthread_frames");
+
+        while (result)
+        {
+            struct sr_core_thread *next = result->next;
+            sr_core_thread_free(result);
+            result = next;
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+        g_free(context.errors[i]);
+
+    g_free(handles);
+    g_free(workers);
+    g_free(context.errors);
+    g_free(context.threads);
+
+    return result;
 }
 
 struct sr_core_stacktrace *
 sr_parse_coredump(const char *core_file,
                   const char *exe_file,
                   char **error_msg)
+{
+    return sr_parse_coredump_parallel(core_file, exe_file, 1, error_msg);
+}
+
+struct sr_core_stacktrace *
+sr_parse_coredump_parallel(const char *core_file,
+                           const char *exe_file,
+                           unsigned nthreads,
+                           char **error_msg)
 {
     struct sr_core_stacktrace *stacktrace = NULL;
+    GArray *tids = NULL;
 
     /* Initialize error_msg to 'no error'. */
     if (error_msg)
@@ -182,13 +403,23 @@ sr_parse_coredump(const char *core_file,
         goto fail;
     }
 
+    if (nthreads == 0)
+        nthreads = g_get_num_processors();
+
     struct thread_callback_arg thread_arg =
     {
+        .symbols = ch->symbols,
         .threads_tail = &(stacktrace->threads),
         .error_msg = NULL
     };
 
-    int ret = dwfl_getthreads(ch->dwfl, unwind_thread, &thread_arg);
+    /* In parallel, the ids of the threads are collected first and the
+     * threads are unwound afterwards. */
+    if (nthreads > 1)
+        tids = g_array_new(FALSE, FALSE, sizeof(pid_t));
+
+    int ret = tids ? dwfl_getthreads(ch->dwfl, collect_thread_id, tids)
+                   : dwfl_getthreads(ch->dwfl, unwind_thread, &thread_arg);
     if (ret != 0)
     {
         if (ret == -1)
@@ -206,12 +437,29 @@ sr_parse_coredump(const char *core_file,
         goto fail;
     }
 
+    if (tids && tids->len > 0)
+    {
+        stacktrace->threads =
+            unwind_threads_parallel(ch, core_file, exe_file,
+                                    (const pid_t *)tids->data, tids->len,
+                                    MIN(nthreads, tids->len), error_msg);
+        if (!stacktrace->threads)
+        {
+            sr_core_stacktrace_free(stacktrace);
+            stacktrace = NULL;
+            goto fail;
+        }
+    }
+
     stacktrace->executable = g_strdup(exe_file);
     stacktrace->signal = get_signal_number(ch->eh, core_file);
     /* FIXME: is this the best we can do? */
     stacktrace->crash_thread = stacktrace->threads;
 
 fail:
+    if (tids)
+        g_array_free(tids, TRUE);
+
     core_handle_free(ch);
     return stacktrace;
 }
@@ -226,6 +474,11 @@ sr_core_stacktrace_unwind_state_free(struct sr_core_stracetrace_unwind_state *st
     if (!state)
         return;
 
+    symbol_cache_free(state->symbols);
+
+    if (state->deferred_addresses)
+        g_array_free(state->deferred_addresses, TRUE);
+
     if (state->dwfl)
     {
         dwfl_end(state->dwfl);
@@ -247,6 +500,7 @@ sr_core_stacktrace_from_core_hook_prepare(pid_t tid, char **error_msg)
     state->proc_cb.find_debuginfo = find_debuginfo_none;
 
     Dwfl *dwfl = state->dwfl = dwfl_begin(&(state->proc_cb));
+    state->symbols = symbol_cache_new();
 
     if (dwfl_linux_proc_report(dwfl, tid) != 0)
     {
@@ -305,12 +559,16 @@ fail:
     return NULL;
 }
 
-struct sr_core_stacktrace*
-sr_core_stacktrace_from_core_hook_generate(pid_t tid,
-                                           const char *executable,
-                                           int signum,
-                                           struct sr_core_stracetrace_unwind_state* state,
-                                           char **error_msg)
+/* Unwinds the thread, the function names are left to
+ * sr_core_stacktrace_symbolize() if deferred is true.  The state is not
+ * released. */
+static struct sr_core_stacktrace *
+unwind_hook_thread(pid_t tid,
+                   const char *executable,
+                   int signum,
+                   struct sr_core_stracetrace_unwind_state *state,
+                   bool deferred,
+                   char **error_msg)
 {
     struct sr_core_stacktrace *stacktrace = sr_core_stacktrace_new();
     if (!stacktrace)
@@ -336,11 +594,22 @@ sr_core_stacktrace_from_core_hook_generate(pid_t tid,
 
     struct frame_callback_arg frame_arg =
     {
+        .symbols = state->symbols,
         .frames_tail = &(stacktrace->threads->frames),
         .error_msg = NULL,
-        .nframes = 0
+        .nframes = 0,
+        .deferred_addresses = NULL
     };
 
+    if (deferred)
+    {
+        if (state->deferred_addresses)
+            g_array_free(state->deferred_addresses, TRUE);
+
+        state->deferred_addresses = g_array_new(FALSE, FALSE, sizeof(Dwarf_Addr));
+        frame_arg.deferred_addresses = state->deferred_addresses;
+    }
+
     int ret = dwfl_getthread_frames(state->dwfl, tid, frame_callback, &frame_arg);
     if (ret != 0 && ret != CB_STOP_UNWIND)
     {
@@ -359,7 +628,11 @@ sr_core_stacktrace_from_core_hook_generate(pid_t tid,
         goto fail;
     }
 
-    truncate_long_thread(stacktrace->threads, &frame_arg);
+    /* The frames are truncated by sr_core_stacktrace_symbolize() in the
+     * deferred mode, after the frames below __libc_start_main are.  Only
+     * CORE_STACKTRACE_DEFERRED_FRAME_LIMIT frames were unwound then. */
+    if (!deferred)
+        truncate_long_thread(stacktrace->threads, frame_arg.nframes);
 
     if (executable)
         stacktrace->executable = g_strdup(executable);
@@ -369,10 +642,107 @@ sr_core_stacktrace_from_core_hook_generate(pid_t tid,
     stacktrace->only_crash_thread = true;
 
 fail:
+    return stacktrace;
+}
+
+struct sr_core_stacktrace*
+sr_core_stacktrace_from_core_hook_generate(pid_t tid,
+                                           const char *executable,
+                                           int signum,
+                                           struct sr_core_stracetrace_unwind_state* state,
+                                           char **error_msg)
+{
+    struct sr_core_stacktrace *stacktrace =
+        unwind_hook_thread(tid, executable, signum, state, false, error_msg);
+
     sr_core_stacktrace_unwind_state_free(state);
     return stacktrace;
 }
 
+struct sr_core_stacktrace *
+sr_core_stacktrace_from_core_hook_generate_deferred(pid_t tid,
+                                                    const char *executable,
+                                                    int signum,
+                                                    struct sr_core_stracetrace_unwind_state *state,
+                                                    char **error_msg)
+{
+    struct sr_core_stacktrace *stacktrace =
+        unwind_hook_thread(tid, executable, signum, state, true, error_msg);
+
+    /* The thread is not needed any more, the modules it had mapped were
+     * opened while it was unwound. */
+    if (ptrace(PTRACE_DETACH, tid, NULL, NULL) != 0)
+        warn("PTRACE_DETACH (tid %u) failed: %s", (unsigned)tid, strerror(errno));
+
+    if (!stacktrace && state->deferred_addresses)
+    {
+        g_array_free(state->deferred_addresses, TRUE);
+        state->deferred_addresses = NULL;
+    }
+
+    return stacktrace;
+}
+
+bool
+sr_core_stacktrace_symbolize(struct sr_core_stacktrace *stacktrace,
+                             struct sr_core_stracetrace_unwind_state *state,
+                             char **error_msg)
+{
+    if (error_msg)
+        *error_msg = NULL;
+
+    GArray *addresses = state->deferred_addresses;
+    struct sr_core_thread *thread = stacktrace->threads;
+    if (!addresses || !thread)
+    {
+        set_error("The stacktrace was not unwound in the deferred mode");
+        return false;
+    }
+
+    guint frame_count = 0;
+    for (struct sr_core_frame *frame = thread->frames; frame; frame = frame->next)
+        frame_count++;
+
+    if (frame_count != addresses->len)
+    {
+        set_error("The stacktrace does not match the unwind state");
+        return false;
+    }
+
+    struct sr_core_frame **frame_ptr = &thread->frames;
+    unsigned nframes = 0;
+
+    for (guint i = 0; i < addresses->len; i++)
+    {
+        struct sr_core_frame *frame = *frame_ptr;
+        resolve_frame_function(state->dwfl, state->symbols, frame,
+                               g_array_index(addresses, Dwarf_Addr, i));
+
+        /* Do not keep the frames below __libc_start_main. */
+        if (0 == g_strcmp0(frame->function_name, "__libc_start_main"))
+        {
+            *frame_ptr = NULL;
+            while (frame)
+            {
+                struct sr_core_frame *next = frame->next;
+                sr_core_frame_free(frame);
+                frame = next;
+            }
+            break;
+        }
+
+        frame_ptr = &frame->next;
+        nframes++;
+    }
+
+    truncate_long_thread(thread, nframes);
+
+    g_array_free(addresses, TRUE);
+    state->deferred_addresses = NULL;
+
+    return true;
+}
+
 struct sr_core_stacktrace *
 sr_core_stacktrace_from_core_hook(pid_t tid,
                                   const char *executable,
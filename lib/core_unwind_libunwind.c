@@ -33,6 +33,7 @@ static struct sr_core_thread *
 unwind_thread(struct UCD_info *ui,
               unw_addr_space_t as,
               Dwfl *dwfl,
+              struct symbol_cache *symbols,
               int thread_no,
               char **error_msg)
 {
@@ -62,7 +63,7 @@ unwind_thread(struct UCD_info *ui,
         if (ip == 0)
             break;
 
-        struct sr_core_frame *entry = resolve_frame(dwfl, ip, false);
+        struct sr_core_frame *entry = resolve_frame(dwfl, symbols, ip, false);
 
         if (!entry->function_name)
         {
@@ -178,7 +179,8 @@ sr_parse_coredump(const char *core_file,
     int tnum, nthreads = _UCD_get_num_threads(ui);
     for (tnum = 0; tnum < nthreads; ++tnum)
     {
-        struct sr_core_thread *trace = unwind_thread(ui, as, ch->dwfl, tnum, error_msg);
+        struct sr_core_thread *trace = unwind_thread(ui, as, ch->dwfl, ch->symbols, tnum,
+                                                    error_msg);
         if (trace)
         {
             stacktrace->threads = sr_core_thread_append(stacktrace->threads, trace);
@@ -205,4 +207,15 @@ fail_destroy_handle:
     return stacktrace;
 }
 
+/* Parallel unwinding is implemented with elfutils only, the threads are
+ * unwound one by one here. */
+struct sr_core_stacktrace *
+sr_parse_coredump_parallel(const char *core_file,
+                           const char *exe_file,
+                           unsigned nthreads,
+                           char **error_msg)
+{
+    return sr_parse_coredump(core_file, exe_file, error_msg);
+}
+
 #endif /* WITH_LIBUNWIND */
@@ -22,17 +22,207 @@
 #include "frame.h"
 #include "normalize.h"
 #include "utils.h"
+#include "gdb/frame.h"
 #include "gdb/thread.h"
 #include "internal_utils.h"
+#include "symbols.h"
+#include "frozen.h"
+#include "matrix_file.h"
 #include <assert.h>
+#include <math.h>
 #include <stdint.h>
 #include <string.h>
 
 #define SHA1_DIGEST_LEN 20
 
+/* Two threads with at most twice this many frames in total are paired
+ * without allocating memory. */
+#define UNKNOWN_PAIRS_SMALL 128
+
+/* Number of 64-bit words of the bitmaps of matched frames of each thread
+ * which are kept on the stack. */
+#define JARO_WINKLER_SMALL_WORDS 4
+
+/* Jaro-Winkler similarity is rejected only if its upper bound is lower
+ * than the minimum by more than this, so that rounding of the bound never
+ * rejects a similarity equal to the minimum. */
+#define JARO_WINKLER_BOUND_SLACK 1e-5f
+
+/* The Jaro-Winkler distances return similarity instead of distance. */
+static bool
+distance_is_similarity(enum sr_distance_type dist_type)
+{
+    return dist_type == SR_DISTANCE_JARO_WINKLER ||
+           dist_type == SR_DISTANCE_JARO_WINKLER_COMPAT;
+}
+
+/* Whether the frame i of the first thread equals the frame j of the
+ * second one. */
+typedef bool (*jaro_winkler_equal_func)(const void *thread1, int i,
+                                        const void *thread2, int j);
+
+static float
+jaro_winkler_from_jaro(float dist_jaro, int prefix_len)
+{
+    /* How much weight we give to having common prefixes
+     * (always k < 0.25).
+     */
+    float k = 0.2;
+
+    return dist_jaro + (float)prefix_len * k * (1 - dist_jaro);
+}
+
+/* The Jaro-Winkler similarity of two threads. Every frame matches at most
+ * one frame of the other thread, which is at most the window away. The
+ * transpositions are the matched frames out of order. Returns 0.0 as soon
+ * as the similarity is known to be lower than min_similarity. */
+static float
+jaro_winkler(const void *thread1, int frame1_count,
+             const void *thread2, int frame2_count,
+             jaro_winkler_equal_func equal,
+             float min_similarity)
+{
+    if (frame1_count == 0 && frame2_count == 0)
+        return 1.0;
+
+    if (frame1_count == 0 || frame2_count == 0)
+        return 0.0;
+
+    int max_frame_count = MAX(frame1_count, frame2_count);
+    int window = MAX(max_frame_count / 2 - 1, 0);
+
+    int prefix_len = 0;
+    while (prefix_len < MIN(4, MIN(frame1_count, frame2_count)) &&
+           equal(thread1, prefix_len, thread2, prefix_len))
+    {
+        ++prefix_len;
+    }
+
+    /* Bitmaps of the matched frames of both threads. */
+    int words1 = (frame1_count + 63) / 64, words2 = (frame2_count + 63) / 64;
+    uint64_t small[2 * JARO_WINKLER_SMALL_WORDS] = { 0 };
+    uint64_t *matched1 = words1 + words2 <= (int)G_N_ELEMENTS(small)
+                         ? small
+                         : g_malloc0_n(words1 + words2, sizeof(*matched1));
+    uint64_t *matched2 = matched1 + words1;
+    int match_count = 0;
+    float dist = 0.0;
+
+    for (int i = 0; i < frame1_count; ++i)
+    {
+        if (min_similarity > 0)
+        {
+            /* No transpositions and all the remaining frames matched. */
+            int max_match_count = match_count +
+                                  MIN(frame1_count - i,
+                                      frame2_count - match_count);
+            float bound = jaro_winkler_from_jaro(
+                (max_match_count / (float)frame1_count +
+                 max_match_count / (float)frame2_count + 1) / 3, prefix_len);
+
+            if (bound < min_similarity - JARO_WINKLER_BOUND_SLACK)
+                goto out;
+        }
+
+        int last = MIN(frame2_count - 1, i + window);
+        for (int j = MAX(0, i - window); j <= last; ++j)
+        {
+            if (!(matched2[j / 64] & (UINT64_C(1) << (j % 64))) &&
+                equal(thread1, i, thread2, j))
+            {
+                matched1[i / 64] |= UINT64_C(1) << (i % 64);
+                matched2[j / 64] |= UINT64_C(1) << (j % 64);
+                ++match_count;
+                break;
+            }
+        }
+    }
+
+    if (0 == match_count)
+        goto out;
+
+    /* Matched frames at the same position among the matched frames of
+     * both threads are in order. */
+    int half_trans_count = 0;
+    for (int i = 0, j = 0; i < frame1_count; ++i)
+    {
+        if (!(matched1[i / 64] & (UINT64_C(1) << (i % 64))))
+            continue;
+
+        while (!(matched2[j / 64] & (UINT64_C(1) << (j % 64))))
+            ++j;
+
+        if (!equal(thread1, i, thread2, j))
+            ++half_trans_count;
+
+        ++j;
+    }
+
+    float trans_count = half_trans_count / 2.0f;
+    float dist_jaro = (match_count / (float)frame1_count +
+                       match_count / (float)frame2_count +
+                       (match_count - trans_count) / match_count) / 3;
+
+    dist = jaro_winkler_from_jaro(dist_jaro, prefix_len);
+
+out:
+    if (matched1 != small)
+        g_free(matched1);
+
+    return dist;
+}
+
+static bool
+jaro_winkler_frames_equal(const void *frames1, int i,
+                          const void *frames2, int j)
+{
+    return 0 == sr_frame_cmp_distance(((struct sr_frame *const *)frames1)[i],
+                                      ((struct sr_frame *const *)frames2)[j]);
+}
+
+static float
+distance_jaro_winkler_bounded(struct sr_thread *thread1,
+                              struct sr_thread *thread2,
+                              float min_similarity)
+{
+    assert(thread1->type == thread2->type);
+
+    int frame1_count = sr_thread_frame_count(thread1);
+    int frame2_count = sr_thread_frame_count(thread2);
+    struct sr_frame **frames1 = g_malloc_n(frame1_count + frame2_count + 1,
+                                           sizeof(*frames1));
+    struct sr_frame **frames2 = frames1 + frame1_count;
+    int i = 0, j = 0;
+
+    for (struct sr_frame *frame = sr_thread_frames(thread1); frame;
+         frame = sr_frame_next(frame))
+        frames1[i++] = frame;
+
+    for (struct sr_frame *frame = sr_thread_frames(thread2); frame;
+         frame = sr_frame_next(frame))
+        frames2[j++] = frame;
+
+    float dist = jaro_winkler(frames1, frame1_count, frames2, frame2_count,
+                              jaro_winkler_frames_equal, min_similarity);
+
+    g_free(frames1);
+
+    return dist;
+}
+
 float
 distance_jaro_winkler(struct sr_thread *thread1,
                       struct sr_thread *thread2)
+{
+    return distance_jaro_winkler_bounded(thread1, thread2, 0.0f);
+}
+
+/* The original implementation of the Jaro-Winkler distance, kept for
+ * SR_DISTANCE_JARO_WINKLER_COMPAT. A frame may match several frames of
+ * the other thread. */
+static float
+distance_jaro_winkler_compat(struct sr_thread *thread1,
+                             struct sr_thread *thread2)
 {
     assert(thread1->type == thread2->type);
 
@@ -271,204 +461,2219 @@ distance_levenshtein(struct sr_thread *thread1,
     return (float)result / max_frame_count;
 }
 
-float
-sr_distance(enum sr_distance_type distance_type,
-            struct sr_thread *thread1,
-            struct sr_thread *thread2)
-{
-    /* Different thread types are always unequal. */
-    if (thread1->type != thread2->type)
-        return 1.0f;
-
-    switch (distance_type)
-    {
-    case SR_DISTANCE_JARO_WINKLER:
-        return distance_jaro_winkler(thread1, thread2);
-    case SR_DISTANCE_JACCARD:
-        return distance_jaccard(thread1, thread2);
-    case SR_DISTANCE_LEVENSHTEIN:
-        return distance_levenshtein(thread1, thread2, false);
-    case SR_DISTANCE_DAMERAU_LEVENSHTEIN:
-        return distance_levenshtein(thread1, thread2, true);
-    default:
-        return 1.0f;
-    }
-}
+/* The bounded variants of the distances compute the same values as the
+ * functions above, but give up as soon as the distance is known to be
+ * beyond the bound. */
 
-static int
-get_distance_position_mn(int m, int n, int i, int j)
+static float
+jaro_winkler_upper_bound(int match_count, int frame1_count,
+                         int frame2_count, int prefix_len)
 {
-    /* The array holds only matrix entries (i, j) where i < j,
-     * locate the position in the array. */
-    assert(i < j && i >= 0 && i < m && j < n);
+    /* No transpositions. */
+    float dist_jaro = (match_count / (float)frame1_count +
+                       match_count / (float)frame2_count + 1) / 3;
 
-    int h = n, l = n - i;
+    /* Frames of thread1 may match the same frame of thread2, so the Jaro
+     * distance can exceed 1 and the prefix then lowers the result. */
+    if (dist_jaro > 1)
+        return dist_jaro;
 
-    return ((h * h - h) - (l * l - l)) / 2 + j - 1;
+    return dist_jaro + (float)prefix_len * 0.2f * (1 - dist_jaro);
 }
 
-static int
-get_distance_position(const struct sr_distances *distances, int i, int j)
+static float
+distance_jaro_winkler_compat_bounded(struct sr_thread *thread1,
+                                     struct sr_thread *thread2,
+                                     float min_similarity)
 {
-    return get_distance_position_mn(distances->m, distances->n, i, j);
-}
+    int frame1_count = sr_thread_frame_count(thread1);
+    int frame2_count = sr_thread_frame_count(thread2);
 
-struct sr_distances *
-sr_distances_new(int m, int n)
-{
-    struct sr_distances *distances = g_malloc(sizeof(*distances));
+    if (frame1_count == 0 || frame2_count == 0)
+        return distance_jaro_winkler_compat(thread1, thread2);
 
-    /* The number of rows has to be smaller than columns. */
-    if (m >= n)
-        m = n - 1;
+    int max_frame_count = frame2_count;
+    if (max_frame_count < frame1_count)
+        max_frame_count = frame1_count;
 
-    assert(m > 0 && n > 1 && m < n);
+    /* Frames of thread1 farther than the window from the end of thread2
+     * never match. */
+    int window = max_frame_count / 2 - 1;
+    int matchable_count = frame2_count + window;
+    if (matchable_count > frame1_count)
+        matchable_count = frame1_count;
+    if (matchable_count <= 0)
+        return 0.0;
 
-    distances->m = m;
-    distances->n = n;
-    distances->distances = g_malloc_n(
-                               get_distance_position(distances, m - 1, n - 1) + 1,
-                               sizeof(*distances->distances)
-                           );
+    int prefix_len = 0;
+    bool still_prefix = true;
+    float trans_count = 0;
+    int match_count = 0;
 
-    return distances;
-}
+    struct sr_frame *curr_frame = sr_thread_frames(thread1);
+    for (int i = 1; curr_frame; ++i)
+    {
+        int remaining = matchable_count - (i - 1);
+        if (remaining < 0)
+            remaining = 0;
 
-struct sr_distances *
-sr_distances_dup(struct sr_distances *distances)
-{
-    struct sr_distances *dup_distances;
+        int max_prefix_len = still_prefix ? 4 : MIN(prefix_len, 4);
+        float bound = jaro_winkler_upper_bound(match_count + remaining,
+                                               frame1_count, frame2_count,
+                                               max_prefix_len);
+        if (bound < min_similarity - JARO_WINKLER_BOUND_SLACK)
+            return 0.0;
 
-    dup_distances = sr_distances_new(distances->m, distances->n);
-    memcpy(dup_distances->distances, distances->distances,
-            sizeof(*distances->distances) *
-            (get_distance_position(distances, distances->m - 1, distances->n - 1) + 1));
+        bool match = false;
+        struct sr_frame *curr_frame2 = sr_thread_frames(thread2);
+        for (int j = 1; !match && curr_frame2; ++j)
+        {
+            if (i == j && 0 != sr_frame_cmp_distance(curr_frame, curr_frame2))
+                still_prefix = false;
 
-    return dup_distances;
-}
+            if (abs(i - j) <= window &&
+                0 == sr_frame_cmp_distance(curr_frame, curr_frame2))
+            {
+                match = true;
+                if (i != j)
+                    ++trans_count;
+            }
 
-void
-sr_distances_free(struct sr_distances *distances)
-{
-    if (!distances)
-        return;
+            curr_frame2 = sr_frame_next(curr_frame2);
+        }
 
-    g_free(distances->distances);
-    g_free(distances);
-}
+        if (still_prefix)
+            ++prefix_len;
 
-float
-sr_distances_get_distance(struct sr_distances *distances, int i, int j)
-{
-    if (i == j)
-        return 0.0;
+        if (match)
+            ++match_count;
 
-    if (i > j)
-    {
-        int x;
-        x = j, j = i, i = x;
+        curr_frame = sr_frame_next(curr_frame);
     }
 
-    return distances->distances[get_distance_position(distances, i, j)];
+    trans_count /= 2;
+
+    if (prefix_len > 4)
+        prefix_len = 4;
+
+    if (0 == match_count)
+        return 0;
+
+    /* Same as in distance_jaro_winkler_compat(). */
+    float dist_jaro = ((float)match_count / (float)frame1_count +
+                       (float)match_count / (float)frame2_count +
+                       ((float)match_count - trans_count) / (float)match_count) / 3;
+
+    float k = 0.2;
+
+    float dist = dist_jaro + (float)prefix_len * k * (1 - dist_jaro);
+    return dist;
 }
 
-void
-sr_distances_set_distance(struct sr_distances *distances,
-                          int i,
-                          int j,
-                          float d)
+static float
+jaccard_lower_bound(int max_intersection_size, int set1_size, int set2_size)
 {
-    if (i == j)
-        return;
-
-    if (i > j)
-    {
-        int x;
-        x = j, j = i, i = x;
-    }
+    int union_size = set1_size + set2_size - max_intersection_size;
+    if (!union_size)
+        return 0.0;
 
-    distances->distances[get_distance_position(distances, i, j)] = d;
+    return 1.0 - max_intersection_size / (float)union_size;
 }
 
 static float
-normalize_and_compare(struct sr_thread *t1, struct sr_thread *t2,
-                      enum sr_distance_type dist_type)
+distance_jaccard_bounded(struct sr_thread *thread1,
+                         struct sr_thread *thread2,
+                         float max_dist)
 {
-    float dist;
+    int frame1_count = sr_thread_frame_count(thread1);
+    int intersection_size = 0, set1_size = 0, set2_size = 0;
+    /* Whether each frame of thread1 is the last of its equal frames, only
+     * those are counted. */
+    bool *last = g_malloc_n(frame1_count > 0 ? frame1_count : 1,
+                            sizeof(*last));
+    int i = 0;
 
-    /* XXX: GDB crashes have a special normalization step for
-     * clustering. If there's something similar for other types, we can
-     * generalize it -- meanwhile there's a separate case for GDB here
-     */
-    if (t1->type == SR_REPORT_GDB)
+    for (struct sr_frame *curr_frame = sr_thread_frames(thread1);
+         curr_frame;
+         curr_frame = sr_frame_next(curr_frame), i++)
     {
-        struct sr_gdb_thread *copy1 = (struct sr_gdb_thread*)t1,
-                             *copy2 = (struct sr_gdb_thread*)t2;
-        int ok = 0, all = 0;
-
-        sr_gdb_thread_quality_counts(copy1, &ok, &all);
-        sr_gdb_thread_quality_counts(copy2, &ok, &all);
+        last[i] = !distance_jaccard_frames_contain(sr_frame_next(curr_frame),
+                                                   curr_frame);
+        if (last[i])
+            ++set1_size;
+    }
 
-        if (ok != all)
+    for (struct sr_frame *curr_frame = sr_thread_frames(thread2);
+         curr_frame;
+         curr_frame = sr_frame_next(curr_frame))
+    {
+        if (!distance_jaccard_frames_contain(sr_frame_next(curr_frame),
+                                             curr_frame))
         {
-            /* There are some unknown function names, try to pair them, but
-             * the threads need to be copied first. */
-            copy1 = sr_gdb_thread_dup(copy1, false);
-            copy2 = sr_gdb_thread_dup(copy2, false);
-            sr_normalize_gdb_paired_unknown_function_names(copy1, copy2);
+            ++set2_size;
         }
+    }
+
+    float dist = 1.0;
 
-        dist = sr_distance(dist_type, (struct sr_thread*)copy1,
-                           (struct sr_thread*)copy2);
+    /* The intersection counts the frames of thread1 found in thread2, it
+     * may be larger than set2_size as equality of frames is not
+     * transitive.  Every frame which is not found lowers its largest
+     * possible size. */
+    if (jaccard_lower_bound(set1_size, set1_size, set2_size) > max_dist)
+        goto out;
 
-        if (ok != all)
+    int missing_count = 0;
+    i = 0;
+    for (struct sr_frame *curr_frame = sr_thread_frames(thread1);
+         curr_frame;
+         curr_frame = sr_frame_next(curr_frame), i++)
+    {
+        if (!last[i])
+            continue;
+
+        if (distance_jaccard_frames_contain(sr_thread_frames(thread2),
+                                            curr_frame))
         {
-            sr_gdb_thread_free(copy1);
-            sr_gdb_thread_free(copy2);
+            ++intersection_size;
+            continue;
         }
+
+        ++missing_count;
+        if (jaccard_lower_bound(set1_size - missing_count,
+                                set1_size, set2_size) > max_dist)
+            goto out;
+    }
+
+    /* Same as in distance_jaccard(). */
+    int union_size = set1_size + set2_size - intersection_size;
+    if (!union_size)
+    {
+        dist = 0.0;
+        goto out;
     }
-    else
-        dist = sr_distance(dist_type, t1, t2);
 
+    dist = 1.0 - intersection_size / (float)union_size;
+    if (dist < 0.0)
+        dist = 0.0;
+
+out:
+    g_free(last);
     return dist;
 }
 
-struct sr_distances *
-sr_threads_compare(struct sr_thread **threads,
-                   int m,
-                   int n,
-                   enum sr_distance_type dist_type)
+/* Levenshtein distance restricted to the diagonal band of the matrix
+ * with at most max_edits edits (Ukkonen), the cells outside of the band
+ * are treated as max_edits + 1. */
+static float
+distance_levenshtein_bounded(struct sr_thread *thread1,
+                             struct sr_thread *thread2,
+                             bool transposition,
+                             float max_dist)
 {
-    struct sr_distances *distances;
-    int i, j;
+    int frame_count1 = sr_thread_frame_count(thread1);
+    int frame_count2 = sr_thread_frame_count(thread2);
 
-    distances = sr_distances_new(m, n);
+    int max_frame_count = frame_count2;
+    if (max_frame_count < frame_count1)
+        max_frame_count = frame_count1;
 
-    if (n <= 0)
-        return distances;
+    if (max_frame_count == 0)
+        return 0.0;
 
-    /* Check that all threads are of the same type */
-    enum sr_report_type type, prev_type = threads[0]->type;
-    for (i = 0; i < n; i++)
+    if (!(max_dist >= 0.0))
+        return 1.0;
+
+    /* The largest number of edits within the bound. */
+    int max_edits = max_dist >= 1.0 ? max_frame_count
+                                     : (int)(max_dist * max_frame_count);
+    while (max_edits < max_frame_count &&
+           (float)(max_edits + 1) / max_frame_count <= max_dist)
+        ++max_edits;
+    while (max_edits >= 0 && (float)max_edits / max_frame_count > max_dist)
+        --max_edits;
+
+    if (max_edits < 0 || abs(frame_count1 - frame_count2) > max_edits)
+        return 1.0;
+
+    /* The band covers the whole matrix. */
+    if (max_edits >= max_frame_count)
+        return distance_levenshtein(thread1, thread2, transposition);
+
+    struct sr_frame **frames1 = g_malloc_n(frame_count1 + 1, sizeof(*frames1));
+    struct sr_frame **frames2 = g_malloc_n(frame_count2 + 1, sizeof(*frames2));
+    int i = 0, j = 0;
+
+    for (struct sr_frame *frame = sr_thread_frames(thread1); frame;
+         frame = sr_frame_next(frame))
+        frames1[i++] = frame;
+
+    for (struct sr_frame *frame = sr_thread_frames(thread2); frame;
+         frame = sr_frame_next(frame))
+        frames2[j++] = frame;
+
+    /* Rows i - 2, i - 1 and i of the matrix. */
+    int width = frame_count2 + 2;
+    int *rows = g_malloc_n(3 * width, sizeof(*rows));
+    int *row2 = rows, *row1 = rows + width, *row = rows + 2 * width;
+    int out_of_band = max_edits + 1;
+    int result = out_of_band;
+    int row_min = 0, row1_min;
+
+    for (j = 0; j <= MIN(max_edits, frame_count2); j++)
+        row[j] = j;
+    row[j] = out_of_band;
+
+    for (i = 1; i <= frame_count1; i++)
+    {
+        int *tmp = row2;
+        row2 = row1, row1 = row, row = tmp;
+
+        int first = MAX(0, i - max_edits);
+        int last = MIN(frame_count2, i + max_edits);
+
+        row1_min = row_min;
+        row_min = out_of_band;
+
+        if (first > 0)
+            row[first - 1] = out_of_band;
+
+        for (j = first; j <= last; j++)
+        {
+            if (j == 0)
+            {
+                row[j] = i;
+                row_min = MIN(row_min, i);
+                continue;
+            }
+
+            int cost = 0 == sr_frame_cmp_distance(frames1[i - 1],
+                                                  frames2[j - 1]) ? 0 : 1;
+            int dist = row1[j - 1] + cost;
+
+            if (cost)
+            {
+                dist = MIN(dist, row1[j] + 1);
+                dist = MIN(dist, row[j - 1] + 1);
+            }
+
+            if (transposition && i >= 2 && j >= 2 &&
+                dist > row2[j - 2] + cost &&
+                0 == sr_frame_cmp_distance(frames1[i - 1], frames2[j - 2]) &&
+                0 == sr_frame_cmp_distance(frames1[i - 2], frames2[j - 1]))
+            {
+                dist = row2[j - 2] + cost;
+            }
+
+            row[j] = MIN(dist, out_of_band);
+            row_min = MIN(row_min, row[j]);
+        }
+
+        row[last + 1] = out_of_band;
+
+        /* Every path to the end goes through this row, or skips it by
+         * a transposition from the previous one. */
+        if (row_min > max_edits && (!transposition || row1_min > max_edits))
+            goto out;
+    }
+
+    result = row[frame_count2];
+
+out:
+    g_free(rows);
+    g_free(frames1);
+    g_free(frames2);
+
+    if (result > max_edits)
+        return 1.0;
+
+    return (float)result / max_frame_count;
+}
+
+/* The following kernels compute the same values as the functions above,
+ * but on the interned frame symbols of the threads. */
+
+static bool
+jaro_winkler_symbols_equal(const void *symbols1, int i,
+                           const void *symbols2, int j)
+{
+    return symbol_eq(((const uint32_t *)symbols1)[i],
+                     ((const uint32_t *)symbols2)[j]);
+}
+
+static float
+symbols_jaro_winkler(const struct symbol_thread *thread1,
+                     const struct symbol_thread *thread2)
+{
+    return jaro_winkler(thread1->symbols, thread1->length,
+                        thread2->symbols, thread2->length,
+                        jaro_winkler_symbols_equal, 0.0f);
+}
+
+static float
+symbols_jaro_winkler_compat(const struct symbol_thread *thread1,
+                            const struct symbol_thread *thread2)
+{
+    int frame1_count = thread1->length;
+    int frame2_count = thread2->length;
+
+    if (frame1_count == 0 && frame2_count == 0)
+        return 1.0;
+
+    int max_frame_count = frame2_count;
+    if (max_frame_count < frame1_count)
+        max_frame_count = frame1_count;
+
+    int prefix_len = 0;
+    bool still_prefix = true;
+    float trans_count = 0, match_count = 0;
+
+    for (int i = 1; i <= frame1_count; ++i)
+    {
+        uint32_t symbol = thread1->symbols[i - 1];
+        bool match = false;
+
+        for (int j = 1; !match && j <= frame2_count; ++j)
+        {
+            bool equal = symbol_eq(symbol, thread2->symbols[j - 1]);
+
+            if (i == j && !equal)
+                still_prefix = false;
+
+            if (abs(i - j) <= max_frame_count / 2 - 1 && equal)
+            {
+                match = true;
+                if (i != j)
+                    ++trans_count;
+            }
+        }
+
+        if (still_prefix)
+            ++prefix_len;
+
+        if (match)
+            ++match_count;
+    }
+
+    trans_count /= 2;
+
+    if (prefix_len > 4)
+        prefix_len = 4;
+
+    if (0 == match_count)
+        return 0;
+
+    float dist_jaro = (match_count / (float)frame1_count +
+                       match_count / (float)frame2_count +
+                       (match_count - trans_count) / match_count) / 3;
+
+    float k = 0.2;
+
+    float dist = dist_jaro + (float)prefix_len * k * (1 - dist_jaro);
+    return dist;
+}
+
+static float
+symbols_jaccard(const struct symbol_thread *thread1,
+                const struct symbol_thread *thread2)
+{
+    /* The unknown frames are distinct from all the other frames. */
+    int intersection_size = symbols_intersection_size(thread1->distinct,
+                                                      thread1->distinct_count,
+                                                      thread2->distinct,
+                                                      thread2->distinct_count);
+    int set1_size = thread1->distinct_count + thread1->unknown_count,
+        set2_size = thread2->distinct_count + thread2->unknown_count;
+
+    int union_size = set1_size + set2_size - intersection_size;
+    if (!union_size)
+        return 0.0;
+
+    float j_distance = 1.0 - intersection_size / (float)union_size;
+    if (j_distance < 0.0)
+        j_distance = 0.0;
+
+    return j_distance;
+}
+
+/* Bit vectors of the positions of each symbol in a thread, the pattern
+ * of the bit-parallel Levenshtein distance. */
+struct symbol_positions
+{
+    /* Number of 64-bit words of a bit vector. */
+    int words;
+    /* Open addressing hash table of the distinct symbols, the number of
+     * slots is 1 << slot_bits and SYMBOL_UNKNOWN marks an empty slot. */
+    int slot_bits;
+    uint32_t *slot_symbols;
+    /* Index of the bit vector of the symbol in each slot. */
+    int *slot_vectors;
+    /* The bit vectors, the first one is zero and belongs to the symbols
+     * not present in the thread. */
+    uint64_t *vectors;
+};
+
+/* Storage of symbol_positions for threads of at most 64 frames. */
+#define SYMBOL_POSITIONS_SMALL_BITS 7
+
+static unsigned
+symbol_positions_slot(const struct symbol_positions *positions,
+                      uint32_t symbol)
+{
+    unsigned slot_mask = (1u << positions->slot_bits) - 1;
+    unsigned slot = (symbol * 2654435761u) >> (32 - positions->slot_bits);
+
+    while (positions->slot_symbols[slot] != symbol &&
+           positions->slot_symbols[slot] != SYMBOL_UNKNOWN)
+    {
+        slot = (slot + 1) & slot_mask;
+    }
+
+    return slot;
+}
+
+/* The slots and vectors need to be allocated by the caller, at least
+ * twice as many slots as frames and a vector per frame plus one. */
+static void
+symbol_positions_init(struct symbol_positions *positions,
+                      const struct symbol_thread *thread)
+{
+    int vector_count = 1;
+
+    memset(positions->slot_symbols, 0,
+           sizeof(*positions->slot_symbols) << positions->slot_bits);
+    memset(positions->vectors, 0,
+           sizeof(*positions->vectors) * positions->words);
+
+    for (int i = 0; i < thread->length; i++)
+    {
+        uint32_t symbol = thread->symbols[i];
+
+        /* Unknown frames are not equal to anything. */
+        if (symbol == SYMBOL_UNKNOWN)
+            continue;
+
+        unsigned slot = symbol_positions_slot(positions, symbol);
+        if (positions->slot_symbols[slot] == SYMBOL_UNKNOWN)
+        {
+            positions->slot_symbols[slot] = symbol;
+            positions->slot_vectors[slot] = vector_count;
+            memset(positions->vectors + vector_count * positions->words, 0,
+                   sizeof(*positions->vectors) * positions->words);
+            vector_count++;
+        }
+
+        positions->vectors[positions->slot_vectors[slot] * positions->words
+                           + i / 64] |= UINT64_C(1) << (i % 64);
+    }
+}
+
+static const uint64_t *
+symbol_positions_get(const struct symbol_positions *positions,
+                     uint32_t symbol)
+{
+    if (symbol == SYMBOL_UNKNOWN)
+        return positions->vectors;
+
+    unsigned slot = symbol_positions_slot(positions, symbol);
+    if (positions->slot_symbols[slot] == SYMBOL_UNKNOWN)
+        return positions->vectors;
+
+    return positions->vectors + positions->slot_vectors[slot] * positions->words;
+}
+
+/* Levenshtein distance of a pattern of at most 64 frames and a text by
+ * the bit-parallel algorithm of Myers, with the transposition extension
+ * of Hyyrö, "A bit-vector algorithm for computing Levenshtein and Damerau
+ * edit distances", 2003.  A column of the dynamic programming matrix is
+ * represented by the vectors of its positive (vp) and negative (vn)
+ * vertical differences. */
+static int
+levenshtein_bits(const struct symbol_positions *pattern,
+                 int pattern_length,
+                 const struct symbol_thread *text,
+                 bool transposition)
+{
+    uint64_t vp = ~UINT64_C(0), vn = 0, d0 = 0, pm_prev = 0;
+    uint64_t last = UINT64_C(1) << (pattern_length - 1);
+    int dist = pattern_length;
+
+    for (int j = 0; j < text->length; j++)
+    {
+        uint64_t pm = *symbol_positions_get(pattern, text->symbols[j]);
+        uint64_t tr = 0;
+
+        if (transposition)
+            tr = (((~d0) & pm) << 1) & pm_prev;
+
+        /* Diagonal zero differences. */
+        d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+
+        /* Horizontal differences. */
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+
+        if (hp & last)
+            dist++;
+        if (hn & last)
+            dist--;
+
+        hp = (hp << 1) | 1;
+        hn = hn << 1;
+
+        vp = hn | ~(d0 | hp);
+        vn = hp & d0;
+        pm_prev = pm;
+    }
+
+    return dist;
+}
+
+/* The vectors of a column of the blocked algorithm. */
+struct levenshtein_block
+{
+    uint64_t vp;
+    uint64_t vn;
+    uint64_t d0;
+    uint64_t pm;
+};
+
+/* Same as levenshtein_bits for longer patterns, the columns are split to
+ * 64-bit blocks and the horizontal differences are carried between
+ * them. */
+static int
+levenshtein_bits_blocked(const struct symbol_positions *pattern,
+                         int pattern_length,
+                         const struct symbol_thread *text,
+                         bool transposition)
+{
+    int words = pattern->words;
+    uint64_t last = UINT64_C(1) << ((pattern_length - 1) % 64);
+    int dist = pattern_length;
+
+    /* Block 0 is a zero sentinel below the first word. */
+    struct levenshtein_block *prev = g_malloc0_n(2 * (words + 1),
+                                                 sizeof(*prev));
+    struct levenshtein_block *next = prev + words + 1;
+
+    for (int w = 1; w <= words; w++)
+        prev[w].vp = ~UINT64_C(0);
+
+    for (int j = 0; j < text->length; j++)
+    {
+        const uint64_t *pms = symbol_positions_get(pattern, text->symbols[j]);
+        uint64_t hp_carry = 1, hn_carry = 0;
+
+        for (int w = 1; w <= words; w++)
+        {
+            uint64_t vp = prev[w].vp, vn = prev[w].vn, d0 = prev[w].d0;
+            uint64_t pm = pms[w - 1];
+            uint64_t tr = 0;
+
+            if (transposition)
+            {
+                tr = ((((~d0) & pm) << 1) |
+                      (((~prev[w - 1].d0) & next[w - 1].pm) >> 63))
+                     & prev[w].pm;
+            }
+
+            uint64_t x = pm | hn_carry;
+            d0 = (((x & vp) + vp) ^ vp) | x | vn | tr;
+
+            uint64_t hp = vn | ~(d0 | vp);
+            uint64_t hn = d0 & vp;
+
+            if (w == words)
+            {
+                if (hp & last)
+                    dist++;
+                if (hn & last)
+                    dist--;
+            }
+
+            uint64_t hp_in = hp_carry, hn_in = hn_carry;
+            hp_carry = hp >> 63;
+            hn_carry = hn >> 63;
+            hp = (hp << 1) | hp_in;
+            hn = (hn << 1) | hn_in;
+
+            next[w].vp = hn | ~(d0 | hp);
+            next[w].vn = hp & d0;
+            next[w].d0 = d0;
+            next[w].pm = pm;
+        }
+
+        struct levenshtein_block *tmp = prev;
+        prev = next, next = tmp;
+    }
+
+    g_free(prev < next ? prev : next);
+
+    return dist;
+}
+
+static float
+symbols_levenshtein(const struct symbol_thread *thread1,
+                    const struct symbol_thread *thread2,
+                    bool transposition)
+{
+    /* Both distances are symmetric, the shorter thread is the pattern. */
+    if (thread1->length > thread2->length)
+    {
+        const struct symbol_thread *tmp = thread1;
+        thread1 = thread2, thread2 = tmp;
+    }
+
+    int pattern_length = thread1->length;
+    int max_frame_count = thread2->length;
+
+    if (max_frame_count == 0)
+        return 0.0;
+
+    if (pattern_length == 0)
+        return 1.0;
+
+    struct symbol_positions pattern;
+    int result;
+
+    pattern.words = (pattern_length + 63) / 64;
+
+    if (pattern.words == 1)
+    {
+        uint32_t slot_symbols[1 << SYMBOL_POSITIONS_SMALL_BITS];
+        int slot_vectors[1 << SYMBOL_POSITIONS_SMALL_BITS];
+        uint64_t vectors[64 + 1];
+
+        pattern.slot_bits = SYMBOL_POSITIONS_SMALL_BITS;
+        pattern.slot_symbols = slot_symbols;
+        pattern.slot_vectors = slot_vectors;
+        pattern.vectors = vectors;
+        symbol_positions_init(&pattern, thread1);
+
+        result = levenshtein_bits(&pattern, pattern_length, thread2,
+                                  transposition);
+    }
+    else
+    {
+        pattern.slot_bits = 1;
+        while ((1 << pattern.slot_bits) < 2 * pattern_length)
+            pattern.slot_bits++;
+
+        pattern.slot_symbols = g_malloc_n(1 << pattern.slot_bits,
+                                          sizeof(*pattern.slot_symbols));
+        pattern.slot_vectors = g_malloc_n(1 << pattern.slot_bits,
+                                          sizeof(*pattern.slot_vectors));
+        pattern.vectors = g_malloc_n((size_t)(pattern_length + 1) * pattern.words,
+                                     sizeof(*pattern.vectors));
+        symbol_positions_init(&pattern, thread1);
+
+        result = levenshtein_bits_blocked(&pattern, pattern_length, thread2,
+                                          transposition);
+
+        g_free(pattern.vectors);
+        g_free(pattern.slot_vectors);
+        g_free(pattern.slot_symbols);
+    }
+
+    return (float)result / max_frame_count;
+}
+
+static float
+symbols_distance(enum sr_distance_type distance_type,
+                 const struct symbol_thread *thread1,
+                 const struct symbol_thread *thread2)
+{
+    switch (distance_type)
+    {
+    case SR_DISTANCE_JARO_WINKLER:
+        return symbols_jaro_winkler(thread1, thread2);
+    case SR_DISTANCE_JARO_WINKLER_COMPAT:
+        return symbols_jaro_winkler_compat(thread1, thread2);
+    case SR_DISTANCE_JACCARD:
+        return symbols_jaccard(thread1, thread2);
+    case SR_DISTANCE_LEVENSHTEIN:
+        return symbols_levenshtein(thread1, thread2, false);
+    case SR_DISTANCE_DAMERAU_LEVENSHTEIN:
+        return symbols_levenshtein(thread1, thread2, true);
+    default:
+        return 1.0f;
+    }
+}
+
+float
+sr_distance(enum sr_distance_type distance_type,
+            struct sr_thread *thread1,
+            struct sr_thread *thread2)
+{
+    /* Different thread types are always unequal. */
+    if (thread1->type != thread2->type)
+        return 1.0f;
+
+    switch (distance_type)
+    {
+    case SR_DISTANCE_JARO_WINKLER:
+        return distance_jaro_winkler(thread1, thread2);
+    case SR_DISTANCE_JARO_WINKLER_COMPAT:
+        return distance_jaro_winkler_compat(thread1, thread2);
+    case SR_DISTANCE_JACCARD:
+        return distance_jaccard(thread1, thread2);
+    case SR_DISTANCE_LEVENSHTEIN:
+        return distance_levenshtein(thread1, thread2, false);
+    case SR_DISTANCE_DAMERAU_LEVENSHTEIN:
+        return distance_levenshtein(thread1, thread2, true);
+    default:
+        return 1.0f;
+    }
+}
+
+/* Same as sr_distance_bounded(), but the bound applies to the returned
+ * value, that is to the similarity for the Jaro-Winkler distance. */
+static float
+distance_bounded(enum sr_distance_type distance_type,
+                 struct sr_thread *thread1,
+                 struct sr_thread *thread2,
+                 float bound)
+{
+    if (thread1->type != thread2->type)
+        return 1.0f;
+
+    switch (distance_type)
+    {
+    case SR_DISTANCE_JARO_WINKLER:
+        return distance_jaro_winkler_bounded(thread1, thread2, bound);
+    case SR_DISTANCE_JARO_WINKLER_COMPAT:
+        return distance_jaro_winkler_compat_bounded(thread1, thread2, bound);
+    case SR_DISTANCE_JACCARD:
+        return distance_jaccard_bounded(thread1, thread2, bound);
+    case SR_DISTANCE_LEVENSHTEIN:
+        return distance_levenshtein_bounded(thread1, thread2, false, bound);
+    case SR_DISTANCE_DAMERAU_LEVENSHTEIN:
+        return distance_levenshtein_bounded(thread1, thread2, true, bound);
+    default:
+        return 1.0f;
+    }
+}
+
+float
+sr_distance_bounded(enum sr_distance_type distance_type,
+                    struct sr_thread *thread1,
+                    struct sr_thread *thread2,
+                    float max_dist)
+{
+    return distance_bounded(distance_type, thread1, thread2,
+                            distance_is_similarity(distance_type)
+                            ? 1.0f - max_dist
+                            : max_dist);
+}
+
+static size_t
+get_distance_position_mn(int m, int n, int i, int j)
+{
+    /* The array holds only matrix entries (i, j) where i < j,
+     * locate the position in the array. */
+    assert(i < j && i >= 0 && i < m && j < n);
+
+    size_t h = n, l = n - i;
+
+    return ((h * h - h) - (l * l - l)) / 2 + j - 1;
+}
+
+static size_t
+get_distance_position(const struct sr_distances *distances, int i, int j)
+{
+    return get_distance_position_mn(distances->m, distances->n, i, j);
+}
+
+/* Conversions between float and IEEE 754 half precision, rounding to
+ * the nearest even value. */
+static uint16_t
+float_to_half(float value)
+{
+    union { float f; uint32_t u; } x = { .f = value };
+    const union { float f; uint32_t u; } denorm_magic = { .u = 126u << 23 };
+    uint32_t sign = x.u & 0x80000000u;
+    uint16_t half;
+
+    x.u ^= sign;
+
+    if (x.u >= 143u << 23)
+    {
+        /* Too big for a half, infinity or NaN. */
+        half = x.u > 255u << 23 ? 0x7e00 : 0x7c00;
+    }
+    else if (x.u < 113u << 23)
+    {
+        /* The addition aligns the mantissa of a subnormal half. */
+        x.f += denorm_magic.f;
+        half = x.u - denorm_magic.u;
+    }
+    else
+    {
+        uint32_t mantissa_odd = (x.u >> 13) & 1;
+
+        x.u += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        x.u += mantissa_odd;
+        half = x.u >> 13;
+    }
+
+    return half | (sign >> 16);
+}
+
+static float
+half_to_float(uint16_t half)
+{
+    const union { float f; uint32_t u; } magic = { .u = 113u << 23 };
+    const uint32_t shifted_exponent = 0x7c00u << 13;
+    union { float f; uint32_t u; } x = { .u = (half & 0x7fffu) << 13 };
+    uint32_t exponent = x.u & shifted_exponent;
+
+    x.u += (uint32_t)(127 - 15) << 23;
+
+    if (exponent == shifted_exponent)
+        x.u += (uint32_t)(128 - 16) << 23;
+    else if (exponent == 0)
+    {
+        x.u += 1u << 23;
+        x.f -= magic.f;
+    }
+
+    x.u |= (uint32_t)(half & 0x8000u) << 16;
+
+    return x.f;
+}
+
+static size_t
+distances_cell_size(enum sr_distances_storage storage)
+{
+    switch (storage)
+    {
+    case SR_DISTANCES_FLOAT:
+        return sizeof(float);
+    case SR_DISTANCES_FLOAT16:
+        return sizeof(uint16_t);
+    case SR_DISTANCES_UINT8:
+        return sizeof(uint8_t);
+    default:
+        assert(0 && "Invalid distances storage");
+        return 0;
+    }
+}
+
+/* Number of stored entries of the m-by-n matrix. */
+static size_t
+distances_cell_count(int m, int n)
+{
+    return get_distance_position_mn(m, n, m - 1, n - 1) + 1;
+}
+
+static inline float
+distances_fetch(const struct sr_distances *distances, size_t position)
+{
+    switch (distances->storage)
+    {
+    case SR_DISTANCES_FLOAT16:
+        return half_to_float(((const uint16_t *)distances->cells)[position]);
+    case SR_DISTANCES_UINT8:
+        return ((const uint8_t *)distances->cells)[position] / 255.0f;
+    default:
+        return ((const float *)distances->cells)[position];
+    }
+}
+
+static inline void
+distances_store(struct sr_distances *distances, size_t position, float d)
+{
+    switch (distances->storage)
+    {
+    case SR_DISTANCES_FLOAT16:
+        ((uint16_t *)distances->cells)[position] = float_to_half(d);
+        break;
+    case SR_DISTANCES_UINT8:
+        /* NaN ends up as zero. */
+        if (!(d > 0.0f))
+            d = 0.0f;
+        else if (d > 1.0f)
+            d = 1.0f;
+        ((uint8_t *)distances->cells)[position] = (uint8_t)lrintf(d * 255.0f);
+        break;
+    default:
+        ((float *)distances->cells)[position] = d;
+        break;
+    }
+}
+
+static void
+distances_set_cells(struct sr_distances *distances, void *cells)
+{
+    distances->cells = cells;
+    distances->distances = distances->storage == SR_DISTANCES_FLOAT
+                           ? cells
+                           : NULL;
+}
+
+struct sr_distances *
+sr_distances_new(int m, int n)
+{
+    return sr_distances_new_ext(m, n, SR_DISTANCES_FLOAT);
+}
+
+struct sr_distances *
+sr_distances_new_ext(int m, int n, enum sr_distances_storage storage)
+{
+    struct sr_distances *distances = g_malloc(sizeof(*distances));
+
+    /* The number of rows has to be smaller than columns. */
+    if (m >= n)
+        m = n - 1;
+
+    assert(m > 0 && n > 1 && m < n);
+
+    distances->m = m;
+    distances->n = n;
+    distances->storage = storage;
+    distances_set_cells(distances,
+                        g_malloc_n(distances_cell_count(m, n),
+                                   distances_cell_size(storage)));
+    distances->dist_type = SR_DISTANCE_UNKNOWN;
+    distances->checksum = 0;
+    distances->mapping = NULL;
+    distances->mapping_size = 0;
+
+    return distances;
+}
+
+struct sr_distances *
+sr_distances_dup(struct sr_distances *distances)
+{
+    struct sr_distances *dup_distances;
+
+    dup_distances = sr_distances_new_ext(distances->m, distances->n,
+                                         distances->storage);
+    memcpy(dup_distances->cells, distances->cells,
+           distances_cell_size(distances->storage) *
+           distances_cell_count(distances->m, distances->n));
+    dup_distances->dist_type = distances->dist_type;
+    dup_distances->checksum = distances->checksum;
+
+    return dup_distances;
+}
+
+void
+sr_distances_free(struct sr_distances *distances)
+{
+    if (!distances)
+        return;
+
+    if (distances->mapping)
+    {
+        struct matrix_file_mapping mapping =
+        {
+            .address = distances->mapping,
+            .size = distances->mapping_size,
+        };
+
+        matrix_file_unmap(&mapping);
+    }
+    else
+        g_free(distances->cells);
+
+    g_free(distances);
+}
+
+bool
+sr_distances_save(struct sr_distances *distances,
+                  const char *filename,
+                  char **error_message)
+{
+    struct matrix_file_header header =
+    {
+        .magic = MATRIX_FILE_MAGIC_DISTANCES,
+        .m = distances->m,
+        .n = distances->n,
+        .dist_type = distances->dist_type,
+        .checksum = distances->checksum,
+        .storage = distances->storage,
+    };
+    const void *chunks[] = { distances->cells };
+    size_t chunk_sizes[] =
+    {
+        distances_cell_size(distances->storage) *
+        distances_cell_count(distances->m, distances->n)
+    };
+
+    return matrix_file_write(filename, &header, chunks, chunk_sizes, 1,
+                             error_message);
+}
+
+struct sr_distances *
+sr_distances_load(const char *filename, char **error_message)
+{
+    struct matrix_file_mapping mapping;
+    struct matrix_file_header *header =
+        matrix_file_map(filename, MATRIX_FILE_MAGIC_DISTANCES, &mapping,
+                        error_message);
+
+    if (!header)
+        return NULL;
+
+    if (header->m <= 0 || header->n <= header->m ||
+        !matrix_file_dist_type_valid(header->dist_type) ||
+        header->storage < 0 || header->storage >= SR_DISTANCES_STORAGE_NUM ||
+        header->data_size != distances_cell_size(header->storage) *
+                             distances_cell_count(header->m, header->n))
+    {
+        *error_message = g_strdup_printf("File '%s' contains an invalid "
+                                         "distance matrix.", filename);
+        matrix_file_unmap(&mapping);
+        return NULL;
+    }
+
+    struct sr_distances *distances = g_malloc(sizeof(*distances));
+
+    distances->m = header->m;
+    distances->n = header->n;
+    distances->storage = header->storage;
+    distances_set_cells(distances, header + 1);
+    distances->dist_type = header->dist_type;
+    distances->checksum = header->checksum;
+    distances->mapping = mapping.address;
+    distances->mapping_size = mapping.size;
+
+    return distances;
+}
+
+float
+sr_distances_get_distance(struct sr_distances *distances, int i, int j)
+{
+    if (i == j)
+        return 0.0;
+
+    if (i > j)
+    {
+        int x;
+        x = j, j = i, i = x;
+    }
+
+    return distances_fetch(distances, get_distance_position(distances, i, j));
+}
+
+void
+sr_distances_set_distance(struct sr_distances *distances,
+                          int i,
+                          int j,
+                          float d)
+{
+    if (i == j)
+        return;
+
+    if (i > j)
+    {
+        int x;
+        x = j, j = i, i = x;
+    }
+
+    distances_store(distances, get_distance_position(distances, i, j), d);
+}
+
+/* Pairs of the unknown frames of two GDB threads, see
+ * normalize_gdb_pair_unknown_frames(). */
+struct unknown_pairs
+{
+    int count;
+    int *pairs1;
+    int *pairs2;
+    /* Storage of the pairs of short threads. */
+    int small[2 * UNKNOWN_PAIRS_SMALL];
+};
+
+static void
+unknown_pairs_init(struct unknown_pairs *pairs,
+                   struct sr_gdb_thread *thread1,
+                   struct sr_gdb_thread *thread2)
+{
+    int length1 = sr_thread_frame_count((struct sr_thread *)thread1),
+        length2 = sr_thread_frame_count((struct sr_thread *)thread2);
+
+    pairs->pairs1 = length1 + length2 <= (int)G_N_ELEMENTS(pairs->small)
+                    ? pairs->small
+                    : g_malloc_n(length1 + length2, sizeof(int));
+    pairs->pairs2 = pairs->pairs1 + length1;
+    pairs->count = normalize_gdb_pair_unknown_frames(thread1, thread2,
+                                                     pairs->pairs1,
+                                                     pairs->pairs2);
+}
+
+static void
+unknown_pairs_clean(struct unknown_pairs *pairs)
+{
+    if (pairs->pairs1 != pairs->small)
+        g_free(pairs->pairs1);
+}
+
+/* Whether the unknown frames of the threads would be paired by
+ * sr_normalize_gdb_paired_unknown_function_names(). */
+static bool
+gdb_threads_pairing_needed(struct sr_gdb_thread *thread1,
+                           struct sr_gdb_thread *thread2)
+{
+    int ok = 0, all = 0;
+
+    sr_gdb_thread_quality_counts(thread1, &ok, &all);
+    sr_gdb_thread_quality_counts(thread2, &ok, &all);
+
+    return ok != all;
+}
+
+/* Makes copies of the GDB threads with the paired unknown frames renamed
+ * as in sr_normalize_gdb_paired_unknown_function_names(). Returns false
+ * and makes no copies if no frame would be renamed. */
+static bool
+gdb_threads_dup_paired(struct sr_thread *t1, struct sr_thread *t2,
+                       struct sr_gdb_thread **copy1,
+                       struct sr_gdb_thread **copy2)
+{
+    if (t1->type != SR_REPORT_GDB || t2->type != SR_REPORT_GDB ||
+        !gdb_threads_pairing_needed((struct sr_gdb_thread *)t1,
+                                    (struct sr_gdb_thread *)t2))
+    {
+        return false;
+    }
+
+    struct unknown_pairs pairs;
+
+    /* Find the pairs first, the threads only need to be copied and
+     * renamed if there are some. */
+    unknown_pairs_init(&pairs, (struct sr_gdb_thread *)t1,
+                       (struct sr_gdb_thread *)t2);
+    unknown_pairs_clean(&pairs);
+
+    if (pairs.count == 0)
+        return false;
+
+    *copy1 = sr_gdb_thread_dup((struct sr_gdb_thread *)t1, false);
+    *copy2 = sr_gdb_thread_dup((struct sr_gdb_thread *)t2, false);
+    sr_normalize_gdb_paired_unknown_function_names(*copy1, *copy2);
+
+    return true;
+}
+
+static float
+normalize_and_compare(struct sr_thread *t1, struct sr_thread *t2,
+                      enum sr_distance_type dist_type)
+{
+    /* XXX: GDB crashes have a special normalization step for
+     * clustering. If there's something similar for other types, we can
+     * generalize it -- meanwhile there's a separate case for GDB here
+     */
+    struct sr_gdb_thread *copy1, *copy2;
+
+    if (gdb_threads_dup_paired(t1, t2, &copy1, &copy2))
+    {
+        float dist = sr_distance(dist_type, (struct sr_thread*)copy1,
+                                 (struct sr_thread*)copy2);
+
+        sr_gdb_thread_free(copy1);
+        sr_gdb_thread_free(copy2);
+
+        return dist;
+    }
+
+    return sr_distance(dist_type, t1, t2);
+}
+
+/* Same as normalize_and_compare, bounded like distance_bounded(). */
+static float
+normalize_and_compare_bounded(struct sr_thread *t1, struct sr_thread *t2,
+                              enum sr_distance_type dist_type, float bound)
+{
+    struct sr_gdb_thread *copy1, *copy2;
+
+    if (gdb_threads_dup_paired(t1, t2, &copy1, &copy2))
+    {
+        float dist = distance_bounded(dist_type, (struct sr_thread*)copy1,
+                                      (struct sr_thread*)copy2, bound);
+
+        sr_gdb_thread_free(copy1);
+        sr_gdb_thread_free(copy2);
+
+        return dist;
+    }
+
+    return distance_bounded(dist_type, t1, t2, bound);
+}
+
+static bool
+gdb_thread_has_paired_names(struct sr_gdb_thread *thread)
+{
+    for (struct sr_gdb_frame *frame = thread->frames; frame; frame = frame->next)
+    {
+        if (frame->function_name &&
+            g_str_has_prefix(frame->function_name, GDB_PAIRED_UNKNOWN_PREFIX))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Same as normalize_and_compare for GDB threads with interned symbols.
+ * Instead of renaming the paired unknown frames of copies of the threads,
+ * the pairs get new symbols in an overlay of the symbols of the threads. */
+static float
+normalize_and_compare_gdb_symbols(struct sr_thread *t1,
+                                  struct sr_thread *t2,
+                                  struct symbol_set *symbols,
+                                  struct symbol_thread *symbols1,
+                                  struct symbol_thread *symbols2,
+                                  enum sr_distance_type dist_type)
+{
+    struct sr_gdb_thread *thread1 = (struct sr_gdb_thread *)t1,
+                         *thread2 = (struct sr_gdb_thread *)t2;
+
+    if (!gdb_threads_pairing_needed(thread1, thread2))
+        return symbols_distance(dist_type, symbols1, symbols2);
+
+    struct unknown_pairs pairs;
+    float dist;
+
+    unknown_pairs_init(&pairs, thread1, thread2);
+
+    if (pairs.count == 0)
+        dist = symbols_distance(dist_type, symbols1, symbols2);
+    else if (gdb_thread_has_paired_names(thread1) ||
+             gdb_thread_has_paired_names(thread2))
+    {
+        /* The new names could clash with the existing ones. */
+        dist = normalize_and_compare(t1, t2, dist_type);
+    }
+    else
+    {
+        struct symbol_thread overlay1 = *symbols1, overlay2 = *symbols2;
+
+        /* The pair indices are replaced by the symbols in place. */
+        overlay1.symbols = (uint32_t *)pairs.pairs1;
+        overlay2.symbols = (uint32_t *)pairs.pairs2;
+
+        for (int k = 0; k < symbols1->length; k++)
+        {
+            overlay1.symbols[k] = pairs.pairs1[k] >= 0
+                                  ? symbols->symbol_count + pairs.pairs1[k]
+                                  : symbols1->symbols[k];
+        }
+
+        for (int k = 0; k < symbols2->length; k++)
+        {
+            overlay2.symbols[k] = pairs.pairs2[k] >= 0
+                                  ? symbols->symbol_count + pairs.pairs2[k]
+                                  : symbols2->symbols[k];
+        }
+
+        /* Only the Jaccard distance uses the sorted distinct symbols. */
+        if (dist_type == SR_DISTANCE_JACCARD)
+        {
+            uint32_t small_distinct[2 * UNKNOWN_PAIRS_SMALL];
+            uint32_t *distinct = pairs.pairs1 == pairs.small
+                                 ? small_distinct
+                                 : g_malloc_n(symbols1->length + symbols2->length,
+                                              sizeof(*distinct));
+
+            symbol_thread_sort_distinct(&overlay1, distinct);
+            symbol_thread_sort_distinct(&overlay2, distinct + symbols1->length);
+
+            dist = symbols_jaccard(&overlay1, &overlay2);
+
+            if (distinct != small_distinct)
+                g_free(distinct);
+        }
+        else
+            dist = symbols_distance(dist_type, &overlay1, &overlay2);
+    }
+
+    unknown_pairs_clean(&pairs);
+
+    return dist;
+}
+
+/* Whether the threads need to be compared the usual way, because their
+ * symbols are not sufficient. */
+static bool
+symbols_need_threads(const struct symbol_thread *symbols1,
+                     const struct symbol_thread *symbols2)
+{
+    if (!symbols1->exact || !symbols2->exact ||
+        symbols1->type != symbols2->type)
+    {
+        return true;
+    }
+
+    /* Unknown frames can only be paired by looking at the two threads
+     * together, see sr_normalize_gdb_paired_unknown_function_names. */
+    return symbols1->type == SR_REPORT_GDB &&
+           symbols1->has_unknown && symbols2->has_unknown;
+}
+
+/* Same as normalize_and_compare, using the interned symbols of the threads
+ * where they are sufficient. */
+static float
+normalize_and_compare_symbols_pair(struct sr_thread *t1,
+                                   struct sr_thread *t2,
+                                   struct symbol_set *symbols,
+                                   struct symbol_thread *symbols1,
+                                   struct symbol_thread *symbols2,
+                                   enum sr_distance_type dist_type)
+{
+    if (!symbols_need_threads(symbols1, symbols2))
+        return symbols_distance(dist_type, symbols1, symbols2);
+
+    if (!symbols1->exact || !symbols2->exact ||
+        symbols1->type != symbols2->type)
+    {
+        return normalize_and_compare(t1, t2, dist_type);
+    }
+
+    return normalize_and_compare_gdb_symbols(t1, t2, symbols, symbols1,
+                                             symbols2, dist_type);
+}
+
+static float
+normalize_and_compare_symbols(struct sr_thread **threads,
+                              struct symbol_set *symbols,
+                              int i,
+                              int j,
+                              enum sr_distance_type dist_type)
+{
+    return normalize_and_compare_symbols_pair(threads[i], threads[j], symbols,
+                                              &symbols->threads[i],
+                                              &symbols->threads[j],
+                                              dist_type);
+}
+
+/* Same as normalize_and_compare_symbols for frozen threads. The threads
+ * which need to be compared the usual way are replaced by their views,
+ * views[i] is used if it is not NULL. */
+static float
+normalize_and_compare_frozen(struct sr_frozen_thread **threads,
+                             struct sr_thread **views,
+                             struct symbol_set *symbols,
+                             int i,
+                             int j,
+                             enum sr_distance_type dist_type)
+{
+    struct symbol_thread *symbols1 = &symbols->threads[i],
+                         *symbols2 = &symbols->threads[j];
+
+    if (!symbols_need_threads(symbols1, symbols2))
+        return symbols_distance(dist_type, symbols1, symbols2);
+
+    struct sr_thread *view1 = views[i] ? views[i]
+                                       : frozen_thread_view_new(threads[i]),
+                     *view2 = views[j] ? views[j]
+                                       : frozen_thread_view_new(threads[j]);
+
+    /* Threads without views cannot be compared, which the validation of
+     * the frozen threads rules out. */
+    float dist = 1.0f;
+    if (view1 && view2)
+    {
+        dist = normalize_and_compare_symbols_pair(view1, view2, symbols,
+                                                  symbols1, symbols2,
+                                                  dist_type);
+    }
+
+    if (view1 != views[i])
+        frozen_thread_view_free(view1);
+    if (view2 != views[j])
+        frozen_thread_view_free(view2);
+
+    return dist;
+}
+
+/* State of one worker of sr_threads_compare_parallel. */
+struct compare_worker
+{
+    struct compare_context *context;
+    GMutex lock;
+    /* Rows of the matrix the worker has not started yet, the worker
+     * takes them from the front and others steal them from the back. */
+    int row_begin;
+    int row_end;
+};
+
+struct compare_context
+{
+    struct sr_thread **threads;
+    /* The frozen threads and their views when comparing frozen threads,
+     * the threads are NULL then. */
+    struct sr_frozen_thread **frozen;
+    struct sr_thread **views;
+    struct symbol_set *symbols;
+    struct sr_distances *distances;
+    enum sr_distance_type dist_type;
+    /* Entries (i, j) with i < known_m and j < known_n are already in the
+     * matrix, see sr_distances_extend(). */
+    int known_m;
+    int known_n;
+    struct compare_worker *workers;
+    unsigned nworkers;
+};
+
+/* The first column of the row which needs to be computed. */
+static int
+compare_row_first_column(const struct compare_context *context, int row)
+{
+    return row < context->known_m ? context->known_n : row + 1;
+}
+
+/* Number of matrix entries to compute in rows [row_begin, row_end). */
+static int64_t
+compare_rows_size(const struct compare_context *context,
+                  int row_begin, int row_end)
+{
+    int n = context->distances->n;
+    int64_t size = 0;
+
+    /* The rows with known entries have the same length. */
+    if (row_begin < context->known_m)
+    {
+        int known_end = MIN(row_end, context->known_m);
+
+        size += (int64_t)(known_end - row_begin) * (n - context->known_n);
+        row_begin = known_end;
+    }
+
+    if (row_begin < row_end)
+    {
+        int64_t rows = row_end - row_begin;
+
+        size += rows * (n - 1) - rows * (row_begin + row_end - 1) / 2;
+    }
+
+    return size;
+}
+
+/* Finds the row splitting [row_begin, row_end) into two parts with about
+ * the same number of entries. Early rows are longer than late ones. */
+static int
+compare_rows_split(const struct compare_context *context,
+                   int row_begin, int row_end)
+{
+    int n = context->distances->n;
+    int64_t half = compare_rows_size(context, row_begin, row_end) / 2;
+    int64_t size = 0;
+    int row = row_end;
+
+    while (row > row_begin + 1 &&
+           size + (n - compare_row_first_column(context, row - 1)) <= half)
+    {
+        row--;
+        size += n - compare_row_first_column(context, row);
+    }
+
+    return row;
+}
+
+static bool
+compare_worker_take_row(struct compare_worker *worker, int *row)
+{
+    bool taken = false;
+
+    g_mutex_lock(&worker->lock);
+    if (worker->row_begin < worker->row_end)
+    {
+        *row = worker->row_begin++;
+        taken = true;
+    }
+    g_mutex_unlock(&worker->lock);
+
+    return taken;
+}
+
+static bool
+compare_worker_steal(struct compare_worker *thief)
+{
+    struct compare_context *context = thief->context;
+    unsigned index = thief - context->workers;
+
+    for (unsigned i = 1; i < context->nworkers; i++)
+    {
+        struct compare_worker *victim =
+            &context->workers[(index + i) % context->nworkers];
+        int row_begin, row_end;
+
+        g_mutex_lock(&victim->lock);
+        row_end = victim->row_end;
+        row_begin = victim->row_begin;
+        if (row_begin < row_end)
+        {
+            row_begin = compare_rows_split(context, row_begin, row_end);
+            victim->row_end = row_begin;
+        }
+        g_mutex_unlock(&victim->lock);
+
+        if (row_begin < row_end)
+        {
+            g_mutex_lock(&thief->lock);
+            thief->row_begin = row_begin;
+            thief->row_end = row_end;
+            g_mutex_unlock(&thief->lock);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static gpointer
+compare_worker_run(gpointer data)
+{
+    struct compare_worker *worker = data;
+    struct compare_context *context = worker->context;
+    struct sr_distances *distances = context->distances;
+    int i;
+
+    do
+    {
+        while (compare_worker_take_row(worker, &i))
+        {
+            for (int j = compare_row_first_column(context, i);
+                 j < distances->n;
+                 j++)
+            {
+                float dist = context->frozen
+                    ? normalize_and_compare_frozen(context->frozen,
+                                                   context->views,
+                                                   context->symbols,
+                                                   i, j, context->dist_type)
+                    : normalize_and_compare_symbols(context->threads,
+                                                    context->symbols,
+                                                    i, j, context->dist_type);
+
+                distances_store(distances,
+                                get_distance_position(distances, i, j),
+                                dist);
+            }
+        }
+    } while (compare_worker_steal(worker));
+
+    return NULL;
+}
+
+/* Computes the entries of the matrix which are not known yet in several
+ * threads of execution. The context is filled except for the workers. */
+static void
+compare_distances_run(struct compare_context *context, unsigned nthreads)
+{
+    int m = context->distances->m;
+
+    if (nthreads == 0)
+        nthreads = g_get_num_processors();
+
+    if (nthreads > (unsigned)m)
+        nthreads = m;
+
+    context->workers = g_malloc_n(nthreads, sizeof(*context->workers));
+    context->nworkers = nthreads;
+
+    /* Initially give every worker the same number of entries. */
+    int row_begin = 0;
+    for (unsigned k = 0; k < nthreads; k++)
+    {
+        struct compare_worker *worker = &context->workers[k];
+        int row_end = row_begin;
+        int64_t size = compare_rows_size(context, row_begin, m) / (nthreads - k);
+
+        while (row_end < m &&
+               (row_end == row_begin ||
+                compare_rows_size(context, row_begin, row_end + 1) <= size))
+        {
+            row_end++;
+        }
+
+        if (k + 1 == nthreads)
+            row_end = m;
+
+        worker->context = context;
+        g_mutex_init(&worker->lock);
+        worker->row_begin = row_begin;
+        worker->row_end = row_end;
+        row_begin = row_end;
+    }
+
+    /* The calling thread works as the first worker. */
+    GThread **workers = g_malloc_n(nthreads, sizeof(*workers));
+    for (unsigned k = 1; k < nthreads; k++)
+        workers[k] = g_thread_new("sr_threads_compare", compare_worker_run,
+                                  &context->workers[k]);
+
+    compare_worker_run(&context->workers[0]);
+
+    for (unsigned k = 1; k < nthreads; k++)
+        g_thread_join(workers[k]);
+
+    for (unsigned k = 0; k < nthreads; k++)
+        g_mutex_clear(&context->workers[k].lock);
+
+    g_free(workers);
+    g_free(context->workers);
+}
+
+static void
+compare_distances(struct sr_distances *distances,
+                  struct sr_thread **threads,
+                  enum sr_distance_type dist_type,
+                  int known_m,
+                  int known_n,
+                  unsigned nthreads)
+{
+    struct compare_context context =
+    {
+        .threads = threads,
+        .symbols = symbol_set_new(threads, distances->n),
+        .distances = distances,
+        .dist_type = dist_type,
+        .known_m = known_m,
+        .known_n = known_n,
+    };
+
+    compare_distances_run(&context, nthreads);
+
+    symbol_set_free(context.symbols);
+}
+
+struct sr_distances *
+sr_threads_compare(struct sr_thread **threads,
+                   int m,
+                   int n,
+                   enum sr_distance_type dist_type)
+{
+    return sr_threads_compare_parallel(threads, m, n, dist_type, 1);
+}
+
+/* Takes the first four bytes of the SHA1 of the frame counts. */
+static uint32_t
+frame_counts_checksum(GChecksum *checksum)
+{
+    union
+    {
+        unsigned char hashbuf[SHA1_DIGEST_LEN];
+        uint32_t truncated;
+    } u;
+
+    gsize digest_len = SHA1_DIGEST_LEN;
+    g_checksum_get_digest(checksum, u.hashbuf, &digest_len);
+    assert(digest_len == SHA1_DIGEST_LEN);
+
+    return u.truncated;
+}
+
+/* Take the lengths of all threads, compute SHA1 from them, take first four
+ * bytes. */
+uint32_t
+sr_threads_checksum(struct sr_thread **threads, int n)
+{
+    g_autoptr(GChecksum) checksum = g_checksum_new(G_CHECKSUM_SHA1);
+
+    for (int i = 0; i < n; i++)
+    {
+        int frame_count = sr_thread_frame_count(threads[i]);
+        g_checksum_update(checksum, (void *)&frame_count, sizeof(frame_count));
+    }
+
+    return frame_counts_checksum(checksum);
+}
+
+uint32_t
+sr_frozen_threads_checksum(struct sr_frozen_thread **threads, int n)
+{
+    g_autoptr(GChecksum) checksum = g_checksum_new(G_CHECKSUM_SHA1);
+
+    for (int i = 0; i < n; i++)
+    {
+        int frame_count = threads[i]->frame_count;
+        g_checksum_update(checksum, (void *)&frame_count, sizeof(frame_count));
+    }
+
+    return frame_counts_checksum(checksum);
+}
+
+struct sr_distances *
+sr_threads_compare_parallel(struct sr_thread **threads,
+                            int m,
+                            int n,
+                            enum sr_distance_type dist_type,
+                            unsigned nthreads)
+{
+    return sr_threads_compare_ext(threads, m, n, dist_type, nthreads,
+                                  SR_DISTANCES_FLOAT);
+}
+
+struct sr_distances *
+sr_threads_compare_ext(struct sr_thread **threads,
+                       int m,
+                       int n,
+                       enum sr_distance_type dist_type,
+                       unsigned nthreads,
+                       enum sr_distances_storage storage)
+{
+    struct sr_distances *distances;
+    int i;
+
+    distances = sr_distances_new_ext(m, n, storage);
+
+    if (n <= 0)
+        return distances;
+
+    /* Check that all threads are of the same type */
+    enum sr_report_type type, prev_type = threads[0]->type;
+    for (i = 0; i < n; i++)
     {
         type = threads[i]->type;
         assert(prev_type == type);
         prev_type = type;
     }
 
-    for (i = 0; i < m; i++)
+    compare_distances(distances, threads, dist_type, 0, 0, nthreads);
+
+    distances->dist_type = dist_type;
+    distances->checksum = sr_threads_checksum(threads, n);
+
+    return distances;
+}
+
+float
+sr_frozen_thread_distance(enum sr_distance_type distance_type,
+                          struct sr_frozen_thread *thread1,
+                          struct sr_frozen_thread *thread2)
+{
+    /* Different thread types are always unequal. */
+    if (thread1->type != thread2->type)
+        return 1.0f;
+
+    struct sr_frozen_thread *threads[] = { thread1, thread2 };
+    struct symbol_set *symbols = symbol_set_new_frozen(threads, 2);
+    float dist;
+
+    /* Unlike sr_threads_compare(), sr_distance() does not pair the
+     * unknown GDB frames, so only the frames without exact symbols need
+     * the views. */
+    if (symbols->threads[0].exact && symbols->threads[1].exact)
+        dist = symbols_distance(distance_type, &symbols->threads[0],
+                                &symbols->threads[1]);
+    else
     {
-        for (j = i + 1; j < n; j++)
-        {
+        struct sr_thread *view1 = frozen_thread_view_new(thread1),
+                         *view2 = frozen_thread_view_new(thread2);
+
+        dist = view1 && view2 ? sr_distance(distance_type, view1, view2)
+                              : 1.0f;
+
+        frozen_thread_view_free(view1);
+        frozen_thread_view_free(view2);
+    }
+
+    symbol_set_free(symbols);
+
+    return dist;
+}
+
+struct sr_distances *
+sr_frozen_threads_compare(struct sr_frozen_thread **threads,
+                          int m,
+                          int n,
+                          enum sr_distance_type dist_type,
+                          unsigned nthreads)
+{
+    struct sr_distances *distances = sr_distances_new(m, n);
+
+    if (n <= 0)
+        return distances;
 
-            distances->distances[get_distance_position(distances, i, j)]
-                = normalize_and_compare(threads[i], threads[j], dist_type);
+    /* Check that all threads are of the same type */
+    for (int i = 1; i < n; i++)
+        assert(threads[i]->type == threads[0]->type);
+
+    struct compare_context context =
+    {
+        .frozen = threads,
+        .views = g_malloc0_n(n, sizeof(*context.views)),
+        .symbols = symbol_set_new_frozen(threads, n),
+        .distances = distances,
+        .dist_type = dist_type,
+    };
+
+    /* The threads which always need to be compared the usual way get
+     * their views in advance, the other ones only for the pairs which
+     * need them. */
+    for (int i = 0; i < n; i++)
+    {
+        struct symbol_thread *symbols = &context.symbols->threads[i];
+
+        if (!symbols->exact ||
+            (symbols->type == SR_REPORT_GDB && symbols->has_unknown))
+        {
+            context.views[i] = frozen_thread_view_new(threads[i]);
         }
     }
 
+    compare_distances_run(&context, nthreads);
+
+    for (int i = 0; i < n; i++)
+        frozen_thread_view_free(context.views[i]);
+
+    g_free(context.views);
+    symbol_set_free(context.symbols);
+
+    distances->dist_type = dist_type;
+    distances->checksum = sr_frozen_threads_checksum(threads, n);
+
     return distances;
 }
 
+struct sr_distances *
+sr_distances_extend(struct sr_distances *distances,
+                    struct sr_thread **old_threads,
+                    struct sr_thread **new_threads,
+                    int new_count,
+                    enum sr_distance_type dist_type,
+                    unsigned nthreads)
+{
+    int old_m = distances->m, old_n = distances->n;
+
+    /* The matrices filled by the caller have an unknown type. */
+    if (distances->dist_type != SR_DISTANCE_UNKNOWN &&
+        (distances->dist_type != dist_type ||
+         distances->checksum != sr_threads_checksum(old_threads, old_n)))
+    {
+        return NULL;
+    }
+
+    int n = old_n + new_count;
+    struct sr_thread **threads = g_malloc_n(n, sizeof(*threads));
+
+    memcpy(threads, old_threads, old_n * sizeof(*threads));
+    memcpy(threads + old_n, new_threads, new_count * sizeof(*threads));
+
+    struct sr_distances *extended = sr_distances_new_ext(n - 1, n,
+                                                         distances->storage);
+    size_t cell_size = distances_cell_size(distances->storage);
+
+    /* The rows keep their order, only every row becomes longer. */
+    for (int i = 0; i < old_m; i++)
+    {
+        memcpy((char *)extended->cells +
+               cell_size * get_distance_position(extended, i, i + 1),
+               (char *)distances->cells +
+               cell_size * get_distance_position(distances, i, i + 1),
+               cell_size * (old_n - i - 1));
+    }
+
+    compare_distances(extended, threads, dist_type, old_m, old_n, nthreads);
+
+    extended->dist_type = dist_type;
+    extended->checksum = sr_threads_checksum(threads, n);
+    g_free(threads);
+
+    return extended;
+}
+
+/* Number of corpus threads a worker of sr_threads_nearest_parallel takes
+ * at once. */
+#define NEAREST_CHUNK 64
+
+/* Bounded max-heap of the nearest threads found, the farthest one is at
+ * the root. */
+struct nearest_heap
+{
+    enum sr_distance_type dist_type;
+    int k;
+    int count;
+    struct sr_thread_neighbor *items;
+};
+
+/* Whether neighbor1 is farther from the query than neighbor2. Ties are
+ * broken by the index, so that the result does not depend on the order
+ * of the comparisons. */
+static bool
+neighbor_farther(enum sr_distance_type dist_type,
+                 const struct sr_thread_neighbor *neighbor1,
+                 const struct sr_thread_neighbor *neighbor2)
+{
+    if (neighbor1->distance != neighbor2->distance)
+    {
+        /* Jaro-Winkler is a similarity. */
+        return distance_is_similarity(dist_type)
+               ? neighbor1->distance < neighbor2->distance
+               : neighbor1->distance > neighbor2->distance;
+    }
+
+    return neighbor1->index > neighbor2->index;
+}
+
+/* Whether the distance is beyond the bound. */
+static bool
+distance_beyond(enum sr_distance_type dist_type, float distance, float bound)
+{
+    return distance_is_similarity(dist_type)
+           ? distance < bound
+           : distance > bound;
+}
+
+static void
+nearest_heap_add(struct nearest_heap *heap,
+                 const struct sr_thread_neighbor *neighbor)
+{
+    struct sr_thread_neighbor *items = heap->items;
+    int i;
+
+    if (heap->count < heap->k)
+    {
+        /* Sift the new item up from the last leaf. */
+        i = heap->count++;
+        while (i > 0 &&
+               neighbor_farther(heap->dist_type, neighbor, &items[(i - 1) / 2]))
+        {
+            items[i] = items[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+
+        items[i] = *neighbor;
+        return;
+    }
+
+    if (!neighbor_farther(heap->dist_type, &items[0], neighbor))
+        return;
+
+    /* Replace the root and sift it down. */
+    i = 0;
+    for (;;)
+    {
+        int child = 2 * i + 1;
+
+        if (child >= heap->count)
+            break;
+
+        if (child + 1 < heap->count &&
+            neighbor_farther(heap->dist_type, &items[child + 1], &items[child]))
+        {
+            child++;
+        }
+
+        if (!neighbor_farther(heap->dist_type, &items[child], neighbor))
+            break;
+
+        items[i] = items[child];
+        i = child;
+    }
+
+    items[i] = *neighbor;
+}
+
+static int
+neighbor_cmp(const void *neighbor1, const void *neighbor2, void *dist_type)
+{
+    enum sr_distance_type type = *(enum sr_distance_type *)dist_type;
+
+    if (neighbor_farther(type, neighbor1, neighbor2))
+        return 1;
+
+    if (neighbor_farther(type, neighbor2, neighbor1))
+        return -1;
+
+    return 0;
+}
+
+struct nearest_context
+{
+    struct sr_thread *query;
+    struct sr_thread **corpus;
+    int ncorpus;
+    enum sr_distance_type dist_type;
+    int k;
+    /* Beginning of the next chunk of the corpus to scan, it is updated
+     * atomically. */
+    gint next;
+    GMutex lock;
+    /* The distance of the k-th nearest thread found by any worker,
+     * protected by the lock. */
+    bool bound_known;
+    float bound;
+};
+
+struct nearest_worker
+{
+    struct nearest_context *context;
+    struct nearest_heap heap;
+};
+
+/* Returns the distance any thread nearer than the ones found must be
+ * within. */
+static float
+nearest_worker_bound(struct nearest_worker *worker)
+{
+    struct nearest_context *context = worker->context;
+    struct nearest_heap *heap = &worker->heap;
+    float bound = distance_is_similarity(context->dist_type) ? 0.0f : 1.0f;
+    bool known = false;
+
+    if (heap->count == heap->k)
+    {
+        bound = heap->items[0].distance;
+        known = true;
+    }
+
+    g_mutex_lock(&context->lock);
+
+    if (context->bound_known &&
+        (!known || distance_beyond(context->dist_type, bound, context->bound)))
+    {
+        bound = context->bound;
+    }
+    else if (known)
+    {
+        /* Let the other workers know about the better bound. */
+        context->bound = bound;
+        context->bound_known = true;
+    }
+
+    g_mutex_unlock(&context->lock);
+
+    return bound;
+}
+
+static gpointer
+nearest_worker_run(gpointer data)
+{
+    struct nearest_worker *worker = data;
+    struct nearest_context *context = worker->context;
+    struct nearest_heap *heap = &worker->heap;
+    int begin;
+
+    while ((begin = g_atomic_int_add(&context->next, NEAREST_CHUNK))
+           < context->ncorpus)
+    {
+        int end = MIN(begin + NEAREST_CHUNK, context->ncorpus);
+        float bound = nearest_worker_bound(worker);
+
+        for (int i = begin; i < end; i++)
+        {
+            struct sr_thread_neighbor neighbor;
+
+            neighbor.index = i;
+            neighbor.distance =
+                normalize_and_compare_bounded(context->query,
+                                              context->corpus[i],
+                                              context->dist_type, bound);
+
+            if (distance_beyond(context->dist_type, neighbor.distance, bound))
+                continue;
+
+            nearest_heap_add(heap, &neighbor);
+
+            /* Threads farther than the k-th nearest one are of no
+             * interest. */
+            if (heap->count == heap->k &&
+                distance_beyond(context->dist_type, bound,
+                                heap->items[0].distance))
+            {
+                bound = heap->items[0].distance;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int
+sr_threads_nearest(struct sr_thread *query,
+                   struct sr_thread **corpus,
+                   int ncorpus,
+                   enum sr_distance_type dist_type,
+                   int k,
+                   struct sr_thread_neighbor *results)
+{
+    return sr_threads_nearest_parallel(query, corpus, ncorpus, dist_type, k,
+                                       results, 1);
+}
+
+int
+sr_threads_nearest_parallel(struct sr_thread *query,
+                            struct sr_thread **corpus,
+                            int ncorpus,
+                            enum sr_distance_type dist_type,
+                            int k,
+                            struct sr_thread_neighbor *results,
+                            unsigned nthreads)
+{
+    if (k > ncorpus)
+        k = ncorpus;
+
+    if (k <= 0)
+        return 0;
+
+    if (nthreads == 0)
+        nthreads = g_get_num_processors();
+
+    unsigned nchunks = (ncorpus + NEAREST_CHUNK - 1) / NEAREST_CHUNK;
+    if (nthreads > nchunks)
+        nthreads = nchunks;
+
+    struct nearest_context context =
+    {
+        .query = query,
+        .corpus = corpus,
+        .ncorpus = ncorpus,
+        .dist_type = dist_type,
+        .k = k,
+        .next = 0,
+        .bound_known = false,
+    };
+
+    g_mutex_init(&context.lock);
+
+    struct nearest_worker *workers = g_malloc_n(nthreads, sizeof(*workers));
+    for (unsigned w = 0; w < nthreads; w++)
+    {
+        workers[w].context = &context;
+        workers[w].heap.dist_type = dist_type;
+        workers[w].heap.k = k;
+        workers[w].heap.count = 0;
+        /* The first worker collects the results. */
+        workers[w].heap.items = w == 0 ? results
+                                       : g_malloc_n(k, sizeof(*results));
+    }
+
+    /* The calling thread works as the first worker. */
+    GThread **handles = g_malloc_n(nthreads, sizeof(*handles));
+    for (unsigned w = 1; w < nthreads; w++)
+        handles[w] = g_thread_new("sr_threads_nearest", nearest_worker_run,
+                                  &workers[w]);
+
+    nearest_worker_run(&workers[0]);
+
+    for (unsigned w = 1; w < nthreads; w++)
+    {
+        g_thread_join(handles[w]);
+
+        for (int i = 0; i < workers[w].heap.count; i++)
+            nearest_heap_add(&workers[0].heap, &workers[w].heap.items[i]);
+
+        g_free(workers[w].heap.items);
+    }
+
+    int count = workers[0].heap.count;
+
+    g_qsort_with_data(results, count, sizeof(*results), neighbor_cmp,
+                      &dist_type);
+
+    g_free(handles);
+    g_free(workers);
+    g_mutex_clear(&context.lock);
+
+    return count;
+}
+
 struct sr_distances_part *
 sr_distances_part_new(int m, int n, enum sr_distance_type dist_type,
                       int m_begin, int n_begin, size_t len)
@@ -576,33 +2781,6 @@ sr_distances_part_create(int m, int n, enum sr_distance_type dist_type,
     return res;
 }
 
-/* Take the lengths of all threads, compute SHA1 from them, take first four
- * bytes. */
-static uint32_t
-thread_list_checksum(struct sr_thread **threads, size_t n)
-{
-    g_autoptr(GChecksum) checksum = g_checksum_new(G_CHECKSUM_SHA1);
-
-    int frame_count;
-    union
-    {
-        unsigned char hashbuf[SHA1_DIGEST_LEN];
-        uint32_t truncated;
-    } u;
-
-    for (size_t i = 0; i < n; i++)
-    {
-        frame_count = sr_thread_frame_count(threads[i]);
-        g_checksum_update(checksum, (void *)&frame_count, sizeof(frame_count));
-    }
-
-    gsize digest_len = SHA1_DIGEST_LEN;
-    g_checksum_get_digest(checksum, u.hashbuf, &digest_len);
-    assert(digest_len == SHA1_DIGEST_LEN);
-
-    return u.truncated;
-}
-
 void
 sr_distances_part_compute(struct sr_distances_part *part,
                           struct sr_thread **threads)
@@ -612,6 +2790,7 @@ sr_distances_part_compute(struct sr_distances_part *part,
     int i,j;
     size_t dist_idx;
     part->distances = g_malloc_n(sizeof(float), part->len);
+    struct symbol_set *symbols = symbol_set_new(threads, part->n);
 
     for (dist_idx = 0, i = part->m_begin, j = part->n_begin;
          dist_idx < part->len;
@@ -621,7 +2800,8 @@ sr_distances_part_compute(struct sr_distances_part *part,
         assert(i < part->m && j < part->n);
 
         part->distances[dist_idx]
-            = normalize_and_compare(threads[i], threads[j], part->dist_type);
+            = normalize_and_compare_symbols(threads, symbols, i, j,
+                                            part->dist_type);
 
         j++;
         if (j >= part->n)
@@ -631,7 +2811,8 @@ sr_distances_part_compute(struct sr_distances_part *part,
         }
     }
 
-    part->checksum = thread_list_checksum(threads, part->n);
+    symbol_set_free(symbols);
+    part->checksum = sr_threads_checksum(threads, part->n);
 }
 
 struct sr_distances *
@@ -663,8 +2844,8 @@ sr_distances_part_merge(struct sr_distances_part *parts)
             if (j <= i || i >= it->m || j >= it->n)
                 goto error;
 
-            distances->distances[get_distance_position(distances, i, j)]
-                = it->distances[dist_idx];
+            distances_store(distances, get_distance_position(distances, i, j),
+                            it->distances[dist_idx]);
 
             j++;
             if (j >= it->n)
@@ -676,6 +2857,9 @@ sr_distances_part_merge(struct sr_distances_part *parts)
 
     }
 
+    distances->dist_type = parts->dist_type;
+    distances->checksum = parts->checksum;
+
     return distances;
 error:
     sr_distances_free(distances);
@@ -889,3 +889,151 @@ sr_elf_fde_to_json(struct sr_elf_fde *fde,
 
     return g_string_free(strbuf, FALSE);
 }
+
+static gint
+fde_start_address_cmp(gconstpointer a, gconstpointer b, gpointer data)
+{
+    const struct sr_elf_fde *fde1 = a, *fde2 = b;
+
+    if (fde1->start_address != fde2->start_address)
+        return fde1->start_address < fde2->start_address ? -1 : 1;
+
+    return 0;
+}
+
+struct sr_elf_fde_index *
+sr_elf_fde_index_new(struct sr_elf_fde *eh_frame)
+{
+    struct sr_elf_fde_index *index = g_malloc0(sizeof(*index));
+
+    for (struct sr_elf_fde *fde = eh_frame; fde; fde = fde->next)
+        index->count++;
+
+    if (index->count == 0)
+        return index;
+
+    index->fdes = g_malloc_n(index->count, sizeof(*index->fdes));
+
+    /* The linkers usually emit the FDEs in the order of the functions,
+     * the sorting is skipped then. */
+    bool sorted = true;
+    size_t i = 0;
+    for (struct sr_elf_fde *fde = eh_frame; fde; fde = fde->next, i++)
+    {
+        index->fdes[i] = *fde;
+        if (i > 0 && fde->start_address < index->fdes[i - 1].start_address)
+            sorted = false;
+    }
+
+    /* The sort is stable. */
+    if (!sorted)
+    {
+        g_qsort_with_data(index->fdes, index->count, sizeof(*index->fdes),
+                          fde_start_address_cmp, NULL);
+    }
+
+    for (i = 0; i + 1 < index->count; i++)
+        index->fdes[i].next = &index->fdes[i + 1];
+
+    index->fdes[index->count - 1].next = NULL;
+
+    return index;
+}
+
+struct sr_elf_fde_index *
+sr_elf_get_eh_frame_index(const char *filename,
+                          char **error_message)
+{
+    struct sr_elf_fde *eh_frame = sr_elf_get_eh_frame(filename,
+                                                      error_message);
+    if (!eh_frame)
+        return NULL;
+
+    struct sr_elf_fde_index *index = sr_elf_fde_index_new(eh_frame);
+    sr_elf_eh_frame_free(eh_frame);
+    return index;
+}
+
+void
+sr_elf_fde_index_free(struct sr_elf_fde_index *index)
+{
+    if (!index)
+        return;
+
+    g_free(index->fdes);
+    g_free(index);
+}
+
+/* Returns the index of the first FDE starting after the offset. */
+static size_t
+fde_index_upper_bound(struct sr_elf_fde_index *index, uint64_t offset)
+{
+    size_t low = 0, high = index->count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (index->fdes[middle].start_address <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+struct sr_elf_fde *
+sr_elf_fde_index_find_for_offset(struct sr_elf_fde_index *index,
+                                 uint64_t build_id_offset)
+{
+    size_t upper = fde_index_upper_bound(index, build_id_offset);
+    if (upper == 0)
+        return NULL;
+
+    /* Prefer the first of the FDEs starting at the same address, the same
+     * as the list scan does. */
+    size_t i = upper - 1;
+    uint64_t start_address = index->fdes[i].start_address;
+    while (i > 0 && index->fdes[i - 1].start_address == start_address)
+        i--;
+
+    for (; i < upper; i++)
+    {
+        struct sr_elf_fde *fde = &index->fdes[i];
+        if (build_id_offset - fde->start_address < fde->length)
+            return fde;
+    }
+
+    return NULL;
+}
+
+struct sr_elf_fde *
+sr_elf_fde_index_find_for_address(struct sr_elf_fde_index *index,
+                                  uint64_t address)
+{
+    /* All the FDEs of a file have the same exec base. */
+    if (index->count == 0 || address < index->fdes[0].exec_base)
+        return NULL;
+
+    return sr_elf_fde_index_find_for_offset(index,
+                                            address - index->fdes[0].exec_base);
+}
+
+struct sr_elf_fde *
+sr_elf_fde_index_find_for_start_address(struct sr_elf_fde_index *index,
+                                        uint64_t start_address)
+{
+    if (index->count == 0 || start_address < index->fdes[0].exec_base)
+        return NULL;
+
+    uint64_t offset = start_address - index->fdes[0].exec_base;
+    size_t upper = fde_index_upper_bound(index, offset);
+    if (upper == 0 || index->fdes[upper - 1].start_address != offset)
+        return NULL;
+
+    size_t i = upper - 1;
+    while (i > 0 && index->fdes[i - 1].start_address == offset)
+        i--;
+
+    return &index->fdes[i];
+}
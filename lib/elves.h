@@ -34,6 +34,7 @@ extern "C" {
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @brief A single item of the Procedure Linkage Table present in ELF
@@ -128,6 +129,65 @@ char *
 sr_elf_fde_to_json(struct sr_elf_fde *fde,
                    bool recursive);
 
+/**
+ * @brief The FDEs of an ELF file sorted by their start addresses, for
+ * the lookups which would need to scan the whole list otherwise.
+ */
+struct sr_elf_fde_index
+{
+    /**
+     * Array of the FDEs sorted by start_address.  The next members link
+     * the array in its order, so that it can be used as an FDE list.
+     * FDEs starting at the same address keep their order in the file.
+     */
+    struct sr_elf_fde *fdes;
+
+    /** Number of the FDEs in the array. */
+    size_t count;
+};
+
+/**
+ * Creates an index of the FDEs of a list returned by
+ * sr_elf_get_eh_frame().  The list is copied, it can be released
+ * afterwards.
+ * @returns
+ *   It never returns NULL.  The returned pointer must be released by
+ *   calling the function sr_elf_fde_index_free().
+ */
+struct sr_elf_fde_index *
+sr_elf_fde_index_new(struct sr_elf_fde *eh_frame);
+
+/**
+ * Reads the .eh_frame section from an ELF file into an index.
+ * @param error_message
+ *   Will be filled by an error message if the function fails (returns
+ *   NULL), see sr_elf_get_eh_frame().
+ */
+struct sr_elf_fde_index *
+sr_elf_get_eh_frame_index(const char *filename,
+                          char **error_message);
+
+void
+sr_elf_fde_index_free(struct sr_elf_fde_index *index);
+
+/**
+ * The same as sr_elf_find_fde_for_offset(), sr_elf_find_fde_for_address()
+ * and sr_elf_find_fde_for_start_address(), but the index is searched by
+ * bisection.  The FDEs are assumed not to overlap, an address is looked
+ * up only in the FDEs with the greatest start address not above it.
+ */
+struct sr_elf_fde *
+sr_elf_fde_index_find_for_offset(struct sr_elf_fde_index *index,
+                                 uint64_t build_id_offset);
+
+struct sr_elf_fde *
+sr_elf_fde_index_find_for_address(struct sr_elf_fde_index *index,
+                                  uint64_t address);
+
+struct sr_elf_fde *
+sr_elf_fde_index_find_for_start_address(struct sr_elf_fde_index *index,
+                                        uint64_t start_address);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,127 @@
+/*
+    frozen.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_FROZEN_H
+#define SATYR_FROZEN_H
+
+/* Layout of the frozen threads.
+ *
+ * A frozen thread is a single block of memory starting with struct
+ * sr_frozen_thread, the columns follow it.  Every column is an array
+ * with an entry for each frame, except for the columns of the duphash
+ * texts of the normalized thread, which have an entry for each frame of
+ * the normalized thread, and the string table.  Strings are stored as
+ * offsets to the string table, the offset 0 stands for NULL.  There are
+ * no pointers in the block, so it is also the serialized form of the
+ * thread, in the native byte order.
+ */
+
+#include "report_type.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct sr_thread;
+
+#define FROZEN_THREAD_MAGIC "SRFROZT"
+#define FROZEN_THREAD_VERSION 1
+#define FROZEN_THREAD_BYTE_ORDER 0x01020304
+
+enum frozen_column
+{
+    /* uint64_t entries. */
+    FROZEN_ADDRESS,
+    FROZEN_BUILD_ID_OFFSET,
+    /* uint32_t string offsets. */
+    FROZEN_FUNCTION,
+    FROZEN_LIBRARY,
+    FROZEN_FILE,
+    FROZEN_BUILD_ID,
+    FROZEN_FINGERPRINT,
+    /* The key and the qualifier from frame_symbol_key(), the key does
+     * not include the frame type. */
+    FROZEN_SYMBOL_KEY,
+    FROZEN_SYMBOL_QUALIFIER,
+    /* Duphash texts of the frames with SR_DUPHASH_NORMAL and with
+     * SR_DUPHASH_KOOPS_COMPAT, the text may be empty. */
+    FROZEN_DUPHASH,
+    FROZEN_DUPHASH_KOOPS,
+    /* The same for the frames of the normalized thread. */
+    FROZEN_NORMALIZED_DUPHASH,
+    FROZEN_NORMALIZED_DUPHASH_KOOPS,
+    /* uint8_t enum frame_symbol_kind entries. */
+    FROZEN_SYMBOL_KIND,
+    /* The string table. */
+    FROZEN_STRINGS,
+    /* Number of columns. Must be last. */
+    FROZEN_COLUMN_NUM
+};
+
+struct sr_frozen_thread
+{
+    /* FROZEN_THREAD_MAGIC including the '\0'. */
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    /* enum sr_report_type of the thread. */
+    int32_t type;
+    int32_t frame_count;
+    int32_t normalized_count;
+    uint32_t strings_size;
+    /* Size of the whole block in bytes. */
+    uint64_t size;
+    /* Offsets of the columns from the start of the block. */
+    uint64_t offsets[FROZEN_COLUMN_NUM];
+};
+
+static inline const void *
+frozen_column(const struct sr_frozen_thread *thread, enum frozen_column column)
+{
+    return (const char *)thread + thread->offsets[column];
+}
+
+static inline const char *
+frozen_string(const struct sr_frozen_thread *thread, uint32_t offset)
+{
+    return offset
+           ? (const char *)frozen_column(thread, FROZEN_STRINGS) + offset
+           : NULL;
+}
+
+static inline const char *
+frozen_frame_string(const struct sr_frozen_thread *thread,
+                    enum frozen_column column, int frame)
+{
+    const uint32_t *offsets = frozen_column(thread, column);
+
+    return frozen_string(thread, offsets[frame]);
+}
+
+/* Creates a thread usable by the sr_frame_cmp_distance() and
+ * normalization functions from the frozen fields of the frames.  The
+ * frames point to the strings of the frozen thread, the view must be
+ * released by frozen_thread_view_free() before the frozen thread.  Only
+ * threads of the types with frames without exact symbols are supported
+ * (see frame_symbol_key()), NULL is returned for other types. */
+struct sr_thread *
+frozen_thread_view_new(const struct sr_frozen_thread *thread);
+
+void
+frozen_thread_view_free(struct sr_thread *view);
+
+#endif
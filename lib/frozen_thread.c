@@ -0,0 +1,596 @@
+/*
+    frozen_thread.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "frozen_thread.h"
+#include "frozen.h"
+#include "frame.h"
+#include "thread.h"
+#include "core/frame.h"
+#include "core/thread.h"
+#include "gdb/frame.h"
+#include "gdb/thread.h"
+#include "generic_frame.h"
+#include "generic_thread.h"
+#include "symbols.h"
+#include "internal_utils.h"
+#include <inttypes.h>
+#include <limits.h>
+#include <string.h>
+
+/* Frames of a thread being frozen, the strings are offsets to the
+ * string table. */
+struct frozen_builder
+{
+    GArray *columns[FROZEN_COLUMN_NUM];
+    GString *strings;
+    /* String -> offset in the string table. */
+    GHashTable *offsets;
+};
+
+static size_t
+frozen_column_entry_size(enum frozen_column column)
+{
+    switch (column)
+    {
+    case FROZEN_ADDRESS:
+    case FROZEN_BUILD_ID_OFFSET:
+        return sizeof(uint64_t);
+    case FROZEN_SYMBOL_KIND:
+    case FROZEN_STRINGS:
+        return sizeof(uint8_t);
+    default:
+        return sizeof(uint32_t);
+    }
+}
+
+static size_t
+frozen_column_length(const struct sr_frozen_thread *thread,
+                     enum frozen_column column)
+{
+    switch (column)
+    {
+    case FROZEN_NORMALIZED_DUPHASH:
+    case FROZEN_NORMALIZED_DUPHASH_KOOPS:
+        return thread->normalized_count;
+    case FROZEN_STRINGS:
+        return thread->strings_size;
+    default:
+        return thread->frame_count;
+    }
+}
+
+/* Computes the offsets of the columns and the size of the block from the
+ * counts in the header. The columns are ordered by the size of their
+ * entries, so all of them are aligned. */
+static void
+frozen_layout(const struct sr_frozen_thread *thread,
+              uint64_t *offsets, uint64_t *size)
+{
+    uint64_t offset = sizeof(struct sr_frozen_thread);
+
+    for (int column = 0; column < FROZEN_COLUMN_NUM; column++)
+    {
+        offsets[column] = offset;
+        offset += (uint64_t)frozen_column_length(thread, column) *
+                  frozen_column_entry_size(column);
+    }
+
+    /* Keep the size a multiple of 8 so that frozen threads can be stored
+     * one after another. */
+    *size = (offset + 7) & ~(uint64_t)7;
+}
+
+static uint32_t
+frozen_builder_intern(struct frozen_builder *builder, const char *str)
+{
+    if (!str)
+        return 0;
+
+    gpointer offset;
+    if (g_hash_table_lookup_extended(builder->offsets, str, NULL, &offset))
+        return GPOINTER_TO_UINT(offset);
+
+    SR_ASSERT(builder->strings->len < UINT32_MAX - strlen(str));
+    uint32_t new_offset = builder->strings->len;
+
+    g_string_append_len(builder->strings, str, strlen(str) + 1);
+    g_hash_table_insert(builder->offsets, g_strdup(str),
+                        GUINT_TO_POINTER(new_offset));
+
+    return new_offset;
+}
+
+static void
+frozen_builder_add_string(struct frozen_builder *builder,
+                          enum frozen_column column, const char *str)
+{
+    uint32_t offset = frozen_builder_intern(builder, str);
+
+    g_array_append_val(builder->columns[column], offset);
+}
+
+static void
+frozen_builder_add_duphash(struct frozen_builder *builder,
+                           struct sr_frame *frame,
+                           enum frozen_column column,
+                           enum frozen_column koops_column,
+                           GString *text)
+{
+    g_string_truncate(text, 0);
+    frame_append_duphash_text(frame, SR_DUPHASH_NORMAL, text);
+    frozen_builder_add_string(builder, column, text->str);
+
+    g_string_truncate(text, 0);
+    frame_append_duphash_text(frame, SR_DUPHASH_KOOPS_COMPAT, text);
+    frozen_builder_add_string(builder, koops_column, text->str);
+}
+
+struct sr_frozen_thread *
+sr_thread_freeze(struct sr_thread *thread)
+{
+    struct frozen_builder builder;
+    GString *text = g_string_new(NULL);
+    int frame_count = 0, normalized_count = 0;
+
+    for (int column = 0; column < FROZEN_COLUMN_NUM; column++)
+        builder.columns[column] =
+            g_array_new(FALSE, FALSE, frozen_column_entry_size(column));
+
+    builder.offsets = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                            g_free, NULL);
+    /* The offset 0 stands for NULL. */
+    builder.strings = g_string_new(NULL);
+    g_string_append_c(builder.strings, '\0');
+
+    for (struct sr_frame *frame = sr_thread_frames(thread);
+         frame;
+         frame = sr_frame_next(frame))
+    {
+        struct frame_frozen_fields fields;
+        const char *qualifier = NULL;
+
+        frame_frozen_fields(frame, &fields);
+        g_array_append_val(builder.columns[FROZEN_ADDRESS], fields.address);
+        g_array_append_val(builder.columns[FROZEN_BUILD_ID_OFFSET],
+                           fields.build_id_offset);
+        frozen_builder_add_string(&builder, FROZEN_FUNCTION, fields.function);
+        frozen_builder_add_string(&builder, FROZEN_LIBRARY, fields.library);
+        frozen_builder_add_string(&builder, FROZEN_FILE, fields.file);
+        frozen_builder_add_string(&builder, FROZEN_BUILD_ID, fields.build_id);
+        frozen_builder_add_string(&builder, FROZEN_FINGERPRINT,
+                                  fields.fingerprint);
+
+        g_string_truncate(text, 0);
+        uint8_t kind = frame_symbol_key(frame, text, &qualifier);
+        g_array_append_val(builder.columns[FROZEN_SYMBOL_KIND], kind);
+        frozen_builder_add_string(&builder, FROZEN_SYMBOL_KEY,
+                                  kind == FRAME_SYMBOL_EXACT ? text->str : NULL);
+        frozen_builder_add_string(&builder, FROZEN_SYMBOL_QUALIFIER,
+                                  kind == FRAME_SYMBOL_EXACT ? qualifier : NULL);
+
+        frozen_builder_add_duphash(&builder, frame, FROZEN_DUPHASH,
+                                   FROZEN_DUPHASH_KOOPS, text);
+        frame_count++;
+    }
+
+    /* The duplication hash is computed from the normalized thread by
+     * default. */
+    struct normalized_thread normalized;
+    normalized_thread_init(&normalized, thread);
+
+    for (unsigned i = 0; i < normalized.frames->len; i++)
+    {
+        frozen_builder_add_duphash(&builder, normalized.frames->pdata[i],
+                                   FROZEN_NORMALIZED_DUPHASH,
+                                   FROZEN_NORMALIZED_DUPHASH_KOOPS, text);
+        normalized_count++;
+    }
+
+    normalized_thread_destroy(&normalized);
+
+    struct sr_frozen_thread header;
+    uint64_t size;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FROZEN_THREAD_MAGIC, sizeof(header.magic));
+    header.version = FROZEN_THREAD_VERSION;
+    header.byte_order = FROZEN_THREAD_BYTE_ORDER;
+    header.type = thread->type;
+    header.frame_count = frame_count;
+    header.normalized_count = normalized_count;
+    header.strings_size = builder.strings->len;
+    frozen_layout(&header, header.offsets, &size);
+    header.size = size;
+
+    struct sr_frozen_thread *frozen = g_malloc0(size);
+
+    memcpy(frozen, &header, sizeof(header));
+    for (int column = 0; column < FROZEN_COLUMN_NUM; column++)
+    {
+        const void *data = column == FROZEN_STRINGS
+                           ? (const void *)builder.strings->str
+                           : (const void *)builder.columns[column]->data;
+        size_t length = frozen_column_length(&header, column);
+
+        if (length > 0)
+        {
+            memcpy((char *)frozen + header.offsets[column], data,
+                   length * frozen_column_entry_size(column));
+        }
+    }
+
+    for (int column = 0; column < FROZEN_COLUMN_NUM; column++)
+        g_array_free(builder.columns[column], TRUE);
+
+    g_hash_table_destroy(builder.offsets);
+    g_string_free(builder.strings, TRUE);
+    g_string_free(text, TRUE);
+
+    return frozen;
+}
+
+void
+sr_frozen_thread_free(struct sr_frozen_thread *thread)
+{
+    g_free(thread);
+}
+
+enum sr_report_type
+sr_frozen_thread_type(const struct sr_frozen_thread *thread)
+{
+    return thread->type;
+}
+
+int
+sr_frozen_thread_frame_count(const struct sr_frozen_thread *thread)
+{
+    return thread->frame_count;
+}
+
+const char *
+sr_frozen_thread_function_name(const struct sr_frozen_thread *thread,
+                               int frame)
+{
+    assert(frame >= 0 && frame < thread->frame_count);
+    return frozen_frame_string(thread, FROZEN_FUNCTION, frame);
+}
+
+const char *
+sr_frozen_thread_library_name(const struct sr_frozen_thread *thread,
+                              int frame)
+{
+    assert(frame >= 0 && frame < thread->frame_count);
+    return frozen_frame_string(thread, FROZEN_LIBRARY, frame);
+}
+
+const char *
+sr_frozen_thread_file_name(const struct sr_frozen_thread *thread,
+                           int frame)
+{
+    assert(frame >= 0 && frame < thread->frame_count);
+    return frozen_frame_string(thread, FROZEN_FILE, frame);
+}
+
+uint64_t
+sr_frozen_thread_address(const struct sr_frozen_thread *thread, int frame)
+{
+    assert(frame >= 0 && frame < thread->frame_count);
+
+    const uint64_t *addresses = frozen_column(thread, FROZEN_ADDRESS);
+    return addresses[frame];
+}
+
+char *
+sr_frozen_thread_get_duphash(const struct sr_frozen_thread *thread,
+                             int nframes, char *prefix,
+                             enum sr_duphash_flags flags)
+{
+    enum frozen_column column;
+    int frame_count;
+    char *ret;
+
+    /* Same as sr_thread_get_duphash(), with the texts of the frames
+     * computed in advance. */
+    if (flags & SR_DUPHASH_NONORMALIZE)
+    {
+        column = flags & SR_DUPHASH_KOOPS_COMPAT
+                 ? FROZEN_DUPHASH_KOOPS
+                 : FROZEN_DUPHASH;
+        frame_count = thread->frame_count;
+    }
+    else
+    {
+        column = flags & SR_DUPHASH_KOOPS_COMPAT
+                 ? FROZEN_NORMALIZED_DUPHASH_KOOPS
+                 : FROZEN_NORMALIZED_DUPHASH;
+        frame_count = thread->normalized_count;
+    }
+
+    GString *strbuf = g_string_new(NULL);
+    struct text_hash hash_state, *hash = NULL;
+    size_t length = 0;
+
+    if (!(flags & SR_DUPHASH_NOHASH))
+    {
+        text_hash_init(&hash_state, flags & SR_DUPHASH_FAST);
+        hash = &hash_state;
+    }
+
+    if (prefix)
+        g_string_append(strbuf, prefix);
+
+    if (!(flags & SR_DUPHASH_KOOPS_COMPAT))
+        g_string_append(strbuf, "Thread\n");
+
+    length += strbuf->len;
+    text_hash_flush(hash, strbuf);
+
+    if (nframes == 0)
+        nframes = INT_MAX;
+
+    for (int i = 0; i < frame_count && nframes > 0; i++)
+    {
+        const char *text = frozen_frame_string(thread, column, i);
+
+        /* Don't count the frame if it has no text. */
+        if (text && *text)
+        {
+            size_t text_length = strlen(text);
+
+            if (hash)
+                text_hash_update(hash, text, text_length);
+            else
+                g_string_append_len(strbuf, text, text_length);
+
+            length += text_length;
+            nframes--;
+        }
+    }
+
+    if (hash)
+    {
+        ret = text_hash_finish(hash);
+        g_string_free(strbuf, TRUE);
+    }
+    else
+        ret = g_string_free(strbuf, FALSE);
+
+    if ((flags & SR_DUPHASH_KOOPS_COMPAT) && length == 0)
+    {
+        g_free(ret);
+        ret = NULL;
+    }
+
+    return ret;
+}
+
+const void *
+sr_frozen_thread_data(const struct sr_frozen_thread *thread, size_t *size)
+{
+    *size = thread->size;
+    return thread;
+}
+
+static bool
+frozen_thread_valid(const struct sr_frozen_thread *thread,
+                    char **error_message)
+{
+    if (memcmp(thread->magic, FROZEN_THREAD_MAGIC, sizeof(thread->magic)) != 0)
+    {
+        *error_message = g_strdup("Not a frozen thread");
+        return false;
+    }
+
+    if (thread->version != FROZEN_THREAD_VERSION)
+    {
+        *error_message = g_strdup_printf("Unsupported frozen thread version %"
+                                         PRIu32, thread->version);
+        return false;
+    }
+
+    if (thread->byte_order != FROZEN_THREAD_BYTE_ORDER)
+    {
+        *error_message = g_strdup("Frozen thread has a different byte order");
+        return false;
+    }
+
+    if (thread->type <= SR_REPORT_INVALID || thread->type >= SR_REPORT_NUM)
+    {
+        *error_message = g_strdup_printf("Invalid frozen thread type %"PRId32,
+                                         thread->type);
+        return false;
+    }
+
+    if (thread->frame_count < 0 || thread->normalized_count < 0 ||
+        thread->strings_size == 0)
+    {
+        *error_message = g_strdup("Invalid frozen thread header");
+        return false;
+    }
+
+    uint64_t offsets[FROZEN_COLUMN_NUM], size;
+    frozen_layout(thread, offsets, &size);
+    if (size != thread->size ||
+        memcmp(offsets, thread->offsets, sizeof(offsets)) != 0)
+    {
+        *error_message = g_strdup("Invalid frozen thread layout");
+        return false;
+    }
+
+    const char *strings = frozen_column(thread, FROZEN_STRINGS);
+    if (strings[0] != '\0' || strings[thread->strings_size - 1] != '\0')
+    {
+        *error_message = g_strdup("Invalid frozen thread string table");
+        return false;
+    }
+
+    for (int column = FROZEN_FUNCTION; column < FROZEN_SYMBOL_KIND; column++)
+    {
+        const uint32_t *entries = frozen_column(thread, column);
+        size_t length = frozen_column_length(thread, column);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            if (entries[i] >= thread->strings_size)
+            {
+                *error_message = g_strdup("Invalid frozen thread string offset");
+                return false;
+            }
+        }
+    }
+
+    /* The frames without exact symbols are compared by the views, which
+     * only the core and GDB threads have, and only the core frames can
+     * lack symbols, see frozen_thread_view_new(). */
+    uint8_t max_kind = thread->type == SR_REPORT_CORE ? FRAME_SYMBOL_NONE
+                     : thread->type == SR_REPORT_GDB ? FRAME_SYMBOL_UNKNOWN
+                     : FRAME_SYMBOL_EXACT;
+
+    const uint8_t *kinds = frozen_column(thread, FROZEN_SYMBOL_KIND);
+    for (int i = 0; i < thread->frame_count; i++)
+    {
+        if (kinds[i] > max_kind)
+        {
+            *error_message = g_strdup("Invalid frozen thread symbol");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+struct sr_frozen_thread *
+sr_frozen_thread_from_data(const void *data, size_t size,
+                           char **error_message)
+{
+    struct sr_frozen_thread header;
+
+    if (size < sizeof(header))
+    {
+        *error_message = g_strdup("Frozen thread data are truncated");
+        return NULL;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if (header.size != size)
+    {
+        *error_message = g_strdup_printf("Frozen thread data have %zu bytes, "
+                                         "expected %"PRIu64, size, header.size);
+        return NULL;
+    }
+
+    struct sr_frozen_thread *thread = g_malloc(size);
+
+    memcpy(thread, data, size);
+    if (!frozen_thread_valid(thread, error_message))
+    {
+        g_free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+static struct sr_thread *
+frozen_core_thread_view(const struct sr_frozen_thread *thread)
+{
+    struct sr_core_thread *view = sr_core_thread_new();
+    struct sr_core_frame *frames = g_malloc0_n(thread->frame_count,
+                                               sizeof(*frames));
+    const uint64_t *addresses = frozen_column(thread, FROZEN_ADDRESS),
+                   *build_id_offsets = frozen_column(thread,
+                                                     FROZEN_BUILD_ID_OFFSET);
+
+    for (int i = 0; i < thread->frame_count; i++)
+    {
+        struct sr_core_frame *frame = &frames[i];
+
+        sr_core_frame_init(frame);
+        frame->address = addresses[i];
+        frame->build_id = (char *)frozen_frame_string(thread, FROZEN_BUILD_ID, i);
+        frame->build_id_offset = build_id_offsets[i];
+        frame->function_name =
+            (char *)frozen_frame_string(thread, FROZEN_FUNCTION, i);
+        frame->file_name = (char *)frozen_frame_string(thread, FROZEN_LIBRARY, i);
+        frame->fingerprint =
+            (char *)frozen_frame_string(thread, FROZEN_FINGERPRINT, i);
+        frame->next = i + 1 < thread->frame_count ? &frames[i + 1] : NULL;
+    }
+
+    view->frames = thread->frame_count > 0 ? frames : NULL;
+    if (!view->frames)
+        g_free(frames);
+
+    return (struct sr_thread *)view;
+}
+
+static struct sr_thread *
+frozen_gdb_thread_view(const struct sr_frozen_thread *thread)
+{
+    struct sr_gdb_thread *view = sr_gdb_thread_new();
+    struct sr_gdb_frame *frames = g_malloc0_n(thread->frame_count,
+                                              sizeof(*frames));
+    const uint64_t *addresses = frozen_column(thread, FROZEN_ADDRESS);
+
+    for (int i = 0; i < thread->frame_count; i++)
+    {
+        struct sr_gdb_frame *frame = &frames[i];
+
+        sr_gdb_frame_init(frame);
+        frame->function_name =
+            (char *)frozen_frame_string(thread, FROZEN_FUNCTION, i);
+        frame->source_file = (char *)frozen_frame_string(thread, FROZEN_FILE, i);
+        frame->address = addresses[i];
+        frame->library_name =
+            (char *)frozen_frame_string(thread, FROZEN_LIBRARY, i);
+        frame->next = i + 1 < thread->frame_count ? &frames[i + 1] : NULL;
+    }
+
+    view->frames = thread->frame_count > 0 ? frames : NULL;
+    if (!view->frames)
+        g_free(frames);
+
+    return (struct sr_thread *)view;
+}
+
+struct sr_thread *
+frozen_thread_view_new(const struct sr_frozen_thread *thread)
+{
+    switch (thread->type)
+    {
+    case SR_REPORT_CORE:
+        return frozen_core_thread_view(thread);
+    case SR_REPORT_GDB:
+        return frozen_gdb_thread_view(thread);
+    default:
+        return NULL;
+    }
+}
+
+void
+frozen_thread_view_free(struct sr_thread *view)
+{
+    if (!view)
+        return;
+
+    /* The frames are a single array and the strings belong to the frozen
+     * thread. */
+    g_free(sr_thread_frames(view));
+    g_free(view);
+}
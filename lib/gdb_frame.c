@@ -38,6 +38,12 @@ gdb_append_bthash_text(struct sr_gdb_frame *frame, enum sr_bthash_flags flags,
 static void
 gdb_append_duphash_text(struct sr_gdb_frame *frame, enum sr_duphash_flags flags,
                         GString *strbuf);
+static enum frame_symbol_kind
+gdb_symbol_key(struct sr_gdb_frame *frame, GString *key,
+               const char **qualifier);
+static void
+gdb_frozen_fields(struct sr_gdb_frame *frame,
+                  struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(gdb_next, struct sr_frame, struct sr_gdb_frame)
 DEFINE_SET_NEXT_FUNC(gdb_set_next, struct sr_frame, struct sr_gdb_frame)
@@ -60,6 +66,8 @@ struct frame_methods gdb_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) gdb_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_gdb_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) gdb_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) gdb_frozen_fields,
 };
 
 /* Public functions */
@@ -67,7 +75,7 @@ struct frame_methods gdb_frame_methods =
 struct sr_gdb_frame *
 sr_gdb_frame_new()
 {
-    struct sr_gdb_frame *frame = g_malloc(sizeof(*frame));
+    struct sr_gdb_frame *frame = arena_malloc(sizeof(*frame));
     sr_gdb_frame_init(frame);
     return frame;
 }
@@ -93,11 +101,11 @@ sr_gdb_frame_free(struct sr_gdb_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->function_name);
-    g_free(frame->function_type);
-    g_free(frame->source_file);
-    g_free(frame->library_name);
-    g_free(frame);
+    sr_intern_free(frame->function_name);
+    arena_free(frame->function_type);
+    sr_intern_free(frame->source_file);
+    sr_intern_free(frame->library_name);
+    arena_free(frame);
 }
 
 struct sr_gdb_frame *
@@ -120,17 +128,27 @@ sr_gdb_frame_dup(struct sr_gdb_frame *frame, bool siblings)
 
     /* Duplicate all strings. */
     if (result->function_name)
-        result->function_name = g_strdup(result->function_name);
+        result->function_name = sr_intern_strdup(result->function_name);
     if (result->function_type)
         result->function_type = g_strdup(result->function_type);
     if (result->source_file)
-        result->source_file = g_strdup(result->source_file);
+        result->source_file = sr_intern_strdup(result->source_file);
     if (result->library_name)
-        result->library_name = g_strdup(result->library_name);
+        result->library_name = sr_intern_strdup(result->library_name);
 
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_gdb_frame *
+gdb_frame_intern(struct sr_gdb_frame *frame)
+{
+    frame->function_name = intern_take(frame->function_name);
+    frame->source_file = intern_take(frame->source_file);
+    frame->library_name = intern_take(frame->library_name);
+    return frame;
+}
+
 bool
 sr_gdb_frame_calls_func(struct sr_gdb_frame *frame,
                         const char *function_name,
@@ -186,8 +204,8 @@ sr_gdb_frame_cmp(struct sr_gdb_frame *frame1,
     }
 
     /* Function. */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
@@ -197,8 +215,8 @@ sr_gdb_frame_cmp(struct sr_gdb_frame *frame1,
         return function_type;
 
     /* Sourcefile. */
-    int source_file = g_strcmp0(frame1->source_file,
-                                 frame2->source_file);
+    int source_file = intern_strcmp0(frame1->source_file,
+                                      frame2->source_file);
     if (source_file != 0)
         return source_file;
 
@@ -208,8 +226,8 @@ sr_gdb_frame_cmp(struct sr_gdb_frame *frame1,
         return source_line;
 
     /* Library name. */
-    int library_name = g_strcmp0(frame1->library_name,
-                                  frame2->library_name);
+    int library_name = intern_strcmp0(frame1->library_name,
+                                       frame2->library_name);
     if (library_name != 0)
         return library_name;
 
@@ -232,16 +250,16 @@ sr_gdb_frame_cmp_distance(struct sr_gdb_frame *frame1,
         g_strcmp0(frame2->function_name, "??") == 0)
         return -1;
 
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* Assume they are the same if one of them is not known. */
     if (frame1->library_name && frame2->library_name)
     {
-        return strcmp(frame1->library_name,
-                      frame2->library_name);
+        return intern_strcmp0(frame1->library_name,
+                            frame2->library_name);
     }
 
     return 0;
@@ -786,12 +804,12 @@ sr_gdb_frame_parse_function_name(const char **input,
 
     if (buf1)
     {
-        *function_name = g_string_free(buf1, FALSE);
-        *function_type = g_string_free(buf0, FALSE);
+        *function_name = arena_string_free(buf1);
+        *function_type = arena_string_free(buf0);
     }
     else
     {
-        *function_name = g_string_free(buf0, FALSE);
+        *function_name = arena_string_free(buf0);
         *function_type = NULL;
     }
 
@@ -896,8 +914,8 @@ sr_gdb_frame_parse_function_call(const char **input,
                                         &line,
                                         &column))
     {
-        g_free(name);
-        g_free(type);
+        arena_free(name);
+        arena_free(type);
         location->message = "Expected a space or newline after the function name.";
         return false;
     }
@@ -906,8 +924,8 @@ sr_gdb_frame_parse_function_call(const char **input,
 
     if (!sr_gdb_frame_skip_function_args(&local_input, location))
     {
-        g_free(name);
-        g_free(type);
+        arena_free(name);
+        arena_free(type);
         /* The location message is set by the function returning
          * false, no need to update it here. */
         return false;
@@ -1059,7 +1077,7 @@ sr_gdb_frame_parse_file_location(const char **input,
     if((tmp = strstr(file_name, "/lib")) != NULL
        && (strstr(tmp, ".so.") != NULL
            || strcmp(tmp + strlen(tmp) - 3, ".so") == 0)) {
-        g_free(file_name);
+        arena_free(file_name);
         file_name = NULL;
     }
 
@@ -1070,7 +1088,7 @@ sr_gdb_frame_parse_file_location(const char **input,
         location->column += digits;
         if (0 == digits)
         {
-            g_free(file_name);
+            arena_free(file_name);
             location->message = "Expected a line number.";
             return false;
         }
@@ -1173,7 +1191,7 @@ sr_gdb_frame_parse_header(const char **input,
     }
 
     *input = local_input;
-    return imframe;
+    return gdb_frame_intern(imframe);
 }
 
 static void
@@ -1210,3 +1228,26 @@ gdb_append_duphash_text(struct sr_gdb_frame *frame, enum sr_duphash_flags flags,
 
     g_string_append(strbuf, "\n");
 }
+
+static enum frame_symbol_kind
+gdb_symbol_key(struct sr_gdb_frame *frame, GString *key,
+               const char **qualifier)
+{
+    if (g_strcmp0(frame->function_name, "??") == 0)
+        return FRAME_SYMBOL_UNKNOWN;
+
+    symbol_key_append_str(key, frame->function_name);
+    /* Frames with unknown library match any library. */
+    *qualifier = frame->library_name;
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+gdb_frozen_fields(struct sr_gdb_frame *frame,
+                  struct frame_frozen_fields *fields)
+{
+    fields->function = frame->function_name;
+    fields->library = frame->library_name;
+    fields->file = frame->source_file;
+    fields->address = frame->address;
+}
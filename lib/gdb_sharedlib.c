@@ -19,6 +19,7 @@
 */
 #include "gdb/sharedlib.h"
 #include "utils.h"
+#include "internal_utils.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <string.h>
@@ -27,7 +28,7 @@
 struct sr_gdb_sharedlib *
 sr_gdb_sharedlib_new()
 {
-    struct sr_gdb_sharedlib *result = g_malloc(sizeof(*result));
+    struct sr_gdb_sharedlib *result = arena_malloc(sizeof(*result));
     sr_gdb_sharedlib_init(result);
     return result;
 }
@@ -48,8 +49,8 @@ sr_gdb_sharedlib_free(struct sr_gdb_sharedlib *sharedlib)
     if (!sharedlib)
         return;
 
-    g_free(sharedlib->soname);
-    g_free(sharedlib);
+    arena_free(sharedlib->soname);
+    arena_free(sharedlib);
 }
 
 struct sr_gdb_sharedlib *
@@ -241,7 +242,7 @@ sr_gdb_sharedlib_parse(const char *input)
         current->from = from;
         current->to = to;
         current->symbols = symbols;
-        current->soname = g_string_free(buf, FALSE);
+        current->soname = arena_string_free(buf);
 
         /* we are on '\n' character, jump to next line */
         ++tmp;
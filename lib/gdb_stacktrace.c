@@ -78,7 +78,7 @@ struct stacktrace_methods gdb_stacktrace_methods =
 struct sr_gdb_stacktrace *
 sr_gdb_stacktrace_new()
 {
-    struct sr_gdb_stacktrace *stacktrace = g_malloc(sizeof(*stacktrace));
+    struct sr_gdb_stacktrace *stacktrace = arena_malloc(sizeof(*stacktrace));
     sr_gdb_stacktrace_init(stacktrace);
     return stacktrace;
 }
@@ -116,7 +116,7 @@ sr_gdb_stacktrace_free(struct sr_gdb_stacktrace *stacktrace)
     if (stacktrace->crash)
         sr_gdb_frame_free(stacktrace->crash);
 
-    g_free(stacktrace);
+    arena_free(stacktrace);
 }
 
 struct sr_gdb_stacktrace *
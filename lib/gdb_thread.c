@@ -58,6 +58,8 @@ struct thread_methods gdb_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) gdb_dup,
     .normalize = (normalize_fn_t) sr_normalize_gdb_thread,
+    .normalized_frames =
+        (normalized_frames_fn_t) normalize_gdb_thread_frames,
 };
 
 /* Public functions */
@@ -65,7 +67,7 @@ struct thread_methods gdb_thread_methods =
 struct sr_gdb_thread *
 sr_gdb_thread_new()
 {
-    struct sr_gdb_thread *thread = g_malloc(sizeof(*thread));
+    struct sr_gdb_thread *thread = arena_malloc(sizeof(*thread));
     sr_gdb_thread_init(thread);
     return thread;
 }
@@ -93,7 +95,7 @@ sr_gdb_thread_free(struct sr_gdb_thread *thread)
         sr_gdb_frame_free(frame);
     }
 
-    g_free(thread);
+    arena_free(thread);
 }
 
 struct sr_gdb_thread *
@@ -545,9 +547,8 @@ sr_gdb_thread_set_libnames(struct sr_gdb_thread *thread, struct sr_gdb_sharedlib
             else
                 s2 += strlen(".so");
 
-            if (frame->library_name)
-                g_free(frame->library_name);
-            frame->library_name = g_strndup(s1, s2 - s1);
+            sr_intern_free(frame->library_name);
+            frame->library_name = intern_take(g_strndup(s1, s2 - s1));
         }
         frame = frame->next;
     }
@@ -91,6 +91,19 @@ frame_append_duphash_text(struct sr_frame *frame, enum sr_duphash_flags flags,
             (frame, flags, strbuf);
 }
 
+enum frame_symbol_kind
+frame_symbol_key(struct sr_frame *frame, GString *key, const char **qualifier)
+{
+    return DISPATCH(dtable, frame->type, symbol_key)(frame, key, qualifier);
+}
+
+void
+frame_frozen_fields(struct sr_frame *frame, struct frame_frozen_fields *fields)
+{
+    memset(fields, 0, sizeof(*fields));
+    DISPATCH(dtable, frame->type, frozen_fields)(frame, fields);
+}
+
 void sr_frame_free(struct sr_frame *frame)
 {
     if (!frame)
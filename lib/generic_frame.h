@@ -21,10 +21,28 @@
 #define SATYR_GENERIC_FRAME_H
 
 #include "frame.h"
+#include "symbols.h"
 
 enum sr_bthash_flags;
 enum sr_duphash_flags;
 
+/* Fields of a frame stored in a frozen thread, see frozen.h. The strings
+ * are owned by the frame. */
+struct frame_frozen_fields
+{
+    const char *function;
+    /* The library, module or class the function belongs to. */
+    const char *library;
+    /* The source file. */
+    const char *file;
+    uint64_t address;
+    /* Fields sr_frame_cmp_distance() uses for the frames without
+     * a symbol key, see frame_symbol_key(). */
+    const char *build_id;
+    uint64_t build_id_offset;
+    const char *fingerprint;
+};
+
 typedef void (*append_to_str_fn_t)(struct sr_frame *, GString *);
 typedef struct sr_frame* (*next_frame_fn_t)(struct sr_frame *);
 typedef void (*set_next_frame_fn_t)(struct sr_frame *, struct sr_frame *);
@@ -34,6 +52,10 @@ typedef void (*frame_append_bthash_text_fn_t)(struct sr_frame*, enum sr_bthash_f
 typedef void (*frame_append_duphash_text_fn_t)(struct sr_frame*, enum sr_duphash_flags,
                                                GString*);
 typedef void (*frame_free_fn_t)(struct sr_frame*);
+typedef enum frame_symbol_kind (*frame_symbol_key_fn_t)(struct sr_frame*, GString*,
+                                                        const char**);
+typedef void (*frame_frozen_fields_fn_t)(struct sr_frame*,
+                                         struct frame_frozen_fields*);
 
 struct frame_methods
 {
@@ -45,6 +67,8 @@ struct frame_methods
     frame_append_bthash_text_fn_t frame_append_bthash_text;
     frame_append_duphash_text_fn_t frame_append_duphash_text;
     frame_free_fn_t frame_free;
+    frame_symbol_key_fn_t symbol_key;
+    frame_frozen_fields_fn_t frozen_fields;
 };
 
 extern struct frame_methods core_frame_methods, python_frame_methods,
@@ -59,4 +83,15 @@ void
 frame_append_duphash_text(struct sr_frame *frame, enum sr_duphash_flags flags,
                           GString *strbuf);
 
+/* Appends the fields that sr_frame_cmp_distance() looks at to key, see
+ * symbols.h. If the comparison treats a missing field as matching any
+ * value, that field is returned in qualifier instead. */
+enum frame_symbol_kind
+frame_symbol_key(struct sr_frame *frame, GString *key, const char **qualifier);
+
+/* Fills the fields of the frame which are stored in frozen threads, the
+ * fields the frame does not have are set to NULL or zero. */
+void
+frame_frozen_fields(struct sr_frame *frame, struct frame_frozen_fields *fields);
+
 #endif
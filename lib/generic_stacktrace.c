@@ -132,6 +132,29 @@ sr_stacktrace_from_json_text(enum sr_report_type type, const char *input, char *
     return stacktrace;
 }
 
+struct sr_stacktrace *
+sr_stacktrace_parse_arena(struct sr_arena *arena, enum sr_report_type type,
+                          const char *input, char **error_message)
+{
+    struct sr_arena *previous = arena_set_current(arena);
+    struct sr_stacktrace *stacktrace =
+        sr_stacktrace_parse(type, input, error_message);
+    arena_set_current(previous);
+    return stacktrace;
+}
+
+struct sr_stacktrace *
+sr_stacktrace_from_json_text_arena(struct sr_arena *arena,
+                                   enum sr_report_type type,
+                                   const char *input, char **error_message)
+{
+    struct sr_arena *previous = arena_set_current(arena);
+    struct sr_stacktrace *stacktrace =
+        sr_stacktrace_from_json_text(type, input, error_message);
+    arena_set_current(previous);
+    return stacktrace;
+}
+
 char *
 sr_stacktrace_to_short_text(struct sr_stacktrace *stacktrace, int max_frames)
 {
@@ -183,6 +206,13 @@ sr_stacktrace_get_bthash(struct sr_stacktrace *stacktrace, enum sr_bthash_flags
 {
     char *ret;
     GString *strbuf = g_string_new(NULL);
+    struct text_hash hash_state, *hash = NULL;
+
+    if (!(flags & SR_BTHASH_NOHASH))
+    {
+        text_hash_init(&hash_state, flags & SR_BTHASH_FAST);
+        hash = &hash_state;
+    }
 
     /* Append data contained in the stacktrace structure. */
     DISPATCH(dtable, stacktrace->type, stacktrace_append_bthash_text)
@@ -200,6 +230,7 @@ sr_stacktrace_get_bthash(struct sr_stacktrace *stacktrace, enum sr_bthash_flags
              frame = sr_frame_next(frame))
         {
             frame_append_bthash_text(frame, flags, strbuf);
+            text_hash_flush(hash, strbuf);
         }
 
         /* Blank line in between threads. */
@@ -211,8 +242,8 @@ sr_stacktrace_get_bthash(struct sr_stacktrace *stacktrace, enum sr_bthash_flags
         ret = g_string_free(strbuf, FALSE);
     else
     {
-        ret = g_compute_checksum_for_string(G_CHECKSUM_SHA1, strbuf->str,
-                                            strlen(strbuf->str));
+        text_hash_flush(hash, strbuf);
+        ret = text_hash_finish(hash);
         g_string_free(strbuf, TRUE);
     }
 
@@ -223,12 +223,25 @@ sr_thread_get_duphash(struct sr_thread *thread, int nframes, char *prefix,
 {
     char *ret;
     GString *strbuf = g_string_new(NULL);
+    struct text_hash hash_state, *hash = NULL;
+    size_t length = 0;
 
-    /* Normalization is destructive, we need to make a copy. */
-    thread = sr_thread_dup(thread);
+    if (!(flags & SR_DUPHASH_NOHASH))
+    {
+        text_hash_init(&hash_state, flags & SR_DUPHASH_FAST);
+        hash = &hash_state;
+    }
 
-    if (!(flags & SR_DUPHASH_NONORMALIZE))
-        sr_thread_normalize(thread);
+    /* Normalization is destructive, the frames of the normalized thread
+     * are found without modifying the thread instead. */
+    struct normalized_thread normalized;
+    if (flags & SR_DUPHASH_NONORMALIZE)
+    {
+        normalized_thread_init(&normalized, NULL);
+        thread_no_normalized_frames(thread, &normalized);
+    }
+    else
+        normalized_thread_init(&normalized, thread);
 
     /* User supplied hash text prefix. */
     if (prefix)
@@ -245,38 +258,221 @@ sr_thread_get_duphash(struct sr_thread *thread, int nframes, char *prefix,
     if (!(flags & SR_DUPHASH_KOOPS_COMPAT))
         g_string_append(strbuf, "Thread\n");
 
+    length += strbuf->len;
+    text_hash_flush(hash, strbuf);
+
     /* Number of nframes, (almost) not limited if nframes = 0. */
     if (nframes == 0)
         nframes = INT_MAX;
 
-    for (struct sr_frame *frame = sr_thread_frames(thread);
-         frame && nframes > 0;
-         frame = sr_frame_next(frame))
+    for (unsigned i = 0; i < normalized.frames->len && nframes > 0; i++)
     {
         size_t prev_len = strbuf->len;
 
-        frame_append_duphash_text(frame, flags, strbuf);
+        frame_append_duphash_text(normalized.frames->pdata[i], flags, strbuf);
 
         /* Don't count the frame if nothing was appended. */
         if (strbuf->len > prev_len)
             nframes--;
+
+        length += strbuf->len - prev_len;
+        text_hash_flush(hash, strbuf);
     }
 
-    if ((flags & SR_DUPHASH_KOOPS_COMPAT) && strbuf->len == 0)
+    normalized_thread_destroy(&normalized);
+
+    if (hash)
     {
+        ret = text_hash_finish(hash);
         g_string_free(strbuf, TRUE);
-        ret = NULL;
     }
-    else if (flags & SR_DUPHASH_NOHASH)
-        ret = g_string_free(strbuf, FALSE);
     else
+        ret = g_string_free(strbuf, FALSE);
+
+    if ((flags & SR_DUPHASH_KOOPS_COMPAT) && length == 0)
     {
-        ret = g_compute_checksum_for_string(G_CHECKSUM_SHA1, strbuf->str,
-                                            strlen(strbuf->str));
-        g_string_free(strbuf, TRUE);
+        g_free(ret);
+        ret = NULL;
     }
 
-    sr_thread_free(thread);
-
     return ret;
 }
+
+/* Number of threads a worker of sr_threads_get_duphash_batch_parallel
+ * takes at once. */
+#define DUPHASH_BATCH_CHUNK 256
+
+struct duphash_batch_context
+{
+    struct sr_thread **threads;
+    int n;
+    int frames;
+    char *prefix;
+    enum sr_duphash_flags flags;
+    char **out;
+    /* Index of the first thread no worker has taken yet. */
+    gint next;
+};
+
+static gpointer
+duphash_batch_worker_run(gpointer data)
+{
+    struct duphash_batch_context *context = data;
+    int begin;
+
+    while ((begin = g_atomic_int_add(&context->next, DUPHASH_BATCH_CHUNK))
+           < context->n)
+    {
+        int end = MIN(begin + DUPHASH_BATCH_CHUNK, context->n);
+
+        for (int i = begin; i < end; i++)
+        {
+            context->out[i] = sr_thread_get_duphash(context->threads[i],
+                                                    context->frames,
+                                                    context->prefix,
+                                                    context->flags);
+        }
+    }
+
+    return NULL;
+}
+
+void
+sr_threads_get_duphash_batch(struct sr_thread **threads, int n, int frames,
+                             char *prefix, enum sr_duphash_flags flags,
+                             char **out)
+{
+    sr_threads_get_duphash_batch_parallel(threads, n, frames, prefix, flags,
+                                          out, 0);
+}
+
+void
+sr_threads_get_duphash_batch_parallel(struct sr_thread **threads, int n,
+                                      int frames, char *prefix,
+                                      enum sr_duphash_flags flags,
+                                      char **out, unsigned nthreads)
+{
+    if (n <= 0)
+        return;
+
+    if (nthreads == 0)
+        nthreads = g_get_num_processors();
+
+    unsigned nchunks = (n + DUPHASH_BATCH_CHUNK - 1) / DUPHASH_BATCH_CHUNK;
+    if (nthreads > nchunks)
+        nthreads = nchunks;
+
+    struct duphash_batch_context context =
+    {
+        .threads = threads,
+        .n = n,
+        .frames = frames,
+        .prefix = prefix,
+        .flags = flags,
+        .out = out,
+        .next = 0,
+    };
+
+    /* The calling thread works as the first worker. */
+    GThread **handles = g_malloc_n(nthreads, sizeof(*handles));
+    for (unsigned w = 1; w < nthreads; w++)
+        handles[w] = g_thread_new("sr_threads_get_duphash",
+                                  duphash_batch_worker_run, &context);
+
+    duphash_batch_worker_run(&context);
+
+    for (unsigned w = 1; w < nthreads; w++)
+        g_thread_join(handles[w]);
+
+    g_free(handles);
+}
+
+void
+thread_no_normalized_frames(struct sr_thread *thread,
+                            struct normalized_thread *normalized)
+{
+    for (struct sr_frame *frame = sr_thread_frames(thread);
+         frame;
+         frame = sr_frame_next(frame))
+    {
+        normalized_thread_add(normalized, frame, frame);
+    }
+}
+
+void
+normalized_thread_init(struct normalized_thread *normalized,
+                       struct sr_thread *thread)
+{
+    normalized->frames = g_ptr_array_new();
+    normalized->originals = g_ptr_array_new();
+    normalized->allocated = g_ptr_array_new_with_free_func(g_free);
+
+    if (thread)
+        DISPATCH(dtable, thread->type, normalized_frames)(thread, normalized);
+}
+
+void
+normalized_thread_destroy(struct normalized_thread *normalized)
+{
+    g_ptr_array_free(normalized->frames, TRUE);
+    g_ptr_array_free(normalized->originals, TRUE);
+    g_ptr_array_free(normalized->allocated, TRUE);
+}
+
+void
+normalized_thread_add(struct normalized_thread *normalized,
+                      struct sr_frame *original, struct sr_frame *frame)
+{
+    g_ptr_array_add(normalized->frames, frame);
+    g_ptr_array_add(normalized->originals, original);
+}
+
+void
+normalized_thread_apply(struct normalized_thread *normalized,
+                        struct sr_thread *thread,
+                        size_t function_name_offset)
+{
+    struct sr_frame *frame = sr_thread_frames(thread), *last = NULL;
+    unsigned index = 0;
+
+    sr_thread_set_frames(thread, NULL);
+
+    while (frame)
+    {
+        struct sr_frame *next = sr_frame_next(frame);
+
+        if (index < normalized->originals->len &&
+            normalized->originals->pdata[index] == frame)
+        {
+            struct sr_frame *copy = normalized->frames->pdata[index++];
+            if (copy != frame)
+            {
+                /* The function name may be interned and shared with other
+                 * frames, so it is replaced instead of being modified. */
+                char **function_name =
+                    (char **)((char *)frame + function_name_offset);
+                const char *copy_function_name =
+                    *(char **)((char *)copy + function_name_offset);
+                char *new_function_name =
+                    intern_take(g_strdup(copy_function_name));
+
+                sr_intern_free(*function_name);
+                *function_name = new_function_name;
+            }
+
+            if (last)
+                sr_frame_set_next(last, frame);
+            else
+                sr_thread_set_frames(thread, frame);
+
+            last = frame;
+        }
+        else
+            sr_frame_free(frame);
+
+        frame = next;
+    }
+
+    if (last)
+        sr_frame_set_next(last, NULL);
+}
@@ -25,6 +25,21 @@
 
 enum sr_bthash_flags;
 
+/* The frames a thread has after sr_thread_normalize(), found without
+ * modifying the thread, so that the thread does not need to be copied. */
+struct normalized_thread
+{
+    /* The frames of the normalized thread.  The frames renamed by the
+     * normalization are shallow copies of the frames of the thread with
+     * the new function name. */
+    GPtrArray *frames;
+    /* The frames of the thread the frames above correspond to. */
+    GPtrArray *originals;
+    /* The copies and the function names made for them, released with the
+     * structure. */
+    GPtrArray *allocated;
+};
+
 typedef struct sr_frame* (*frames_fn_t)(struct sr_thread*);
 typedef void (*set_frames_fn_t)(struct sr_thread*, struct sr_frame*);
 typedef int (*thread_cmp_fn_t)(struct sr_thread*, struct sr_thread*);
@@ -35,6 +50,8 @@ typedef void (*thread_append_bthash_text_fn_t)(struct sr_thread*, enum sr_bthash
                                                GString*);
 typedef void (*thread_free_fn_t)(struct sr_thread*);
 typedef void (*normalize_fn_t)(struct sr_thread*);
+typedef void (*normalized_frames_fn_t)(struct sr_thread*,
+                                       struct normalized_thread*);
 typedef bool (*remove_frame_fn_t)(struct sr_thread*, struct sr_frame*);
 typedef bool (*remove_frames_above_fn_t)(struct sr_thread*, struct sr_frame*);
 typedef struct sr_thread* (*thread_dup_fn_t)(struct sr_thread*);
@@ -50,6 +67,7 @@ struct thread_methods
     thread_append_bthash_text_fn_t thread_append_bthash_text;
     thread_free_fn_t thread_free;
     normalize_fn_t normalize;
+    normalized_frames_fn_t normalized_frames;
     remove_frame_fn_t remove_frame;
     remove_frames_above_fn_t remove_frames_above;
     thread_dup_fn_t thread_dup;
@@ -93,6 +111,33 @@ thread_no_bthash_text(struct sr_thread *thread, enum sr_bthash_flags flags,
 void
 thread_no_normalization(struct sr_thread *thread);
 
+/* Adds all the frames of the thread as they are. */
+void
+thread_no_normalized_frames(struct sr_thread *thread,
+                            struct normalized_thread *normalized);
+
+/* Fills the structure with the frames of the normalized thread. */
+void
+normalized_thread_init(struct normalized_thread *normalized,
+                       struct sr_thread *thread);
+
+void
+normalized_thread_destroy(struct normalized_thread *normalized);
+
+/* Appends a frame of the normalized thread, which is either the original
+ * frame or its copy. */
+void
+normalized_thread_add(struct normalized_thread *normalized,
+                      struct sr_frame *original, struct sr_frame *frame);
+
+/* Removes the frames and frees the ones that are not in the normalized
+ * thread, and renames the frames that have been copied.  The offset is
+ * the offset of the function name in the frame structure. */
+void
+normalized_thread_apply(struct normalized_thread *normalized,
+                        struct sr_thread *thread,
+                        size_t function_name_offset);
+
 /* Uses dispatch table but not intended for public use. */
 void
 thread_append_bthash_text(struct sr_thread *thread, enum sr_bthash_flags flags,
@@ -0,0 +1,163 @@
+/*
+    intern.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "utils.h"
+#include "internal_utils.h"
+#include <string.h>
+
+/* An interned string, the frames point to str. */
+struct intern_entry
+{
+    unsigned refcount;
+    char str[];
+};
+
+static GMutex intern_mutex;
+/* Maps the strings to their entries, the keys are the str members. */
+static GHashTable *intern_table;
+/* Number of nested sr_intern_pool_enable() calls. */
+static gint intern_enabled;
+/* Number of the entries in the table, it can be read without the lock
+ * to find out that a string cannot be interned. */
+static gint intern_count;
+
+void
+sr_intern_pool_enable(void)
+{
+    g_atomic_int_inc(&intern_enabled);
+}
+
+void
+sr_intern_pool_disable(void)
+{
+    assert(g_atomic_int_get(&intern_enabled) > 0);
+    g_atomic_int_add(&intern_enabled, -1);
+}
+
+unsigned
+sr_intern_pool_size(void)
+{
+    return g_atomic_int_get(&intern_count);
+}
+
+/* Returns the entry of the string if it is an interned string, NULL
+ * otherwise.  Must be called with the lock held. */
+static struct intern_entry *
+intern_lookup(const char *str)
+{
+    if (!intern_table)
+        return NULL;
+
+    return g_hash_table_lookup(intern_table, str);
+}
+
+char *
+sr_intern_strdup(const char *str)
+{
+    if (!str)
+        return NULL;
+
+    /* The strings of the frames parsed into an arena are released with
+     * the arena, which would leave their references in the pool. */
+    if (arena_get_current())
+        return arena_strdup(str);
+
+    bool enabled = g_atomic_int_get(&intern_enabled) > 0;
+    if (!enabled && g_atomic_int_get(&intern_count) == 0)
+        return g_strdup(str);
+
+    g_mutex_lock(&intern_mutex);
+
+    struct intern_entry *entry = intern_lookup(str);
+    /* Copies of interned strings stay interned even when the pool is
+     * disabled, so that the frame duplicates share the strings too. */
+    if (entry && (enabled || entry->str == str))
+    {
+        ++entry->refcount;
+        g_mutex_unlock(&intern_mutex);
+        return entry->str;
+    }
+
+    if (!enabled)
+    {
+        g_mutex_unlock(&intern_mutex);
+        return g_strdup(str);
+    }
+
+    if (!intern_table)
+        intern_table = g_hash_table_new(g_str_hash, g_str_equal);
+
+    size_t length = strlen(str);
+    entry = g_malloc(sizeof(*entry) + length + 1);
+    entry->refcount = 1;
+    memcpy(entry->str, str, length + 1);
+    g_hash_table_insert(intern_table, entry->str, entry);
+    g_atomic_int_inc(&intern_count);
+
+    g_mutex_unlock(&intern_mutex);
+    return entry->str;
+}
+
+void
+sr_intern_free(char *str)
+{
+    if (!str)
+        return;
+
+    if (g_atomic_int_get(&intern_count) == 0)
+    {
+        arena_free(str);
+        return;
+    }
+
+    g_mutex_lock(&intern_mutex);
+
+    struct intern_entry *entry = intern_lookup(str);
+    if (!entry || entry->str != str)
+    {
+        g_mutex_unlock(&intern_mutex);
+        arena_free(str);
+        return;
+    }
+
+    if (--entry->refcount == 0)
+    {
+        g_hash_table_remove(intern_table, entry->str);
+        g_atomic_int_add(&intern_count, -1);
+        g_free(entry);
+    }
+
+    g_mutex_unlock(&intern_mutex);
+}
+
+char *
+intern_take(char *str)
+{
+    if (!str || g_atomic_int_get(&intern_enabled) == 0 ||
+        arena_get_current())
+    {
+        return str;
+    }
+
+    char *result = sr_intern_strdup(str);
+    if (result != str)
+        arena_free(str);
+
+    return result;
+}
@@ -62,6 +62,12 @@ _set_error(char **error_msg, const char *fmt, ...) __sr_printf(2, 3);
  */
 #define CORE_STACKTRACE_FRAME_LIMIT 256
 
+/* The limit for the number of frames unwound while a thread is stopped for
+ * sr_core_stacktrace_symbolize(), which removes the frames below
+ * __libc_start_main and the ones over CORE_STACKTRACE_FRAME_LIMIT later.
+ */
+#define CORE_STACKTRACE_DEFERRED_FRAME_LIMIT (4 * CORE_STACKTRACE_FRAME_LIMIT)
+
 struct exe_mapping_data
 {
     uint64_t start;
@@ -69,6 +75,8 @@ struct exe_mapping_data
     struct exe_mapping_data *next;
 };
 
+struct symbol_cache;
+
 struct core_handle
 {
     int fd;
@@ -76,6 +84,7 @@ struct core_handle
     Dwfl *dwfl;
     Dwfl_Callbacks cb;
     struct exe_mapping_data *segments;
+    struct symbol_cache *symbols;
 };
 
 /* Gets dwfl handle and executable map data to be used for unwinding. The
@@ -86,8 +95,29 @@ open_coredump(const char *elf_file, const char *exe_file, char **error_msg);
 void
 core_handle_free(struct core_handle *ch);
 
+/* Caches the module data and the function names resolve_frame() looks up
+ * for the frames, a cache must be used with one dwfl handle only and it
+ * must be released before the handle. */
+struct symbol_cache *
+symbol_cache_new(void);
+
+void
+symbol_cache_free(struct symbol_cache *cache);
+
+struct sr_core_frame *
+resolve_frame(Dwfl *dwfl, struct symbol_cache *cache, Dwarf_Addr ip,
+              bool minus_one);
+
+/* The two parts of resolve_frame().  The first one finds the module of the
+ * frame and the offset in it, the function name is filled in by the second
+ * one.  It gets the address minus one if minus_one was true. */
 struct sr_core_frame *
-resolve_frame(Dwfl *dwfl, Dwarf_Addr ip, bool minus_one);
+resolve_frame_module(Dwfl *dwfl, struct symbol_cache *cache, Dwarf_Addr ip,
+                     bool minus_one);
+
+void
+resolve_frame_function(Dwfl *dwfl, struct symbol_cache *cache,
+                       struct sr_core_frame *frame, Dwarf_Addr ip_adjusted);
 
 short
 get_signal_number(Elf *e, const char *elf_file);
@@ -67,6 +67,128 @@ struct sr_taint_flag
 };
 extern struct sr_taint_flag sr_flags[];
 
+struct sr_gdb_thread;
+
+/* Unknown GDB frames paired by
+ * sr_normalize_gdb_paired_unknown_function_names() get this prefix
+ * followed by the index of the pair as their function name. */
+#define GDB_PAIRED_UNKNOWN_PREFIX "__unknown_function_"
+
+/* Finds the unknown frames which
+ * sr_normalize_gdb_paired_unknown_function_names() renames, without
+ * modifying the threads. The arrays get an entry for every frame of the
+ * thread: the index of the pair, or -1 for frames which are not renamed.
+ * Returns the number of pairs. */
+int
+normalize_gdb_pair_unknown_frames(struct sr_gdb_thread *thread1,
+                                  struct sr_gdb_thread *thread2,
+                                  int *pairs1,
+                                  int *pairs2);
+
+struct sr_core_thread;
+struct normalized_thread;
+
+/* Find the frames the gdb and core threads have after normalization,
+ * see struct normalized_thread.  The file names of core frames are not
+ * anonymized. */
+void
+normalize_gdb_thread_frames(struct sr_gdb_thread *thread,
+                            struct normalized_thread *normalized);
+
+void
+normalize_core_thread_frames(struct sr_core_thread *thread,
+                             struct normalized_thread *normalized);
+
+/* Interns a string allocated by g_malloc() if the intern pool is
+ * enabled and no arena is current, the string is released in that case.
+ * Otherwise the string is returned as it is.  Either way, the result must be released by
+ * sr_intern_free(). */
+char *
+intern_take(char *str);
+
+/* Compares strings which may be interned, the same interned strings are
+ * recognized without comparing the characters. */
+static inline int
+intern_strcmp0(const char *s1, const char *s2)
+{
+    if (s1 == s2)
+        return 0;
+
+    return g_strcmp0(s1, s2);
+}
+
+/* Incremental hash of the bthash and duphash texts, see text_hash.c. */
+struct text_hash
+{
+    /* SHA-1, NULL for the fast hash. */
+    GChecksum *checksum;
+    /* State of the fast hash. */
+    uint64_t h1, h2;
+    uint64_t length;
+    unsigned char block[16];
+    size_t block_used;
+};
+
+/* The fast hash is a non-cryptographic 128-bit hash, SHA-1 is used
+ * otherwise. */
+void
+text_hash_init(struct text_hash *hash, bool fast);
+
+void
+text_hash_update(struct text_hash *hash, const char *text, size_t length);
+
+/* Returns the hexadecimal digest and releases the state. */
+char *
+text_hash_finish(struct text_hash *hash);
+
+/* Feeds the text in the buffer to the hash and empties the buffer, so
+ * that a hashed text is never built as a whole.  The text is kept if the
+ * hash is NULL. */
+void
+text_hash_flush(struct text_hash *hash, GString *strbuf);
+
+struct sr_arena;
+
+/* Makes the parsers of the calling thread allocate from the arena, NULL
+ * makes them use g_malloc() again.  Returns the previous arena. */
+struct sr_arena *
+arena_set_current(struct sr_arena *arena);
+
+/* Returns the arena the parsers of the calling thread allocate from, NULL
+ * if there is none. */
+struct sr_arena *
+arena_get_current(void);
+
+/* Allocate from the current arena of the thread, or by the g_malloc()
+ * family of functions if there is none.  The parsers use them for
+ * everything they store in the stacktraces, the memory must be released
+ * by arena_free(). */
+void *
+arena_malloc(size_t size);
+
+/* The old size is needed to copy the data when allocating from an arena,
+ * the memory of arenas cannot be resized. */
+void *
+arena_realloc(void *ptr, size_t old_size, size_t size);
+
+char *
+arena_strdup(const char *str);
+
+char *
+arena_strndup(const char *str, size_t length);
+
+char *
+arena_strdup_printf(const char *format, ...) __sr_printf(1, 2);
+
+/* Releases the string and returns its contents. */
+char *
+arena_string_free(GString *string);
+
+/* Releases memory allocated by g_malloc(), the memory of arenas is left
+ * to be released with the arena. */
+void
+arena_free(void *ptr);
+
 /* assert that is never compiled out */
 #define SR_ASSERT(cond)                                                               \
     if (!(cond))                                                                      \
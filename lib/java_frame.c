@@ -41,6 +41,12 @@ java_append_bthash_text(struct sr_java_frame *frame, enum sr_bthash_flags flags,
 static void
 java_append_duphash_text(struct sr_java_frame *frame, enum sr_duphash_flags flags,
                          GString *strbuf);
+static enum frame_symbol_kind
+java_symbol_key(struct sr_java_frame *frame, GString *key,
+                const char **qualifier);
+static void
+java_frozen_fields(struct sr_java_frame *frame,
+                   struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(java_next, struct sr_frame, struct sr_java_frame)
 DEFINE_SET_NEXT_FUNC(java_set_next, struct sr_frame, struct sr_java_frame)
@@ -57,6 +63,8 @@ struct frame_methods java_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) java_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_java_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) java_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) java_frozen_fields,
 };
 
 /* Public functions */
@@ -65,7 +73,7 @@ struct sr_java_frame *
 sr_java_frame_new()
 {
     struct sr_java_frame *frame =
-        g_malloc(sizeof(*frame));
+        arena_malloc(sizeof(*frame));
 
     sr_java_frame_init(frame);
     return frame;
@@ -75,7 +83,7 @@ struct sr_java_frame *
 sr_java_frame_new_exception()
 {
     struct sr_java_frame *frame =
-        g_malloc(sizeof(*frame));
+        arena_malloc(sizeof(*frame));
 
     sr_java_frame_init(frame);
     frame->is_exception = true;
@@ -95,11 +103,11 @@ sr_java_frame_free(struct sr_java_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->file_name);
-    g_free(frame->name);
-    g_free(frame->class_path);
-    g_free(frame->message);
-    g_free(frame);
+    sr_intern_free(frame->file_name);
+    sr_intern_free(frame->name);
+    sr_intern_free(frame->class_path);
+    arena_free(frame->message);
+    arena_free(frame);
 }
 
 void
@@ -139,13 +147,13 @@ sr_java_frame_dup(struct sr_java_frame *frame, bool siblings)
 
     /* Duplicate all strings. */
     if (result->file_name)
-        result->file_name = g_strdup(result->file_name);
+        result->file_name = sr_intern_strdup(result->file_name);
 
     if (result->name)
-        result->name = g_strdup(result->name);
+        result->name = sr_intern_strdup(result->name);
 
     if (result->class_path)
-        result->class_path = g_strdup(result->class_path);
+        result->class_path = sr_intern_strdup(result->class_path);
 
     if (result->message)
         result->message = g_strdup(result->message);
@@ -153,6 +161,16 @@ sr_java_frame_dup(struct sr_java_frame *frame, bool siblings)
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_java_frame *
+java_frame_intern(struct sr_java_frame *frame)
+{
+    frame->file_name = intern_take(frame->file_name);
+    frame->name = intern_take(frame->name);
+    frame->class_path = intern_take(frame->class_path);
+    return frame;
+}
+
 int
 sr_java_frame_cmp(struct sr_java_frame *frame1,
                   struct sr_java_frame *frame2)
@@ -160,7 +178,7 @@ sr_java_frame_cmp(struct sr_java_frame *frame1,
     if (frame1->is_exception != frame2->is_exception)
         return frame1->is_exception ? 1 : -1;
 
-    int res = g_strcmp0(frame1->name, frame2->name);
+    int res = intern_strcmp0(frame1->name, frame2->name);
     if (res != 0)
         return res;
 
@@ -169,11 +187,11 @@ sr_java_frame_cmp(struct sr_java_frame *frame1,
         return 0;
 
     /* Method call comparsion */
-    res = g_strcmp0(frame1->class_path, frame2->class_path);
+    res = intern_strcmp0(frame1->class_path, frame2->class_path);
     if (res != 0)
         return res;
 
-    res = g_strcmp0(frame1->file_name, frame2->file_name);
+    res = intern_strcmp0(frame1->file_name, frame2->file_name);
     if (res != 0)
         return res;
 
@@ -187,7 +205,7 @@ int
 sr_java_frame_cmp_distance(struct sr_java_frame *frame1,
                            struct sr_java_frame *frame2)
 {
-    int res = g_strcmp0(frame1->name, frame2->name);
+    int res = intern_strcmp0(frame1->name, frame2->name);
     if (res != 0)
         return res;
 
@@ -290,7 +308,7 @@ sr_java_frame_parse_exception(const char **input,
     }
 
     struct sr_java_frame *exception = sr_java_frame_new_exception();
-    exception->name = g_strndup(mark, cursor - mark);
+    exception->name = arena_strndup(mark, cursor - mark);
 
     /* : foo */
     if (*cursor == ':')
@@ -307,7 +325,7 @@ sr_java_frame_parse_exception(const char **input,
         sr_location_add(location, 0, sr_skip_char_cspan(&cursor, "\n"));
 
         if (mark != cursor)
-            exception->message = g_strndup(mark, cursor - mark);
+            exception->message = arena_strndup(mark, cursor - mark);
     }
     else
     {
@@ -468,7 +486,7 @@ const char *sr_java_frame_parse_frame_url(struct sr_java_frame *frame, const cha
 
         if (mark != cursor)
         {
-            frame->class_path = g_strndup(mark, cursor - mark);
+            frame->class_path = arena_strndup(mark, cursor - mark);
             frame->class_path = anonymize_path(frame->class_path);
         }
     }
@@ -508,7 +526,7 @@ sr_java_frame_parse(const char **input,
     struct sr_java_frame *frame = sr_java_frame_new();
 
     if (cursor != mark)
-        frame->name = g_strndup(mark, cursor - mark);
+        frame->name = arena_strndup(mark, cursor - mark);
 
     /* (SimpleTest.java:36) [file:/usr/lib/java/foo.class] */
     if (*cursor == '(')
@@ -526,7 +544,7 @@ sr_java_frame_parse(const char **input,
             else if (!sr_java_frame_parse_is_unknown_source(mark))
             {
                 /* DO NOT set file_name if input says that source isn't known */
-                frame->file_name = g_strndup(mark, cursor - mark);
+                frame->file_name = arena_strndup(mark, cursor - mark);
                 frame->file_name = anonymize_path(frame->file_name);
             }
         }
@@ -559,7 +577,7 @@ sr_java_frame_parse(const char **input,
         sr_location_add(location, 0, (cursor - mark) - 1);
     }
 
-    return frame;
+    return java_frame_intern(frame);
 }
 
 char *
@@ -642,7 +660,7 @@ sr_java_frame_from_json(json_object *root, char **error_message)
         return NULL;
     }
 
-    return result;
+    return java_frame_intern(result);
 }
 
 static void
@@ -672,3 +690,20 @@ java_append_duphash_text(struct sr_java_frame *frame, enum sr_duphash_flags flag
                               OR_UNKNOWN(frame->file_name),
                               frame->file_line);
 }
+
+static enum frame_symbol_kind
+java_symbol_key(struct sr_java_frame *frame, GString *key,
+                const char **qualifier)
+{
+    symbol_key_append_str(key, frame->name);
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+java_frozen_fields(struct sr_java_frame *frame,
+                   struct frame_frozen_fields *fields)
+{
+    fields->function = frame->name;
+    fields->library = frame->class_path;
+    fields->file = frame->file_name;
+}
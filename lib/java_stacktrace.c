@@ -65,7 +65,7 @@ struct sr_java_stacktrace *
 sr_java_stacktrace_new()
 {
     struct sr_java_stacktrace *stacktrace =
-        g_malloc(sizeof(*stacktrace));
+        arena_malloc(sizeof(*stacktrace));
 
     sr_java_stacktrace_init(stacktrace);
     return stacktrace;
@@ -91,7 +91,7 @@ sr_java_stacktrace_free(struct sr_java_stacktrace *stacktrace)
         sr_java_thread_free(thread);
     }
 
-    g_free(stacktrace);
+    arena_free(stacktrace);
 }
 
 struct sr_java_stacktrace *
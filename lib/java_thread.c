@@ -58,6 +58,8 @@ struct thread_methods java_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) java_dup,
     .normalize = (normalize_fn_t) thread_no_normalization,
+    .normalized_frames =
+        (normalized_frames_fn_t) thread_no_normalized_frames,
 };
 
 /* Public functions */
@@ -66,7 +68,7 @@ struct sr_java_thread *
 sr_java_thread_new()
 {
     struct sr_java_thread *thread =
-        g_malloc(sizeof(*thread));
+        arena_malloc(sizeof(*thread));
     sr_java_thread_init(thread);
     return thread;
 }
@@ -88,8 +90,8 @@ sr_java_thread_free(struct sr_java_thread *thread)
 
     sr_java_frame_free_full(thread->frames);
 
-    g_free(thread->name);
-    g_free(thread);
+    arena_free(thread->name);
+    arena_free(thread);
 }
 
 struct sr_java_thread *
@@ -325,7 +327,7 @@ sr_java_thread_parse(const char **input,
             return NULL;
         }
 
-        thread->name = g_strndup(mark, cursor - mark);
+        thread->name = arena_strndup(mark, cursor - mark);
 
         sr_location_eat_char(location, *(++cursor));
     }
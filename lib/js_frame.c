@@ -37,6 +37,12 @@ js_append_bthash_text(struct sr_js_frame *frame, enum sr_bthash_flags flags,
 static void
 js_append_duphash_text(struct sr_js_frame *frame, enum sr_duphash_flags flags,
                        GString *strbuf);
+static enum frame_symbol_kind
+js_symbol_key(struct sr_js_frame *frame, GString *key,
+              const char **qualifier);
+static void
+js_frozen_fields(struct sr_js_frame *frame,
+                 struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(js_next, struct sr_frame, struct sr_js_frame)
 DEFINE_SET_NEXT_FUNC(js_set_next, struct sr_frame, struct sr_js_frame)
@@ -53,6 +59,8 @@ struct frame_methods js_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) js_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_js_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) js_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) js_frozen_fields,
 };
 
 struct sr_js_frame *(*js_frame_parsers[])(const char **input, struct sr_location *location) = 
@@ -66,7 +74,7 @@ struct sr_js_frame *
 sr_js_frame_new()
 {
     struct sr_js_frame *frame =
-        g_malloc(sizeof(*frame));
+        arena_malloc(sizeof(*frame));
 
     sr_js_frame_init(frame);
     return frame;
@@ -85,9 +93,9 @@ sr_js_frame_free(struct sr_js_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->file_name);
-    g_free(frame->function_name);
-    g_free(frame);
+    sr_intern_free(frame->file_name);
+    sr_intern_free(frame->function_name);
+    arena_free(frame);
 }
 
 struct sr_js_frame *
@@ -107,27 +115,36 @@ sr_js_frame_dup(struct sr_js_frame *frame, bool siblings)
 
     /* Duplicate all strings. */
     if (result->file_name)
-        result->file_name = g_strdup(result->file_name);
+        result->file_name = sr_intern_strdup(result->file_name);
 
     if (result->function_name)
-        result->function_name = g_strdup(result->function_name);
+        result->function_name = sr_intern_strdup(result->function_name);
 
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_js_frame *
+js_frame_intern(struct sr_js_frame *frame)
+{
+    frame->file_name = intern_take(frame->file_name);
+    frame->function_name = intern_take(frame->function_name);
+    return frame;
+}
+
 int
 sr_js_frame_cmp(struct sr_js_frame *frame1,
                 struct sr_js_frame *frame2)
 {
     /* function_name */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* file_name */
-    int file_name = g_strcmp0(frame1->file_name,
-                               frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                    frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -154,14 +171,14 @@ sr_js_frame_cmp_distance(struct sr_js_frame *frame1,
         return file_line;
 
     /* function_name */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* file_name */
-    int file_name = g_strcmp0(frame1->file_name,
-                               frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                    frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -245,7 +262,7 @@ sr_js_frame_parse_v8(const char **input,
         /* Object.<anonymous> ([stdin]-wrapper:6:22)
          * ^^^^^^^^^^^^^^^^^^
          */
-        frame->function_name = g_strndup(name_beg, columns);
+        frame->function_name = arena_strndup(name_beg, columns);
 
         sr_location_add(location, 0, columns);
 
@@ -342,7 +359,7 @@ sr_js_frame_parse_v8(const char **input,
     /* bootstrap_node.js:357:29
      * ^^^^^^^^^^^^^^^^^
      */
-    frame->file_name = g_strndup(local_input, token - local_input);
+    frame->file_name = arena_strndup(local_input, token - local_input);
     frame->file_name = anonymize_path(frame->file_name);
 
     location->column += sr_skip_char_cspan(&local_input, "\n");
@@ -363,7 +380,7 @@ sr_js_frame_parse(const char **input,
     {
         struct sr_js_frame *frame = js_frame_parsers[i](input, location);
         if (frame)
-            return frame;
+            return js_frame_intern(frame);
     }
 
     location->message = "The frame does not match any JavaScript dialect";
@@ -389,7 +406,7 @@ sr_js_frame_from_json(json_object *root, char **error_message)
 
         string = json_object_get_string(val);
 
-        result->file_name = g_strdup(string);
+        result->file_name = arena_strdup(string);
     }
 
     /* Function name. */
@@ -402,7 +419,7 @@ sr_js_frame_from_json(json_object *root, char **error_message)
 
         string = json_object_get_string(val);
 
-        result->function_name = g_strdup(string);
+        result->function_name = arena_strdup(string);
     }
 
     bool success =
@@ -412,7 +429,7 @@ sr_js_frame_from_json(json_object *root, char **error_message)
     if (!success)
         goto fail;
 
-    return result;
+    return js_frame_intern(result);
 
 fail:
     sr_js_frame_free(result);
@@ -498,3 +515,21 @@ js_append_duphash_text(struct sr_js_frame *frame, enum sr_duphash_flags flags,
                           OR_UNKNOWN(frame->file_name),
                           frame->file_line);
 }
+
+static enum frame_symbol_kind
+js_symbol_key(struct sr_js_frame *frame, GString *key,
+              const char **qualifier)
+{
+    symbol_key_append_int(key, frame->file_line);
+    symbol_key_append_str(key, frame->function_name);
+    symbol_key_append_str(key, frame->file_name);
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+js_frozen_fields(struct sr_js_frame *frame,
+                 struct frame_frozen_fields *fields)
+{
+    fields->function = frame->function_name;
+    fields->file = frame->file_name;
+}
@@ -58,6 +58,8 @@ struct thread_methods js_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) sr_js_stacktrace_dup,
     .normalize = (normalize_fn_t) thread_no_normalization,
+    .normalized_frames =
+        (normalized_frames_fn_t) thread_no_normalized_frames,
 };
 
 struct stacktrace_methods js_stacktrace_methods =
@@ -82,7 +84,7 @@ struct sr_js_stacktrace *
 sr_js_stacktrace_new()
 {
     struct sr_js_stacktrace *stacktrace =
-        g_malloc(sizeof(*stacktrace));
+        arena_malloc(sizeof(*stacktrace));
 
     sr_js_stacktrace_init(stacktrace);
     return stacktrace;
@@ -108,8 +110,8 @@ sr_js_stacktrace_free(struct sr_js_stacktrace *stacktrace)
         sr_js_frame_free(frame);
     }
 
-    g_free(stacktrace->exception_name);
-    g_free(stacktrace);
+    arena_free(stacktrace->exception_name);
+    arena_free(stacktrace);
 }
 
 struct sr_js_stacktrace *
@@ -37,6 +37,12 @@ koops_append_bthash_text(struct sr_koops_frame *frame, enum sr_bthash_flags flag
 static void
 koops_append_duphash_text(struct sr_koops_frame *frame, enum sr_duphash_flags flags,
                           GString *strbuf);
+static enum frame_symbol_kind
+koops_symbol_key(struct sr_koops_frame *frame, GString *key,
+                 const char **qualifier);
+static void
+koops_frozen_fields(struct sr_koops_frame *frame,
+                    struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(koops_next, struct sr_frame, struct sr_koops_frame)
 DEFINE_SET_NEXT_FUNC(koops_set_next, struct sr_frame, struct sr_koops_frame)
@@ -53,6 +59,8 @@ struct frame_methods koops_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) koops_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_koops_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) koops_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) koops_frozen_fields,
 };
 
 /* Public functions */
@@ -61,7 +69,7 @@ struct sr_koops_frame *
 sr_koops_frame_new()
 {
     struct sr_koops_frame *frame =
-        g_malloc(sizeof(*frame));
+        arena_malloc(sizeof(*frame));
 
     sr_koops_frame_init(frame);
     return frame;
@@ -80,12 +88,12 @@ sr_koops_frame_free(struct sr_koops_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->function_name);
-    g_free(frame->module_name);
-    g_free(frame->from_function_name);
-    g_free(frame->from_module_name);
-    g_free(frame->special_stack);
-    g_free(frame);
+    sr_intern_free(frame->function_name);
+    sr_intern_free(frame->module_name);
+    sr_intern_free(frame->from_function_name);
+    sr_intern_free(frame->from_module_name);
+    arena_free(frame->special_stack);
+    arena_free(frame);
 }
 
 struct sr_koops_frame *
@@ -105,16 +113,16 @@ sr_koops_frame_dup(struct sr_koops_frame *frame, bool siblings)
 
     /* Duplicate all strings. */
     if (result->function_name)
-        result->function_name = g_strdup(result->function_name);
+        result->function_name = sr_intern_strdup(result->function_name);
 
     if (result->module_name)
-        result->module_name = g_strdup(result->module_name);
+        result->module_name = sr_intern_strdup(result->module_name);
 
     if (result->from_function_name)
-        result->from_function_name = g_strdup(result->from_function_name);
+        result->from_function_name = sr_intern_strdup(result->from_function_name);
 
     if (result->from_module_name)
-        result->from_module_name = g_strdup(result->from_module_name);
+        result->from_module_name = sr_intern_strdup(result->from_module_name);
 
     if (result->special_stack)
         result->special_stack = g_strdup(result->special_stack);
@@ -122,6 +130,17 @@ sr_koops_frame_dup(struct sr_koops_frame *frame, bool siblings)
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_koops_frame *
+koops_frame_intern(struct sr_koops_frame *frame)
+{
+    frame->function_name = intern_take(frame->function_name);
+    frame->module_name = intern_take(frame->module_name);
+    frame->from_function_name = intern_take(frame->from_function_name);
+    frame->from_module_name = intern_take(frame->from_module_name);
+    return frame;
+}
+
 int
 sr_koops_frame_cmp(struct sr_koops_frame *frame1,
                    struct sr_koops_frame *frame2)
@@ -137,8 +156,8 @@ sr_koops_frame_cmp(struct sr_koops_frame *frame1,
         return reliable;
 
     /* Function name. */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
 
     if (function_name != 0)
         return function_name;
@@ -154,8 +173,8 @@ sr_koops_frame_cmp(struct sr_koops_frame *frame1,
         return function_length;
 
     /* Module name. */
-    int module_name = g_strcmp0(frame1->module_name,
-                                 frame2->module_name);
+    int module_name = intern_strcmp0(frame1->module_name,
+                                      frame2->module_name);
 
     if (module_name != 0)
         return module_name;
@@ -166,8 +185,8 @@ sr_koops_frame_cmp(struct sr_koops_frame *frame1,
         return from_address;
 
     /* From function name. */
-    int from_function_name = g_strcmp0(frame1->from_function_name,
-                                        frame2->from_function_name);
+    int from_function_name = intern_strcmp0(frame1->from_function_name,
+                                             frame2->from_function_name);
 
     if (from_function_name != 0)
         return from_function_name;
@@ -183,8 +202,8 @@ sr_koops_frame_cmp(struct sr_koops_frame *frame1,
         return from_function_length;
 
     /* From module name. */
-    int from_module_name = g_strcmp0(frame1->from_module_name,
-                                      frame2->from_module_name);
+    int from_module_name = intern_strcmp0(frame1->from_module_name,
+                                           frame2->from_module_name);
 
     if (from_module_name != 0)
         return from_module_name;
@@ -204,8 +223,8 @@ sr_koops_frame_cmp_distance(struct sr_koops_frame *frame1,
                             struct sr_koops_frame *frame2)
 {
     /* Function. */
-    int function_name = g_strcmp0(frame1->function_name,
-                                    frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                         frame2->function_name);
     if (function_name != 0)
         return function_name;
 
@@ -344,11 +363,11 @@ sr_koops_frame_parse(const char **input)
 {
     struct sr_koops_frame *ppc_frame = koops_frame_parse_ppc(input);
     if (ppc_frame)
-        return ppc_frame;
+        return koops_frame_intern(ppc_frame);
 
     struct sr_koops_frame *arm_frame = koops_frame_parse_arm_reduced(input);
     if (arm_frame)
-        return arm_frame;
+        return koops_frame_intern(arm_frame);
 
     const char *local_input = *input;
     sr_skip_char_span(&local_input, " \t");
@@ -436,7 +455,7 @@ done:
     }
 
     *input = local_input;
-    return frame;
+    return koops_frame_intern(frame);
 }
 
 
@@ -508,7 +527,7 @@ sr_koops_parse_module_name(const char **input,
 
     if (!sr_skip_char(&local_input, ']'))
     {
-        g_free(*module_name);
+        arena_free(*module_name);
         *module_name = NULL;
         return false;
     }
@@ -553,7 +572,7 @@ sr_koops_parse_function(const char **input,
 
         if (!sr_skip_char(&local_input, '/'))
         {
-            g_free(*function_name);
+            arena_free(*function_name);
             *function_name = NULL;
             return false;
         }
@@ -574,11 +593,11 @@ sr_koops_parse_function(const char **input,
 
     if (parenthesis && !sr_skip_char(&local_input, ')'))
     {
-        g_free(*function_name);
+        arena_free(*function_name);
         *function_name = NULL;
         if (has_module)
         {
-            g_free(*module_name);
+            arena_free(*module_name);
             *module_name = NULL;
         }
 
@@ -696,7 +715,7 @@ sr_koops_frame_from_json(json_object *root, char **error_message)
         return NULL;
     }
 
-    return result;
+    return koops_frame_intern(result);
 }
 
 void
@@ -747,3 +766,20 @@ koops_append_duphash_text(struct sr_koops_frame *frame, enum sr_duphash_flags fl
     else
         g_string_append_printf(strbuf, "0x%"PRIx64"\n", frame->address);
 }
+
+static enum frame_symbol_kind
+koops_symbol_key(struct sr_koops_frame *frame, GString *key,
+                 const char **qualifier)
+{
+    symbol_key_append_str(key, frame->function_name);
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+koops_frozen_fields(struct sr_koops_frame *frame,
+                    struct frame_frozen_fields *fields)
+{
+    fields->function = frame->function_name;
+    fields->library = frame->module_name;
+    fields->address = frame->address;
+}
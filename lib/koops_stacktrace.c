@@ -61,6 +61,9 @@ struct sr_taint_flag sr_flags[] = {
 static void
 koops_append_bthash_text(struct sr_koops_stacktrace *stacktrace,
                          enum sr_bthash_flags flags, GString *strbuf);
+static void
+koops_normalized_frames(struct sr_koops_stacktrace *stacktrace,
+                        struct normalized_thread *normalized);
 
 DEFINE_FRAMES_FUNC(koops_frames, struct sr_koops_stacktrace)
 DEFINE_SET_FRAMES_FUNC(koops_set_frames, struct sr_koops_stacktrace)
@@ -81,6 +84,8 @@ struct thread_methods koops_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) sr_koops_stacktrace_dup,
     .normalize = (normalize_fn_t) sr_normalize_koops_stacktrace,
+    .normalized_frames =
+        (normalized_frames_fn_t) koops_normalized_frames,
 };
 
 struct stacktrace_methods koops_stacktrace_methods =
@@ -105,7 +110,7 @@ struct sr_koops_stacktrace *
 sr_koops_stacktrace_new()
 {
     struct sr_koops_stacktrace *stacktrace =
-        g_malloc(sizeof(*stacktrace));
+        arena_malloc(sizeof(*stacktrace));
 
     sr_koops_stacktrace_init(stacktrace);
     return stacktrace;
@@ -131,12 +136,18 @@ sr_koops_stacktrace_free(struct sr_koops_stacktrace *stacktrace)
         sr_koops_frame_free(frame);
     }
 
-    g_strfreev(stacktrace->modules);
+    if (stacktrace->modules)
+    {
+        for (char **module = stacktrace->modules; *module; ++module)
+            arena_free(*module);
+
+        arena_free(stacktrace->modules);
+    }
 
-    g_free(stacktrace->version);
-    g_free(stacktrace->raw_oops);
-    g_free(stacktrace->reason);
-    g_free(stacktrace);
+    arena_free(stacktrace->version);
+    arena_free(stacktrace->raw_oops);
+    arena_free(stacktrace->reason);
+    arena_free(stacktrace);
 }
 
 struct sr_koops_stacktrace *
@@ -320,7 +331,7 @@ parse_alt_stack_start(const char **input)
         !sr_parse_char_cspan(&local_input, "> \t\n", &stack_label) ||
         !sr_skip_char(&local_input, '>'))
     {
-        g_free(stack_label);
+        arena_free(stack_label);
         return NULL;
     }
 
@@ -340,13 +351,13 @@ sr_koops_stacktrace_parse(const char **input,
     char *alt_stack = NULL;
 
     /* Include the raw kerneloops text */
-    stacktrace->raw_oops = g_strdup(*input);
+    stacktrace->raw_oops = arena_strdup(*input);
 
     /* Looks for the "Tainted: " line in the whole input */
     parse_taint_flags(local_input, stacktrace);
 
     /* The "reason" is expected to be the first line of the input */
-    stacktrace->reason = g_strndup(*input, strcspn(*input, "\n"));
+    stacktrace->reason = arena_strndup(*input, strcspn(*input, "\n"));
 
     while (*local_input)
     {
@@ -383,7 +394,7 @@ sr_koops_stacktrace_parse(const char **input,
         /* <IRQ>, <NMI>, ... */
         if (parse_alt_stack_end(&local_input))
         {
-            g_free(alt_stack);
+            arena_free(alt_stack);
             alt_stack = NULL;
         }
 
@@ -397,7 +408,7 @@ sr_koops_stacktrace_parse(const char **input,
         if((frame = sr_koops_frame_parse(&local_input)))
         {
             if (alt_stack)
-                frame->special_stack = g_strdup(alt_stack);
+                frame->special_stack = arena_strdup(alt_stack);
 
             stacktrace->frames = sr_koops_frame_append(stacktrace->frames, frame);
             goto next_line;
@@ -408,8 +419,7 @@ sr_koops_stacktrace_parse(const char **input,
 next_line:
         sr_skip_char(&local_input, '\n');
     }
-    if (alt_stack)
-        g_free(alt_stack);
+    arena_free(alt_stack);
 
     *input = local_input;
     return stacktrace;
@@ -463,7 +473,7 @@ sr_koops_stacktrace_parse_modules(const char **input)
     int ws = sr_skip_char_span(&local_input, " \t");
 
     int result_size = 20, result_offset = 0;
-    char **result = g_malloc_n(result_size, sizeof(char*));
+    char **result = arena_malloc(result_size * sizeof(char*));
 
     char *module;
     while (true)
@@ -474,8 +484,9 @@ sr_koops_stacktrace_parse_modules(const char **input)
             // the list by a NULL pointer.
             if (result_offset == result_size - 1)
             {
+                result = arena_realloc(result, result_size * sizeof(char*),
+                                       2 * result_size * sizeof(char*));
                 result_size *= 2;
-                result = g_realloc_n(result, result_size, sizeof(char*));
             }
 
             result[result_offset] = module;
@@ -502,8 +513,9 @@ sr_koops_stacktrace_parse_modules(const char **input)
                     break; /* wtf? */
                 }
 
-                char *tmp = g_strdup_printf("%s%s", result[result_offset-1], therest);
-                g_free(result[result_offset-1]);
+                char *tmp = arena_strdup_printf("%s%s", result[result_offset-1], therest);
+                arena_free(result[result_offset-1]);
+                arena_free(therest);
                 result[result_offset-1] = tmp;
             }
 
@@ -696,7 +708,7 @@ sr_koops_stacktrace_from_json(json_object *root, char **error_message)
         array_length = json_object_array_length(modules);
 
         size_t allocated = 128;
-        result->modules = g_malloc_n(allocated, sizeof(char*));
+        result->modules = arena_malloc(allocated * sizeof(char*));
 
         for (i = 0; i < array_length; i++)
         {
@@ -713,10 +725,12 @@ sr_koops_stacktrace_from_json(json_object *root, char **error_message)
             /* need to keep the last element for NULL terminator */
             if (i + 1 == allocated)
             {
+                result->modules = arena_realloc(result->modules,
+                                                allocated * sizeof(char*),
+                                                2 * allocated * sizeof(char*));
                 allocated *= 2;
-                result->modules = g_realloc(result->modules, allocated);
             }
-            result->modules[i] = g_strdup(module);
+            result->modules[i] = arena_strdup(module);
         }
 
         result->modules[i] = NULL;
@@ -762,11 +776,14 @@ sr_koops_stacktrace_get_reason(struct sr_koops_stacktrace *stacktrace)
     char *func = "<unknown>";
     GString *result = g_string_new(NULL);
 
-    struct sr_koops_stacktrace *copy = sr_koops_stacktrace_dup(stacktrace);
-    sr_normalize_koops_stacktrace(copy);
+    struct normalized_thread normalized;
+    normalized_thread_init(&normalized, (struct sr_thread *)stacktrace);
+
+    struct sr_koops_frame *frame =
+        normalized.frames->len > 0 ? normalized.frames->pdata[0] : NULL;
 
-    if (copy->frames && copy->frames->function_name)
-        func = copy->frames->function_name;
+    if (frame && frame->function_name)
+        func = frame->function_name;
 
     if (stacktrace->reason)
     {
@@ -782,10 +799,10 @@ sr_koops_stacktrace_get_reason(struct sr_koops_stacktrace *stacktrace)
         g_string_append_printf(result, "Kernel oops in %s", func);
     }
 
-    if (copy->frames && copy->frames->module_name)
-        g_string_append_printf(result, " [%s]", copy->frames->module_name);
+    if (frame && frame->module_name)
+        g_string_append_printf(result, " [%s]", frame->module_name);
 
-    sr_koops_stacktrace_free(copy);
+    normalized_thread_destroy(&normalized);
 
     return g_string_free(result, FALSE);
 }
@@ -817,26 +834,10 @@ koops_append_bthash_text(struct sr_koops_stacktrace *stacktrace,
     g_string_append_c(strbuf, '\n');
 }
 
-void
-sr_normalize_koops_stacktrace(struct sr_koops_stacktrace *stacktrace)
+static void
+koops_normalized_frames(struct sr_koops_stacktrace *stacktrace,
+                        struct normalized_thread *normalized)
 {
-    /* Normalize function names by removing the suffixes identified by
-     * the dot character.
-     */
-    struct sr_koops_frame *frame = stacktrace->frames;
-    while (frame)
-    {
-        if (frame->function_name)
-        {
-            char *dot = strchr(frame->function_name, '.');
-            if (dot)
-                *dot = '\0';
-        }
-
-        frame = frame->next;
-    }
-
-    /* Remove blacklisted frames. */
     /* !!! MUST BE SORTED !!! */
     const char *blacklist[] = {
         "do_softirq",
@@ -856,11 +857,27 @@ sr_normalize_koops_stacktrace(struct sr_koops_stacktrace *stacktrace)
         "worker_thread"
     };
 
-    frame = stacktrace->frames;
-    while (frame)
+    for (struct sr_koops_frame *original = stacktrace->frames;
+         original;
+         original = original->next)
     {
-        struct sr_koops_frame *next_frame = frame->next;
+        struct sr_koops_frame *frame = original;
 
+        /* Normalize function names by removing the suffixes identified by
+         * the dot character.
+         */
+        char *dot = frame->function_name ? strchr(frame->function_name, '.') : NULL;
+        if (dot)
+        {
+            frame = g_new(struct sr_koops_frame, 1);
+            *frame = *original;
+            frame->function_name = g_strndup(original->function_name,
+                                             dot - original->function_name);
+            g_ptr_array_add(normalized->allocated, frame->function_name);
+            g_ptr_array_add(normalized->allocated, frame);
+        }
+
+        /* Remove blacklisted frames. */
         bool in_blacklist = bsearch(&frame->function_name,
                                     blacklist,
                                     sizeof(blacklist) / sizeof(blacklist[0]),
@@ -869,11 +886,20 @@ sr_normalize_koops_stacktrace(struct sr_koops_stacktrace *stacktrace)
 
         /* do not drop frames belonging to a module */
         if (!frame->module_name && in_blacklist)
-        {
-            bool success = sr_koops_stacktrace_remove_frame(stacktrace, frame);
-            assert(success || !"failed to remove frame");
-        }
+            continue;
 
-        frame = next_frame;
+        normalized_thread_add(normalized, (struct sr_frame *)original,
+                              (struct sr_frame *)frame);
     }
 }
+
+void
+sr_normalize_koops_stacktrace(struct sr_koops_stacktrace *stacktrace)
+{
+    struct normalized_thread normalized;
+
+    normalized_thread_init(&normalized, (struct sr_thread *)stacktrace);
+    normalized_thread_apply(&normalized, (struct sr_thread *)stacktrace,
+                            offsetof(struct sr_koops_frame, function_name));
+    normalized_thread_destroy(&normalized);
+}
@@ -0,0 +1,196 @@
+/*
+    matrix_file.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "matrix_file.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* The arrays following the header must stay aligned. */
+G_STATIC_ASSERT(sizeof(struct matrix_file_header) == 56);
+
+static bool
+write_all(int fd, const void *data, size_t size)
+{
+    const char *ptr = data;
+
+    while (size > 0)
+    {
+        ssize_t written = write(fd, ptr, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        ptr += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+bool
+matrix_file_write(const char *filename,
+                  struct matrix_file_header *header,
+                  const void *const *chunks,
+                  const size_t *chunk_sizes,
+                  int chunk_count,
+                  char **error_message)
+{
+    /* The file gets the usual mode of new files, g_mkstemp() would make it
+     * readable by the owner only. */
+    char *tmp_filename = g_strdup_printf("%s.XXXXXX", filename);
+    int fd = g_mkstemp_full(tmp_filename, O_RDWR, 0666);
+    if (fd < 0)
+    {
+        *error_message = g_strdup_printf("Unable to create '%s': %s.",
+                                         tmp_filename, strerror(errno));
+        g_free(tmp_filename);
+        return false;
+    }
+
+    header->version = MATRIX_FILE_VERSION;
+    header->byte_order = MATRIX_FILE_BYTE_ORDER;
+    header->data_size = 0;
+    for (int i = 0; i < chunk_count; i++)
+        header->data_size += chunk_sizes[i];
+
+    bool success = write_all(fd, header, sizeof(*header));
+    for (int i = 0; success && i < chunk_count; i++)
+        success = write_all(fd, chunks[i], chunk_sizes[i]);
+
+    if (!success)
+    {
+        *error_message = g_strdup_printf("Unable to write to '%s': %s.",
+                                         tmp_filename, strerror(errno));
+    }
+
+    if (close(fd) != 0 && success)
+    {
+        *error_message = g_strdup_printf("Unable to write to '%s': %s.",
+                                         tmp_filename, strerror(errno));
+        success = false;
+    }
+
+    if (success && rename(tmp_filename, filename) != 0)
+    {
+        *error_message = g_strdup_printf("Unable to rename '%s' to '%s': %s.",
+                                         tmp_filename, filename,
+                                         strerror(errno));
+        success = false;
+    }
+
+    if (!success)
+        unlink(tmp_filename);
+
+    g_free(tmp_filename);
+
+    return success;
+}
+
+struct matrix_file_header *
+matrix_file_map(const char *filename,
+                const char *magic,
+                struct matrix_file_mapping *mapping,
+                char **error_message)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        *error_message = g_strdup_printf("Unable to open '%s': %s.",
+                                         filename, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        *error_message = g_strdup_printf("Unable to stat '%s': %s.",
+                                         filename, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    if (st.st_size < (off_t)sizeof(struct matrix_file_header))
+    {
+        *error_message = g_strdup_printf("File '%s' is too short.", filename);
+        close(fd);
+        return NULL;
+    }
+
+    void *address = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (address == MAP_FAILED)
+    {
+        *error_message = g_strdup_printf("Unable to map '%s': %s.",
+                                         filename, strerror(errno));
+        return NULL;
+    }
+
+    mapping->address = address;
+    mapping->size = st.st_size;
+
+    struct matrix_file_header *header = address;
+
+    if (memcmp(header->magic, magic, sizeof(header->magic)) != 0)
+    {
+        *error_message = g_strdup_printf("File '%s' has an invalid format.",
+                                         filename);
+    }
+    else if (header->byte_order != MATRIX_FILE_BYTE_ORDER)
+    {
+        *error_message = g_strdup_printf("File '%s' was written on a machine "
+                                         "with a different byte order.",
+                                         filename);
+    }
+    else if (header->version != MATRIX_FILE_VERSION)
+    {
+        *error_message = g_strdup_printf("File '%s' has unsupported version %u.",
+                                         filename, (unsigned)header->version);
+    }
+    else if (header->data_size != mapping->size - sizeof(*header))
+    {
+        *error_message = g_strdup_printf("File '%s' is truncated.", filename);
+    }
+    else
+        return header;
+
+    matrix_file_unmap(mapping);
+
+    return NULL;
+}
+
+void
+matrix_file_unmap(struct matrix_file_mapping *mapping)
+{
+    if (mapping->address)
+        munmap(mapping->address, mapping->size);
+
+    mapping->address = NULL;
+    mapping->size = 0;
+}
@@ -0,0 +1,129 @@
+/*
+    matrix_file.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_MATRIX_FILE_H
+#define SATYR_MATRIX_FILE_H
+
+/* Binary files holding distance matrices and dendrograms, and the symbol
+ * tables stored by the core unwinder.
+ *
+ * The file starts with the header below, the arrays of the structure
+ * follow immediately.  Everything is stored in the native byte order
+ * and the file is mapped to the memory when it is loaded, so the
+ * arrays are used in place without reading them.  Files written on
+ * a machine with a different byte order are rejected.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "distance.h"
+
+/* Version 2 added the storage type of the distances and the base address
+ * of the symbols to the header. */
+#define MATRIX_FILE_VERSION 2
+#define MATRIX_FILE_BYTE_ORDER 0x01020304
+
+#define MATRIX_FILE_MAGIC_DISTANCES "SRDISTM"
+#define MATRIX_FILE_MAGIC_DENDROGRAM "SRDENDR"
+#define MATRIX_FILE_MAGIC_SYMBOLS "SRSYMBS"
+
+struct matrix_file_header
+{
+    /* One of the MATRIX_FILE_MAGIC_* strings, including the '\0'. */
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    /* Dimensions of the distance matrix, both are the number of objects
+     * in a dendrogram file.  In a symbol file, m is the number of symbols
+     * and n is the size of their names. */
+    int32_t m;
+    int32_t n;
+    /* enum sr_distance_type of the distances, SR_DISTANCE_UNKNOWN (-1)
+     * for the matrices filled by the caller. */
+    int32_t dist_type;
+    /* Checksum of the compared threads, see sr_threads_checksum(). */
+    uint32_t checksum;
+    /* enum sr_distances_storage of the distances, SR_DISTANCES_FLOAT in
+     * a dendrogram file. */
+    int32_t storage;
+    uint32_t reserved;
+    /* Size of the data following the header in bytes. */
+    uint64_t data_size;
+    /* In a symbol file, the address of the binary the module starts at,
+     * so that the load bias of the module is known without opening the
+     * binary.  Zero in the other files. */
+    uint64_t base_address;
+};
+
+/* A range of addresses of a symbol file, named by the symbol containing
+ * them.  The addresses are the ones of the binary, without the load bias,
+ * so that the file does not depend on where the binary is mapped.  The
+ * ranges are sorted by their start addresses and followed by the names. */
+struct matrix_file_symbol
+{
+    uint64_t start;
+    /* Zero for the last range, if it does not end. */
+    uint64_t size;
+    /* Offset of the demangled name in the names following the symbols. */
+    uint64_t name;
+};
+
+/* Checks the dist_type of a distances or dendrogram header. */
+static inline bool
+matrix_file_dist_type_valid(int32_t dist_type)
+{
+    return dist_type == SR_DISTANCE_UNKNOWN ||
+           (dist_type >= 0 && dist_type < SR_DISTANCE_NUM);
+}
+
+/* A file mapped to the memory by matrix_file_map(). */
+struct matrix_file_mapping
+{
+    void *address;
+    size_t size;
+};
+
+/* Writes the header and the data to a temporary file which then replaces
+ * the file with the given name, so that a mapping of the old file is not
+ * affected. The file is created with the mode 0666 modified by the umask.
+ * The data_size of the header is computed from the chunks. */
+bool
+matrix_file_write(const char *filename,
+                  struct matrix_file_header *header,
+                  const void *const *chunks,
+                  const size_t *chunk_sizes,
+                  int chunk_count,
+                  char **error_message);
+
+/* Maps the file to the memory, checks that the header is valid and that
+ * the file has the given magic. The mapping is private and writable, the
+ * changes are never written to the file. Returns a pointer to the header,
+ * the data follow it. */
+struct matrix_file_header *
+matrix_file_map(const char *filename,
+                const char *magic,
+                struct matrix_file_mapping *mapping,
+                char **error_message);
+
+void
+matrix_file_unmap(struct matrix_file_mapping *mapping);
+
+#endif
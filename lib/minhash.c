@@ -0,0 +1,335 @@
+/*
+    minhash.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "minhash.h"
+#include "distance.h"
+#include "frame.h"
+#include "thread.h"
+#include "generic_frame.h"
+#include "symbols.h"
+#include "internal_utils.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct sr_minhash_index
+{
+    int bands;
+    int rows;
+    /* Seeds of the bands * rows hash functions. */
+    uint64_t *seeds;
+    /* The inserted threads, not owned by the index. */
+    GPtrArray *threads;
+    /* Bucket key (gint64 *) -> GArray of thread identifiers. */
+    GHashTable *buckets;
+};
+
+/* Finalizer of splitmix64, a bijection scattering the bits well. */
+static uint64_t
+minhash_mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+    return x;
+}
+
+/* 64-bit FNV-1a. */
+static uint64_t
+minhash_string(const char *str, size_t len)
+{
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)str[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+
+    return hash;
+}
+
+/* Hashes of the frames of the thread, so that frames equal according to
+ * sr_frame_cmp_distance() get the same hash. The frames which are never
+ * equal to anything are left out. */
+static uint64_t *
+minhash_frame_hashes(struct sr_thread *thread, int *count)
+{
+    uint64_t *hashes = g_malloc_n(sr_thread_frame_count(thread) + 1,
+                                  sizeof(*hashes));
+    GString *key = g_string_new(NULL);
+
+    *count = 0;
+
+    for (struct sr_frame *frame = sr_thread_frames(thread);
+         frame;
+         frame = sr_frame_next(frame))
+    {
+        const char *qualifier = NULL;
+
+        g_string_truncate(key, 0);
+        symbol_key_append_int(key, frame->type);
+        size_t prefix_len = key->len;
+
+        /* The qualifier is left out, frames without it are equal to the
+         * frames with any qualifier. */
+        switch (frame_symbol_key(frame, key, &qualifier))
+        {
+        case FRAME_SYMBOL_EXACT:
+            break;
+        case FRAME_SYMBOL_UNKNOWN:
+            continue;
+        case FRAME_SYMBOL_NONE:
+            /* The duplication hash identifies such frames well enough
+             * for finding the candidates. */
+            g_string_truncate(key, prefix_len);
+            frame_append_duphash_text(frame, SR_DUPHASH_NOHASH, key);
+            break;
+        }
+
+        hashes[(*count)++] = minhash_string(key->str, key->len);
+    }
+
+    g_string_free(key, TRUE);
+
+    return hashes;
+}
+
+/* Computes the bands * rows minimal hashes of the thread frames. Returns
+ * false if the thread has no frames to hash. */
+static bool
+minhash_signature(struct sr_minhash_index *index,
+                  struct sr_thread *thread,
+                  uint64_t *signature)
+{
+    int count, length = index->bands * index->rows;
+    uint64_t *hashes = minhash_frame_hashes(thread, &count);
+
+    for (int i = 0; i < length; i++)
+    {
+        uint64_t min = UINT64_MAX;
+
+        for (int j = 0; j < count; j++)
+        {
+            uint64_t hash = minhash_mix(hashes[j] ^ index->seeds[i]);
+            if (hash < min)
+                min = hash;
+        }
+
+        signature[i] = min;
+    }
+
+    g_free(hashes);
+
+    return count > 0;
+}
+
+static gint64
+minhash_bucket_key(struct sr_minhash_index *index,
+                   const uint64_t *signature,
+                   int band)
+{
+    uint64_t key = minhash_mix(band + 1);
+
+    for (int row = 0; row < index->rows; row++)
+        key = minhash_mix(key ^ signature[band * index->rows + row]);
+
+    return (gint64)key;
+}
+
+static void
+minhash_bucket_free(gpointer bucket)
+{
+    g_array_free(bucket, TRUE);
+}
+
+struct sr_minhash_index *
+sr_minhash_index_new(int bands, int rows)
+{
+    assert(bands > 0 && rows > 0);
+
+    struct sr_minhash_index *index = g_malloc(sizeof(*index));
+
+    index->bands = bands;
+    index->rows = rows;
+    index->seeds = g_malloc_n(bands * rows, sizeof(*index->seeds));
+    for (int i = 0; i < bands * rows; i++)
+        index->seeds[i] = minhash_mix(UINT64_C(0x9e3779b97f4a7c15) * (i + 1));
+
+    index->threads = g_ptr_array_new();
+    index->buckets = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                           g_free, minhash_bucket_free);
+
+    return index;
+}
+
+void
+sr_minhash_index_free(struct sr_minhash_index *index)
+{
+    if (!index)
+        return;
+
+    g_hash_table_destroy(index->buckets);
+    g_ptr_array_free(index->threads, TRUE);
+    g_free(index->seeds);
+    g_free(index);
+}
+
+int
+sr_minhash_index_insert(struct sr_minhash_index *index,
+                        struct sr_thread *thread)
+{
+    int id = index->threads->len;
+    uint64_t *signature = g_malloc_n(index->bands * index->rows,
+                                     sizeof(*signature));
+
+    g_ptr_array_add(index->threads, thread);
+
+    if (minhash_signature(index, thread, signature))
+    {
+        for (int band = 0; band < index->bands; band++)
+        {
+            gint64 key = minhash_bucket_key(index, signature, band);
+            GArray *bucket = g_hash_table_lookup(index->buckets, &key);
+
+            if (!bucket)
+            {
+                gint64 *stored_key = g_new(gint64, 1);
+
+                *stored_key = key;
+                bucket = g_array_new(FALSE, FALSE, sizeof(int));
+                g_hash_table_insert(index->buckets, stored_key, bucket);
+            }
+
+            g_array_append_val(bucket, id);
+        }
+    }
+
+    g_free(signature);
+
+    return id;
+}
+
+int
+sr_minhash_index_size(struct sr_minhash_index *index)
+{
+    return index->threads->len;
+}
+
+static int
+minhash_id_cmp(const void *id1, const void *id2)
+{
+    return *(const int *)id1 - *(const int *)id2;
+}
+
+int *
+sr_minhash_index_query(struct sr_minhash_index *index,
+                       struct sr_thread *thread,
+                       int *count)
+{
+    uint64_t *signature = g_malloc_n(index->bands * index->rows,
+                                     sizeof(*signature));
+    GArray *candidates = g_array_new(FALSE, FALSE, sizeof(int));
+
+    if (minhash_signature(index, thread, signature))
+    {
+        for (int band = 0; band < index->bands; band++)
+        {
+            gint64 key = minhash_bucket_key(index, signature, band);
+            GArray *bucket = g_hash_table_lookup(index->buckets, &key);
+
+            if (bucket)
+                g_array_append_vals(candidates, bucket->data, bucket->len);
+        }
+    }
+
+    g_free(signature);
+
+    /* A candidate is usually found in several bands. */
+    int *ids = (int *)candidates->data;
+    int unique = 0;
+
+    qsort(ids, candidates->len, sizeof(*ids), minhash_id_cmp);
+    for (guint i = 0; i < candidates->len; i++)
+    {
+        if (unique == 0 || ids[unique - 1] != ids[i])
+            ids[unique++] = ids[i];
+    }
+
+    *count = unique;
+
+    return (int *)g_array_free(candidates, unique == 0);
+}
+
+int *
+sr_minhash_index_query_distance(struct sr_minhash_index *index,
+                                struct sr_thread *thread,
+                                enum sr_distance_type dist_type,
+                                float max_dist,
+                                int *count,
+                                float **distances)
+{
+    int candidate_count;
+    int *ids = sr_minhash_index_query(index, thread, &candidate_count);
+    float *found_distances = g_malloc_n(candidate_count + 1,
+                                        sizeof(*found_distances));
+
+    *count = 0;
+
+    for (int i = 0; i < candidate_count; i++)
+    {
+        struct sr_thread *candidate = g_ptr_array_index(index->threads,
+                                                        ids[i]);
+        float dist = sr_distance_bounded(dist_type, thread, candidate,
+                                         max_dist);
+
+        /* Jaro-Winkler is a similarity. */
+        bool within = dist_type == SR_DISTANCE_JARO_WINKLER ||
+                      dist_type == SR_DISTANCE_JARO_WINKLER_COMPAT
+                      ? dist >= 1.0f - max_dist
+                      : dist <= max_dist;
+
+        if (within)
+        {
+            ids[*count] = ids[i];
+            found_distances[*count] = dist;
+            ++*count;
+        }
+    }
+
+    if (*count == 0)
+    {
+        g_free(ids);
+        ids = NULL;
+    }
+
+    if (distances && *count > 0)
+        *distances = found_distances;
+    else
+    {
+        if (distances)
+            *distances = NULL;
+        g_free(found_distances);
+    }
+
+    return ids;
+}
@@ -26,6 +26,8 @@
 #include "core/thread.h"
 #include "thread.h"
 #include "utils.h"
+#include "internal_utils.h"
+#include "generic_thread.h"
 #include <string.h>
 #include <assert.h>
 
@@ -103,7 +105,7 @@ is_removable_glibc_with_above(const char *function_name,
         call_match(function_name, source_file, "__libc_fatal", "libc", NULL);
 }
 
-static char *
+static const char *
 find_new_function_name_glibc(const char *function_name,
                              const char *source_file)
 {
@@ -117,7 +119,7 @@ find_new_function_name_glibc(const char *function_name,
         call_match(function_name, source_file, "__" func "_sse42", func, "/sysdeps/", "libc.so", NULL) || \
         call_match(function_name, source_file, "__" func "_ia32", func, "/sysdeps", "libc.so", NULL)) \
         {                                                               \
-            return g_strdup(func);                                     \
+            return func;                                               \
         }
 
         NORMALIZE_ARCH_SPECIFIC("memchr");
@@ -145,24 +147,41 @@ find_new_function_name_glibc(const char *function_name,
         return NULL;
 }
 
-static void
-remove_func_prefix(char *function_name, const char *prefix, int num)
+/* Returns the function name without the prefix, the name is not copied. */
+static const char *
+skip_func_prefix(const char *function_name, const char *prefix, int num)
 {
     int prefix_len, func_len;
 
     if (!function_name)
-        return;
+        return function_name;
 
     prefix_len = strlen(prefix);
 
     if (strncmp(function_name, prefix, prefix_len))
-        return;
+        return function_name;
 
     func_len = strlen(function_name);
     if (num > func_len)
         num = func_len;
 
-    memmove(function_name, function_name + num, func_len - num + 1);
+    return function_name + num;
+}
+
+/* Removes a frame from the normalized thread. */
+static void
+normalized_thread_remove(struct normalized_thread *normalized, unsigned index)
+{
+    g_ptr_array_remove_index(normalized->frames, index);
+    g_ptr_array_remove_index(normalized->originals, index);
+}
+
+/* Removes all the frames added to the normalized thread so far. */
+static void
+normalized_thread_clear(struct normalized_thread *normalized)
+{
+    g_ptr_array_set_size(normalized->frames, 0);
+    g_ptr_array_set_size(normalized->originals, 0);
 }
 
 static bool
@@ -215,62 +234,58 @@ sr_gdb_frame_is_removable(const char *function_name,
     return false;
 }
 
+/* Returns the frame with the function name, which is a copy of the frame
+ * if the name differs. */
+static struct sr_gdb_frame *
+normalized_gdb_frame(struct normalized_thread *normalized,
+                     struct sr_gdb_frame *frame, const char *function_name)
+{
+    if (function_name == frame->function_name)
+        return frame;
+
+    struct sr_gdb_frame *copy = g_new(struct sr_gdb_frame, 1);
+    *copy = *frame;
+    copy->function_name = (char *)function_name;
+    g_ptr_array_add(normalized->allocated, copy);
+    return copy;
+}
+
 void
-sr_normalize_gdb_thread(struct sr_gdb_thread *thread)
+normalize_gdb_thread_frames(struct sr_gdb_thread *thread,
+                            struct normalized_thread *normalized)
 {
-    /* Find the exit frame and remove everything above it. */
+    /* Find the exit frame and skip everything above it. */
     struct sr_gdb_frame *exit_frame = sr_glibc_thread_find_exit_frame(thread);
-    if (exit_frame)
-    {
-        bool success = sr_gdb_thread_remove_frames_above(thread, exit_frame);
-        assert(success); /* if this fails, some code become broken */
-        success = sr_gdb_thread_remove_frame(thread, exit_frame);
-        assert(success); /* if this fails, some code become broken */
-    }
+    struct sr_gdb_frame *original = exit_frame ? exit_frame->next : thread->frames;
 
-    /* Normalize function names by removing various prefixes that
-     * occur only in some cases.
-     */
-    struct sr_gdb_frame *frame = thread->frames;
-    while (frame)
+    for (; original; original = original->next)
     {
-        if (frame->source_file)
+        const char *function_name = original->function_name;
+
+        /* Normalize function names by removing various prefixes that
+         * occur only in some cases.
+         */
+        if (original->source_file)
         {
             /* Remove IA__ prefix used in GLib, GTK and GDK. */
-            remove_func_prefix(frame->function_name, "IA__gdk", strlen("IA__"));
-            remove_func_prefix(frame->function_name, "IA__g_", strlen("IA__"));
-            remove_func_prefix(frame->function_name, "IA__gtk", strlen("IA__"));
+            function_name = skip_func_prefix(function_name, "IA__gdk", strlen("IA__"));
+            function_name = skip_func_prefix(function_name, "IA__g_", strlen("IA__"));
+            function_name = skip_func_prefix(function_name, "IA__gtk", strlen("IA__"));
 
             /* Remove __GI_ (glibc internal) prefix. */
-            remove_func_prefix(frame->function_name, "__GI_", strlen("__GI_"));
+            function_name = skip_func_prefix(function_name, "__GI_", strlen("__GI_"));
         }
 
-        frame = frame->next;
-    }
-
-    /* Unify some functions by renaming them.
-     */
-    frame = thread->frames;
-    while (frame)
-    {
-        char *new_function_name =
-            find_new_function_name_glibc(frame->function_name, frame->source_file);
+        /* Unify some functions by renaming them.
+         */
+        const char *new_function_name =
+            find_new_function_name_glibc(function_name, original->source_file);
 
         if (new_function_name)
-        {
-            g_free(frame->function_name);
-            frame->function_name = new_function_name;
-        }
+            function_name = new_function_name;
 
-        frame = frame->next;
-    }
-
-    /* Remove redundant frames from the thread.
-     */
-    frame = thread->frames;
-    while (frame)
-    {
-        struct sr_gdb_frame *next_frame = frame->next;
+        struct sr_gdb_frame *frame =
+            normalized_gdb_frame(normalized, original, function_name);
 
         /* Remove frames which are not a cause of the crash. */
         bool removable = sr_gdb_frame_is_removable(frame->function_name,
@@ -280,17 +295,17 @@ sr_normalize_gdb_thread(struct sr_gdb_thread *thread)
             sr_gdb_is_exit_frame(frame);
 
         if (removable_with_above)
+            normalized_thread_clear(normalized);
+
+        if (!removable && !removable_with_above)
         {
-            bool success = sr_gdb_thread_remove_frames_above(thread, frame);
-            assert(success);
+            normalized_thread_add(normalized, (struct sr_frame *)original,
+                                  (struct sr_frame *)frame);
         }
-
-        if (removable || removable_with_above)
-            sr_gdb_thread_remove_frame(thread, frame);
-
-        frame = next_frame;
     }
 
+    GPtrArray *frames = normalized->frames;
+
     /* If the first frame has address 0x0000 and its name is '??', it
      * is a dereferenced null, and we remove it. This frame is not
      * really invalid, but it affects stacktrace quality rating. See
@@ -303,12 +318,13 @@ sr_normalize_gdb_thread(struct sr_gdb_thread *thread)
      *       totem = 0xdee070 [TotemObject]
      * @endcode
      */
-    if (thread->frames &&
-        thread->frames->address == 0x0000 &&
-        thread->frames->function_name &&
-        0 == strcmp(thread->frames->function_name, "??"))
+    struct sr_gdb_frame *first = frames->len > 0 ? frames->pdata[0] : NULL;
+    if (first &&
+        first->address == 0x0000 &&
+        first->function_name &&
+        0 == strcmp(first->function_name, "??"))
     {
-        sr_gdb_thread_remove_frame(thread, thread->frames);
+        normalized_thread_remove(normalized, 0);
     }
 
     /* If the last frame has address 0x0000 and its name is '??',
@@ -321,92 +337,99 @@ sr_normalize_gdb_thread(struct sr_gdb_thread *thread)
      * #3  0x0000000000000000 in ?? ()
      * @endcode
      */
-    struct sr_gdb_frame *last = thread->frames;
-    while (last && last->next)
-        last = last->next;
+    struct sr_gdb_frame *last =
+        frames->len > 0 ? frames->pdata[frames->len - 1] : NULL;
     if (last &&
         last->address == 0x0000 &&
         last->function_name &&
         0 == strcmp(last->function_name, "??"))
     {
-        sr_gdb_thread_remove_frame(thread, last);
+        normalized_thread_remove(normalized, frames->len - 1);
     }
 
     /* Merge recursively called functions into single frame */
-    struct sr_gdb_frame *curr_frame = thread->frames;
-    struct sr_gdb_frame *prev_frame = NULL;
-    while (curr_frame)
+    unsigned count = 0;
+    for (unsigned i = 0; i < frames->len; i++)
     {
+        struct sr_gdb_frame *prev_frame =
+            count > 0 ? frames->pdata[count - 1] : NULL;
+        struct sr_gdb_frame *curr_frame = frames->pdata[i];
+
         if (prev_frame &&
             0 != g_strcmp0(prev_frame->function_name, "??") &&
             0 == g_strcmp0(prev_frame->function_name, curr_frame->function_name))
         {
-            prev_frame->next = curr_frame->next;
-            sr_gdb_frame_free(curr_frame);
-            curr_frame = prev_frame->next;
             continue;
         }
 
-        prev_frame = curr_frame;
-        curr_frame = curr_frame->next;
+        frames->pdata[count] = curr_frame;
+        normalized->originals->pdata[count] = normalized->originals->pdata[i];
+        count++;
     }
+
+    g_ptr_array_set_size(frames, count);
+    g_ptr_array_set_size(normalized->originals, count);
 }
 
 void
-sr_normalize_core_thread(struct sr_core_thread *thread)
+sr_normalize_gdb_thread(struct sr_gdb_thread *thread)
+{
+    struct normalized_thread normalized;
+
+    normalized_thread_init(&normalized, (struct sr_thread *)thread);
+    normalized_thread_apply(&normalized, (struct sr_thread *)thread,
+                            offsetof(struct sr_gdb_frame, function_name));
+    normalized_thread_destroy(&normalized);
+}
+
+/* Same as normalized_gdb_frame(). */
+static struct sr_core_frame *
+normalized_core_frame(struct normalized_thread *normalized,
+                      struct sr_core_frame *frame, const char *function_name)
 {
-    /* Find the exit frame and remove everything above it. */
+    if (function_name == frame->function_name)
+        return frame;
+
+    struct sr_core_frame *copy = g_new(struct sr_core_frame, 1);
+    *copy = *frame;
+    copy->function_name = (char *)function_name;
+    g_ptr_array_add(normalized->allocated, copy);
+    return copy;
+}
+
+void
+normalize_core_thread_frames(struct sr_core_thread *thread,
+                             struct normalized_thread *normalized)
+{
+    /* Find the exit frame and skip everything above it. */
     struct sr_core_frame *exit_frame = sr_core_thread_find_exit_frame(thread);
-    if (exit_frame)
-    {
-        bool success = sr_thread_remove_frames_above((struct sr_thread *)thread,
-                                                     (struct sr_frame *)exit_frame);
-        assert(success); /* if this fails, some code become broken */
-        success = sr_thread_remove_frame((struct sr_thread *)thread,
-                                         (struct sr_frame *)exit_frame);
-        assert(success); /* if this fails, some code become broken */
-    }
+    struct sr_core_frame *original = exit_frame ? exit_frame->next : thread->frames;
 
-    /* Normalize function names by removing various prefixes that
-     * occur only in some cases.
-     */
-    struct sr_core_frame *frame = thread->frames;
-    while (frame)
+    for (; original; original = original->next)
     {
+        /* Normalize function names by removing various prefixes that
+         * occur only in some cases.
+         */
+        const char *function_name = original->function_name;
+
         /* Remove IA__ prefix used in GLib, GTK and GDK. */
-        remove_func_prefix(frame->function_name, "IA__gdk", strlen("IA__"));
-        remove_func_prefix(frame->function_name, "IA__g_", strlen("IA__"));
-        remove_func_prefix(frame->function_name, "IA__gtk", strlen("IA__"));
+        function_name = skip_func_prefix(function_name, "IA__gdk", strlen("IA__"));
+        function_name = skip_func_prefix(function_name, "IA__g_", strlen("IA__"));
+        function_name = skip_func_prefix(function_name, "IA__gtk", strlen("IA__"));
 
         /* Remove __GI_ (glibc internal) prefix. */
-        remove_func_prefix(frame->function_name, "__GI_", strlen("__GI_"));
+        function_name = skip_func_prefix(function_name, "__GI_", strlen("__GI_"));
 
-        frame = frame->next;
-    }
-
-    /* Unify some functions by renaming them.
-     */
-    frame = thread->frames;
-    while (frame)
-    {
-        char *new_function_name =
-            find_new_function_name_glibc(frame->function_name, frame->file_name);
+        /* Unify some functions by renaming them.
+         */
+        const char *new_function_name =
+            find_new_function_name_glibc(function_name, original->file_name);
 
         if (new_function_name)
-        {
-            g_free(frame->function_name);
-            frame->function_name = new_function_name;
-        }
+            function_name = new_function_name;
 
-        frame = frame->next;
-    }
-
-    /* Remove redundant frames from the thread.
-     */
-    frame = thread->frames;
-    while (frame)
-    {
-        struct sr_core_frame *next_frame = frame->next;
+        struct sr_core_frame *frame =
+            normalized_core_frame(normalized, original, function_name);
 
         /* Remove frames which are not a cause of the crash. */
         bool removable = sr_gdb_frame_is_removable(frame->function_name,
@@ -416,26 +439,16 @@ sr_normalize_core_thread(struct sr_core_thread *thread)
             sr_core_thread_is_exit_frame(frame);
 
         if (removable_with_above)
+            normalized_thread_clear(normalized);
+
+        if (!removable && !removable_with_above)
         {
-            bool success = sr_thread_remove_frames_above((struct sr_thread *)thread,
-                                                         (struct sr_frame *)frame);
-            assert(success);
+            normalized_thread_add(normalized, (struct sr_frame *)original,
+                                  (struct sr_frame *)frame);
         }
-
-        if (removable || removable_with_above)
-            sr_thread_remove_frame((struct sr_thread *)thread, (struct sr_frame *)frame);
-
-        frame = next_frame;
     }
 
-    /* Anonymize file_name if contains /home/<user>/...
-     */
-    frame = thread->frames;
-    while (frame)
-    {
-        frame->file_name = anonymize_path(frame->file_name);
-        frame = frame->next;
-    }
+    GPtrArray *frames = normalized->frames;
 
     /* If the first frame has address 0x0000 and its name is '??', it
      * is a dereferenced null, and we remove it. This frame is not
@@ -449,12 +462,12 @@ sr_normalize_core_thread(struct sr_core_thread *thread)
      *       totem = 0xdee070 [TotemObject]
      * @endcode
      */
-    if (thread->frames &&
-        thread->frames->address == 0x0000 &&
-        !thread->frames->function_name)
+    struct sr_core_frame *first = frames->len > 0 ? frames->pdata[0] : NULL;
+    if (first &&
+        first->address == 0x0000 &&
+        !first->function_name)
     {
-        sr_thread_remove_frame((struct sr_thread *)thread,
-                               (struct sr_frame *)thread->frames);
+        normalized_thread_remove(normalized, 0);
     }
 
     /* If the last frame has address 0x0000 and its name is '??',
@@ -467,35 +480,57 @@ sr_normalize_core_thread(struct sr_core_thread *thread)
      * #3  0x0000000000000000 in ?? ()
      * @endcode
      */
-    struct sr_core_frame *last = thread->frames;
-    while (last && last->next)
-        last = last->next;
+    struct sr_core_frame *last =
+        frames->len > 0 ? frames->pdata[frames->len - 1] : NULL;
     if (last &&
         last->address == 0x0000 &&
         !last->function_name)
     {
-        sr_thread_remove_frame((struct sr_thread *)thread, (struct sr_frame *)last);
+        normalized_thread_remove(normalized, frames->len - 1);
     }
 
     /* Merge recursively called functions into single frame */
-    struct sr_core_frame *curr_frame = thread->frames;
-    struct sr_core_frame *prev_frame = NULL;
-    while (curr_frame)
+    unsigned count = 0;
+    for (unsigned i = 0; i < frames->len; i++)
     {
+        struct sr_core_frame *prev_frame =
+            count > 0 ? frames->pdata[count - 1] : NULL;
+        struct sr_core_frame *curr_frame = frames->pdata[i];
+
         if (prev_frame &&
             prev_frame->function_name &&
             0 == g_strcmp0(prev_frame->function_name, curr_frame->function_name))
         {
-            prev_frame->next = curr_frame->next;
-            sr_core_frame_free(curr_frame);
-            curr_frame = prev_frame->next;
             continue;
         }
 
-        prev_frame = curr_frame;
-        curr_frame = curr_frame->next;
+        frames->pdata[count] = curr_frame;
+        normalized->originals->pdata[count] = normalized->originals->pdata[i];
+        count++;
     }
 
+    g_ptr_array_set_size(frames, count);
+    g_ptr_array_set_size(normalized->originals, count);
+}
+
+void
+sr_normalize_core_thread(struct sr_core_thread *thread)
+{
+    struct normalized_thread normalized;
+
+    normalized_thread_init(&normalized, (struct sr_thread *)thread);
+    normalized_thread_apply(&normalized, (struct sr_thread *)thread,
+                            offsetof(struct sr_core_frame, function_name));
+    normalized_thread_destroy(&normalized);
+
+    /* Anonymize file_name if contains /home/<user>/...
+     */
+    struct sr_core_frame *frame = thread->frames;
+    while (frame)
+    {
+        frame->file_name = anonymize_path(frame->file_name);
+        frame = frame->next;
+    }
 }
 
 void
@@ -509,86 +544,176 @@ sr_normalize_gdb_stacktrace(struct sr_gdb_stacktrace *stacktrace)
     }
 }
 
+/* Function name of the frame after the pairing, the paired unknown
+ * frames are renamed to GDB_PAIRED_UNKNOWN_PREFIX and the pair index. */
+struct paired_name
+{
+    const char *name;
+    int pair;
+};
+
+static struct paired_name
+paired_name(struct sr_gdb_frame *frame, const int *pairs, int index)
+{
+    struct paired_name name = { frame->function_name, pairs[index] };
+    return name;
+}
+
+static bool
+paired_name_is_unknown(struct paired_name name)
+{
+    return name.pair < 0 && 0 == g_strcmp0(name.name, "??");
+}
+
+static bool
+paired_names_equal(struct paired_name name1, struct paired_name name2)
+{
+    if (name1.pair >= 0 && name2.pair >= 0)
+        return name1.pair == name2.pair;
+
+    if (name1.pair < 0 && name2.pair < 0)
+        return 0 == g_strcmp0(name1.name, name2.name);
+
+    /* Compare the new name with the original one. */
+    struct paired_name renamed = name1.pair >= 0 ? name1 : name2,
+                       original = name1.pair >= 0 ? name2 : name1;
+    char buf[sizeof(GDB_PAIRED_UNKNOWN_PREFIX) + 12];
+
+    g_snprintf(buf, sizeof(buf), GDB_PAIRED_UNKNOWN_PREFIX "%d", renamed.pair);
+
+    return 0 == g_strcmp0(original.name, buf);
+}
+
+static bool
+libraries_compatible(struct sr_gdb_frame *frame1,
+                     struct sr_gdb_frame *frame2)
+{
+    return !(frame1->library_name && frame2->library_name &&
+             strcmp(frame1->library_name, frame2->library_name));
+}
+
 static bool
-next_functions_similar(struct sr_gdb_frame *frame1,
-                       struct sr_gdb_frame *frame2)
+next_functions_similar(struct sr_gdb_frame *frame1, const int *pairs1, int index1,
+                       struct sr_gdb_frame *frame2, const int *pairs2, int index2)
 {
     if ((!frame1->next && frame2->next) ||
         (frame1->next && !frame2->next) ||
         (frame1->next && frame2->next &&
-         (0 != g_strcmp0(frame1->next->function_name,
-                          frame2->next->function_name) ||
-          0 == g_strcmp0(frame1->next->function_name, "??") ||
-         (frame1->next->library_name && frame2->next->library_name &&
-          0 != strcmp(frame1->next->library_name, frame2->next->library_name)))))
+         (!paired_names_equal(paired_name(frame1->next, pairs1, index1 + 1),
+                              paired_name(frame2->next, pairs2, index2 + 1)) ||
+          paired_name_is_unknown(paired_name(frame1->next, pairs1, index1 + 1)) ||
+          !libraries_compatible(frame1->next, frame2->next))))
         return false;
     return true;
 }
 
-void
-sr_normalize_gdb_paired_unknown_function_names(struct sr_gdb_thread *thread1,
-                                               struct sr_gdb_thread *thread2)
-
+int
+normalize_gdb_pair_unknown_frames(struct sr_gdb_thread *thread1,
+                                  struct sr_gdb_thread *thread2,
+                                  int *pairs1,
+                                  int *pairs2)
 {
+    int i = 0, index1 = 0, index2 = 0;
+
+    for (struct sr_gdb_frame *frame = thread1->frames; frame; frame = frame->next)
+        pairs1[index1++] = -1;
+    for (struct sr_gdb_frame *frame = thread2->frames; frame; frame = frame->next)
+        pairs2[index2++] = -1;
+
     if (!thread1->frames || !thread2->frames)
     {
-        return;
+        return 0;
     }
 
-    int i = 0;
     struct sr_gdb_frame *curr_frame1 = thread1->frames;
     struct sr_gdb_frame *curr_frame2 = thread2->frames;
 
-    if (0 == g_strcmp0(curr_frame1->function_name, "??") &&
-        0 == g_strcmp0(curr_frame2->function_name, "??") &&
-        !(curr_frame1->library_name && curr_frame2->library_name &&
-          strcmp(curr_frame1->library_name, curr_frame2->library_name)) &&
-        next_functions_similar(curr_frame1, curr_frame2))
+    index1 = index2 = 0;
+
+    if (paired_name_is_unknown(paired_name(curr_frame1, pairs1, 0)) &&
+        paired_name_is_unknown(paired_name(curr_frame2, pairs2, 0)) &&
+        libraries_compatible(curr_frame1, curr_frame2) &&
+        next_functions_similar(curr_frame1, pairs1, 0, curr_frame2, pairs2, 0))
     {
-        g_free(curr_frame1->function_name);
-        curr_frame1->function_name = g_strdup_printf("__unknown_function_%d", i);
-        g_free(curr_frame2->function_name);
-        curr_frame2->function_name = g_strdup_printf("__unknown_function_%d", i);
-        i++;
+        pairs1[0] = pairs2[0] = i++;
     }
 
     struct sr_gdb_frame *prev_frame1 = curr_frame1;
     struct sr_gdb_frame *prev_frame2 = curr_frame2;
     curr_frame1 = curr_frame1->next;
     curr_frame2 = curr_frame2->next;
+    index1 = index2 = 1;
 
     while (curr_frame1)
     {
-        if (0 == g_strcmp0(curr_frame1->function_name, "??"))
+        if (paired_name_is_unknown(paired_name(curr_frame1, pairs1, index1)))
         {
             while (curr_frame2)
             {
-                if (0 == g_strcmp0(curr_frame2->function_name, "??") &&
-                    !(curr_frame1->library_name && curr_frame2->library_name &&
-                      strcmp(curr_frame1->library_name, curr_frame2->library_name)) &&
-                    0 != g_strcmp0(prev_frame2->function_name, "??") &&
-                    next_functions_similar(curr_frame1, curr_frame2) &&
-                    0 == g_strcmp0(prev_frame1->function_name,
-                                     prev_frame2->function_name) &&
-                    !(prev_frame1->library_name && prev_frame2->library_name &&
-                      strcmp(prev_frame1->library_name, prev_frame2->library_name)))
+                if (paired_name_is_unknown(paired_name(curr_frame2, pairs2, index2)) &&
+                    libraries_compatible(curr_frame1, curr_frame2) &&
+                    !paired_name_is_unknown(paired_name(prev_frame2, pairs2, index2 - 1)) &&
+                    next_functions_similar(curr_frame1, pairs1, index1,
+                                           curr_frame2, pairs2, index2) &&
+                    paired_names_equal(paired_name(prev_frame1, pairs1, index1 - 1),
+                                       paired_name(prev_frame2, pairs2, index2 - 1)) &&
+                    libraries_compatible(prev_frame1, prev_frame2))
                 {
-                    g_free(curr_frame1->function_name);
-                    curr_frame1->function_name = g_strdup_printf("__unknown_function_%d", i);
-                    g_free(curr_frame2->function_name);
-                    curr_frame2->function_name = g_strdup_printf("__unknown_function_%d", i);
-                    i++;
+                    pairs1[index1] = pairs2[index2] = i++;
                     break;
                 }
                 prev_frame2 = curr_frame2;
                 curr_frame2 = curr_frame2->next;
+                index2++;
             }
         }
         prev_frame1 = curr_frame1;
         curr_frame1 = curr_frame1->next;
+        index1++;
         prev_frame2 = thread2->frames;
         curr_frame2 = prev_frame2->next;
+        index2 = 1;
     }
+
+    return i;
+}
+
+static void
+rename_paired_unknown_frames(struct sr_gdb_thread *thread, const int *pairs)
+{
+    int index = 0;
+
+    for (struct sr_gdb_frame *frame = thread->frames; frame; frame = frame->next)
+    {
+        if (pairs[index] >= 0)
+        {
+            sr_intern_free(frame->function_name);
+            frame->function_name =
+                g_strdup_printf(GDB_PAIRED_UNKNOWN_PREFIX "%d", pairs[index]);
+        }
+
+        index++;
+    }
+}
+
+void
+sr_normalize_gdb_paired_unknown_function_names(struct sr_gdb_thread *thread1,
+                                               struct sr_gdb_thread *thread2)
+
+{
+    int *pairs1 = g_malloc_n(sr_thread_frame_count((struct sr_thread *)thread1) + 1,
+                             sizeof(*pairs1));
+    int *pairs2 = g_malloc_n(sr_thread_frame_count((struct sr_thread *)thread2) + 1,
+                             sizeof(*pairs2));
+
+    if (normalize_gdb_pair_unknown_frames(thread1, thread2, pairs1, pairs2) > 0)
+    {
+        rename_paired_unknown_frames(thread1, pairs1);
+        rename_paired_unknown_frames(thread2, pairs2);
+    }
+
+    g_free(pairs1);
+    g_free(pairs2);
 }
 
 void
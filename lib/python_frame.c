@@ -36,6 +36,12 @@ python_append_bthash_text(struct sr_python_frame *frame, enum sr_bthash_flags fl
 static void
 python_append_duphash_text(struct sr_python_frame *frame, enum sr_duphash_flags flags,
                            GString *strbuf);
+static enum frame_symbol_kind
+python_symbol_key(struct sr_python_frame *frame, GString *key,
+                  const char **qualifier);
+static void
+python_frozen_fields(struct sr_python_frame *frame,
+                     struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(python_next, struct sr_frame, struct sr_python_frame)
 DEFINE_SET_NEXT_FUNC(python_set_next, struct sr_frame, struct sr_python_frame)
@@ -52,6 +58,8 @@ struct frame_methods python_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) python_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_python_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) python_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) python_frozen_fields,
 };
 
 /* Public functions */
@@ -60,7 +68,7 @@ struct sr_python_frame *
 sr_python_frame_new()
 {
     struct sr_python_frame *frame =
-        g_malloc(sizeof(*frame));
+        arena_malloc(sizeof(*frame));
 
     sr_python_frame_init(frame);
     return frame;
@@ -79,10 +87,10 @@ sr_python_frame_free(struct sr_python_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->file_name);
-    g_free(frame->function_name);
-    g_free(frame->line_contents);
-    g_free(frame);
+    sr_intern_free(frame->file_name);
+    sr_intern_free(frame->function_name);
+    arena_free(frame->line_contents);
+    arena_free(frame);
 }
 
 struct sr_python_frame *
@@ -102,10 +110,10 @@ sr_python_frame_dup(struct sr_python_frame *frame, bool siblings)
 
     /* Duplicate all strings. */
     if (result->file_name)
-        result->file_name = g_strdup(result->file_name);
+        result->file_name = sr_intern_strdup(result->file_name);
 
     if (result->function_name)
-        result->function_name = g_strdup(result->function_name);
+        result->function_name = sr_intern_strdup(result->function_name);
 
     if (result->line_contents)
         result->line_contents = g_strdup(result->line_contents);
@@ -113,19 +121,28 @@ sr_python_frame_dup(struct sr_python_frame *frame, bool siblings)
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_python_frame *
+python_frame_intern(struct sr_python_frame *frame)
+{
+    frame->file_name = intern_take(frame->file_name);
+    frame->function_name = intern_take(frame->function_name);
+    return frame;
+}
+
 int
 sr_python_frame_cmp(struct sr_python_frame *frame1,
                     struct sr_python_frame *frame2)
 {
     /* function_name */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* file_name */
-    int file_name = g_strcmp0(frame1->file_name,
-                               frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                    frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -160,14 +177,14 @@ sr_python_frame_cmp_distance(struct sr_python_frame *frame1,
                              struct sr_python_frame *frame2)
 {
     /* function_name */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* file_name */
-    int file_name = g_strcmp0(frame1->file_name,
-                               frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                    frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -231,8 +248,8 @@ sr_python_frame_parse(const char **input,
     {
         frame->special_file = true;
         frame->file_name[strlen(frame->file_name)-1] = '\0';
-        char *inside = g_strdup(frame->file_name + 1);
-        g_free(frame->file_name);
+        char *inside = arena_strdup(frame->file_name + 1);
+        arena_free(frame->file_name);
         frame->file_name = inside;
     }
 
@@ -270,7 +287,7 @@ sr_python_frame_parse(const char **input,
          * function name on its line. For the sake of simplicity, we will
          * believe that we are dealing with such a frame now.
          */
-        frame->function_name = g_strdup("syntax");
+        frame->function_name = arena_strdup("syntax");
         frame->special_function = true;
     }
     else
@@ -294,8 +311,8 @@ sr_python_frame_parse(const char **input,
         {
             frame->special_function = true;
             frame->function_name[strlen(frame->function_name)-1] = '\0';
-            char *inside = g_strdup(frame->function_name + 1);
-            g_free(frame->function_name);
+            char *inside = arena_strdup(frame->function_name + 1);
+            arena_free(frame->function_name);
             frame->function_name = inside;
         }
     }
@@ -312,7 +329,7 @@ sr_python_frame_parse(const char **input,
     }
 
     *input = local_input;
-    return frame;
+    return python_frame_intern(frame);
 
 fail:
     sr_python_frame_free(frame);
@@ -389,7 +406,7 @@ sr_python_frame_from_json(json_object *root, char **error_message)
         string = json_object_get_string(val);
 
         result->special_file = false;
-        result->file_name = g_strdup(string);
+        result->file_name = arena_strdup(string);
     }
     else if (json_object_object_get_ex(root, "special_file", &val))
     {
@@ -401,7 +418,7 @@ sr_python_frame_from_json(json_object *root, char **error_message)
         string = json_object_get_string(val);
 
         result->special_file = true;
-        result->file_name = g_strdup(string);
+        result->file_name = arena_strdup(string);
     }
 
     /* Function name / special function. */
@@ -415,7 +432,7 @@ sr_python_frame_from_json(json_object *root, char **error_message)
         string = json_object_get_string(val);
 
         result->special_function = false;
-        result->function_name = g_strdup(string);
+        result->function_name = arena_strdup(string);
     }
     else if (json_object_object_get_ex(root, "special_function", &val))
     {
@@ -427,7 +444,7 @@ sr_python_frame_from_json(json_object *root, char **error_message)
         string = json_object_get_string(val);
 
         result->special_function = true;
-        result->function_name = g_strdup(string);
+        result->function_name = arena_strdup(string);
     }
 
     bool success =
@@ -437,7 +454,7 @@ sr_python_frame_from_json(json_object *root, char **error_message)
     if (!success)
         goto fail;
 
-    return result;
+    return python_frame_intern(result);
 
 fail:
     sr_python_frame_free(result);
@@ -492,3 +509,22 @@ python_append_duphash_text(struct sr_python_frame *frame, enum sr_duphash_flags
                           OR_UNKNOWN(frame->file_name),
                           frame->file_line);
 }
+
+static enum frame_symbol_kind
+python_symbol_key(struct sr_python_frame *frame, GString *key,
+                  const char **qualifier)
+{
+    symbol_key_append_str(key, frame->function_name);
+    symbol_key_append_str(key, frame->file_name);
+    symbol_key_append_int(key, frame->special_function);
+    symbol_key_append_int(key, frame->special_file);
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+python_frozen_fields(struct sr_python_frame *frame,
+                     struct frame_frozen_fields *fields)
+{
+    fields->function = frame->function_name;
+    fields->file = frame->file_name;
+}
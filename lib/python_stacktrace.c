@@ -57,6 +57,8 @@ struct thread_methods python_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) sr_python_stacktrace_dup,
     .normalize = (normalize_fn_t) thread_no_normalization,
+    .normalized_frames =
+        (normalized_frames_fn_t) thread_no_normalized_frames,
 };
 
 struct stacktrace_methods python_stacktrace_methods =
@@ -81,7 +83,7 @@ struct sr_python_stacktrace *
 sr_python_stacktrace_new()
 {
     struct sr_python_stacktrace *stacktrace =
-        g_malloc(sizeof(*stacktrace));
+        arena_malloc(sizeof(*stacktrace));
 
     sr_python_stacktrace_init(stacktrace);
     return stacktrace;
@@ -107,8 +109,8 @@ sr_python_stacktrace_free(struct sr_python_stacktrace *stacktrace)
         sr_python_frame_free(frame);
     }
 
-    g_free(stacktrace->exception_name);
-    g_free(stacktrace);
+    arena_free(stacktrace->exception_name);
+    arena_free(stacktrace);
 }
 
 struct sr_python_stacktrace *
@@ -37,6 +37,12 @@ ruby_append_bthash_text(struct sr_ruby_frame *frame, enum sr_bthash_flags flags,
 static void
 ruby_append_duphash_text(struct sr_ruby_frame *frame, enum sr_duphash_flags flags,
                            GString *strbuf);
+static enum frame_symbol_kind
+ruby_symbol_key(struct sr_ruby_frame *frame, GString *key,
+                const char **qualifier);
+static void
+ruby_frozen_fields(struct sr_ruby_frame *frame,
+                   struct frame_frozen_fields *fields);
 
 DEFINE_NEXT_FUNC(ruby_next, struct sr_frame, struct sr_ruby_frame)
 DEFINE_SET_NEXT_FUNC(ruby_set_next, struct sr_frame, struct sr_ruby_frame)
@@ -53,6 +59,8 @@ struct frame_methods ruby_frame_methods =
     .frame_append_duphash_text =
         (frame_append_duphash_text_fn_t) ruby_append_duphash_text,
     .frame_free = (frame_free_fn_t) sr_ruby_frame_free,
+    .symbol_key = (frame_symbol_key_fn_t) ruby_symbol_key,
+    .frozen_fields = (frame_frozen_fields_fn_t) ruby_frozen_fields,
 };
 
 /* Public functions */
@@ -61,7 +69,7 @@ struct sr_ruby_frame *
 sr_ruby_frame_new()
 {
     struct sr_ruby_frame *frame =
-        g_malloc(sizeof(*frame));
+        arena_malloc(sizeof(*frame));
 
     sr_ruby_frame_init(frame);
     return frame;
@@ -80,9 +88,9 @@ sr_ruby_frame_free(struct sr_ruby_frame *frame)
     if (!frame)
         return;
 
-    g_free(frame->file_name);
-    g_free(frame->function_name);
-    g_free(frame);
+    sr_intern_free(frame->file_name);
+    sr_intern_free(frame->function_name);
+    arena_free(frame);
 }
 
 struct sr_ruby_frame *
@@ -102,27 +110,36 @@ sr_ruby_frame_dup(struct sr_ruby_frame *frame, bool siblings)
 
     /* Duplicate all strings. */
     if (result->file_name)
-        result->file_name = g_strdup(result->file_name);
+        result->file_name = sr_intern_strdup(result->file_name);
 
     if (result->function_name)
-        result->function_name = g_strdup(result->function_name);
+        result->function_name = sr_intern_strdup(result->function_name);
 
     return result;
 }
 
+/* Interns the strings of a parsed frame, see sr_intern_pool_enable(). */
+static struct sr_ruby_frame *
+ruby_frame_intern(struct sr_ruby_frame *frame)
+{
+    frame->file_name = intern_take(frame->file_name);
+    frame->function_name = intern_take(frame->function_name);
+    return frame;
+}
+
 int
 sr_ruby_frame_cmp(struct sr_ruby_frame *frame1,
                   struct sr_ruby_frame *frame2)
 {
     /* function_name */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* file_name */
-    int file_name = g_strcmp0(frame1->file_name,
-                               frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                    frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -154,14 +171,14 @@ sr_ruby_frame_cmp_distance(struct sr_ruby_frame *frame1,
                            struct sr_ruby_frame *frame2)
 {
     /* function_name */
-    int function_name = g_strcmp0(frame1->function_name,
-                                   frame2->function_name);
+    int function_name = intern_strcmp0(frame1->function_name,
+                                        frame2->function_name);
     if (function_name != 0)
         return function_name;
 
     /* file_name */
-    int file_name = g_strcmp0(frame1->file_name,
-                               frame2->file_name);
+    int file_name = intern_strcmp0(frame1->file_name,
+                                    frame2->file_name);
     if (file_name != 0)
         return file_name;
 
@@ -332,11 +349,11 @@ sr_ruby_frame_parse(const char **input,
     location->column++;
 
     *input = local_input;
-    return frame;
+    return ruby_frame_intern(frame);
 
 fail:
     sr_ruby_frame_free(frame);
-    g_free(filename_lineno_in);
+    arena_free(filename_lineno_in);
     return NULL;
 }
 
@@ -414,7 +431,7 @@ sr_ruby_frame_from_json(json_object *root, char **error_message)
 
         string = json_object_get_string(val);
 
-        result->file_name = g_strdup(string);
+        result->file_name = arena_strdup(string);
     }
 
     /* Function name / special function. */
@@ -428,7 +445,7 @@ sr_ruby_frame_from_json(json_object *root, char **error_message)
         string = json_object_get_string(val);
 
         result->special_function = false;
-        result->function_name = g_strdup(string);
+        result->function_name = arena_strdup(string);
     }
     else if (json_object_object_get_ex(root, "special_function", &val))
     {
@@ -440,7 +457,7 @@ sr_ruby_frame_from_json(json_object *root, char **error_message)
         string = json_object_get_string(val);
 
         result->special_function = true;
-        result->function_name = g_strdup(string);
+        result->function_name = arena_strdup(string);
     }
 
     bool success =
@@ -451,7 +468,7 @@ sr_ruby_frame_from_json(json_object *root, char **error_message)
     if (!success)
         goto fail;
 
-    return result;
+    return ruby_frame_intern(result);
 
 fail:
     sr_ruby_frame_free(result);
@@ -515,3 +532,21 @@ ruby_append_duphash_text(struct sr_ruby_frame *frame, enum sr_duphash_flags flag
                           OR_UNKNOWN(frame->file_name),
                           frame->file_line);
 }
+
+static enum frame_symbol_kind
+ruby_symbol_key(struct sr_ruby_frame *frame, GString *key,
+                const char **qualifier)
+{
+    symbol_key_append_str(key, frame->function_name);
+    symbol_key_append_str(key, frame->file_name);
+    symbol_key_append_int(key, frame->special_function);
+    return FRAME_SYMBOL_EXACT;
+}
+
+static void
+ruby_frozen_fields(struct sr_ruby_frame *frame,
+                   struct frame_frozen_fields *fields)
+{
+    fields->function = frame->function_name;
+    fields->file = frame->file_name;
+}
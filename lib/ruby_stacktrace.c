@@ -56,6 +56,8 @@ struct thread_methods ruby_thread_methods =
         (remove_frames_above_fn_t) thread_remove_frames_above,
     .thread_dup = (thread_dup_fn_t) sr_ruby_stacktrace_dup,
     .normalize = (normalize_fn_t) thread_no_normalization,
+    .normalized_frames =
+        (normalized_frames_fn_t) thread_no_normalized_frames,
 };
 
 struct stacktrace_methods ruby_stacktrace_methods =
@@ -80,7 +82,7 @@ struct sr_ruby_stacktrace *
 sr_ruby_stacktrace_new()
 {
     struct sr_ruby_stacktrace *stacktrace =
-        g_malloc(sizeof(*stacktrace));
+        arena_malloc(sizeof(*stacktrace));
 
     sr_ruby_stacktrace_init(stacktrace);
     return stacktrace;
@@ -106,8 +108,8 @@ sr_ruby_stacktrace_free(struct sr_ruby_stacktrace *stacktrace)
         sr_ruby_frame_free(frame);
     }
 
-    g_free(stacktrace->exception_name);
-    g_free(stacktrace);
+    arena_free(stacktrace->exception_name);
+    arena_free(stacktrace);
 }
 
 struct sr_ruby_stacktrace *
@@ -205,7 +207,7 @@ sr_ruby_stacktrace_parse(const char **input,
                                       "the beginning of the exception class");
         goto fail;
     }
-    stacktrace->exception_name = g_strdup(p);
+    stacktrace->exception_name = arena_strdup(p);
 
     /* /some/thing.rb:13:in `method': exception message (Exception::Class)\n\tfrom ...
      *                                                  ^
@@ -219,7 +221,7 @@ sr_ruby_stacktrace_parse(const char **input,
     }
 
     /* Throw away the message, it may contain sensitive data. */
-    g_free(message_and_class);
+    arena_free(message_and_class);
     message_and_class = p = NULL;
 
     /* /some/thing.rb:13:in `method': exception message (Exception::Class)\n\tfrom ...
@@ -265,7 +267,7 @@ sr_ruby_stacktrace_parse(const char **input,
 
 fail:
     sr_ruby_stacktrace_free(stacktrace);
-    g_free(message_and_class);
+    arena_free(message_and_class);
     return NULL;
 }
 
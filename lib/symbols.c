@@ -0,0 +1,475 @@
+/*
+    symbols.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "symbols.h"
+#include "frame.h"
+#include "thread.h"
+#include "generic_frame.h"
+#include "frozen.h"
+#include "internal_utils.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SYMBOLS_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/* Marks a symbol which turned out not to identify the frames it was
+ * assigned to, see symbol_set_new(). */
+#define SYMBOL_AMBIGUOUS UINT32_MAX
+
+/* All frames sharing the same key. */
+struct symbol_key_entry
+{
+    /* Symbol of the frames without a qualifier, or SYMBOL_UNKNOWN. */
+    uint32_t wildcard;
+    /* Symbol of the first qualified variant of the key. */
+    uint32_t qualified;
+    /* Number of distinct qualifiers seen with the key. */
+    unsigned qualified_count;
+};
+
+void
+symbol_key_append_str(GString *key, const char *str)
+{
+    if (str)
+        g_string_append_printf(key, "%zu:%s", strlen(str), str);
+    else
+        g_string_append_c(key, '-');
+}
+
+void
+symbol_key_append_int(GString *key, int64_t value)
+{
+    g_string_append_printf(key, "%" PRId64 ";", value);
+}
+
+static uint32_t
+symbol_set_intern(GHashTable *keys, GHashTable *qualified,
+                  GString *key, const char *qualifier, uint32_t *next_symbol)
+{
+    struct symbol_key_entry *entry = g_hash_table_lookup(keys, key->str);
+    if (!entry)
+    {
+        entry = g_malloc0(sizeof(*entry));
+        g_hash_table_insert(keys, g_strdup(key->str), entry);
+    }
+
+    if (!qualifier)
+    {
+        if (entry->wildcard == SYMBOL_UNKNOWN)
+            entry->wildcard = (*next_symbol)++;
+
+        return entry->wildcard;
+    }
+
+    symbol_key_append_str(key, qualifier);
+
+    gpointer symbol;
+    if (g_hash_table_lookup_extended(qualified, key->str, NULL, &symbol))
+        return GPOINTER_TO_UINT(symbol);
+
+    uint32_t new_symbol = (*next_symbol)++;
+    g_hash_table_insert(qualified, g_strdup(key->str),
+                        GUINT_TO_POINTER(new_symbol));
+
+    if (entry->qualified_count++ == 0)
+        entry->qualified = new_symbol;
+
+    return new_symbol;
+}
+
+static int
+symbol_cmp(const void *symbol1, const void *symbol2)
+{
+    uint32_t s1 = *(const uint32_t *)symbol1, s2 = *(const uint32_t *)symbol2;
+
+    return (s1 > s2) - (s1 < s2);
+}
+
+void
+symbol_thread_sort_distinct(struct symbol_thread *thread, uint32_t *storage)
+{
+    int count = 0, distinct_count = 0;
+
+    for (int i = 0; i < thread->length; i++)
+    {
+        if (thread->symbols[i] != SYMBOL_UNKNOWN)
+            storage[count++] = thread->symbols[i];
+    }
+
+    qsort(storage, count, sizeof(*storage), symbol_cmp);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (distinct_count == 0 || storage[distinct_count - 1] != storage[i])
+            storage[distinct_count++] = storage[i];
+    }
+
+    thread->distinct = storage;
+    thread->distinct_count = distinct_count;
+    thread->unknown_count = thread->length - count;
+}
+
+static int
+symbols_intersection_size_scalar(const uint32_t *symbols1, int count1,
+                                 const uint32_t *symbols2, int count2)
+{
+    int i = 0, j = 0, size = 0;
+
+    while (i < count1 && j < count2)
+    {
+        if (symbols1[i] < symbols2[j])
+            i++;
+        else if (symbols1[i] > symbols2[j])
+            j++;
+        else
+        {
+            size++;
+            i++;
+            j++;
+        }
+    }
+
+    return size;
+}
+
+#ifdef SYMBOLS_X86_SIMD
+/* The vector kernels compare a block of each array with all rotations of
+ * the other block and advance the block(s) with the smaller last symbol.
+ * Every pair of blocks is compared at most once, so a common symbol is
+ * counted exactly once. The rest is left to the scalar merge. */
+
+__attribute__((target("sse4.2,popcnt")))
+static int
+symbols_intersection_size_sse42(const uint32_t *symbols1, int count1,
+                                const uint32_t *symbols2, int count2)
+{
+    int i = 0, j = 0, size = 0;
+
+    while (i + 4 <= count1 && j + 4 <= count2)
+    {
+        __m128i block1 = _mm_loadu_si128((const __m128i *)(symbols1 + i));
+        __m128i block2 = _mm_loadu_si128((const __m128i *)(symbols2 + j));
+        __m128i equal = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(block1, block2),
+                         _mm_cmpeq_epi32(block1,
+                                         _mm_shuffle_epi32(block2, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(block1,
+                                         _mm_shuffle_epi32(block2, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(block1,
+                                         _mm_shuffle_epi32(block2, _MM_SHUFFLE(2, 1, 0, 3)))));
+
+        size += _mm_popcnt_u32(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+
+        uint32_t last1 = symbols1[i + 3], last2 = symbols2[j + 3];
+        if (last1 <= last2)
+            i += 4;
+        if (last2 <= last1)
+            j += 4;
+    }
+
+    return size + symbols_intersection_size_scalar(symbols1 + i, count1 - i,
+                                                   symbols2 + j, count2 - j);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int
+symbols_intersection_size_avx2(const uint32_t *symbols1, int count1,
+                               const uint32_t *symbols2, int count2)
+{
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    int i = 0, j = 0, size = 0;
+
+    while (i + 8 <= count1 && j + 8 <= count2)
+    {
+        __m256i block1 = _mm256_loadu_si256((const __m256i *)(symbols1 + i));
+        __m256i block2 = _mm256_loadu_si256((const __m256i *)(symbols2 + j));
+        __m256i equal = _mm256_cmpeq_epi32(block1, block2);
+
+        for (int k = 1; k < 8; k++)
+        {
+            block2 = _mm256_permutevar8x32_epi32(block2, rotate);
+            equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(block1, block2));
+        }
+
+        size += _mm_popcnt_u32(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+
+        uint32_t last1 = symbols1[i + 7], last2 = symbols2[j + 7];
+        if (last1 <= last2)
+            i += 8;
+        if (last2 <= last1)
+            j += 8;
+    }
+
+    return size + symbols_intersection_size_sse42(symbols1 + i, count1 - i,
+                                                  symbols2 + j, count2 - j);
+}
+#endif
+
+int
+symbols_intersection_size(const uint32_t *symbols1, int count1,
+                          const uint32_t *symbols2, int count2)
+{
+#ifdef SYMBOLS_X86_SIMD
+    if (__builtin_cpu_supports("popcnt"))
+    {
+        if (__builtin_cpu_supports("avx2"))
+            return symbols_intersection_size_avx2(symbols1, count1,
+                                                  symbols2, count2);
+
+        if (__builtin_cpu_supports("sse4.2"))
+            return symbols_intersection_size_sse42(symbols1, count1,
+                                                   symbols2, count2);
+    }
+#endif
+
+    return symbols_intersection_size_scalar(symbols1, count1,
+                                            symbols2, count2);
+}
+
+/* State of symbol_set_new() and symbol_set_new_frozen(). */
+struct symbol_set_builder
+{
+    struct symbol_set *set;
+    /* Key -> struct symbol_key_entry. */
+    GHashTable *keys;
+    /* Key and qualifier -> symbol. */
+    GHashTable *qualified;
+    GString *key;
+    uint32_t next_symbol;
+    size_t position;
+};
+
+static void
+symbol_set_builder_init(struct symbol_set_builder *builder,
+                        int count, size_t total)
+{
+    struct symbol_set *set = g_malloc(sizeof(*set));
+
+    set->count = count;
+    set->threads = g_malloc0_n(count > 0 ? count : 1, sizeof(*set->threads));
+    set->storage = g_malloc_n(total > 0 ? total : 1, sizeof(*set->storage));
+    set->distinct_storage = g_malloc_n(total > 0 ? total : 1,
+                                       sizeof(*set->distinct_storage));
+
+    builder->set = set;
+    builder->keys = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                          g_free, g_free);
+    builder->qualified = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                               g_free, NULL);
+    builder->key = g_string_new(NULL);
+    builder->next_symbol = SYMBOL_UNKNOWN + 1;
+    builder->position = 0;
+}
+
+/* Starts the next thread of the set, its frames are added by
+ * symbol_set_builder_add(). */
+static struct symbol_thread *
+symbol_set_builder_thread(struct symbol_set_builder *builder, int index,
+                          enum sr_report_type type)
+{
+    struct symbol_thread *thread = &builder->set->threads[index];
+
+    if (index > 0)
+        builder->position += builder->set->threads[index - 1].length;
+
+    thread->type = type;
+    thread->exact = true;
+    thread->has_unknown = false;
+    thread->length = 0;
+    thread->symbols = builder->set->storage + builder->position;
+
+    return thread;
+}
+
+/* Starts the key of the next frame, the frame method appends the rest. */
+static GString *
+symbol_set_builder_key(struct symbol_set_builder *builder,
+                       enum sr_report_type type)
+{
+    g_string_truncate(builder->key, 0);
+    /* Frames of different types are never compared. */
+    symbol_key_append_int(builder->key, type);
+
+    return builder->key;
+}
+
+static void
+symbol_set_builder_add(struct symbol_set_builder *builder,
+                       struct symbol_thread *thread,
+                       enum frame_symbol_kind kind,
+                       const char *qualifier)
+{
+    uint32_t symbol = SYMBOL_UNKNOWN;
+
+    switch (kind)
+    {
+    case FRAME_SYMBOL_EXACT:
+        symbol = symbol_set_intern(builder->keys, builder->qualified,
+                                   builder->key, qualifier,
+                                   &builder->next_symbol);
+        break;
+    case FRAME_SYMBOL_UNKNOWN:
+        thread->has_unknown = true;
+        break;
+    case FRAME_SYMBOL_NONE:
+        thread->exact = false;
+        break;
+    }
+
+    thread->symbols[thread->length++] = symbol;
+}
+
+static struct symbol_set *
+symbol_set_builder_finish(struct symbol_set_builder *builder)
+{
+    struct symbol_set *set = builder->set;
+    uint32_t next_symbol = builder->next_symbol;
+
+    /* A frame without a qualifier equals all frames with the same key.
+     * That is only expressible by a single symbol if the key has been
+     * seen with at most one qualifier. */
+    SR_ASSERT(next_symbol < SYMBOL_AMBIGUOUS);
+    uint32_t *remap = g_malloc_n(next_symbol, sizeof(*remap));
+    for (uint32_t symbol = 0; symbol < next_symbol; symbol++)
+        remap[symbol] = symbol;
+
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, builder->keys);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        struct symbol_key_entry *entry = value;
+
+        if (entry->wildcard == SYMBOL_UNKNOWN || entry->qualified_count == 0)
+            continue;
+
+        remap[entry->wildcard] = entry->qualified_count == 1
+                                 ? entry->qualified
+                                 : SYMBOL_AMBIGUOUS;
+    }
+
+    for (int i = 0; i < set->count; i++)
+    {
+        struct symbol_thread *thread = &set->threads[i];
+
+        for (int j = 0; j < thread->length; j++)
+        {
+            thread->symbols[j] = remap[thread->symbols[j]];
+            if (thread->symbols[j] == SYMBOL_AMBIGUOUS)
+                thread->exact = false;
+        }
+
+        symbol_thread_sort_distinct(thread, set->distinct_storage +
+                                    (thread->symbols - set->storage));
+    }
+
+    set->symbol_count = next_symbol;
+
+    g_free(remap);
+    g_string_free(builder->key, TRUE);
+    g_hash_table_destroy(builder->qualified);
+    g_hash_table_destroy(builder->keys);
+
+    return set;
+}
+
+struct symbol_set *
+symbol_set_new(struct sr_thread **threads, int count)
+{
+    struct symbol_set_builder builder;
+    size_t total = 0;
+
+    for (int i = 0; i < count; i++)
+        total += sr_thread_frame_count(threads[i]);
+
+    symbol_set_builder_init(&builder, count, total);
+
+    for (int i = 0; i < count; i++)
+    {
+        struct symbol_thread *thread =
+            symbol_set_builder_thread(&builder, i, threads[i]->type);
+
+        for (struct sr_frame *frame = sr_thread_frames(threads[i]);
+             frame;
+             frame = sr_frame_next(frame))
+        {
+            GString *key = symbol_set_builder_key(&builder, frame->type);
+            const char *qualifier = NULL;
+            enum frame_symbol_kind kind = frame_symbol_key(frame, key,
+                                                           &qualifier);
+
+            symbol_set_builder_add(&builder, thread, kind, qualifier);
+        }
+    }
+
+    return symbol_set_builder_finish(&builder);
+}
+
+struct symbol_set *
+symbol_set_new_frozen(struct sr_frozen_thread **threads, int count)
+{
+    struct symbol_set_builder builder;
+    size_t total = 0;
+
+    for (int i = 0; i < count; i++)
+        total += threads[i]->frame_count;
+
+    symbol_set_builder_init(&builder, count, total);
+
+    for (int i = 0; i < count; i++)
+    {
+        struct sr_frozen_thread *frozen = threads[i];
+        struct symbol_thread *thread =
+            symbol_set_builder_thread(&builder, i, frozen->type);
+        const uint8_t *kinds = frozen_column(frozen, FROZEN_SYMBOL_KIND);
+
+        for (int j = 0; j < frozen->frame_count; j++)
+        {
+            GString *key = symbol_set_builder_key(&builder, frozen->type);
+            const char *stored_key =
+                frozen_frame_string(frozen, FROZEN_SYMBOL_KEY, j);
+
+            if (stored_key)
+                g_string_append(key, stored_key);
+
+            symbol_set_builder_add(&builder, thread, kinds[j],
+                                   frozen_frame_string(frozen,
+                                                       FROZEN_SYMBOL_QUALIFIER,
+                                                       j));
+        }
+    }
+
+    return symbol_set_builder_finish(&builder);
+}
+
+void
+symbol_set_free(struct symbol_set *set)
+{
+    if (!set)
+        return;
+
+    g_free(set->distinct_storage);
+    g_free(set->storage);
+    g_free(set->threads);
+    g_free(set);
+}
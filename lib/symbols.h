@@ -0,0 +1,124 @@
+/*
+    symbols.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_SYMBOLS_H
+#define SATYR_SYMBOLS_H
+
+/* Interned frame symbols.
+ *
+ * The distance functions only ever ask whether two frames are equal
+ * according to sr_frame_cmp_distance().  Instead of dispatching and
+ * comparing strings for every pair of frames, each frame of a thread
+ * set is mapped to a 32-bit symbol so that two frames compare equal
+ * exactly when their symbols are equal.
+ */
+
+#include "report_type.h"
+#include <glib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct sr_frame;
+struct sr_thread;
+struct sr_frozen_thread;
+
+/* Reserved symbol of frames that never match any frame, not even
+ * another frame with the same symbol (e.g. the "??" GDB frames). */
+#define SYMBOL_UNKNOWN 0
+
+static inline bool
+symbol_eq(uint32_t symbol1, uint32_t symbol2)
+{
+    return symbol1 == symbol2 && symbol1 != SYMBOL_UNKNOWN;
+}
+
+/* How a frame maps to a symbol, returned by the symbol_key frame method. */
+enum frame_symbol_kind
+{
+    /* The key (and the optional qualifier) identify the frame. */
+    FRAME_SYMBOL_EXACT,
+    /* The frame is unequal to every frame; it gets SYMBOL_UNKNOWN. */
+    FRAME_SYMBOL_UNKNOWN,
+    /* Equality of this frame cannot be expressed by a key. */
+    FRAME_SYMBOL_NONE
+};
+
+/* Helpers for the symbol_key frame methods, they append the field so
+ * that distinct sequences of fields always produce distinct keys. */
+void
+symbol_key_append_str(GString *key, const char *str);
+
+void
+symbol_key_append_int(GString *key, int64_t value);
+
+/* Symbols of a single thread. */
+struct symbol_thread
+{
+    enum sr_report_type type;
+    /* False if some frame of the thread has no symbol, the thread must
+     * be compared the usual way then. */
+    bool exact;
+    /* The thread contains SYMBOL_UNKNOWN frames. */
+    bool has_unknown;
+    int length;
+    uint32_t *symbols;
+    /* The distinct symbols of the thread other than SYMBOL_UNKNOWN,
+     * sorted in ascending order, see symbol_thread_sort_distinct(). */
+    uint32_t *distinct;
+    int distinct_count;
+    /* Number of SYMBOL_UNKNOWN frames. */
+    int unknown_count;
+};
+
+/* Fills the distinct symbols of the thread, the storage must have room
+ * for the symbols of all the frames. */
+void
+symbol_thread_sort_distinct(struct symbol_thread *thread, uint32_t *storage);
+
+/* Returns the number of symbols present in both sorted arrays of
+ * distinct symbols. Uses SIMD instructions if the CPU supports them. */
+int
+symbols_intersection_size(const uint32_t *symbols1, int count1,
+                          const uint32_t *symbols2, int count2);
+
+/* Symbols of a set of threads, interned in a shared table. Only threads
+ * from the same set can be compared by their symbols. */
+struct symbol_set
+{
+    int count;
+    /* All symbols of the set are smaller than this number. */
+    uint32_t symbol_count;
+    struct symbol_thread *threads;
+    /* Storage for the symbols of all threads. */
+    uint32_t *storage;
+    /* Storage for the distinct symbols of all threads. */
+    uint32_t *distinct_storage;
+};
+
+struct symbol_set *
+symbol_set_new(struct sr_thread **threads, int count);
+
+/* The same for frozen threads, using the symbol keys stored in them. */
+struct symbol_set *
+symbol_set_new_frozen(struct sr_frozen_thread **threads, int count);
+
+void
+symbol_set_free(struct symbol_set *set);
+
+#endif
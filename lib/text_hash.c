@@ -0,0 +1,192 @@
+/*
+    text_hash.c
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "internal_utils.h"
+#include <inttypes.h>
+#include <string.h>
+
+/* The fast hash is MurmurHash3 x64_128 with the seed 0, computed
+ * incrementally. */
+#define MURMUR_C1 UINT64_C(0x87c37b91114253d5)
+#define MURMUR_C2 UINT64_C(0x4cf5ad432745937f)
+
+static inline uint64_t
+rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t
+load64(const unsigned char *p)
+{
+    uint64_t result = 0;
+
+    for (int i = 7; i >= 0; i--)
+        result = (result << 8) | p[i];
+
+    return result;
+}
+
+static inline uint64_t
+fmix64(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= UINT64_C(0xff51afd7ed558ccd);
+    k ^= k >> 33;
+    k *= UINT64_C(0xc4ceb9fe1a85ec53);
+    k ^= k >> 33;
+    return k;
+}
+
+static void
+murmur_block(struct text_hash *hash, const unsigned char *block)
+{
+    uint64_t k1 = load64(block);
+    uint64_t k2 = load64(block + 8);
+
+    k1 *= MURMUR_C1;
+    k1 = rotl64(k1, 31);
+    k1 *= MURMUR_C2;
+    hash->h1 ^= k1;
+
+    hash->h1 = rotl64(hash->h1, 27);
+    hash->h1 += hash->h2;
+    hash->h1 = hash->h1 * 5 + 0x52dce729;
+
+    k2 *= MURMUR_C2;
+    k2 = rotl64(k2, 33);
+    k2 *= MURMUR_C1;
+    hash->h2 ^= k2;
+
+    hash->h2 = rotl64(hash->h2, 31);
+    hash->h2 += hash->h1;
+    hash->h2 = hash->h2 * 5 + 0x38495ab5;
+}
+
+static char *
+murmur_finish(struct text_hash *hash)
+{
+    uint64_t k1 = 0, k2 = 0;
+    const unsigned char *tail = hash->block;
+
+    for (int i = hash->block_used - 1; i >= 8; i--)
+        k2 = (k2 << 8) | tail[i];
+
+    for (int i = MIN(hash->block_used, 8) - 1; i >= 0; i--)
+        k1 = (k1 << 8) | tail[i];
+
+    if (hash->block_used > 8)
+    {
+        k2 *= MURMUR_C2;
+        k2 = rotl64(k2, 33);
+        k2 *= MURMUR_C1;
+        hash->h2 ^= k2;
+    }
+
+    if (hash->block_used > 0)
+    {
+        k1 *= MURMUR_C1;
+        k1 = rotl64(k1, 31);
+        k1 *= MURMUR_C2;
+        hash->h1 ^= k1;
+    }
+
+    uint64_t h1 = hash->h1 ^ hash->length;
+    uint64_t h2 = hash->h2 ^ hash->length;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    return g_strdup_printf("%016"PRIx64"%016"PRIx64, h1, h2);
+}
+
+void
+text_hash_init(struct text_hash *hash, bool fast)
+{
+    memset(hash, 0, sizeof(*hash));
+
+    if (!fast)
+        hash->checksum = g_checksum_new(G_CHECKSUM_SHA1);
+}
+
+void
+text_hash_update(struct text_hash *hash, const char *text, size_t length)
+{
+    if (hash->checksum)
+    {
+        g_checksum_update(hash->checksum, (const guchar *)text, length);
+        return;
+    }
+
+    const unsigned char *data = (const unsigned char *)text;
+    hash->length += length;
+
+    /* Complete the block left from the previous update. */
+    if (hash->block_used > 0)
+    {
+        size_t missing = MIN(sizeof(hash->block) - hash->block_used, length);
+        memcpy(hash->block + hash->block_used, data, missing);
+        hash->block_used += missing;
+        data += missing;
+        length -= missing;
+
+        if (hash->block_used < sizeof(hash->block))
+            return;
+
+        murmur_block(hash, hash->block);
+        hash->block_used = 0;
+    }
+
+    for (; length >= sizeof(hash->block); length -= sizeof(hash->block))
+    {
+        murmur_block(hash, data);
+        data += sizeof(hash->block);
+    }
+
+    memcpy(hash->block, data, length);
+    hash->block_used = length;
+}
+
+char *
+text_hash_finish(struct text_hash *hash)
+{
+    if (!hash->checksum)
+        return murmur_finish(hash);
+
+    char *result = g_strdup(g_checksum_get_string(hash->checksum));
+    g_checksum_free(hash->checksum);
+    hash->checksum = NULL;
+    return result;
+}
+
+void
+text_hash_flush(struct text_hash *hash, GString *strbuf)
+{
+    if (!hash || strbuf->len == 0)
+        return;
+
+    text_hash_update(hash, strbuf->str, strbuf->len);
+    g_string_truncate(strbuf, 0);
+}
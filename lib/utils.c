@@ -19,12 +19,14 @@
 */
 #include "utils.h"
 #include "location.h"
+#include "internal_utils.h"
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
 #include <regex.h>
 #include <limits.h>
 #include <sys/types.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -203,6 +205,124 @@ sr_file_to_string(const char *filename,
     return contents;
 }
 
+/* Size of the memory sr_file_map() maps for a file of the given size.  At
+ * least one byte follows the file to terminate the contents. */
+static size_t
+file_map_length(size_t size)
+{
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    return (size / page_size + 1) * page_size;
+}
+
+const char *
+sr_file_map(const char *filename,
+            size_t *size,
+            char **error_message)
+{
+    int fd = open(filename, O_RDONLY | O_LARGEFILE);
+    if (fd < 0)
+    {
+        *error_message = g_strdup_printf("Unable to open '%s': %s.",
+                                     filename,
+                                     strerror(errno));
+
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        *error_message = g_strdup_printf("Unable to stat '%s': %s.",
+                                     filename,
+                                     strerror(errno));
+
+        close(fd);
+        return NULL;
+    }
+
+    if (!S_ISREG(st.st_mode))
+    {
+        *error_message = g_strdup_printf("'%s' is not a regular file.",
+                                     filename);
+
+        close(fd);
+        return NULL;
+    }
+
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    if ((uintmax_t)st.st_size > SIZE_MAX - page_size)
+    {
+        *error_message = g_strdup_printf("Input file too big (%lld).",
+                                     (long long)st.st_size);
+
+        close(fd);
+        return NULL;
+    }
+
+    /* The whole pages of the file are mapped over anonymous memory.  The
+     * rest of the file is copied after them, so that the contents are
+     * terminated by the zeroes of the anonymous memory even if the file
+     * grows meanwhile. */
+    size_t length = file_map_length(st.st_size);
+    size_t mapped = st.st_size - st.st_size % page_size;
+
+    char *contents = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (contents == MAP_FAILED)
+    {
+        *error_message = g_strdup_printf("Unable to map '%s': %s.",
+                                     filename,
+                                     strerror(errno));
+
+        close(fd);
+        return NULL;
+    }
+
+    if (mapped > 0 &&
+        mmap(contents, mapped, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0)
+        == MAP_FAILED)
+    {
+        *error_message = g_strdup_printf("Unable to map '%s': %s.",
+                                     filename,
+                                     strerror(errno));
+
+        munmap(contents, length);
+        close(fd);
+        return NULL;
+    }
+
+    size_t rest = st.st_size - mapped;
+    if (rest > 0 && pread(fd, contents + mapped, rest, mapped) != (ssize_t)rest)
+    {
+        *error_message = g_strdup_printf("Unable to read from '%s'.", filename);
+        munmap(contents, length);
+        close(fd);
+        return NULL;
+    }
+
+    /* Just reading, so no need to check the returned value. */
+    close(fd);
+
+    mprotect(contents + mapped, length - mapped, PROT_READ);
+
+    /* The parsers read the contents from the start to the end. */
+    if (mapped > 0)
+        madvise(contents, mapped, MADV_SEQUENTIAL);
+
+    *size = st.st_size;
+    return contents;
+}
+
+void
+sr_file_unmap(const char *contents,
+              size_t size)
+{
+    if (!contents)
+        return;
+
+    munmap((void *)contents, file_map_length(size));
+}
+
 bool
 sr_string_to_file(const char *filename,
                   char *contents,
@@ -319,7 +439,7 @@ sr_parse_char_span(const char **input, const char *accept, char **result)
     size_t count = strspn(*input, accept);
     if (count == 0)
         return 0;
-    *result = g_strndup(*input, count);
+    *result = arena_strndup(*input, count);
     *input += count;
     return count;
 }
@@ -340,7 +460,7 @@ sr_parse_char_cspan(const char **input, const char *reject, char **result)
     size_t count = strcspn(*input, reject);
     if (count == 0)
         return false;
-    *result = g_strndup(*input, count);
+    *result = arena_strndup(*input, count);
     *input += count;
     return true;
 }
@@ -374,7 +494,7 @@ sr_parse_string(const char **input, const char *string, char **result)
     }
     if (*local_string != '\0')
         return false;
-    *result = g_strndup(string, local_input - *input);
+    *result = arena_strndup(string, local_input - *input);
     *input = local_input;
     return true;
 }
@@ -413,7 +533,7 @@ sr_parse_uint32(const char **input, uint32_t *result)
     bool failure = (errno || numstr == endptr || *endptr != '\0'
                     || r > UINT32_MAX);
 
-    g_free(numstr);
+    arena_free(numstr);
     if (failure) /* number too big or some other error */
         return 0;
 
@@ -438,7 +558,7 @@ sr_parse_uint64(const char **input, uint64_t *result)
     unsigned long long result_tmp = strtoull(numstr, &endptr, 10);
     bool failure = (errno || numstr == endptr || *endptr != '\0'
                     || result_tmp == UINT64_MAX);
-    g_free(numstr);
+    arena_free(numstr);
     if (failure) /* number too big or some other error */
         return 0;
     *result = result_tmp;
@@ -487,7 +607,7 @@ sr_parse_hexadecimal_uint64(const char **input, uint64_t *result)
     errno = 0;
     unsigned long long r = strtoull(numstr, &endptr, 16);
     bool failure = (errno || numstr == endptr || *endptr != '\0');
-    g_free(numstr);
+    arena_free(numstr);
     if (failure) /* number too big or some other error */
         return 0;
 
@@ -739,8 +859,8 @@ anonymize_path(char *orig_path)
         if (new_path)
         {
             // Join /home/anonymized/ and ^
-            new_path = g_strdup_printf("%s%s", ANONYMIZED_PATH, new_path);
-            g_free(orig_path);
+            new_path = arena_strdup_printf("%s%s", ANONYMIZED_PATH, new_path);
+            sr_intern_free(orig_path);
             return new_path;
         }
     }
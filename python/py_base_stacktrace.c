@@ -33,7 +33,7 @@
 
 #define get_bthash_doc "Usage: stacktrace.get_bthash([flags])\n\n" \
                        "Returns: string - hash of the stacktrace\n\n" \
-                       "flags: integer - bitwise sum of flags (BTHASH_NORMAL, BTHASH_NOHASH)"
+                       "flags: integer - bitwise sum of flags (BTHASH_NORMAL, BTHASH_NOHASH, BTHASH_FAST)"
 
 #define from_json_doc "Usage: SomeStacktrace.from_json(json_string) (class method)\n\n" \
                       "Returns: stacktrace (of SomeStacktrace class) deserialized from json_string\n\n" \
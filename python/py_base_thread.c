@@ -31,14 +31,24 @@
 #define distance_doc "Usage: thread.distance(other, dist_type=DISTANCE_LEVENSHTEIN)\n\n"\
                      "other: other thread\n\n"\
                      "dist_type (optional): one of DISTANCE_LEVENSHTEIN, DISTANCE_JARO_WINKLER, "\
-                     "DISTANCE_JACCARD or DISTANCE_DAMERAU_LEVENSHTEIN\n\n"\
+                     "DISTANCE_JACCARD, DISTANCE_DAMERAU_LEVENSHTEIN or DISTANCE_JARO_WINKLER_COMPAT\n\n"\
                      "Returns: positive float - distance between the two threads"
 
+#define nearest_doc "Usage: thread.nearest(corpus, k=10, dist_type=DISTANCE_LEVENSHTEIN, nthreads=1)\n\n"\
+                    "corpus: list of threads of the same type as this thread\n\n"\
+                    "k (optional): maximal number of threads to find\n\n"\
+                    "dist_type (optional): one of DISTANCE_LEVENSHTEIN, DISTANCE_JARO_WINKLER, "\
+                    "DISTANCE_JACCARD, DISTANCE_DAMERAU_LEVENSHTEIN or DISTANCE_JARO_WINKLER_COMPAT\n\n"\
+                    "nthreads (optional): number of threads to scan the corpus in, "\
+                    "0 means the number of processors\n\n"\
+                    "Returns: list of (index, distance) tuples of the k threads of the corpus "\
+                    "nearest to this thread, starting with the nearest one"
+
 #define get_duphash_doc "Usage: thread.get_duphash(frames=0, flags=DUPHASH_NORMAL, prefix='')\n\n"\
                         "Returns: string - thread's duplication hash\n\n"\
                         "frames: integer - number of frames to use (default 0 means use all)\n\n"\
                         "flags: integer - bitwise sum of flags (DUPHASH_NORMAL, DUPHASH_NOHASH, \n"\
-                        "DUPHASH_NONORMALIZE, DUPHASH_KOOPS_COMPAT)\n\n"\
+                        "DUPHASH_NONORMALIZE, DUPHASH_KOOPS_COMPAT, DUPHASH_FAST)\n\n"\
                         "prefix: string - string to be prepended in front of the text before hashing"
 
 #define equals_doc "Usage: frame.equals(otherthread)\n\n" \
@@ -49,6 +59,7 @@ thread_methods[] =
 {
     /* methods */
     { "distance",    (PyCFunction)sr_py_base_thread_distance,    METH_VARARGS|METH_KEYWORDS, distance_doc    },
+    { "nearest",     (PyCFunction)sr_py_base_thread_nearest,     METH_VARARGS|METH_KEYWORDS, nearest_doc     },
     { "get_duphash", (PyCFunction)sr_py_base_thread_get_duphash, METH_VARARGS|METH_KEYWORDS, get_duphash_doc },
     { "equals",      sr_py_base_thread_equals,                   METH_VARARGS,               equals_doc      },
     { NULL },
@@ -257,6 +268,96 @@ sr_py_base_thread_distance(PyObject *self, PyObject *args, PyObject *kwds)
     return PyFloat_FromDouble((double)dist);
 }
 
+PyObject *
+sr_py_base_thread_nearest(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    PyObject *corpus_list;
+    int k = 10;
+    int dist_type = SR_DISTANCE_LEVENSHTEIN;
+    int nthreads = 1;
+    static const char *kwlist[] = { "corpus", "k", "dist_type", "nthreads", NULL };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|iii", (char **)kwlist,
+                                     &PyList_Type, &corpus_list, &k,
+                                     &dist_type, &nthreads))
+        return NULL;
+
+    if (k < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Number of threads to find must not be negative");
+        return NULL;
+    }
+
+    if (dist_type < 0 || dist_type >= SR_DISTANCE_NUM)
+    {
+        PyErr_SetString(PyExc_ValueError, "Invalid distance type");
+        return NULL;
+    }
+
+    if (nthreads < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Number of threads must not be negative");
+        return NULL;
+    }
+
+    struct sr_py_base_thread *this = (struct sr_py_base_thread *)self;
+    if (frames_prepare_linked_list(this) < 0)
+        return NULL;
+
+    int ncorpus = PyList_Size(corpus_list);
+    struct sr_thread **corpus = g_malloc_n(ncorpus + 1, sizeof(*corpus));
+
+    for (int i = 0; i < ncorpus; i++)
+    {
+        PyObject *obj = PyList_GetItem(corpus_list, i);
+        if (Py_TYPE(obj) != Py_TYPE(self))
+        {
+            PyErr_SetString(PyExc_TypeError, "All threads in the corpus must have the same type as the thread");
+            g_free(corpus);
+            return NULL;
+        }
+
+        struct sr_py_base_thread *to = (struct sr_py_base_thread *)obj;
+        if (frames_prepare_linked_list(to) < 0)
+        {
+            g_free(corpus);
+            return NULL;
+        }
+
+        corpus[i] = to->thread;
+    }
+
+    struct sr_thread_neighbor *neighbors = g_malloc_n(MIN(k, ncorpus) + 1,
+                                                      sizeof(*neighbors));
+    int count = sr_threads_nearest_parallel(this->thread, corpus, ncorpus,
+                                            dist_type, k, neighbors, nthreads);
+    g_free(corpus);
+
+    PyObject *result = PyList_New(count);
+    if (!result)
+    {
+        g_free(neighbors);
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        PyObject *item = Py_BuildValue("(if)", neighbors[i].index,
+                                       (double)neighbors[i].distance);
+        if (!item)
+        {
+            Py_DECREF(result);
+            g_free(neighbors);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(result, i, item);
+    }
+
+    g_free(neighbors);
+    return result;
+}
+
 PyObject *
 sr_py_base_thread_get_duphash(PyObject *self, PyObject *args, PyObject *kwds)
 {
@@ -285,3 +386,85 @@ sr_py_base_thread_get_duphash(PyObject *self, PyObject *args, PyObject *kwds)
     g_free(hash);
     return result;
 }
+
+PyObject *
+sr_py_threads_get_duphash(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    PyObject *thread_list;
+    const char *prefix = NULL;
+    int frames = 0, flags = 0, nthreads = 0;
+
+    static const char *kwlist[] = { "threads", "frames", "flags", "prefix",
+                                    "nthreads", NULL };
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|iisi", (char **)kwlist,
+                                     &PyList_Type, &thread_list, &frames,
+                                     &flags, &prefix, &nthreads))
+        return NULL;
+
+    if (nthreads < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Number of threads must not be negative");
+        return NULL;
+    }
+
+    int n = PyList_Size(thread_list);
+    struct sr_thread **threads = g_malloc_n(n + 1, sizeof(*threads));
+
+    for (int i = 0; i < n; i++)
+    {
+        PyObject *obj = PyList_GetItem(thread_list, i);
+        if (!PyObject_TypeCheck(obj, &sr_py_base_thread_type))
+        {
+            PyErr_SetString(PyExc_TypeError, "Must be a list of satyr.BaseThread objects");
+            g_free(threads);
+            return NULL;
+        }
+
+        struct sr_py_base_thread *to = (struct sr_py_base_thread *)obj;
+        if (frames_prepare_linked_list(to) < 0)
+        {
+            g_free(threads);
+            return NULL;
+        }
+
+        threads[i] = to->thread;
+    }
+
+    char **hashes = g_malloc_n(n + 1, sizeof(*hashes));
+    sr_threads_get_duphash_batch_parallel(threads, n, frames, (char *)prefix,
+                                          flags, hashes, nthreads);
+    g_free(threads);
+
+    PyObject *result = PyList_New(n);
+    for (int i = 0; i < n; i++)
+    {
+        PyObject *item;
+
+        if (!result)
+        {
+            g_free(hashes[i]);
+            continue;
+        }
+
+        if (hashes[i])
+            item = PyString_FromString(hashes[i]);
+        else
+        {
+            Py_INCREF(Py_None);
+            item = Py_None;
+        }
+
+        g_free(hashes[i]);
+
+        if (!item)
+        {
+            Py_CLEAR(result);
+            continue;
+        }
+
+        PyList_SET_ITEM(result, i, item);
+    }
+
+    g_free(hashes);
+    return result;
+}
@@ -50,8 +50,12 @@ PyObject *sr_py_base_thread_equals(PyObject *self, PyObject *args);
 
 /* methods */
 PyObject *sr_py_base_thread_distance(PyObject *self, PyObject *args, PyObject *kwds);
+PyObject *sr_py_base_thread_nearest(PyObject *self, PyObject *args, PyObject *kwds);
 PyObject *sr_py_base_thread_get_duphash(PyObject *self, PyObject *args, PyObject *kwds);
 
+/* module functions */
+PyObject *sr_py_threads_get_duphash(PyObject *self, PyObject *args, PyObject *kwds);
+
 #ifdef __cplusplus
 }
 #endif
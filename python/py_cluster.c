@@ -5,7 +5,9 @@
 #include <glib.h>
 
 #define dendrogram_doc "satyr.Dendrogram - a dendrogram created by clustering algorithm\n\n" \
-                       "Usage: satyr.Dendrogram(distances) - creates new dendrogram from a distance matrix"
+                       "Usage: satyr.Dendrogram(distances, linkage=satyr.LINKAGE_AVERAGE) - creates new dendrogram from a distance matrix\n\n" \
+                       "linkage - how distances between clusters are computed: LINKAGE_SINGLE,\n" \
+                       "          LINKAGE_COMPLETE, LINKAGE_AVERAGE or LINKAGE_WARD"
 
 #define de_get_size_doc "Usage: dendrogram.get_size()\n\n" \
                         "Returns: integer - number of objects in the dendrogram"
@@ -20,6 +22,12 @@
                    "Returns: list of clusters (lists of objects) which have at least min_size objects\n" \
                    "and which were merged at most at the specified distance"
 
+#define de_save_doc "Usage: dendrogram.save(filename)\n\n" \
+                    "Saves the dendrogram to a binary file which can be loaded by satyr.Dendrogram.load"
+
+#define de_load_doc "Usage: satyr.Dendrogram.load(filename)\n\n" \
+                    "Returns: satyr.Dendrogram - dendrogram saved by the save() method"
+
 static PyMethodDef
 dendrogram_methods[] =
 {
@@ -29,6 +37,8 @@ dendrogram_methods[] =
     { "get_merge_level", sr_py_dendrogram_get_merge_level, METH_VARARGS, de_get_merge_level_doc },
     /* methods */
     { "cut",             sr_py_dendrogram_cut,             METH_VARARGS, de_cut_doc             },
+    { "save",            sr_py_dendrogram_save,            METH_VARARGS, de_save_doc            },
+    { "load",            sr_py_dendrogram_load,            METH_VARARGS|METH_STATIC, de_load_doc },
     { NULL },
 };
 
@@ -88,18 +98,29 @@ sr_py_dendrogram_new(PyTypeObject *object,
                      PyObject *args,
                      PyObject *kwds)
 {
+    struct sr_py_distances *distances;
+    int linkage = SR_LINKAGE_AVERAGE;
+    static const char *kwlist[] = { "distances", "linkage", NULL };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|i", (char **)kwlist,
+                                     &sr_py_distances_type, &distances,
+                                     &linkage))
+        return NULL;
+
+    if (linkage < 0 || linkage >= SR_LINKAGE_NUM)
+    {
+        PyErr_SetString(PyExc_ValueError, "Invalid linkage");
+        return NULL;
+    }
+
     struct sr_py_dendrogram *o = (struct sr_py_dendrogram*)
         PyObject_New(struct sr_py_dendrogram, &sr_py_dendrogram_type);
 
     if (!o)
         return PyErr_NoMemory();
 
-    struct sr_py_distances *distances;
-
-    if (!PyArg_ParseTuple(args, "O!", &sr_py_distances_type, &distances))
-        return NULL;
-
-    o->dendrogram = sr_distances_cluster_objects(distances->distances);
+    o->dendrogram = sr_distances_cluster_objects_ext(distances->distances,
+                                                     linkage);
 
     return (PyObject*)o;
 }
@@ -198,3 +219,54 @@ sr_py_dendrogram_cut(PyObject *self, PyObject *args)
 
     return list;
 }
+
+PyObject *
+sr_py_dendrogram_save(PyObject *self, PyObject *args)
+{
+    struct sr_py_dendrogram *this = (struct sr_py_dendrogram*)self;
+    const char *filename;
+    char *error_message;
+
+    if (!PyArg_ParseTuple(args, "s", &filename))
+        return NULL;
+
+    if (!sr_dendrogram_save(this->dendrogram, filename, &error_message))
+    {
+        PyErr_SetString(PyExc_IOError, error_message);
+        g_free(error_message);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyObject *
+sr_py_dendrogram_load(PyObject *self, PyObject *args)
+{
+    const char *filename;
+    char *error_message;
+
+    if (!PyArg_ParseTuple(args, "s", &filename))
+        return NULL;
+
+    struct sr_dendrogram *dendrogram = sr_dendrogram_load(filename,
+                                                          &error_message);
+    if (!dendrogram)
+    {
+        PyErr_SetString(PyExc_IOError, error_message);
+        g_free(error_message);
+        return NULL;
+    }
+
+    struct sr_py_dendrogram *o = (struct sr_py_dendrogram*)
+        PyObject_New(struct sr_py_dendrogram, &sr_py_dendrogram_type);
+
+    if (!o)
+    {
+        sr_dendrogram_free(dendrogram);
+        return PyErr_NoMemory();
+    }
+
+    o->dendrogram = dendrogram;
+    return (PyObject*)o;
+}
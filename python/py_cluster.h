@@ -58,6 +58,8 @@ PyObject *sr_py_dendrogram_get_merge_level(PyObject *self, PyObject *args);
 
 /* methods */
 PyObject *sr_py_dendrogram_cut(PyObject *self, PyObject *args);
+PyObject *sr_py_dendrogram_save(PyObject *self, PyObject *args);
+PyObject *sr_py_dendrogram_load(PyObject *self, PyObject *args);
 
 #ifdef __cplusplus
 }
@@ -54,8 +54,9 @@ sr_py_setter_string(PyObject *self, PyObject *rhs, void *data)
     if (!newvalue)
         return -1;
 
+    /* The string may be interned by the frame parsers. */
     char *str = MEMB_T(char*, MEMB(self, gsoff->c_struct_offset), gsoff->member_offset);
-    g_free(str);
+    sr_intern_free(str);
     MEMB_T(char*, MEMB(self, gsoff->c_struct_offset), gsoff->member_offset) = g_strdup(newvalue);
 
     return 0;
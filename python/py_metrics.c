@@ -8,10 +8,14 @@
 #define distances_doc "satyr.Distances - class representing distances between objects\n\n" \
                       "Usage:\n\n" \
                       "satyr.Distances(m, n) - creates an m-by-n distance matrix\n\n" \
-                      "satyr.Distances([threads], m, dist_type=DISTANCE_LEVENSHTEIN) "\
+                      "satyr.Distances([threads], m, dist_type=DISTANCE_LEVENSHTEIN, nthreads=1) "\
                       "- compares first m threads with others\n\n" \
                       "dist_type (optional): DISTANCE_LEVENSHTEIN, DISTANCE_JACCARD "\
-                      "or DISTANCE_DAMERAU_LEVENSHTEIN"
+                      "or DISTANCE_DAMERAU_LEVENSHTEIN\n\n" \
+                      "nthreads (optional): number of threads to compute the distances in, "\
+                      "0 to use all processors\n\n" \
+                      "storage (optional, also for the first form): DISTANCES_FLOAT, " \
+                      "DISTANCES_FLOAT16 or DISTANCES_UINT8 - precision of the stored distances"
 
 #define di_get_size_doc "Usage: distances.get_size()\n\n" \
                         "Returns: (m, n) - size of the distance matrix"
@@ -32,6 +36,19 @@
                            "that were created by satyr.DistancesPart.create and their compute() method " \
                            "has been called."
 
+#define di_extend_doc "Usage: distances.extend([old_threads], [new_threads], dist_type=DISTANCE_LEVENSHTEIN, nthreads=1)\n\n" \
+                      "Returns: satyr.Distances - a new full distance matrix of old_threads followed\n" \
+                      "by new_threads. Only the distances not present in this matrix are computed.\n\n" \
+                      "old_threads: the threads this matrix was computed from\n\n" \
+                      "dist_type, nthreads: the same as for the constructor"
+
+#define di_save_doc "Usage: distances.save(filename)\n\n" \
+                    "Saves the distances to a binary file which can be loaded by satyr.Distances.load"
+
+#define di_load_doc "Usage: satyr.Distances.load(filename)\n\n" \
+                    "Returns: satyr.Distances - distances saved by the save() method. The file is\n" \
+                    "mapped to the memory, so even large matrices are loaded instantly."
+
 #define distances_part_doc "satyr.DistancesPart - class representing a part of a distance matrix " \
                            "that can be computed independent of other parts and later merged into " \
                            "the full matrix.\n\n" \
@@ -59,6 +76,9 @@ distances_methods[] =
     /* methods */
     { "dup",            sr_py_distances_dup,          METH_NOARGS,              di_dup_doc          },
     { "merge_parts",    sr_py_distances_merge_parts,  METH_VARARGS|METH_STATIC, di_merge_parts_doc  },
+    { "extend",         (PyCFunction)sr_py_distances_extend, METH_VARARGS|METH_KEYWORDS, di_extend_doc },
+    { "save",           sr_py_distances_save,         METH_VARARGS,             di_save_doc         },
+    { "load",           sr_py_distances_load,         METH_VARARGS|METH_STATIC, di_load_doc         },
     { NULL },
 };
 
@@ -180,12 +200,26 @@ validate_distance_params(int m, int n, int dist_type)
         PyErr_SetString(PyExc_ValueError, "Invalid distance type");
     else if (dist_type == SR_DISTANCE_JARO_WINKLER)
         PyErr_SetString(PyExc_ValueError, "Cannot use DISTANCE_JARO_WINKLER as it is not a metric");
+    else if (dist_type == SR_DISTANCE_JARO_WINKLER_COMPAT)
+        PyErr_SetString(PyExc_ValueError, "Cannot use DISTANCE_JARO_WINKLER_COMPAT as it is not a metric");
     else
         return true;
 
     return false;
 }
 
+static bool
+validate_storage(int storage)
+{
+    if (storage < 0 || storage >= SR_DISTANCES_STORAGE_NUM)
+    {
+        PyErr_SetString(PyExc_ValueError, "Invalid distances storage");
+        return false;
+    }
+
+    return true;
+}
+
 static bool
 prepare_thread_array(PyObject *thread_list, struct sr_thread *threads[], int n)
 {
@@ -232,10 +266,15 @@ sr_py_distances_new(PyTypeObject *object, PyObject *args, PyObject *kwds)
     PyObject *thread_list;
     int m, n;
     int dist_type = SR_DISTANCE_LEVENSHTEIN;
-    static const char *kwlist[] = { "threads", "m", "dist_type", NULL };
-
-    if (PyArg_ParseTupleAndKeywords(args, kwds, "O!i|i", (char **)kwlist,
-                                    &PyList_Type, &thread_list, &m, &dist_type))
+    int nthreads = 1;
+    int storage = SR_DISTANCES_FLOAT;
+    static const char *kwlist[] = { "threads", "m", "dist_type", "nthreads",
+                                    "storage", NULL };
+    static const char *kwlist_size[] = { "m", "n", "storage", NULL };
+
+    if (PyArg_ParseTupleAndKeywords(args, kwds, "O!i|iii", (char **)kwlist,
+                                    &PyList_Type, &thread_list, &m, &dist_type,
+                                    &nthreads, &storage))
     {
         n = PyList_Size(thread_list);
         struct sr_thread *threads[n];
@@ -243,24 +282,39 @@ sr_py_distances_new(PyTypeObject *object, PyObject *args, PyObject *kwds)
         if (!validate_distance_params(m, n, dist_type))
             return NULL;
 
+        if (nthreads < 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "Number of threads must not be negative");
+            return NULL;
+        }
+
+        if (!validate_storage(storage))
+            return NULL;
+
         if (!prepare_thread_array(thread_list, threads, n))
             return NULL;
 
-        o->distances = sr_threads_compare(threads, m, n, dist_type);
+        o->distances = sr_threads_compare_ext(threads, m, n, dist_type,
+                                              nthreads, storage);
     }
-    else if (PyArg_ParseTuple(args, "ii", &m, &n))
+    else
     {
         PyErr_Clear();
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "ii|i", (char **)kwlist_size,
+                                         &m, &n, &storage))
+            return NULL;
+
         if (m < 1 || n < 2)
         {
             PyErr_SetString(PyExc_ValueError, "Distance matrix must have at least 1 row and 2 columns");
             return NULL;
         }
 
-        o->distances = sr_distances_new(m, n);
+        if (!validate_storage(storage))
+            return NULL;
+
+        o->distances = sr_distances_new_ext(m, n, storage);
     }
-    else
-        return NULL;
 
     return (PyObject *)o;
 }
@@ -419,6 +473,118 @@ sr_py_distances_merge_parts(PyObject *self, PyObject *args)
     return (PyObject *)o;
 }
 
+PyObject *
+sr_py_distances_extend(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    struct sr_py_distances *this = (struct sr_py_distances*)self;
+    PyObject *old_list, *new_list;
+    int dist_type = SR_DISTANCE_LEVENSHTEIN;
+    int nthreads = 1;
+    static const char *kwlist[] = { "old_threads", "new_threads", "dist_type",
+                                    "nthreads", NULL };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!O!|ii", (char **)kwlist,
+                                     &PyList_Type, &old_list,
+                                     &PyList_Type, &new_list,
+                                     &dist_type, &nthreads))
+        return NULL;
+
+    int old_n = PyList_Size(old_list);
+    int n = old_n + PyList_Size(new_list);
+
+    if (old_n != this->distances->n)
+    {
+        PyErr_SetString(PyExc_ValueError, "Number of old threads does not match the distance matrix");
+        return NULL;
+    }
+
+    if (!validate_distance_params(n - 1, n, dist_type))
+        return NULL;
+
+    if (nthreads < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Number of threads must not be negative");
+        return NULL;
+    }
+
+    PyObject *thread_list = PySequence_Concat(old_list, new_list);
+    if (!thread_list)
+        return NULL;
+
+    struct sr_thread *threads[n];
+    bool prepared = prepare_thread_array(thread_list, threads, n);
+    Py_DECREF(thread_list);
+    if (!prepared)
+        return NULL;
+
+    struct sr_distances *dist = sr_distances_extend(this->distances, threads,
+                                                    threads + old_n, n - old_n,
+                                                    dist_type, nthreads);
+    if (!dist)
+    {
+        PyErr_SetString(PyExc_ValueError, "The distance matrix was computed from different threads or by different distance type");
+        return NULL;
+    }
+
+    struct sr_py_distances *o = PyObject_New(struct sr_py_distances, &sr_py_distances_type);
+    if (!o)
+    {
+        sr_distances_free(dist);
+        return PyErr_NoMemory();
+    }
+
+    o->distances = dist;
+    return (PyObject *)o;
+}
+
+PyObject *
+sr_py_distances_save(PyObject *self, PyObject *args)
+{
+    struct sr_py_distances *this = (struct sr_py_distances*)self;
+    const char *filename;
+    char *error_message;
+
+    if (!PyArg_ParseTuple(args, "s", &filename))
+        return NULL;
+
+    if (!sr_distances_save(this->distances, filename, &error_message))
+    {
+        PyErr_SetString(PyExc_IOError, error_message);
+        g_free(error_message);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyObject *
+sr_py_distances_load(PyObject *self, PyObject *args)
+{
+    const char *filename;
+    char *error_message;
+
+    if (!PyArg_ParseTuple(args, "s", &filename))
+        return NULL;
+
+    struct sr_distances *dist = sr_distances_load(filename, &error_message);
+    if (!dist)
+    {
+        PyErr_SetString(PyExc_IOError, error_message);
+        g_free(error_message);
+        return NULL;
+    }
+
+    struct sr_py_distances *o = PyObject_New(struct sr_py_distances, &sr_py_distances_type);
+    if (!o)
+    {
+        sr_distances_free(dist);
+        return PyErr_NoMemory();
+    }
+
+    o->distances = dist;
+    return (PyObject *)o;
+}
+
 /* constructor */
 PyObject *
 sr_py_distances_part_new(PyTypeObject *object, PyObject *args, PyObject *kwds)
@@ -60,6 +60,9 @@ PyObject *sr_py_distances_set_distance(PyObject *self, PyObject *args);
 /* methods */
 PyObject *sr_py_distances_dup(PyObject *self, PyObject *args);
 PyObject *sr_py_distances_merge_parts(PyObject *self, PyObject *args);
+PyObject *sr_py_distances_extend(PyObject *self, PyObject *args, PyObject *kwds);
+PyObject *sr_py_distances_save(PyObject *self, PyObject *args);
+PyObject *sr_py_distances_load(PyObject *self, PyObject *args);
 
 struct sr_py_distances_part
 {
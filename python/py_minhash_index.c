@@ -0,0 +1,265 @@
+#include "py_common.h"
+#include "py_minhash_index.h"
+#include "py_base_thread.h"
+#include "minhash.h"
+#include "distance.h"
+#include <glib.h>
+
+#define minhash_index_doc "satyr.MinHashIndex - index for finding similar threads without comparing all of them\n\n" \
+                          "Usage: satyr.MinHashIndex(bands=32, rows=4) - creates new empty index\n\n" \
+                          "bands, rows - shape of the MinHash signatures; threads with Jaccard similarity\n" \
+                          "              above about (1/bands)^(1/rows) are likely to be found"
+
+#define mi_get_size_doc "Usage: index.get_size()\n\n" \
+                        "Returns: integer - number of threads in the index"
+
+#define mi_insert_doc "Usage: index.insert(thread)\n\n" \
+                      "thread - satyr.BaseThread, it must not be modified afterwards\n\n" \
+                      "Returns: integer - identifier of the thread, the threads are numbered\n" \
+                      "from zero in the order of insertion"
+
+#define mi_query_doc "Usage: index.query(thread)\n\n" \
+                     "Returns: sorted list of identifiers of threads likely to be similar to thread"
+
+#define mi_query_distance_doc "Usage: index.query_distance(thread, max_dist, dist_type=satyr.DISTANCE_JACCARD)\n\n" \
+                              "Returns: list of (identifier, distance) pairs of the candidate threads\n" \
+                              "within max_dist from thread"
+
+static PyMethodDef
+minhash_index_methods[] =
+{
+    /* getters & setters */
+    { "get_size",       sr_py_minhash_index_get_size,       METH_NOARGS,                  mi_get_size_doc       },
+    /* methods */
+    { "insert",         sr_py_minhash_index_insert,         METH_VARARGS,                 mi_insert_doc         },
+    { "query",          sr_py_minhash_index_query,          METH_VARARGS,                 mi_query_doc          },
+    { "query_distance", (PyCFunction)sr_py_minhash_index_query_distance, METH_VARARGS | METH_KEYWORDS, mi_query_distance_doc },
+    { NULL },
+};
+
+PyTypeObject
+sr_py_minhash_index_type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "satyr.MinHashIndex",       /* tp_name */
+    sizeof(struct sr_py_minhash_index), /* tp_basicsize */
+    0,                          /* tp_itemsize */
+    sr_py_minhash_index_free,   /* tp_dealloc */
+    0,                          /* tp_vectorcall_offset */
+    NULL,                       /* tp_getattr */
+    NULL,                       /* tp_setattr */
+    NULL,                       /* tp_compare */
+    NULL,                       /* tp_repr */
+    NULL,                       /* tp_as_number */
+    NULL,                       /* tp_as_sequence */
+    NULL,                       /* tp_as_mapping */
+    NULL,                       /* tp_hash */
+    NULL,                       /* tp_call */
+    sr_py_minhash_index_str,    /* tp_str */
+    NULL,                       /* tp_getattro */
+    NULL,                       /* tp_setattro */
+    NULL,                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,         /* tp_flags */
+    minhash_index_doc,          /* tp_doc */
+    NULL,                       /* tp_traverse */
+    NULL,                       /* tp_clear */
+    NULL,                       /* tp_richcompare */
+    0,                          /* tp_weaklistoffset */
+    NULL,                       /* tp_iter */
+    NULL,                       /* tp_iternext */
+    minhash_index_methods,      /* tp_methods */
+    NULL,                       /* tp_members */
+    NULL,                       /* tp_getset */
+    NULL,                       /* tp_base */
+    NULL,                       /* tp_dict */
+    NULL,                       /* tp_descr_get */
+    NULL,                       /* tp_descr_set */
+    0,                          /* tp_dictoffset */
+    NULL,                       /* tp_init */
+    NULL,                       /* tp_alloc */
+    sr_py_minhash_index_new,    /* tp_new */
+    NULL,                       /* tp_free */
+    NULL,                       /* tp_is_gc */
+    NULL,                       /* tp_bases */
+    NULL,                       /* tp_mro */
+    NULL,                       /* tp_cache */
+    NULL,                       /* tp_subclasses */
+    NULL,                       /* tp_weaklist */
+};
+
+/* constructor */
+PyObject *
+sr_py_minhash_index_new(PyTypeObject *object,
+                        PyObject *args,
+                        PyObject *kwds)
+{
+    int bands = 32, rows = 4;
+    static const char *kwlist[] = { "bands", "rows", NULL };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ii", (char **)kwlist,
+                                     &bands, &rows))
+        return NULL;
+
+    if (bands < 1 || rows < 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "Number of bands and rows must be positive");
+        return NULL;
+    }
+
+    struct sr_py_minhash_index *o = (struct sr_py_minhash_index*)
+        PyObject_New(struct sr_py_minhash_index, &sr_py_minhash_index_type);
+
+    if (!o)
+        return PyErr_NoMemory();
+
+    o->threads = PyList_New(0);
+    if (!o->threads)
+    {
+        o->index = NULL;
+        Py_DECREF(o);
+        return NULL;
+    }
+
+    o->index = sr_minhash_index_new(bands, rows);
+
+    return (PyObject*)o;
+}
+
+/* destructor */
+void
+sr_py_minhash_index_free(PyObject *object)
+{
+    struct sr_py_minhash_index *this = (struct sr_py_minhash_index*)object;
+    sr_minhash_index_free(this->index);
+    Py_XDECREF(this->threads);
+    PyObject_Del(object);
+}
+
+PyObject *
+sr_py_minhash_index_str(PyObject *self)
+{
+    struct sr_py_minhash_index *this = (struct sr_py_minhash_index*)self;
+    GString *buf = g_string_new(NULL);
+    g_string_append_printf(buf, "MinHash index with %d threads",
+                           sr_minhash_index_size(this->index));
+    char *str = g_string_free(buf, FALSE);
+    PyObject *result = Py_BuildValue("s", str);
+    g_free(str);
+    return result;
+}
+
+/* getters & setters */
+PyObject *
+sr_py_minhash_index_get_size(PyObject *self, PyObject *args)
+{
+    struct sr_py_minhash_index *this = (struct sr_py_minhash_index*)self;
+    return Py_BuildValue("i", sr_minhash_index_size(this->index));
+}
+
+/* methods */
+PyObject *
+sr_py_minhash_index_insert(PyObject *self, PyObject *args)
+{
+    struct sr_py_minhash_index *this = (struct sr_py_minhash_index*)self;
+    struct sr_py_base_thread *thread;
+
+    if (!PyArg_ParseTuple(args, "O!", &sr_py_base_thread_type, &thread))
+        return NULL;
+
+    if (frames_prepare_linked_list(thread) < 0)
+        return NULL;
+
+    if (PyList_Append(this->threads, (PyObject*)thread) < 0)
+        return NULL;
+
+    return PyInt_FromLong(sr_minhash_index_insert(this->index, thread->thread));
+}
+
+PyObject *
+sr_py_minhash_index_query(PyObject *self, PyObject *args)
+{
+    struct sr_py_minhash_index *this = (struct sr_py_minhash_index*)self;
+    struct sr_py_base_thread *thread;
+    int count, i;
+
+    if (!PyArg_ParseTuple(args, "O!", &sr_py_base_thread_type, &thread))
+        return NULL;
+
+    if (frames_prepare_linked_list(thread) < 0)
+        return NULL;
+
+    int *ids = sr_minhash_index_query(this->index, thread->thread, &count);
+    PyObject *list = PyList_New(count);
+    if (!list)
+    {
+        g_free(ids);
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++)
+        PyList_SET_ITEM(list, i, PyInt_FromLong(ids[i]));
+
+    g_free(ids);
+    return list;
+}
+
+PyObject *
+sr_py_minhash_index_query_distance(PyObject *self,
+                                   PyObject *args,
+                                   PyObject *kwds)
+{
+    struct sr_py_minhash_index *this = (struct sr_py_minhash_index*)self;
+    struct sr_py_base_thread *thread;
+    float max_dist;
+    int dist_type = SR_DISTANCE_JACCARD;
+    int count, i;
+    static const char *kwlist[] = { "thread", "max_dist", "dist_type", NULL };
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!f|i", (char **)kwlist,
+                                     &sr_py_base_thread_type, &thread,
+                                     &max_dist, &dist_type))
+        return NULL;
+
+    if (dist_type < 0 || dist_type >= SR_DISTANCE_NUM)
+    {
+        PyErr_SetString(PyExc_ValueError, "Invalid distance type");
+        return NULL;
+    }
+
+    if (frames_prepare_linked_list(thread) < 0)
+        return NULL;
+
+    /* The frames of the candidates are compared, their linked lists must
+     * be up to date. */
+    int *ids = sr_minhash_index_query(this->index, thread->thread, &count);
+    for (i = 0; i < count; i++)
+    {
+        PyObject *candidate = PyList_GET_ITEM(this->threads, ids[i]);
+        if (frames_prepare_linked_list((struct sr_py_base_thread*)candidate) < 0)
+        {
+            g_free(ids);
+            return NULL;
+        }
+    }
+    g_free(ids);
+
+    float *distances;
+    ids = sr_minhash_index_query_distance(this->index, thread->thread,
+                                          dist_type, max_dist, &count,
+                                          &distances);
+
+    PyObject *list = PyList_New(count);
+    if (!list)
+    {
+        g_free(ids);
+        g_free(distances);
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++)
+        PyList_SET_ITEM(list, i, Py_BuildValue("(if)", ids[i], distances[i]));
+
+    g_free(ids);
+    g_free(distances);
+    return list;
+}
@@ -0,0 +1,70 @@
+/*
+    py_minhash_index.h
+
+    Copyright (C) 2026  Red Hat, Inc.
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifndef SATYR_PY_MINHASH_INDEX_H
+#define SATYR_PY_MINHASH_INDEX_H
+
+/**
+ * @file
+ * @brief Python bindings for the MinHash index.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <Python.h>
+#include <structmember.h>
+
+extern PyTypeObject sr_py_minhash_index_type;
+
+struct sr_py_minhash_index
+{
+    PyObject_HEAD
+    struct sr_minhash_index *index;
+    /* The inserted satyr.BaseThread objects, the index refers to them. */
+    PyObject *threads;
+};
+
+/* constructor */
+PyObject *sr_py_minhash_index_new(PyTypeObject *object,
+                                  PyObject *args,
+                                  PyObject *kwds);
+
+/* destructor */
+void sr_py_minhash_index_free(PyObject *object);
+
+/* str */
+PyObject *sr_py_minhash_index_str(PyObject *self);
+
+/* getters & setters */
+PyObject *sr_py_minhash_index_get_size(PyObject *self, PyObject *args);
+
+/* methods */
+PyObject *sr_py_minhash_index_insert(PyObject *self, PyObject *args);
+PyObject *sr_py_minhash_index_query(PyObject *self, PyObject *args);
+PyObject *sr_py_minhash_index_query_distance(PyObject *self,
+                                             PyObject *args,
+                                             PyObject *kwds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
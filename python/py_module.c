@@ -24,9 +24,11 @@
 #include "py_js_stacktrace.h"
 #include "py_rpm_package.h"
 #include "py_metrics.h"
+#include "py_minhash_index.h"
 #include "py_operating_system.h"
 #include "py_report.h"
 
+#include "cluster.h"
 #include "distance.h"
 #include "thread.h"
 #include "stacktrace.h"
@@ -73,11 +75,19 @@ sr_py_demangle_symbol(PyObject *self, PyObject *args)
     return result;
 }
 
+#define get_duphashes_doc "Usage: satyr.get_duphashes(threads, frames=0, flags=DUPHASH_NORMAL, prefix='', nthreads=0)\n\n"\
+                          "Returns: list of the duplication hashes of the threads, None for the threads "\
+                          "thread.get_duphash() fails for\n\n"\
+                          "threads: list of satyr.BaseThread objects\n\n"\
+                          "frames, flags, prefix: the same as for thread.get_duphash()\n\n"\
+                          "nthreads (optional): number of threads to compute the hashes in, "\
+                          "0 means the number of processors"
 
 static PyMethodDef
 module_methods[]=
 {
     { "demangle_symbol", sr_py_demangle_symbol, METH_VARARGS, "Demangle C++ symbol." },
+    { "get_duphashes", (PyCFunction)sr_py_threads_get_duphash, METH_VARARGS|METH_KEYWORDS, get_duphashes_doc },
     { NULL },
 };
 
@@ -145,6 +155,12 @@ MOD_INIT
         return MOD_ERROR_VAL;
     }
 
+    if (PyType_Ready(&sr_py_minhash_index_type) < 0)
+    {
+        puts("PyType_Ready(&sr_py_minhash_index_type) < 0");
+        return MOD_ERROR_VAL;
+    }
+
     if (PyType_Ready(&sr_py_gdb_sharedlib_type) < 0)
     {
         puts("PyType_Ready(&sr_py_gdb_sharedlib_type) < 0");
@@ -274,6 +290,7 @@ MOD_INIT
     PyModule_AddIntConstant(module, "DUPHASH_NOHASH", SR_DUPHASH_NOHASH);
     PyModule_AddIntConstant(module, "DUPHASH_NONORMALIZE", SR_DUPHASH_NONORMALIZE);
     PyModule_AddIntConstant(module, "DUPHASH_KOOPS_COMPAT", SR_DUPHASH_KOOPS_COMPAT);
+    PyModule_AddIntConstant(module, "DUPHASH_FAST", SR_DUPHASH_FAST);
 
     Py_INCREF(&sr_py_single_stacktrace_type);
     PyModule_AddObject(module, "SingleThreadStacktrace",
@@ -285,6 +302,7 @@ MOD_INIT
 
     PyModule_AddIntConstant(module, "BTHASH_NORMAL", SR_BTHASH_NORMAL);
     PyModule_AddIntConstant(module, "BTHASH_NOHASH", SR_BTHASH_NOHASH);
+    PyModule_AddIntConstant(module, "BTHASH_FAST", SR_BTHASH_FAST);
 
     Py_INCREF(&sr_py_gdb_frame_type);
     PyModule_AddObject(module, "GdbFrame",
@@ -313,11 +331,26 @@ MOD_INIT
                             SR_DISTANCE_LEVENSHTEIN);
     PyModule_AddIntConstant(module, "DISTANCE_DAMERAU_LEVENSHTEIN",
                             SR_DISTANCE_DAMERAU_LEVENSHTEIN);
+    PyModule_AddIntConstant(module, "DISTANCE_JARO_WINKLER_COMPAT",
+                            SR_DISTANCE_JARO_WINKLER_COMPAT);
+
+    PyModule_AddIntConstant(module, "DISTANCES_FLOAT", SR_DISTANCES_FLOAT);
+    PyModule_AddIntConstant(module, "DISTANCES_FLOAT16", SR_DISTANCES_FLOAT16);
+    PyModule_AddIntConstant(module, "DISTANCES_UINT8", SR_DISTANCES_UINT8);
 
     Py_INCREF(&sr_py_dendrogram_type);
     PyModule_AddObject(module, "Dendrogram",
                        (PyObject *)&sr_py_dendrogram_type);
 
+    PyModule_AddIntConstant(module, "LINKAGE_SINGLE", SR_LINKAGE_SINGLE);
+    PyModule_AddIntConstant(module, "LINKAGE_COMPLETE", SR_LINKAGE_COMPLETE);
+    PyModule_AddIntConstant(module, "LINKAGE_AVERAGE", SR_LINKAGE_AVERAGE);
+    PyModule_AddIntConstant(module, "LINKAGE_WARD", SR_LINKAGE_WARD);
+
+    Py_INCREF(&sr_py_minhash_index_type);
+    PyModule_AddObject(module, "MinHashIndex",
+                       (PyObject *)&sr_py_minhash_index_type);
+
     Py_INCREF(&sr_py_gdb_sharedlib_type);
     PyModule_AddObject(module, "GdbSharedlib",
                        (PyObject *)&sr_py_gdb_sharedlib_type);
@@ -141,7 +141,8 @@ debug_normalize(int argc, char **argv)
     }
 
     char *error_message;
-    char *text = sr_file_to_string(argv[0], &error_message);
+    size_t size;
+    const char *text = sr_file_map(argv[0], &size, &error_message);
     if (!text)
     {
         fprintf(stderr, "%s\n", error_message);
@@ -150,7 +151,7 @@ debug_normalize(int argc, char **argv)
 
     struct sr_gdb_thread *thread = sr_gdb_thread_new();
 
-    char *cur = text;
+    const char *cur = text;
 
     /* Parse the text. */
     while (*cur)
@@ -162,7 +163,7 @@ debug_normalize(int argc, char **argv)
         /* if ( character is found, we do not stop on white space, but on ) */
         /* parentheses may be nested, we need to consider the depth */
         sr_skip_whitespace(cur);
-        char *end;
+        const char *end;
         for (end = cur; *end && *end != ' '; ++end)
         {
         }
@@ -200,7 +201,7 @@ debug_normalize(int argc, char **argv)
     sr_gdb_thread_append_to_str(thread, strbuf, false);
     puts(strbuf->str);
 
-    g_free(text);
+    sr_file_unmap(text, size);
     g_string_free(strbuf, TRUE);
 }
 
@@ -223,7 +224,8 @@ debug_duphash(int argc, char **argv)
     }
 
     char *error_message;
-    char *text = sr_file_to_string(argv[1], &error_message);
+    size_t size;
+    const char *text = sr_file_map(argv[1], &size, &error_message);
     if (!text)
     {
         fprintf(stderr, "%s\n", error_message);
@@ -232,6 +234,7 @@ debug_duphash(int argc, char **argv)
 
     struct sr_stacktrace *stacktrace = sr_stacktrace_parse(type, text,
                                                            &error_message);
+    sr_file_unmap(text, size);
     if (!stacktrace)
     {
         fprintf(stderr, "%s\n", error_message);
@@ -298,16 +301,28 @@ debug_unwind_from_hook(int argc, char **argv)
     }
 
     char *error_message = NULL;
+    struct sr_core_stracetrace_unwind_state *state;
     struct sr_core_stacktrace *core_stacktrace;
 
-    core_stacktrace = sr_core_stacktrace_from_core_hook(tid, executable, signum,
-                                                        &error_message);
-    if (!core_stacktrace)
+    /* Release the dying process before the function names are looked up. */
+    state = sr_core_stacktrace_from_core_hook_prepare(tid, &error_message);
+    if (!state)
     {
         fprintf(stderr, "Unwind failed: %s\n", error_message);
         exit(1);
     }
 
+    core_stacktrace = sr_core_stacktrace_from_core_hook_generate_deferred(tid,
+                                    executable, signum, state, &error_message);
+    if (!core_stacktrace
+        || !sr_core_stacktrace_symbolize(core_stacktrace, state, &error_message))
+    {
+        fprintf(stderr, "Unwind failed: %s\n", error_message);
+        exit(1);
+    }
+
+    sr_core_stacktrace_unwind_state_free(state);
+
     char *json = sr_core_stacktrace_to_json(core_stacktrace);
     // Add newline to the end of core stacktrace file to make text
     // editors happy.
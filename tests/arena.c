@@ -0,0 +1,126 @@
+#include <arena.h>
+#include <frame.h>
+#include <report_type.h>
+#include <stacktrace.h>
+#include <thread.h>
+#include <utils.h>
+
+#include <glib.h>
+
+struct arena_testcase
+{
+    enum sr_report_type type;
+    const char *filename;
+    int frame_count;
+};
+
+static const struct arena_testcase arena_testcases[] =
+{
+    { SR_REPORT_CORE, "json_files/core-01", 6 },
+    { SR_REPORT_PYTHON, "python_stacktraces/python-01", 11 },
+    { SR_REPORT_KERNELOOPS, "kerneloopses/rhbz-1140681", 21 },
+    { SR_REPORT_JAVA, "java_stacktraces/java-01", 9 },
+    { SR_REPORT_JAVASCRIPT, "js_stacktraces/node-01", 10 },
+};
+
+static int
+stacktrace_frame_count(struct sr_stacktrace *stacktrace)
+{
+    int count = 0;
+
+    for (struct sr_thread *thread = sr_stacktrace_threads(stacktrace);
+         thread;
+         thread = sr_thread_next(thread))
+    {
+        count += sr_thread_frame_count(thread);
+    }
+
+    return count;
+}
+
+static void
+test_arena_parse(gconstpointer user_data)
+{
+    /* Check that the stacktraces allocated from an arena, parsed and read
+     * from JSON, equal the ones allocated by g_malloc(). */
+    const struct arena_testcase *testcase = user_data;
+    char *error_message = NULL;
+    g_autofree char *input = sr_file_to_string(testcase->filename, &error_message);
+    g_assert_nonnull(input);
+    struct sr_stacktrace *expected = sr_stacktrace_parse(testcase->type, input, &error_message);
+    g_assert_nonnull(expected);
+    g_autofree char *expected_json = sr_stacktrace_to_json(expected);
+    struct sr_stacktrace *expected_from_json =
+        sr_stacktrace_from_json_text(testcase->type, expected_json, &error_message);
+    g_assert_nonnull(expected_from_json);
+    g_autofree char *expected_json2 = sr_stacktrace_to_json(expected_from_json);
+
+    struct sr_arena *arena = sr_arena_new();
+    struct sr_stacktrace *stacktrace =
+        sr_stacktrace_parse_arena(arena, testcase->type, input, &error_message);
+    g_assert_nonnull(stacktrace);
+    g_assert_cmpuint(sr_arena_size(arena), >, 0);
+    g_assert_cmpint(stacktrace_frame_count(stacktrace), ==, testcase->frame_count);
+    g_autofree char *json = sr_stacktrace_to_json(stacktrace);
+    g_assert_cmpstr(json, ==, expected_json);
+
+    struct sr_stacktrace *from_json =
+        sr_stacktrace_from_json_text_arena(arena, testcase->type, expected_json,
+                                           &error_message);
+    g_assert_nonnull(from_json);
+    g_assert_cmpint(stacktrace_frame_count(from_json), ==, testcase->frame_count);
+    g_autofree char *json2 = sr_stacktrace_to_json(from_json);
+    g_assert_cmpstr(json2, ==, expected_json2);
+
+    /* The free function skips the memory of the arena. */
+    sr_stacktrace_free(from_json);
+    sr_arena_free(arena);
+    sr_stacktrace_free(expected_from_json);
+    sr_stacktrace_free(expected);
+}
+
+static void
+test_arena_intern_pool(gconstpointer user_data)
+{
+    /* The strings parsed into an arena do not take references in the
+     * pool, they would stay there after the arena is released. */
+    const struct arena_testcase *testcase = user_data;
+    char *error_message = NULL;
+    g_autofree char *input = sr_file_to_string(testcase->filename, &error_message);
+    g_assert_nonnull(input);
+
+    g_assert_cmpuint(sr_intern_pool_size(), ==, 0);
+    sr_intern_pool_enable();
+
+    struct sr_arena *arena = sr_arena_new();
+    struct sr_stacktrace *stacktrace =
+        sr_stacktrace_parse_arena(arena, testcase->type, input, &error_message);
+    g_assert_nonnull(stacktrace);
+    g_autofree char *json = sr_stacktrace_to_json(stacktrace);
+    g_assert_nonnull(sr_stacktrace_from_json_text_arena(arena, testcase->type,
+                                                        json, &error_message));
+    sr_arena_free(arena);
+
+    sr_intern_pool_disable();
+    g_assert_cmpuint(sr_intern_pool_size(), ==, 0);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(arena_testcases); i++)
+    {
+        const struct arena_testcase *testcase = &arena_testcases[i];
+        g_autofree char *name = sr_report_type_to_string(testcase->type);
+        g_autofree char *parse_path = g_strdup_printf("/arena/parse/%s", name);
+        g_autofree char *intern_path = g_strdup_printf("/arena/intern-pool/%s", name);
+
+        g_test_add_data_func(parse_path, testcase, test_arena_parse);
+        g_test_add_data_func(intern_path, testcase, test_arena_intern_pool);
+    }
+
+    return g_test_run();
+}
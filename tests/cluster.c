@@ -2,6 +2,9 @@
 #include <distance.h>
 
 #include <glib.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 static void
 test_distances_cluster_objects_1(void)
@@ -68,6 +71,128 @@ test_distances_cluster_objects_2(void)
     sr_dendrogram_free(dendrogram);
 }
 
+static void
+test_distances_cluster_objects_3(void)
+{
+    struct sr_distances *distances;
+    struct sr_dendrogram *dendrogram;
+
+    /* Many equal distances, the first closest pair is merged. */
+    distances = sr_distances_new(5, 6);
+
+    sr_distances_set_distance(distances, 0, 1, 0.5);
+    sr_distances_set_distance(distances, 0, 2, 0.25);
+    sr_distances_set_distance(distances, 0, 3, 0.5);
+    sr_distances_set_distance(distances, 0, 4, 0.75);
+    sr_distances_set_distance(distances, 0, 5, 0.25);
+    sr_distances_set_distance(distances, 1, 2, 0.5);
+    sr_distances_set_distance(distances, 1, 3, 0.25);
+    sr_distances_set_distance(distances, 1, 4, 0.5);
+    sr_distances_set_distance(distances, 1, 5, 0.75);
+    sr_distances_set_distance(distances, 2, 3, 0.75);
+    sr_distances_set_distance(distances, 2, 4, 0.25);
+    sr_distances_set_distance(distances, 2, 5, 0.5);
+    sr_distances_set_distance(distances, 3, 4, 0.5);
+    sr_distances_set_distance(distances, 3, 5, 0.25);
+    sr_distances_set_distance(distances, 4, 5, 0.5);
+
+    dendrogram = sr_distances_cluster_objects(distances);
+    sr_distances_free(distances);
+
+    g_assert_cmpint(dendrogram->size, ==, 6);
+
+    g_assert_cmpint(dendrogram->order[0], ==, 4);
+    g_assert_cmpint(dendrogram->order[1], ==, 2);
+    g_assert_cmpint(dendrogram->order[2], ==, 0);
+    g_assert_cmpint(dendrogram->order[3], ==, 5);
+    g_assert_cmpint(dendrogram->order[4], ==, 3);
+    g_assert_cmpint(dendrogram->order[5], ==, 1);
+
+    g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[0], 0.5, 1e-6);
+    g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[1], 0.25, 1e-6);
+    g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[2], 0.375, 1e-6);
+    g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[3], 0.53125, 1e-6);
+    g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[4], 0.25, 1e-6);
+    sr_dendrogram_free(dendrogram);
+}
+
+static void
+test_distances_cluster_objects_linkage(void)
+{
+    const float expected[SR_LINKAGE_NUM][3] =
+    {
+        [SR_LINKAGE_SINGLE] = { 0.0, 0.3, 0.1 },
+        [SR_LINKAGE_COMPLETE] = { 0.0, 1.0, 0.1 },
+        [SR_LINKAGE_AVERAGE] = { 0.0, 0.625, 0.1 },
+        [SR_LINKAGE_WARD] = { 0.0, 0.953939, 0.1 },
+    };
+    struct sr_distances *distances;
+    struct sr_dendrogram *dendrogram;
+
+    distances = sr_distances_new(3, 4);
+
+    sr_distances_set_distance(distances, 0, 1, 1.0);
+    sr_distances_set_distance(distances, 0, 2, 0.5);
+    sr_distances_set_distance(distances, 0, 3, 0.0);
+    sr_distances_set_distance(distances, 1, 2, 0.1);
+    sr_distances_set_distance(distances, 1, 3, 0.3);
+    sr_distances_set_distance(distances, 2, 3, 0.7);
+
+    for (int linkage = 0; linkage < SR_LINKAGE_NUM; linkage++)
+    {
+        dendrogram = sr_distances_cluster_objects_ext(distances, linkage);
+
+        g_assert_cmpint(dendrogram->size, ==, 4);
+
+        g_assert_cmpint(dendrogram->order[0], ==, 0);
+        g_assert_cmpint(dendrogram->order[1], ==, 3);
+        g_assert_cmpint(dendrogram->order[2], ==, 1);
+        g_assert_cmpint(dendrogram->order[3], ==, 2);
+
+        for (int i = 0; i < 3; i++)
+        {
+            g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[i],
+                                           expected[linkage][i], 1e-6);
+        }
+
+        sr_dendrogram_free(dendrogram);
+    }
+
+    sr_distances_free(distances);
+}
+
+static void
+test_distances_cluster_objects_single(void)
+{
+    struct sr_distances *distances;
+    struct sr_dendrogram *dendrogram;
+
+    /* A chain of objects, each one closest to its neighbours. */
+    distances = sr_distances_new(5, 6);
+
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = i + 1; j < 6; j++)
+            sr_distances_set_distance(distances, i, j, 0.1 * (j - i) + 0.01 * i);
+    }
+
+    dendrogram = sr_distances_cluster_objects_ext(distances, SR_LINKAGE_SINGLE);
+    sr_distances_free(distances);
+
+    g_assert_cmpint(dendrogram->size, ==, 6);
+
+    for (int i = 0; i < 6; i++)
+        g_assert_cmpint(dendrogram->order[i], ==, i);
+
+    for (int i = 0; i < 5; i++)
+    {
+        g_assert_cmpfloat_with_epsilon(dendrogram->merge_levels[i],
+                                       0.1 + 0.01 * i, 1e-6);
+    }
+
+    sr_dendrogram_free(dendrogram);
+}
+
 static void
 test_dendrogram_cut_1(void)
 {
@@ -169,6 +294,171 @@ test_dendrogram_cut_2(void)
     sr_dendrogram_free(dendrogram);
 }
 
+static void
+test_distances_cluster_objects_storage(void)
+{
+    enum sr_distances_storage storages[] = { SR_DISTANCES_FLOAT,
+                                             SR_DISTANCES_FLOAT16,
+                                             SR_DISTANCES_UINT8 };
+    struct sr_dendrogram *reference[SR_LINKAGE_NUM];
+
+    for (size_t k = 0; k < G_N_ELEMENTS(storages); k++)
+    {
+        struct sr_distances *distances = sr_distances_new_ext(3, 4, storages[k]);
+
+        sr_distances_set_distance(distances, 0, 1, 1.0);
+        sr_distances_set_distance(distances, 0, 2, 0.5);
+        sr_distances_set_distance(distances, 0, 3, 0.0);
+        sr_distances_set_distance(distances, 1, 2, 0.1);
+        sr_distances_set_distance(distances, 1, 3, 0.3);
+        sr_distances_set_distance(distances, 2, 3, 0.7);
+
+        /* The linkage distances are rounded to the storage. */
+        for (int linkage = 0; linkage < SR_LINKAGE_NUM; linkage++)
+        {
+            struct sr_dendrogram *dendrogram =
+                sr_distances_cluster_objects_ext(distances, linkage);
+
+            if (k == 0)
+            {
+                reference[linkage] = dendrogram;
+                continue;
+            }
+
+            for (int i = 0; i < 4; i++)
+            {
+                g_assert_cmpint(dendrogram->order[i], ==,
+                                reference[linkage]->order[i]);
+            }
+
+            for (int i = 0; i < 3; i++)
+            {
+                g_assert_cmpfloat(fabsf(dendrogram->merge_levels[i] -
+                                        reference[linkage]->merge_levels[i]),
+                                  <, 0.005);
+            }
+
+            sr_dendrogram_free(dendrogram);
+        }
+
+        sr_distances_free(distances);
+    }
+
+    for (int linkage = 0; linkage < SR_LINKAGE_NUM; linkage++)
+        sr_dendrogram_free(reference[linkage]);
+
+    /* The Ward's distances above 1 are not clamped to the bytes. */
+    struct sr_distances *distances = sr_distances_new_ext(2, 3, SR_DISTANCES_UINT8);
+    struct sr_dendrogram *dendrogram;
+
+    sr_distances_set_distance(distances, 0, 1, 0.1);
+    sr_distances_set_distance(distances, 0, 2, 1.0);
+    sr_distances_set_distance(distances, 1, 2, 1.0);
+
+    dendrogram = sr_distances_cluster_objects_ext(distances, SR_LINKAGE_WARD);
+    sr_distances_free(distances);
+
+    g_assert_cmpint(dendrogram->order[0], ==, 0);
+    g_assert_cmpint(dendrogram->order[1], ==, 1);
+    g_assert_cmpint(dendrogram->order[2], ==, 2);
+    g_assert_cmpfloat(fabsf(dendrogram->merge_levels[1] - sqrtf(3.99 / 3)),
+                      <, 0.005);
+
+    sr_dendrogram_free(dendrogram);
+}
+
+static void
+test_dendrogram_save_load(void)
+{
+    struct sr_distances *distances;
+    struct sr_dendrogram *dendrogram, *loaded;
+    char *filename, *error_message = NULL;
+    int fd;
+
+    distances = sr_distances_new(3, 4);
+    sr_distances_set_distance(distances, 0, 1, 1.0);
+    sr_distances_set_distance(distances, 0, 2, 0.5);
+    sr_distances_set_distance(distances, 0, 3, 0.0);
+    sr_distances_set_distance(distances, 1, 2, 0.1);
+    sr_distances_set_distance(distances, 1, 3, 0.3);
+    sr_distances_set_distance(distances, 2, 3, 0.7);
+    distances->dist_type = SR_DISTANCE_JACCARD;
+    distances->checksum = 1234;
+
+    dendrogram = sr_distances_cluster_objects(distances);
+    sr_distances_free(distances);
+
+    fd = g_file_open_tmp("satyr-dendrogram-XXXXXX", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    close(fd);
+
+    g_assert_true(sr_dendrogram_save(dendrogram, filename, &error_message));
+
+    loaded = sr_dendrogram_load(filename, &error_message);
+    g_assert_nonnull(loaded);
+    g_assert_cmpint(loaded->size, ==, 4);
+    g_assert_cmpint(loaded->dist_type, ==, SR_DISTANCE_JACCARD);
+    g_assert_cmpuint(loaded->checksum, ==, 1234);
+
+    for (int i = 0; i < 4; i++)
+        g_assert_cmpint(loaded->order[i], ==, dendrogram->order[i]);
+    for (int i = 0; i < 3; i++)
+        g_assert_cmpfloat(loaded->merge_levels[i], ==, dendrogram->merge_levels[i]);
+
+    sr_dendrogram_free(loaded);
+
+    /* A dendrogram is not a distance matrix. */
+    g_assert_null(sr_distances_load(filename, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    error_message = NULL;
+
+    /* The file gets the mode of new files, not the one of temporary files. */
+    mode_t mask = umask(022);
+    g_assert_true(sr_dendrogram_save(dendrogram, filename, &error_message));
+    umask(mask);
+
+    struct stat st;
+    g_assert_cmpint(stat(filename, &st), ==, 0);
+    g_assert_cmpint(st.st_mode & 0777, ==, 0644);
+
+    /* The order must be a permutation of the objects. */
+    int order = dendrogram->order[1];
+    dendrogram->order[1] = dendrogram->order[0];
+    g_assert_true(sr_dendrogram_save(dendrogram, filename, &error_message));
+    g_assert_null(sr_dendrogram_load(filename, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    error_message = NULL;
+
+    dendrogram->order[1] = 4;
+    g_assert_true(sr_dendrogram_save(dendrogram, filename, &error_message));
+    g_assert_null(sr_dendrogram_load(filename, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    error_message = NULL;
+    dendrogram->order[1] = order;
+
+    /* The unknown type is stored as it is, the count of the types is not
+     * a valid type. */
+    dendrogram->dist_type = SR_DISTANCE_UNKNOWN;
+    g_assert_true(sr_dendrogram_save(dendrogram, filename, &error_message));
+    loaded = sr_dendrogram_load(filename, &error_message);
+    g_assert_nonnull(loaded);
+    g_assert_cmpint(loaded->dist_type, ==, SR_DISTANCE_UNKNOWN);
+    sr_dendrogram_free(loaded);
+
+    dendrogram->dist_type = SR_DISTANCE_NUM;
+    g_assert_true(sr_dendrogram_save(dendrogram, filename, &error_message));
+    g_assert_null(sr_dendrogram_load(filename, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+
+    unlink(filename);
+    g_free(filename);
+    sr_dendrogram_free(dendrogram);
+}
+
 int
 main(int    argc,
      char **argv)
@@ -177,8 +467,13 @@ main(int    argc,
 
     g_test_add_func("/cluster/objects-distances-1", test_distances_cluster_objects_1);
     g_test_add_func("/cluster/objects-distances-2", test_distances_cluster_objects_2);
+    g_test_add_func("/cluster/objects-distances-3", test_distances_cluster_objects_3);
+    g_test_add_func("/cluster/objects-distances-linkage", test_distances_cluster_objects_linkage);
+    g_test_add_func("/cluster/objects-distances-single", test_distances_cluster_objects_single);
+    g_test_add_func("/cluster/objects-distances-storage", test_distances_cluster_objects_storage);
     g_test_add_func("/dendrogram/cut-1", test_dendrogram_cut_1);
     g_test_add_func("/dendrogram/cut-2", test_dendrogram_cut_2);
+    g_test_add_func("/dendrogram/save-load", test_dendrogram_save_load);
 
     return g_test_run();
 }
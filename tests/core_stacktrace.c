@@ -10,9 +10,12 @@
 #include <errno.h>
 #include <utils.h>
 #include <internal_unwind.h>
+#include <matrix_file.h>
 #include <stacktrace.h>
 #include <stdio.h>
+#include <sys/ptrace.h>
 #include <sys/wait.h>
+#include <thread.h>
 #include <unistd.h>
 
 static char const *test_json =
@@ -345,6 +348,357 @@ test_core_stacktrace_from_gdb_limit(void)
     sr_core_stacktrace_free(core_stacktrace);
 }
 
+static void
+test_core_stacktrace_parse_coredump_parallel(void)
+{
+    g_autoptr(GString) coredump_path = NULL;
+    char *error_msg = NULL;
+    struct sr_core_stacktrace *serial;
+    struct sr_core_stacktrace *parallel;
+
+    coredump_path = run_and_get_stdout((char const *[]) {
+        dump_core_program,
+        "8",
+        "6",
+        NULL,
+    });
+
+    g_assert_nonnull(coredump_path);
+    g_assert_cmpuint(strlen(coredump_path->str), >, 0);
+
+    serial = sr_parse_coredump(coredump_path->str, dump_core_program, &error_msg);
+    g_assert_cmpstr(error_msg, ==, NULL);
+    g_assert_nonnull(serial);
+    g_assert_cmpuint(sr_core_stacktrace_get_thread_count(serial), ==, 7);
+
+    parallel = sr_parse_coredump_parallel(coredump_path->str, dump_core_program,
+                                          4, &error_msg);
+    g_assert_cmpstr(error_msg, ==, NULL);
+    g_assert_nonnull(parallel);
+
+    /* The threads are compared in order, together with their frames. */
+    g_autofree char *serial_json = sr_core_stacktrace_to_json(serial);
+    g_autofree char *parallel_json = sr_core_stacktrace_to_json(parallel);
+    g_assert_cmpstr(parallel_json, ==, serial_json);
+
+    sr_core_stacktrace_free(parallel);
+    sr_core_stacktrace_free(serial);
+}
+
+static GString *
+stacktrace_function_names(struct sr_core_stacktrace *stacktrace)
+{
+    GString *names = g_string_new(NULL);
+
+    for (struct sr_core_thread *thread = stacktrace->threads; thread; thread = thread->next)
+    {
+        for (struct sr_core_frame *frame = thread->frames; frame; frame = frame->next)
+        {
+            g_string_append(names, frame->function_name ? frame->function_name : "??");
+            g_string_append_c(names, '\n');
+        }
+
+        g_string_append_c(names, '\n');
+    }
+
+    return names;
+}
+
+static GString *
+coredump_function_names(char const *coredump_path)
+{
+    char *error_msg = NULL;
+    struct sr_core_stacktrace *stacktrace;
+    GString *names;
+
+    stacktrace = sr_parse_coredump(coredump_path, dump_core_program, &error_msg);
+    g_assert_cmpstr(error_msg, ==, NULL);
+    g_assert_nonnull(stacktrace);
+
+    names = stacktrace_function_names(stacktrace);
+
+    sr_core_stacktrace_free(stacktrace);
+
+    return names;
+}
+
+static GPtrArray *
+symbol_file_paths(char const *directory)
+{
+    GDir *dir;
+    char const *name;
+    GPtrArray *paths = g_ptr_array_new_with_free_func(g_free);
+
+    dir = g_dir_open(directory, 0, NULL);
+    g_assert_nonnull(dir);
+
+    while (NULL != (name = g_dir_read_name(dir)))
+    {
+        g_ptr_array_add(paths, g_build_filename(directory, name, NULL));
+    }
+
+    g_dir_close(dir);
+
+    return paths;
+}
+
+static void
+assert_symbol_file_bounded(char const *path)
+{
+    g_autofree char *contents = NULL;
+    gsize length;
+    struct matrix_file_header *header;
+    struct matrix_file_symbol *symbols;
+
+    g_assert_true(g_file_get_contents(path, &contents, &length, NULL));
+    g_assert_cmpuint(length, >=, sizeof(*header));
+
+    header = (struct matrix_file_header *)contents;
+    g_assert_cmpmem(header->magic, sizeof(header->magic),
+                    MATRIX_FILE_MAGIC_SYMBOLS, sizeof(header->magic));
+    g_assert_cmpuint(length, >=, sizeof(*header) + header->m * sizeof(*symbols));
+
+    /* The ranges of the symbols without a size end with their sections. */
+    symbols = (struct matrix_file_symbol *)(header + 1);
+    for (int i = 0; i < header->m; i++)
+    {
+        g_assert_cmpuint(symbols[i].size, >, 0);
+    }
+}
+
+static void
+change_file(char const *path, bool truncate)
+{
+    g_autofree char *contents = NULL;
+    gsize length;
+
+    g_assert_true(g_file_get_contents(path, &contents, &length, NULL));
+    g_assert_cmpuint(length, >, 0);
+
+    if (truncate)
+    {
+        length /= 2;
+    }
+    else
+    {
+        contents[length - 1] = 'x';
+    }
+
+    g_assert_true(g_file_set_contents(path, contents, length, NULL));
+}
+
+static void
+test_core_stacktrace_symbol_cache(void)
+{
+    g_autoptr(GString) coredump_path = NULL;
+    g_autofree char *directory = NULL;
+    g_autoptr(GString) expected = NULL;
+    g_autoptr(GString) cold = NULL;
+    g_autoptr(GString) warm = NULL;
+    g_autoptr(GString) truncated = NULL;
+    g_autoptr(GString) unterminated = NULL;
+    g_autoptr(GPtrArray) paths = NULL;
+
+    coredump_path = run_and_get_stdout((char const *[]) {
+        dump_core_program,
+        "8",
+        "2",
+        NULL,
+    });
+
+    g_assert_nonnull(coredump_path);
+    g_assert_cmpuint(strlen(coredump_path->str), >, 0);
+
+    directory = g_dir_make_tmp("satyr-symbols-XXXXXX", NULL);
+    g_assert_nonnull(directory);
+
+    expected = coredump_function_names(coredump_path->str);
+    g_assert_nonnull(strstr(expected->str, "dump_core\n"));
+    g_assert_nonnull(strstr(expected->str, "wait_for_exit_read\n"));
+
+    /* The tables are built and stored by the first unwinding, and only
+     * loaded by the second one. */
+    sr_core_unwind_set_symbol_cache_dir(directory);
+
+    cold = coredump_function_names(coredump_path->str);
+    g_assert_cmpstr(cold->str, ==, expected->str);
+    warm = coredump_function_names(coredump_path->str);
+    g_assert_cmpstr(warm->str, ==, expected->str);
+
+    paths = symbol_file_paths(directory);
+    g_assert_cmpuint(paths->len, >, 0);
+
+    for (guint i = 0; i < paths->len; i++)
+    {
+        assert_symbol_file_bounded(g_ptr_array_index(paths, i));
+    }
+
+    /* The truncated tables and the ones with unterminated names are built
+     * and stored again. */
+    for (guint i = 0; i < paths->len; i++)
+    {
+        change_file(g_ptr_array_index(paths, i), true);
+    }
+
+    truncated = coredump_function_names(coredump_path->str);
+    g_assert_cmpstr(truncated->str, ==, expected->str);
+
+    for (guint i = 0; i < paths->len; i++)
+    {
+        change_file(g_ptr_array_index(paths, i), false);
+    }
+
+    unterminated = coredump_function_names(coredump_path->str);
+    g_assert_cmpstr(unterminated->str, ==, expected->str);
+
+    sr_core_unwind_set_symbol_cache_dir(NULL);
+
+    for (guint i = 0; i < paths->len; i++)
+    {
+        g_assert_cmpint(unlink(g_ptr_array_index(paths, i)), ==, 0);
+    }
+
+    g_assert_cmpint(rmdir(directory), ==, 0);
+}
+
+/* Starts the dump_core program with a stack of the given depth.  It exits
+ * when the standard input of the test is closed, which the core hook
+ * functions do once the process is stopped. */
+static pid_t
+start_exiting_process(int depth)
+{
+    int in[2];
+    int out[2];
+    pid_t pid;
+    char c;
+    g_autofree char *depth_string = g_strdup_printf("%d", depth);
+    char const *argv[] =
+    {
+        dump_core_program,
+        depth_string,
+        "0",
+        "exit",
+        NULL,
+    };
+
+    if (pipe(in) == -1 || pipe(out) == -1)
+    {
+        err(1, "pipe");
+    }
+
+    pid = fork();
+    if (-1 == pid)
+    {
+        err(1, "fork");
+    }
+    if (0 == pid)
+    {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+
+        execv(argv[0], (char *const *) argv);
+        _exit(EXIT_FAILURE);
+    }
+
+    close(in[0]);
+    close(out[1]);
+
+    /* The stack is ready once the process writes to its output. */
+    while (read(out[0], &c, 1) == -1 && EINTR == errno)
+    {
+        continue;
+    }
+
+    close(out[0]);
+
+    dup2(in[1], STDIN_FILENO);
+    close(in[1]);
+
+    return pid;
+}
+
+static void
+wait_for_exited_process(pid_t pid)
+{
+    int status;
+
+    /* The deferred unwinding detaches from the process itself. */
+    ptrace(PTRACE_DETACH, pid, NULL, NULL);
+
+    g_assert_cmpint(waitpid(pid, &status, 0), ==, pid);
+    g_assert_true(WIFEXITED(status));
+    g_assert_cmpint(WEXITSTATUS(status), ==, EXIT_SUCCESS);
+}
+
+static void
+test_core_stacktrace_symbolize(void)
+{
+    char *error_msg = NULL;
+    pid_t pid;
+    struct sr_core_stracetrace_unwind_state *state;
+    struct sr_core_stacktrace *expected;
+    struct sr_core_stacktrace *deferred;
+    struct sr_core_stacktrace *shorter;
+    struct sr_core_frame *frame;
+    g_autoptr(GString) expected_names = NULL;
+    g_autoptr(GString) names = NULL;
+
+    pid = start_exiting_process(8);
+    expected = sr_core_stacktrace_from_core_hook(pid, dump_core_program, 0, &error_msg);
+    g_assert_cmpstr(error_msg, ==, NULL);
+    g_assert_nonnull(expected);
+    wait_for_exited_process(pid);
+
+    expected_names = stacktrace_function_names(expected);
+    g_assert_nonnull(strstr(expected_names->str, "exit_on_stdin_close\n"));
+    g_assert_null(strstr(expected_names->str, "__libc_start_main\n"));
+
+    pid = start_exiting_process(8);
+    state = sr_core_stacktrace_from_core_hook_prepare(pid, &error_msg);
+    g_assert_cmpstr(error_msg, ==, NULL);
+    g_assert_nonnull(state);
+
+    /* The state has no addresses before the deferred unwinding. */
+    g_assert_false(sr_core_stacktrace_symbolize(expected, state, &error_msg));
+    g_assert_cmpstr(error_msg, ==, "The stacktrace was not unwound in the deferred mode");
+    g_clear_pointer(&error_msg, g_free);
+
+    deferred = sr_core_stacktrace_from_core_hook_generate_deferred(pid, dump_core_program,
+                                                                   0, state, &error_msg);
+    g_assert_cmpstr(error_msg, ==, NULL);
+    g_assert_nonnull(deferred);
+    wait_for_exited_process(pid);
+
+    /* A stacktrace without the innermost frame does not match the state,
+     * which is kept for the right one. */
+    shorter = sr_core_stacktrace_dup(deferred);
+    frame = shorter->threads->frames;
+    shorter->threads->frames = frame->next;
+    sr_core_frame_free(frame);
+
+    g_assert_false(sr_core_stacktrace_symbolize(shorter, state, &error_msg));
+    g_assert_cmpstr(error_msg, ==, "The stacktrace does not match the unwind state");
+    g_clear_pointer(&error_msg, g_free);
+
+    g_assert_true(sr_core_stacktrace_symbolize(deferred, state, &error_msg));
+    g_assert_cmpstr(error_msg, ==, NULL);
+
+    names = stacktrace_function_names(deferred);
+    g_assert_cmpstr(names->str, ==, expected_names->str);
+    g_assert_cmpint(sr_thread_frame_count((struct sr_thread *)deferred->threads), ==,
+                    sr_thread_frame_count((struct sr_thread *)expected->threads));
+
+    sr_core_stacktrace_unwind_state_free(state);
+    sr_core_stacktrace_free(shorter);
+    sr_core_stacktrace_free(deferred);
+    sr_core_stacktrace_free(expected);
+}
+
 int
 main(int    argc,
      char **argv)
@@ -354,6 +708,9 @@ main(int    argc,
     g_test_add_func("/stacktrace/core/to-json", test_core_stacktrace_to_json);
     g_test_add_func("/stacktrace/core/from-json", test_core_stacktrace_from_json);
     g_test_add_func("/stacktrace/core/from-gdb-limit", test_core_stacktrace_from_gdb_limit);
+    g_test_add_func("/stacktrace/core/parse-coredump-parallel", test_core_stacktrace_parse_coredump_parallel);
+    g_test_add_func("/stacktrace/core/symbol-cache", test_core_stacktrace_symbol_cache);
+    g_test_add_func("/stacktrace/core/symbolize", test_core_stacktrace_symbolize);
 
     return g_test_run();
 }
@@ -6,14 +6,48 @@
 #undef _FORTIFY_SOURCE
 #endif
 
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 static char const *prefix = "/tmp/satyr.core";
+static pthread_barrier_t threads_started;
+/* Never written, reading it blocks until the process exits. */
+static int exit_pipe[2];
+
+__attribute__((optimize((0))))
+void *
+wait_for_exit(void *arg)
+{
+    int depth = (intptr_t)arg;
+
+    if (--depth > 0)
+    {
+        return wait_for_exit((void *)(intptr_t)depth);
+    }
+
+    pthread_barrier_wait(&threads_started);
+
+    char c;
+    /* A label with a size but without a type inside the function, it names
+     * the addresses of the loop the thread blocks in. */
+    __asm__ volatile (".globl wait_for_exit_read\nwait_for_exit_read:");
+    while (read(exit_pipe[0], &c, 1) == -1 && errno == EINTR)
+    {
+        continue;
+    }
+    __asm__ volatile (".size wait_for_exit_read, . - wait_for_exit_read");
+
+    return NULL;
+}
 
 __attribute__((optimize((0))))
 int
@@ -90,14 +124,76 @@ dump_core(int    depth,
     return true;
 }
 
+/* Tells the parent the stack is ready, then exits as soon as the standard
+ * input is closed, the way the kernel waits for the core hook. */
+__attribute__((optimize((0))))
+int
+exit_on_stdin_close(int depth)
+{
+    ssize_t size;
+    char c = '\n';
+
+    if (--depth > 0)
+    {
+        return exit_on_stdin_close(depth);
+    }
+
+    if (write(STDOUT_FILENO, &c, 1) != 1)
+    {
+        return EXIT_FAILURE;
+    }
+
+    do
+    {
+        size = read(STDIN_FILENO, &c, 1);
+    } while (size > 0 || (size == -1 && errno == EINTR));
+
+    /* The process exits with the whole stack. */
+    syscall(SYS_exit_group, EXIT_SUCCESS);
+
+    return EXIT_FAILURE;
+}
+
 int
 main (int    argc,
       char **argv)
 {
     int depth;
+    int threads = 0;
     char *name = NULL;
 
     depth = atoi(argv[1]);
+    if (argc > 2)
+    {
+        threads = atoi(argv[2]);
+    }
+
+    if (argc > 3 && strcmp(argv[3], "exit") == 0)
+    {
+        return exit_on_stdin_close(depth);
+    }
+
+    /* The other threads wait with stacks of different depths, they end
+     * when the process exits. */
+    if (pipe(exit_pipe) == -1)
+    {
+        return EXIT_FAILURE;
+    }
+
+    pthread_barrier_init(&threads_started, NULL, threads + 1);
+
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, wait_for_exit,
+                           (void *)(intptr_t)(i + 2)) != 0)
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    pthread_barrier_wait(&threads_started);
 
     if (!dump_core(depth, &name))
     {
@@ -0,0 +1,133 @@
+#include <elves.h>
+
+#include <glib.h>
+
+static struct sr_elf_fde *
+fde_list_new(uint64_t exec_base, const uint64_t (*ranges)[2], size_t count)
+{
+    struct sr_elf_fde *first = NULL, *last = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        struct sr_elf_fde *fde = g_malloc0(sizeof(*fde));
+
+        fde->exec_base = exec_base;
+        fde->start_address = ranges[i][0];
+        fde->length = ranges[i][1];
+
+        if (last)
+            last->next = fde;
+        else
+            first = fde;
+
+        last = fde;
+    }
+
+    return first;
+}
+
+static void
+assert_same_fde(struct sr_elf_fde *fde1, struct sr_elf_fde *fde2)
+{
+    if (!fde1 || !fde2)
+    {
+        g_assert_true(fde1 == fde2);
+        return;
+    }
+
+    g_assert_cmpuint(fde1->start_address, ==, fde2->start_address);
+    g_assert_cmpuint(fde1->length, ==, fde2->length);
+}
+
+static void
+check_index_lookups(struct sr_elf_fde_index *index, struct sr_elf_fde *eh_frame,
+                    uint64_t exec_base)
+{
+    /* The addresses below the exec base are also valid offsets of the FDEs,
+     * they must not be found by address. */
+    for (uint64_t offset = 0; offset < 0x400; offset++)
+    {
+        assert_same_fde(sr_elf_fde_index_find_for_offset(index, offset),
+                        sr_elf_find_fde_for_offset(eh_frame, offset));
+    }
+
+    for (uint64_t address = 0; address < exec_base + 0x400; address++)
+    {
+        assert_same_fde(sr_elf_fde_index_find_for_address(index, address),
+                        sr_elf_find_fde_for_address(eh_frame, address));
+        assert_same_fde(sr_elf_fde_index_find_for_start_address(index, address),
+                        sr_elf_find_fde_for_start_address(eh_frame, address));
+    }
+}
+
+static void
+test_elf_fde_index(void)
+{
+    /* Unsorted, the FDEs starting at 0x100 and 0x200 differ in length so
+     * that the first one of them in the list can be recognized. */
+    const uint64_t ranges[][2] =
+    {
+        { 0x300, 0x20 },
+        { 0x100, 0x10 },
+        { 0x200, 0x40 },
+        { 0x100, 0x30 },
+        { 0x180, 0x8 },
+        { 0x200, 0x10 },
+    };
+    uint64_t exec_base = 0x1000;
+    struct sr_elf_fde *eh_frame = fde_list_new(exec_base, ranges,
+                                               G_N_ELEMENTS(ranges));
+    struct sr_elf_fde_index *index = sr_elf_fde_index_new(eh_frame);
+
+    g_assert_cmpuint(index->count, ==, G_N_ELEMENTS(ranges));
+    for (size_t i = 0; i + 1 < index->count; i++)
+    {
+        g_assert_true(index->fdes[i].next == &index->fdes[i + 1]);
+        g_assert_cmpuint(index->fdes[i].start_address, <=,
+                         index->fdes[i + 1].start_address);
+    }
+
+    g_assert_null(index->fdes[index->count - 1].next);
+
+    /* The FDEs starting at the same address keep their order. */
+    g_assert_cmpuint(index->fdes[0].length, ==, 0x10);
+    g_assert_cmpuint(index->fdes[1].length, ==, 0x30);
+    g_assert_cmpuint(index->fdes[3].length, ==, 0x40);
+    g_assert_cmpuint(index->fdes[4].length, ==, 0x10);
+
+    check_index_lookups(index, eh_frame, exec_base);
+
+    /* The sorted array of the index is an FDE list too, it is copied
+     * without sorting. */
+    struct sr_elf_fde_index *sorted_index = sr_elf_fde_index_new(index->fdes);
+    check_index_lookups(sorted_index, eh_frame, exec_base);
+
+    sr_elf_fde_index_free(sorted_index);
+    sr_elf_fde_index_free(index);
+    sr_elf_eh_frame_free(eh_frame);
+}
+
+static void
+test_elf_fde_index_empty(void)
+{
+    struct sr_elf_fde_index *index = sr_elf_fde_index_new(NULL);
+
+    g_assert_cmpuint(index->count, ==, 0);
+    g_assert_null(sr_elf_fde_index_find_for_offset(index, 0));
+    g_assert_null(sr_elf_fde_index_find_for_address(index, 0));
+    g_assert_null(sr_elf_fde_index_find_for_start_address(index, 0));
+
+    sr_elf_fde_index_free(index);
+}
+
+int
+main(int    argc,
+     char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/elves/fde-index", test_elf_fde_index);
+    g_test_add_func("/elves/fde-index-empty", test_elf_fde_index_empty);
+
+    return g_test_run();
+}
@@ -1,9 +1,11 @@
+#include "arena.h"
 #include "stacktrace.h"
 #include "thread.h"
 #include "gdb/frame.h"
 #include "gdb/thread.h"
 #include "gdb/stacktrace.h"
 #include "location.h"
+#include "normalize.h"
 #include "utils.h"
 #include <stdio.h>
 #include <glib.h>
@@ -230,6 +232,58 @@ test_gdb_stacktrace_parse_ppc64(void)
     sr_gdb_stacktrace_free(stacktrace);
 }
 
+static void
+test_gdb_stacktrace_parse_arena(void)
+{
+    /* Check that a stacktrace allocated from an arena equals the one
+     * allocated by g_malloc() and is released together with the arena. */
+    char *error_message = NULL;
+    g_autofree char *full_input = sr_file_to_string("gdb_stacktraces/rhbz-803600", &error_message);
+    g_assert_nonnull(full_input);
+    struct sr_gdb_stacktrace *expected = (struct sr_gdb_stacktrace *)
+        sr_stacktrace_parse(SR_REPORT_GDB, full_input, &error_message);
+    g_assert_nonnull(expected);
+    g_autofree char *expected_text = sr_gdb_stacktrace_to_text(expected, true);
+
+    struct sr_arena *arena = sr_arena_new();
+    struct sr_gdb_stacktrace *stacktrace = (struct sr_gdb_stacktrace *)
+        sr_stacktrace_parse_arena(arena, SR_REPORT_GDB, full_input, &error_message);
+    g_assert_nonnull(stacktrace);
+    g_assert_cmpuint(sr_arena_size(arena), >, 0);
+    g_autofree char *text = sr_gdb_stacktrace_to_text(stacktrace, true);
+    g_assert_cmpstr(text, ==, expected_text);
+
+    sr_arena_free(arena);
+    sr_gdb_stacktrace_free(expected);
+}
+
+static void
+test_gdb_stacktrace_parse_arena_normalize(void)
+{
+    /* Normalization mixes strings allocated by g_malloc() into the
+     * stacktrace, the free function must release only those. */
+    char *error_message = NULL;
+    g_autofree char *full_input = sr_file_to_string("gdb_stacktraces/rhbz-621492", &error_message);
+    g_assert_nonnull(full_input);
+    struct sr_gdb_stacktrace *expected = (struct sr_gdb_stacktrace *)
+        sr_stacktrace_parse(SR_REPORT_GDB, full_input, &error_message);
+    g_assert_nonnull(expected);
+    sr_normalize_gdb_stacktrace(expected);
+    g_autofree char *expected_text = sr_gdb_stacktrace_to_text(expected, true);
+
+    struct sr_arena *arena = sr_arena_new();
+    struct sr_gdb_stacktrace *stacktrace = (struct sr_gdb_stacktrace *)
+        sr_stacktrace_parse_arena(arena, SR_REPORT_GDB, full_input, &error_message);
+    g_assert_nonnull(stacktrace);
+    sr_normalize_gdb_stacktrace(stacktrace);
+    g_autofree char *text = sr_gdb_stacktrace_to_text(stacktrace, true);
+    g_assert_cmpstr(text, ==, expected_text);
+
+    sr_gdb_stacktrace_free(stacktrace);
+    sr_arena_free(arena);
+    sr_gdb_stacktrace_free(expected);
+}
+
 
 int
 main(int    argc,
@@ -244,6 +298,8 @@ main(int    argc,
     g_test_add_func("/stacktrace/gdb/get-crash-frame", test_gdb_stacktrace_get_crash_frame);
     g_test_add_func("/stacktrace/gdb/parse-no-thread-header", test_gdb_stacktrace_parse_no_thread_header);
     g_test_add_func("/stacktrace/gdb/parse-ppc64", test_gdb_stacktrace_parse_ppc64);
+    g_test_add_func("/stacktrace/gdb/parse-arena", test_gdb_stacktrace_parse_arena);
+    g_test_add_func("/stacktrace/gdb/parse-arena-normalize", test_gdb_stacktrace_parse_arena_normalize);
 
     return g_test_run();
 }
@@ -751,6 +751,144 @@ test_thread_get_duphash(void)
     sr_koops_stacktrace_free(stacktrace);
 }
 
+static void
+test_thread_get_duphash_normalized(void)
+{
+    struct sr_koops_stacktrace *stacktrace = sr_koops_stacktrace_new();
+    struct sr_thread *thread = (struct sr_thread *)stacktrace;
+    const char *names[] = { "warn_slowpath_common", "foo.isra.0", "bar" };
+
+    sr_intern_pool_enable();
+    for (int i = 2; i >= 0; i--)
+    {
+        struct sr_koops_frame *frame = sr_koops_frame_new();
+        frame->function_name = sr_intern_strdup(names[i]);
+        frame->reliable = 1;
+        frame->next = stacktrace->frames;
+        stacktrace->frames = frame;
+    }
+    sr_intern_pool_disable();
+
+    /* The normalized thread is hashed, the thread stays as it was. */
+    char *text = sr_thread_get_duphash(thread, 0, NULL, SR_DUPHASH_NOHASH);
+    g_assert_cmpstr(text, ==, "Thread\nfoo\nbar\n");
+
+    char *expected = g_compute_checksum_for_string(G_CHECKSUM_SHA1, text, -1);
+    char *hash = sr_thread_get_duphash(thread, 0, NULL, SR_DUPHASH_NORMAL);
+    g_assert_cmpstr(hash, ==, expected);
+
+    struct sr_koops_frame *frame = stacktrace->frames;
+    for (int i = 0; i < 3; i++, frame = frame->next)
+        g_assert_cmpstr(frame->function_name, ==, names[i]);
+
+    /* Normalization must not modify the names shared with the copy. */
+    struct sr_koops_stacktrace *copy = sr_koops_stacktrace_dup(stacktrace);
+    g_assert_true(copy->frames->next->function_name ==
+                  stacktrace->frames->next->function_name);
+    sr_normalize_koops_stacktrace(copy);
+    g_assert_cmpstr(copy->frames->function_name, ==, "foo");
+    g_assert_cmpstr(copy->frames->next->function_name, ==, "bar");
+    g_assert_cmpstr(stacktrace->frames->next->function_name, ==, "foo.isra.0");
+
+    sr_koops_stacktrace_free(copy);
+    sr_koops_stacktrace_free(stacktrace);
+    g_assert_cmpuint(sr_intern_pool_size(), ==, 0);
+    g_free(hash);
+    g_free(expected);
+    g_free(text);
+}
+
+static void
+test_thread_get_duphash_fast(void)
+{
+    struct sr_koops_stacktrace *stacktrace = sr_koops_stacktrace_new();
+    struct sr_thread *thread = (struct sr_thread *)stacktrace;
+
+    /* Without frames, only the prefix is hashed. MurmurHash3 x64_128 of
+     * "hello". */
+    char *hash = sr_thread_get_duphash(thread, 0, "hello",
+                                       SR_DUPHASH_KOOPS_COMPAT | SR_DUPHASH_FAST);
+    g_assert_cmpstr(hash, ==, "cbd8a7b341bd9b025b1e906a48ae1d19");
+    g_free(hash);
+
+    struct sr_koops_frame *frame = sr_koops_frame_new();
+    frame->function_name = g_strdup("omg_warn_slowpath_common");
+    frame->reliable = 1;
+    stacktrace->frames = frame;
+
+    char *sha1 = sr_thread_get_duphash(thread, 0, NULL, SR_DUPHASH_NORMAL);
+    hash = sr_thread_get_duphash(thread, 0, NULL, SR_DUPHASH_FAST);
+    g_assert_cmpuint(strlen(sha1), ==, 40);
+    g_assert_cmpuint(strlen(hash), ==, 32);
+
+    char *text = sr_thread_get_duphash(thread, 0, NULL,
+                                       SR_DUPHASH_FAST | SR_DUPHASH_NOHASH);
+    g_assert_cmpstr(text, ==, "Thread\nomg_warn_slowpath_common\n");
+
+    g_free(text);
+    g_free(hash);
+    g_free(sha1);
+    sr_koops_stacktrace_free(stacktrace);
+}
+
+static void
+test_threads_get_duphash_batch(void)
+{
+    const char *names[] = { "warn_slowpath_common", "foo.isra.0", "bar",
+                            "baz", "qux" };
+    enum sr_duphash_flags flags[] =
+    {
+        SR_DUPHASH_NORMAL,
+        SR_DUPHASH_FAST,
+        SR_DUPHASH_NOHASH | SR_DUPHASH_KOOPS_COMPAT,
+    };
+    int n = 1000;
+
+    /* Threads with up to four frames, some of them reliable. Enough of
+     * them to be split among the workers. */
+    struct sr_thread **threads = g_malloc_n(n, sizeof(*threads));
+    for (int i = 0; i < n; i++)
+    {
+        struct sr_koops_stacktrace *stacktrace = sr_koops_stacktrace_new();
+
+        for (int j = 0; j < i % 5; j++)
+        {
+            struct sr_koops_frame *frame = sr_koops_frame_new();
+            frame->function_name = g_strdup(names[(i + j) % G_N_ELEMENTS(names)]);
+            frame->reliable = (i >> j) & 1;
+            frame->next = stacktrace->frames;
+            stacktrace->frames = frame;
+        }
+
+        threads[i] = (struct sr_thread *)stacktrace;
+    }
+
+    char **out = g_malloc_n(n, sizeof(*out));
+    for (size_t k = 0; k < G_N_ELEMENTS(flags); k++)
+    {
+        for (unsigned nthreads = 0; nthreads < 4; nthreads++)
+        {
+            sr_threads_get_duphash_batch_parallel(threads, n, 2, "prefix\n",
+                                                  flags[k], out, nthreads);
+
+            for (int i = 0; i < n; i++)
+            {
+                char *expected = sr_thread_get_duphash(threads[i], 2,
+                                                       "prefix\n", flags[k]);
+                g_assert_cmpstr(out[i], ==, expected);
+                g_free(expected);
+                g_free(out[i]);
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+        sr_thread_free(threads[i]);
+
+    g_free(out);
+    g_free(threads);
+}
+
 static void
 test_koops_stacktrace_get_reason(void)
 {
@@ -787,6 +925,9 @@ main(int    argc,
     g_test_add_func("/stacktrace/koops/parse", test_koops_stacktrace_parse);
     g_test_add_func("/stacktrace/koops/to-json", test_koops_stacktrace_to_json);
     g_test_add_func("/thread/get-duphash", test_thread_get_duphash);
+    g_test_add_func("/thread/get-duphash/normalized", test_thread_get_duphash_normalized);
+    g_test_add_func("/thread/get-duphash/fast", test_thread_get_duphash_fast);
+    g_test_add_func("/thread/get-duphash/batch", test_threads_get_duphash_batch);
     g_test_add_func("/stacktrace/koops/get-reason", test_koops_stacktrace_get_reason);
 
     return g_test_run();
@@ -1,11 +1,20 @@
+#include <core/frame.h>
+#include <core/thread.h>
 #include <distance.h>
+#include <frozen.h>
+#include <frozen_thread.h>
 #include <gdb/frame.h>
 #include <gdb/thread.h>
 #include <glib.h>
 #include <math.h>
+#include <minhash.h>
 #include <normalize.h>
+#include <report_type.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 #include <utils.h>
+#include <unistd.h>
 
 typedef struct
 {
@@ -270,6 +279,592 @@ test_distances_threads_compare(void)
     }
 }
 
+static float
+reference_distance(struct sr_gdb_thread *thread1,
+                   struct sr_gdb_thread *thread2,
+                   enum sr_distance_type dist_type)
+{
+    struct sr_gdb_thread *copy1 = sr_gdb_thread_dup(thread1, false);
+    struct sr_gdb_thread *copy2 = sr_gdb_thread_dup(thread2, false);
+    float distance;
+
+    sr_normalize_gdb_paired_unknown_function_names(copy1, copy2);
+    distance = sr_distance(dist_type, (struct sr_thread *)copy1,
+                           (struct sr_thread *)copy2);
+
+    sr_gdb_thread_free(copy1);
+    sr_gdb_thread_free(copy2);
+
+    return distance;
+}
+
+static void
+test_distances_threads_compare_symbols(void)
+{
+    struct sr_gdb_thread *threads[10];
+    struct sr_gdb_frame *frame;
+
+    prepare_threads(threads);
+
+    /* "foo" is seen with two libraries, so the frame without a library
+     * matches both of them. */
+    threads[8] = create_thread(3, "foo", "bar", "baz");
+    threads[9] = create_thread(3, "foo", "bar", "baz");
+    threads[8]->frames->library_name = g_strdup("libfoo.so");
+    threads[9]->frames->library_name = g_strdup("libbar.so");
+    frame = threads[5]->frames->next->next;
+    g_assert_cmpstr(frame->function_name, ==, "foo");
+    g_assert_null(frame->library_name);
+    /* "bar" is seen with a single library. */
+    threads[8]->frames->next->library_name = g_strdup("libbar.so");
+
+    for (int dist_type = 0; dist_type < SR_DISTANCE_NUM; dist_type++)
+    {
+        struct sr_distances *distances;
+        int n = G_N_ELEMENTS(threads);
+
+        distances = sr_threads_compare((struct sr_thread **)threads, n - 1, n,
+                                       dist_type);
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++)
+            {
+                float expected = reference_distance(threads[i], threads[j],
+                                                    dist_type);
+
+                g_assert_cmpfloat(sr_distances_get_distance(distances, i, j),
+                                  ==, expected);
+            }
+        }
+
+        sr_distances_free(distances);
+    }
+
+    for (size_t i = 0; i < G_N_ELEMENTS(threads); i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
+static void
+test_distances_threads_compare_paired_unknown(void)
+{
+    struct sr_gdb_thread *threads[6];
+    int n = G_N_ELEMENTS(threads);
+
+    /* The unknown frames followed by the same function are paired. */
+    threads[0] = create_thread(5, "??", "foo", "??", "bar", "baz");
+    threads[1] = create_thread(5, "??", "foo", "??", "bar", "qux");
+    threads[2] = create_thread(4, "??", "foo", "??", "baz");
+    threads[3] = create_thread(4, "abc", "??", "bar", "baz");
+    /* A frame clashing with the name of a paired frame. */
+    threads[4] = create_thread(5, "__unknown_function_0", "foo", "??",
+                               "bar", "baz");
+    threads[5] = create_thread(3, "??", "??", "foo");
+    threads[5]->frames->library_name = g_strdup("libfoo.so");
+
+    for (int dist_type = 0; dist_type < SR_DISTANCE_NUM; dist_type++)
+    {
+        struct sr_distances *distances;
+
+        distances = sr_threads_compare((struct sr_thread **)threads, n - 1, n,
+                                       dist_type);
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++)
+            {
+                float expected = reference_distance(threads[i], threads[j],
+                                                    dist_type);
+
+                g_assert_cmpfloat(sr_distances_get_distance(distances, i, j),
+                                  ==, expected);
+            }
+        }
+
+        sr_distances_free(distances);
+    }
+
+    /* The threads are left intact. */
+    g_assert_cmpstr(threads[0]->frames->function_name, ==, "??");
+    g_assert_cmpstr(threads[1]->frames->next->next->function_name, ==, "??");
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
+static void
+test_distances_threads_compare_long(void)
+{
+    /* Lengths around the 64-frame words of the bit-parallel Levenshtein
+     * distance. */
+    const int frame_counts[] = { 1, 2, 63, 64, 65, 100, 127, 128, 129, 200 };
+    const char *names[] = { "a", "b", "c", "d", "e", "f", "g", "??" };
+    struct sr_gdb_thread *threads[2 * G_N_ELEMENTS(frame_counts) + 2];
+    char *function_names[200];
+    int n = G_N_ELEMENTS(threads);
+
+    for (int i = 0; i < n - 2; i++)
+    {
+        int frame_count = frame_counts[i / 2];
+
+        /* Every other thread is free of unknown frames. */
+        for (int j = 0; j < frame_count; j++)
+        {
+            int name = (i * 31 + j * j * 7 + j / 5) % (i % 2 ? 8 : 7);
+            function_names[j] = (char *)names[name];
+        }
+
+        threads[i] = create_threadv(frame_count, function_names);
+    }
+
+    /* Transpositions across the words. */
+    for (int j = 0; j < 130; j++)
+        function_names[j] = (char *)names[j % 7];
+
+    threads[n - 2] = create_threadv(130, function_names);
+    function_names[63] = (char *)names[64 % 7];
+    function_names[64] = (char *)names[63 % 7];
+    function_names[127] = (char *)names[128 % 7];
+    function_names[128] = (char *)names[127 % 7];
+    threads[n - 1] = create_threadv(130, function_names);
+
+    for (int dist_type = SR_DISTANCE_LEVENSHTEIN;
+         dist_type <= SR_DISTANCE_DAMERAU_LEVENSHTEIN;
+         dist_type++)
+    {
+        struct sr_distances *distances;
+
+        distances = sr_threads_compare((struct sr_thread **)threads, n - 1, n,
+                                       dist_type);
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++)
+            {
+                float expected = reference_distance(threads[i], threads[j],
+                                                    dist_type);
+
+                g_assert_cmpfloat(sr_distances_get_distance(distances, i, j),
+                                  ==, expected);
+            }
+        }
+
+        sr_distances_free(distances);
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
+static void
+test_distances_threads_compare_jaccard(void)
+{
+    /* Sets of various sizes around the blocks of the vectorized
+     * intersection, with repeated and unknown frames. */
+    struct sr_gdb_thread *threads[24];
+    char *function_names[100];
+    char *names[60];
+    int n = G_N_ELEMENTS(threads);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(names); i++)
+        names[i] = i % 13 ? g_strdup_printf("f%zu", i) : g_strdup("??");
+
+    for (int i = 0; i < n; i++)
+    {
+        int frame_count = (i * 37) % 100;
+
+        for (int j = 0; j < frame_count; j++)
+            function_names[j] = names[(i * 5 + j * (i % 3 + 1)) % 60];
+
+        threads[i] = create_threadv(frame_count, function_names);
+    }
+
+    struct sr_distances *distances;
+
+    distances = sr_threads_compare((struct sr_thread **)threads, n - 1, n,
+                                   SR_DISTANCE_JACCARD);
+
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            float expected = reference_distance(threads[i], threads[j],
+                                                SR_DISTANCE_JACCARD);
+
+            g_assert_cmpfloat(sr_distances_get_distance(distances, i, j),
+                              ==, expected);
+        }
+    }
+
+    sr_distances_free(distances);
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+
+    for (size_t i = 0; i < G_N_ELEMENTS(names); i++)
+        g_free(names[i]);
+}
+
+static void
+test_distances_threads_compare_parallel(void)
+{
+    struct sr_gdb_thread *threads[40];
+    const char *names[] = { "a", "b", "c", "d", "e", "??" };
+    int n = G_N_ELEMENTS(threads);
+
+    for (int i = 0; i < n; i++)
+    {
+        char *function_names[6];
+        int frame_count = i % 7;
+
+        for (int j = 0; j < frame_count; j++)
+            function_names[j] = (char *)names[(i * 7 + j * 3) % 6];
+
+        threads[i] = create_threadv(frame_count, function_names);
+    }
+
+    for (int dist_type = 0; dist_type < SR_DISTANCE_NUM; dist_type++)
+    {
+        struct sr_distances *reference;
+        unsigned nthreads[] = { 0, 1, 2, 3, 8, 64 };
+
+        reference = sr_threads_compare((struct sr_thread **)threads, n - 1, n,
+                                       dist_type);
+
+        for (size_t k = 0; k < G_N_ELEMENTS(nthreads); k++)
+        {
+            struct sr_distances *distances;
+
+            distances = sr_threads_compare_parallel((struct sr_thread **)threads,
+                                                    n - 1, n, dist_type,
+                                                    nthreads[k]);
+
+            g_assert_cmpint(distances->m, ==, reference->m);
+            g_assert_cmpint(distances->n, ==, reference->n);
+
+            for (int i = 0; i < n - 1; i++)
+            {
+                for (int j = i + 1; j < n; j++)
+                {
+                    g_assert_cmpfloat(sr_distances_get_distance(distances, i, j),
+                                      ==,
+                                      sr_distances_get_distance(reference, i, j));
+                }
+            }
+
+            sr_distances_free(distances);
+        }
+
+        sr_distances_free(reference);
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
+static void
+test_distance_jaro_winkler(void)
+{
+    struct sr_gdb_thread *threads[4];
+    struct sr_thread **t = (struct sr_thread **)threads;
+
+    threads[0] = create_thread(4, "a", "a", "a", "a");
+    threads[1] = create_thread(4, "a", "b", "b", "b");
+    threads[2] = create_thread(4, "a", "b", "c", "d");
+    threads[3] = create_thread(4, "b", "a", "d", "c");
+
+    /* Only the first frame matches. */
+    g_assert_cmpfloat_with_epsilon(sr_distance(SR_DISTANCE_JARO_WINKLER,
+                                               t[0], t[1]),
+                                   0.6, 1e-6);
+    g_assert_cmpfloat(sr_distance(SR_DISTANCE_JARO_WINKLER, t[0], t[1]), ==,
+                      sr_distance(SR_DISTANCE_JARO_WINKLER, t[1], t[0]));
+    /* The first frame of the second thread used to be matched twice,
+     * which also extended the prefix. */
+    g_assert_cmpfloat_with_epsilon(sr_distance(SR_DISTANCE_JARO_WINKLER_COMPAT,
+                                               t[0], t[1]),
+                                   0.75, 1e-6);
+
+    /* Four matches, all of them transposed. */
+    g_assert_cmpfloat_with_epsilon(sr_distance(SR_DISTANCE_JARO_WINKLER,
+                                               t[2], t[3]),
+                                   2.5 / 3.0, 1e-6);
+    g_assert_cmpfloat_with_epsilon(sr_distance(SR_DISTANCE_JARO_WINKLER_COMPAT,
+                                               t[2], t[3]),
+                                   2.5 / 3.0, 1e-6);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(threads); i++)
+    {
+        g_assert_cmpfloat(sr_distance(SR_DISTANCE_JARO_WINKLER, t[i], t[i]),
+                          ==, 1.0);
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
+/* The Jaro-Winkler distances are similarities. */
+static bool
+is_similarity(enum sr_distance_type dist_type)
+{
+    return dist_type == SR_DISTANCE_JARO_WINKLER ||
+           dist_type == SR_DISTANCE_JARO_WINKLER_COMPAT;
+}
+
+/* Whether neighbor1 is nearer than neighbor2 or at the same distance
+ * with a lower index. */
+static bool
+neighbor_before(enum sr_distance_type dist_type,
+                struct sr_thread_neighbor *neighbor1,
+                struct sr_thread_neighbor *neighbor2)
+{
+    if (neighbor1->distance == neighbor2->distance)
+        return neighbor1->index < neighbor2->index;
+
+    if (is_similarity(dist_type))
+        return neighbor1->distance > neighbor2->distance;
+
+    return neighbor1->distance < neighbor2->distance;
+}
+
+static void
+test_threads_nearest(void)
+{
+    struct sr_gdb_thread *corpus[150];
+    const char *names[] = { "a", "b", "c", "d", "e", "??" };
+    const int ks[] = { 0, 1, 5, 64, 200 };
+    int n = G_N_ELEMENTS(corpus);
+
+    for (int i = 0; i < n; i++)
+    {
+        char *function_names[10];
+        int frame_count = i % 10;
+
+        for (int j = 0; j < frame_count; j++)
+            function_names[j] = (char *)names[(i * 7 + j * j * 3 + j / 2) % 6];
+
+        corpus[i] = create_threadv(frame_count, function_names);
+    }
+
+    for (int dist_type = 0; dist_type < SR_DISTANCE_NUM; dist_type++)
+    {
+        for (int q = 0; q < n; q += 37)
+        {
+            struct sr_thread *query = (struct sr_thread *)corpus[q];
+            struct sr_thread_neighbor all[G_N_ELEMENTS(corpus)];
+
+            for (int i = 0; i < n; i++)
+            {
+                all[i].index = i;
+                all[i].distance = reference_distance(corpus[q], corpus[i],
+                                                     dist_type);
+            }
+
+            for (size_t k = 0; k < G_N_ELEMENTS(ks); k++)
+            {
+                for (unsigned nthreads = 1; nthreads <= 4; nthreads += 3)
+                {
+                    struct sr_thread_neighbor results[200];
+                    bool found[G_N_ELEMENTS(corpus)] = { false };
+                    int count;
+
+                    count = sr_threads_nearest_parallel(query,
+                                                        (struct sr_thread **)corpus,
+                                                        n, dist_type, ks[k],
+                                                        results, nthreads);
+                    g_assert_cmpint(count, ==, MIN(ks[k], n));
+
+                    for (int i = 0; i < count; i++)
+                    {
+                        int index = results[i].index;
+
+                        g_assert_cmpfloat(results[i].distance, ==,
+                                          all[index].distance);
+                        if (i > 0)
+                            g_assert_true(neighbor_before(dist_type,
+                                                          &results[i - 1],
+                                                          &results[i]));
+                        found[index] = true;
+                    }
+
+                    /* No thread left out is nearer than the found ones. */
+                    for (int i = 0; i < n && count > 0; i++)
+                    {
+                        if (!found[i])
+                            g_assert_true(neighbor_before(dist_type,
+                                                          &results[count - 1],
+                                                          &all[i]));
+                    }
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(corpus[i]);
+    }
+}
+
+static void
+test_distance_bounded(void)
+{
+    struct sr_gdb_thread *threads[12];
+    const char *names[] = { "a", "b", "c", "d", "??" };
+    const float bounds[] = { -0.1, 0.0, 0.1, 0.25, 0.3, 0.5, 0.75, 1.0 };
+    int n = G_N_ELEMENTS(threads);
+
+    prepare_threads(threads);
+
+    /* Longer threads, a few edits apart. */
+    for (int i = 8; i < n; i++)
+    {
+        char *function_names[40];
+        int frame_count = 20 + i;
+
+        for (int j = 0; j < frame_count; j++)
+            function_names[j] = (char *)names[(j + (j % (i + 2) == 0)) % 5];
+
+        threads[i] = create_threadv(frame_count, function_names);
+    }
+
+    for (int dist_type = 0; dist_type < SR_DISTANCE_NUM; dist_type++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                float distance = sr_distance(dist_type,
+                                             (struct sr_thread *)threads[i],
+                                             (struct sr_thread *)threads[j]);
+
+                for (size_t k = 0; k < G_N_ELEMENTS(bounds); k++)
+                {
+                    float bounded = sr_distance_bounded(dist_type,
+                                                        (struct sr_thread *)threads[i],
+                                                        (struct sr_thread *)threads[j],
+                                                        bounds[k]);
+
+                    if (is_similarity(dist_type))
+                    {
+                        if (distance >= 1.0 - bounds[k])
+                            g_assert_cmpfloat(bounded, ==, distance);
+                        else
+                            g_assert_cmpfloat(bounded, <, 1.0 - bounds[k]);
+                    }
+                    else
+                    {
+                        if (distance <= bounds[k])
+                            g_assert_cmpfloat(bounded, ==, distance);
+                        else
+                            g_assert_cmpfloat(bounded, >, bounds[k]);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
+static void
+test_minhash_index(void)
+{
+    struct sr_gdb_thread *threads[60];
+    struct sr_minhash_index *index;
+    int n = G_N_ELEMENTS(threads);
+
+    /* Families of threads which differ in a frame or two. */
+    for (int i = 0; i < n; i++)
+    {
+        char *function_names[20];
+        int family = i / 6;
+
+        for (int j = 0; j < 20; j++)
+        {
+            int variant = j == i % 6 || j == 2 * (i % 3) ? i : family;
+            function_names[j] = g_strdup_printf("f%d_%d", variant, j);
+        }
+
+        threads[i] = create_threadv(20, function_names);
+
+        for (int j = 0; j < 20; j++)
+            g_free(function_names[j]);
+    }
+
+    index = sr_minhash_index_new(32, 4);
+
+    for (int i = 0; i < n; i++)
+    {
+        g_assert_cmpint(sr_minhash_index_insert(index,
+                                                (struct sr_thread *)threads[i]),
+                        ==, i);
+    }
+
+    g_assert_cmpint(sr_minhash_index_size(index), ==, n);
+
+    for (int i = 0; i < n; i++)
+    {
+        int count, found = 0;
+        float *distances;
+        int *ids;
+
+        /* The thread itself is always a candidate. */
+        ids = sr_minhash_index_query(index, (struct sr_thread *)threads[i],
+                                     &count);
+        while (found < count && ids[found] != i)
+            found++;
+        g_assert_cmpint(found, <, count);
+        g_free(ids);
+
+        found = 0;
+
+        ids = sr_minhash_index_query_distance(index,
+                                              (struct sr_thread *)threads[i],
+                                              SR_DISTANCE_JACCARD, 0.3,
+                                              &count, &distances);
+
+        for (int j = 0; j < n; j++)
+        {
+            float distance = sr_distance(SR_DISTANCE_JACCARD,
+                                         (struct sr_thread *)threads[i],
+                                         (struct sr_thread *)threads[j]);
+
+            if (distance > 0.3)
+                continue;
+
+            /* The similar threads are found with high probability, the
+             * hash functions are fixed so this is deterministic. */
+            g_assert_cmpint(found, <, count);
+            g_assert_cmpint(ids[found], ==, j);
+            g_assert_cmpfloat(distances[found], ==, distance);
+            found++;
+        }
+
+        g_assert_cmpint(found, ==, count);
+        g_free(ids);
+        g_free(distances);
+    }
+
+    sr_minhash_index_free(index);
+
+    for (int i = 0; i < n; i++)
+    {
+        sr_gdb_thread_free(threads[i]);
+    }
+}
+
 static void
 test_distances_part_divide(void)
 {
@@ -399,6 +994,428 @@ test_distances_part_conquer(void)
     }
 }
 
+static void
+test_distances_storage(void)
+{
+    struct sr_gdb_thread *threads[8];
+    struct sr_distances *reference, *distances;
+
+    distances = sr_distances_new_ext(1, 1002, SR_DISTANCES_FLOAT16);
+    g_assert_null(distances->distances);
+    for (int j = 1; j <= 1001; j++)
+        sr_distances_set_distance(distances, 0, j, (j - 1) / 1000.0f);
+    for (int j = 1; j <= 1001; j++)
+    {
+        float d = (j - 1) / 1000.0f;
+        g_assert_cmpfloat(fabsf(sr_distances_get_distance(distances, 0, j) - d),
+                          <=, d / 2048);
+    }
+    g_assert_cmpfloat(sr_distances_get_distance(distances, 0, 501), ==, 0.5f);
+    g_assert_cmpfloat(sr_distances_get_distance(distances, 0, 1001), ==, 1.0f);
+    sr_distances_free(distances);
+
+    distances = sr_distances_new_ext(1, 1002, SR_DISTANCES_UINT8);
+    for (int j = 1; j <= 1001; j++)
+        sr_distances_set_distance(distances, 0, j, (j - 1) / 1000.0f);
+    for (int j = 1; j <= 1001; j++)
+    {
+        float d = (j - 1) / 1000.0f;
+        g_assert_cmpfloat(fabsf(sr_distances_get_distance(distances, 0, j) - d),
+                          <=, 1.0f / 510 + FLT_EPSILON);
+    }
+    /* Out of range values are clamped. */
+    sr_distances_set_distance(distances, 1, 0, 1.5f);
+    g_assert_cmpfloat(sr_distances_get_distance(distances, 0, 1), ==, 1.0f);
+    sr_distances_set_distance(distances, 0, 1, -0.5f);
+    g_assert_cmpfloat(sr_distances_get_distance(distances, 1, 0), ==, 0.0f);
+    sr_distances_free(distances);
+
+    prepare_threads(threads);
+    reference = sr_threads_compare((struct sr_thread **)threads, 7, 8,
+                                   SR_DISTANCE_LEVENSHTEIN);
+    distances = sr_threads_compare_ext((struct sr_thread **)threads, 7, 8,
+                                       SR_DISTANCE_LEVENSHTEIN, 2,
+                                       SR_DISTANCES_UINT8);
+    g_assert_cmpint(distances->storage, ==, SR_DISTANCES_UINT8);
+
+    struct sr_distances *dup = sr_distances_dup(distances);
+    g_assert_cmpint(dup->storage, ==, SR_DISTANCES_UINT8);
+
+    for (int i = 0; i < 7; i++)
+    {
+        for (int j = i + 1; j < 8; j++)
+        {
+            float d = sr_distances_get_distance(distances, i, j);
+
+            g_assert_cmpfloat(fabsf(d - sr_distances_get_distance(reference, i, j)),
+                              <=, 1.0f / 510 + FLT_EPSILON);
+            g_assert_cmpfloat(d, ==, sr_distances_get_distance(dup, i, j));
+        }
+    }
+
+    sr_distances_free(dup);
+    sr_distances_free(distances);
+    sr_distances_free(reference);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(threads); i++)
+        sr_gdb_thread_free(threads[i]);
+}
+
+static void
+test_distances_extend(void)
+{
+    struct sr_gdb_thread *threads[8];
+    struct sr_thread **all = (struct sr_thread **)threads;
+    struct sr_distances *reference, *old, *extended;
+
+    prepare_threads(threads);
+    reference = sr_threads_compare(all, 7, 8, SR_DISTANCE_DAMERAU_LEVENSHTEIN);
+
+    /* Full and partial old matrices, serial and parallel computation. */
+    int test_data[][3] =
+    {
+        { 4, 5, 1, },
+        { 4, 5, 3, },
+        { 2, 5, 2, },
+        { 1, 2, 4, },
+        { 6, 7, 1, },
+    };
+
+    for (size_t k = 0; k < G_N_ELEMENTS(test_data); k++)
+    {
+        int old_m = test_data[k][0], old_n = test_data[k][1];
+
+        old = sr_threads_compare(all, old_m, old_n,
+                                 SR_DISTANCE_DAMERAU_LEVENSHTEIN);
+        extended = sr_distances_extend(old, all, all + old_n, 8 - old_n,
+                                       SR_DISTANCE_DAMERAU_LEVENSHTEIN,
+                                       test_data[k][2]);
+        g_assert_nonnull(extended);
+        g_assert_cmpint(extended->m, ==, 7);
+        g_assert_cmpint(extended->n, ==, 8);
+        g_assert_cmpuint(extended->checksum, ==, reference->checksum);
+
+        for (int i = 0; i < 7; i++)
+        {
+            for (int j = i + 1; j < 8; j++)
+            {
+                g_assert_cmpfloat(sr_distances_get_distance(extended, i, j), ==,
+                                  sr_distances_get_distance(reference, i, j));
+            }
+        }
+
+        sr_distances_free(extended);
+
+        /* The matrix must match the distance type and the threads. */
+        g_assert_null(sr_distances_extend(old, all, all + old_n, 8 - old_n,
+                                          SR_DISTANCE_JACCARD, 1));
+        g_assert_null(sr_distances_extend(old, all + 1, all + old_n,
+                                          7 - old_n,
+                                          SR_DISTANCE_DAMERAU_LEVENSHTEIN, 1));
+
+        sr_distances_free(old);
+    }
+
+    sr_distances_free(reference);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(threads); i++)
+        sr_gdb_thread_free(threads[i]);
+}
+
+static void
+test_distances_save_load(void)
+{
+    struct sr_gdb_thread *threads[8];
+    struct sr_distances *distances, *loaded;
+    char *filename, *error_message = NULL;
+    int fd;
+
+    prepare_threads(threads);
+    distances = sr_threads_compare((struct sr_thread **)threads, 5, 8,
+                                   SR_DISTANCE_LEVENSHTEIN);
+    g_assert_cmpint(distances->dist_type, ==, SR_DISTANCE_LEVENSHTEIN);
+    g_assert_cmpuint(distances->checksum, ==,
+                     sr_threads_checksum((struct sr_thread **)threads, 8));
+
+    fd = g_file_open_tmp("satyr-distances-XXXXXX", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    close(fd);
+
+    /* Not a distance matrix. */
+    g_assert_null(sr_distances_load(filename, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+
+    g_assert_true(sr_distances_save(distances, filename, &error_message));
+
+    loaded = sr_distances_load(filename, &error_message);
+    g_assert_nonnull(loaded);
+    g_assert_cmpint(loaded->m, ==, 5);
+    g_assert_cmpint(loaded->n, ==, 8);
+    g_assert_cmpint(loaded->dist_type, ==, SR_DISTANCE_LEVENSHTEIN);
+    g_assert_cmpuint(loaded->checksum, ==, distances->checksum);
+
+    for (int i = 0; i < 5; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            g_assert_cmpfloat(sr_distances_get_distance(loaded, i, j), ==,
+                              sr_distances_get_distance(distances, i, j));
+        }
+    }
+
+    /* Changes of the loaded matrix are private. */
+    sr_distances_set_distance(loaded, 0, 1, 42.0);
+    sr_distances_free(loaded);
+    loaded = sr_distances_load(filename, &error_message);
+    g_assert_cmpfloat(sr_distances_get_distance(loaded, 0, 1), ==,
+                      sr_distances_get_distance(distances, 0, 1));
+    sr_distances_free(loaded);
+
+    /* Reduced precision matrices are saved as they are. */
+    loaded = sr_distances_new_ext(2, 3, SR_DISTANCES_FLOAT16);
+    sr_distances_set_distance(loaded, 0, 1, 0.1f);
+    sr_distances_set_distance(loaded, 0, 2, 0.2f);
+    sr_distances_set_distance(loaded, 1, 2, 0.3f);
+    g_assert_true(sr_distances_save(loaded, filename, &error_message));
+    sr_distances_free(loaded);
+    loaded = sr_distances_load(filename, &error_message);
+    g_assert_nonnull(loaded);
+    g_assert_cmpint(loaded->storage, ==, SR_DISTANCES_FLOAT16);
+    g_assert_cmpfloat_with_epsilon(sr_distances_get_distance(loaded, 2, 1),
+                                   0.3f, 0.001f);
+    sr_distances_free(loaded);
+
+    /* Truncated file. */
+    g_assert_cmpint(truncate(filename, 50), ==, 0);
+    g_assert_null(sr_distances_load(filename, &error_message));
+    g_free(error_message);
+
+    unlink(filename);
+    g_free(filename);
+    sr_distances_free(distances);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(threads); i++)
+        sr_gdb_thread_free(threads[i]);
+}
+
+/* Compares the frozen copies of the threads with the threads. */
+static void
+check_frozen_threads(struct sr_thread **threads, int n)
+{
+    struct sr_frozen_thread **frozen = g_malloc_n(n, sizeof(*frozen));
+
+    for (int i = 0; i < n; i++)
+    {
+        frozen[i] = sr_thread_freeze(threads[i]);
+        g_assert_cmpint(sr_frozen_thread_type(frozen[i]), ==,
+                        threads[i]->type);
+        g_assert_cmpint(sr_frozen_thread_frame_count(frozen[i]), ==,
+                        sr_thread_frame_count(threads[i]));
+    }
+
+    g_assert_cmpuint(sr_frozen_threads_checksum(frozen, n), ==,
+                     sr_threads_checksum(threads, n));
+
+    for (int dist_type = 0; dist_type < SR_DISTANCE_NUM; dist_type++)
+    {
+        struct sr_distances *distances, *frozen_distances;
+
+        distances = sr_threads_compare(threads, n - 1, n, dist_type);
+        frozen_distances = sr_frozen_threads_compare(frozen, n - 1, n,
+                                                     dist_type, 2);
+        g_assert_cmpuint(frozen_distances->checksum, ==, distances->checksum);
+        g_assert_cmpint(frozen_distances->dist_type, ==, dist_type);
+
+        for (int i = 0; i < n - 1; i++)
+        {
+            for (int j = i + 1; j < n; j++)
+            {
+                g_assert_cmpfloat(sr_distances_get_distance(frozen_distances,
+                                                            i, j),
+                                  ==,
+                                  sr_distances_get_distance(distances, i, j));
+                g_assert_cmpfloat(sr_frozen_thread_distance(dist_type,
+                                                            frozen[i],
+                                                            frozen[j]),
+                                  ==,
+                                  sr_distance(dist_type, threads[i],
+                                              threads[j]));
+            }
+        }
+
+        sr_distances_free(frozen_distances);
+        sr_distances_free(distances);
+    }
+
+    enum sr_duphash_flags flags[] =
+    {
+        SR_DUPHASH_NORMAL,
+        SR_DUPHASH_NOHASH,
+        SR_DUPHASH_NOHASH | SR_DUPHASH_NONORMALIZE,
+        SR_DUPHASH_NOHASH | SR_DUPHASH_KOOPS_COMPAT,
+        SR_DUPHASH_FAST,
+        SR_DUPHASH_FAST | SR_DUPHASH_KOOPS_COMPAT,
+    };
+
+    for (int i = 0; i < n; i++)
+    {
+        for (size_t k = 0; k < G_N_ELEMENTS(flags); k++)
+        {
+            for (int nframes = 0; nframes < 3; nframes++)
+            {
+                char *expected = sr_thread_get_duphash(threads[i], nframes,
+                                                       "prefix\n", flags[k]);
+                char *duphash = sr_frozen_thread_get_duphash(frozen[i], nframes,
+                                                             "prefix\n",
+                                                             flags[k]);
+
+                g_assert_cmpstr(duphash, ==, expected);
+                g_free(duphash);
+                g_free(expected);
+            }
+        }
+
+        sr_frozen_thread_free(frozen[i]);
+    }
+
+    g_free(frozen);
+}
+
+static struct sr_core_thread *
+create_core_thread(size_t frame_count,
+                   ...)
+{
+    struct sr_core_thread *thread = sr_core_thread_new();
+    va_list argp;
+
+    /* Function name, build id, offset and fingerprint of every frame. */
+    va_start(argp, frame_count);
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        struct sr_core_frame *frame = sr_core_frame_new();
+
+        frame->function_name = g_strdup(va_arg(argp, char *));
+        frame->build_id = g_strdup(va_arg(argp, char *));
+        frame->build_id_offset = va_arg(argp, int);
+        frame->fingerprint = g_strdup(va_arg(argp, char *));
+        frame->address = 0x1000 + i;
+        thread->frames = sr_core_frame_append(thread->frames, frame);
+    }
+    va_end(argp);
+
+    return thread;
+}
+
+static void
+test_frozen_threads(void)
+{
+    struct sr_gdb_thread *gdb_threads[14];
+
+    prepare_threads(gdb_threads);
+    gdb_threads[8] = create_thread(5, "??", "foo", "??", "bar", "baz");
+    gdb_threads[9] = create_thread(5, "__unknown_function_0", "foo", "??",
+                                   "bar", "baz");
+    gdb_threads[10] = create_thread(3, "foo", "bar", "baz");
+    gdb_threads[11] = create_thread(3, "foo", "bar", "baz");
+    gdb_threads[10]->frames->library_name = g_strdup("libfoo.so");
+    gdb_threads[11]->frames->library_name = g_strdup("libbar.so");
+    gdb_threads[12] = create_thread(0);
+    gdb_threads[13] = create_thread(2, "", "main");
+    gdb_threads[13]->frames->source_file = g_strdup("main.c");
+    check_frozen_threads((struct sr_thread **)gdb_threads,
+                         G_N_ELEMENTS(gdb_threads));
+
+    /* Core frames without function names are compared by the build ids,
+     * offsets and fingerprints. */
+    struct sr_core_thread *core_threads[] =
+    {
+        create_core_thread(3, "main", "aaaa", 1, NULL,
+                              NULL, "aaaa", 2, "fp1",
+                              NULL, "bbbb", 3, NULL),
+        create_core_thread(3, "main", "aaaa", 1, NULL,
+                              NULL, "cccc", 7, "fp1",
+                              "foo", "bbbb", 3, NULL),
+        create_core_thread(2, NULL, "aaaa", 2, NULL,
+                              NULL, "bbbb", 3, "fp2"),
+        create_core_thread(2, "foo", NULL, 0, NULL,
+                              "main", NULL, 0, NULL),
+    };
+    check_frozen_threads((struct sr_thread **)core_threads,
+                         G_N_ELEMENTS(core_threads));
+
+    /* Serialization. */
+    struct sr_frozen_thread *frozen, *loaded;
+    char *error_message = NULL;
+    const void *data;
+    size_t size;
+
+    frozen = sr_thread_freeze((struct sr_thread *)core_threads[1]);
+    data = sr_frozen_thread_data(frozen, &size);
+    loaded = sr_frozen_thread_from_data(data, size, &error_message);
+    g_assert_nonnull(loaded);
+    g_assert_cmpint(sr_frozen_thread_frame_count(loaded), ==, 3);
+    g_assert_null(sr_frozen_thread_function_name(loaded, 1));
+    g_assert_cmpstr(sr_frozen_thread_function_name(loaded, 2), ==, "foo");
+    g_assert_cmpuint(sr_frozen_thread_address(loaded, 2), ==, 0x1002);
+    g_assert_cmpfloat(sr_frozen_thread_distance(SR_DISTANCE_LEVENSHTEIN,
+                                                loaded, frozen), ==, 0.0f);
+    sr_frozen_thread_free(loaded);
+
+    g_assert_null(sr_frozen_thread_from_data(data, size - 8, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    error_message = NULL;
+
+    char *corrupted = g_malloc(size);
+    memcpy(corrupted, data, size);
+    corrupted[0] = 'X';
+    g_assert_null(sr_frozen_thread_from_data(corrupted, size, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    error_message = NULL;
+
+    /* Frames without exact symbols are accepted only for the types which
+     * can compare them: the core frame without a function name is not a
+     * GDB frame and the unknown GDB frame is not a kernel oops frame. */
+    int32_t type = SR_REPORT_GDB;
+    memcpy(corrupted, data, size);
+    memcpy(corrupted + offsetof(struct sr_frozen_thread, type), &type,
+           sizeof(type));
+    g_assert_null(sr_frozen_thread_from_data(corrupted, size, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    error_message = NULL;
+    g_free(corrupted);
+
+    struct sr_gdb_thread *unknown_thread = create_thread(2, "??", "main");
+    struct sr_frozen_thread *unknown_frozen =
+        sr_thread_freeze((struct sr_thread *)unknown_thread);
+    data = sr_frozen_thread_data(unknown_frozen, &size);
+    corrupted = g_malloc(size);
+    memcpy(corrupted, data, size);
+    loaded = sr_frozen_thread_from_data(corrupted, size, &error_message);
+    g_assert_nonnull(loaded);
+    sr_frozen_thread_free(loaded);
+
+    type = SR_REPORT_KERNELOOPS;
+    memcpy(corrupted + offsetof(struct sr_frozen_thread, type), &type,
+           sizeof(type));
+    g_assert_null(sr_frozen_thread_from_data(corrupted, size, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+    g_free(corrupted);
+    sr_frozen_thread_free(unknown_frozen);
+    sr_gdb_thread_free(unknown_thread);
+
+    sr_frozen_thread_free(frozen);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(gdb_threads); i++)
+        sr_gdb_thread_free(gdb_threads[i]);
+    for (size_t i = 0; i < G_N_ELEMENTS(core_threads); i++)
+        sr_core_thread_free(core_threads[i]);
+}
+
 int
 main(int    argc,
      char **argv)
@@ -511,9 +1528,28 @@ main(int    argc,
 
     g_test_add_func("/distances/basic-properties", test_distances_basic_properties);
     g_test_add_func("/distances/threads-compare", test_distances_threads_compare);
-
+    g_test_add_func("/distances/threads-compare/symbols",
+                    test_distances_threads_compare_symbols);
+    g_test_add_func("/distances/threads-compare/paired-unknown",
+                    test_distances_threads_compare_paired_unknown);
+    g_test_add_func("/distances/threads-compare/long",
+                    test_distances_threads_compare_long);
+    g_test_add_func("/distances/threads-compare/jaccard",
+                    test_distances_threads_compare_jaccard);
+    g_test_add_func("/distances/threads-compare/parallel",
+                    test_distances_threads_compare_parallel);
+
+    g_test_add_func("/distances/jaro-winkler", test_distance_jaro_winkler);
+    g_test_add_func("/distances/bounded", test_distance_bounded);
+    g_test_add_func("/distances/nearest", test_threads_nearest);
+    g_test_add_func("/distances/minhash-index", test_minhash_index);
+
+    g_test_add_func("/distances/storage", test_distances_storage);
+    g_test_add_func("/distances/extend", test_distances_extend);
+    g_test_add_func("/distances/save-load", test_distances_save_load);
     g_test_add_func("/distances/part/divide", test_distances_part_divide);
     g_test_add_func("/distances/part/conquer", test_distances_part_conquer);
+    g_test_add_func("/distances/frozen", test_frozen_threads);
 
     exit_code = g_test_run();
 
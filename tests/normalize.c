@@ -1,5 +1,6 @@
 #include <gdb/frame.h>
 #include <gdb/thread.h>
+#include <location.h>
 #include <normalize.h>
 #include <utils.h>
 
@@ -293,6 +294,49 @@ test_normalize_gdb_thread_java_frames(void)
     sr_gdb_frame_free(frames[0]);
 }
 
+static void
+test_normalize_gdb_thread_interned(void)
+{
+    const char *input =
+        "#0  __GI_foo (x=1) at foo.c:10\n"
+        "#1  0x00000000004005d4 in __GI_foo (x=2) at foo.c:10\n"
+        "#2  0x00000000004005f0 in main () at main.c:5\n";
+    struct sr_location location;
+    sr_location_init(&location);
+
+    sr_intern_pool_enable();
+
+    struct sr_gdb_thread *thread = sr_gdb_thread_new();
+    while (*input)
+    {
+        struct sr_gdb_frame *frame = sr_gdb_frame_parse(&input, &location);
+        g_assert_nonnull(frame);
+        thread->frames = sr_gdb_frame_append(thread->frames, frame);
+    }
+
+    struct sr_gdb_frame *frame0 = thread->frames;
+    struct sr_gdb_frame *frame1 = frame0->next;
+    g_assert_true(frame0->function_name == frame1->function_name);
+    g_assert_true(frame0->source_file == frame1->source_file);
+    g_assert_cmpuint(sr_intern_pool_size(), ==, 4);
+
+    struct sr_gdb_thread *dup = sr_gdb_thread_dup(thread, false);
+    g_assert_true(dup->frames->function_name == frame0->function_name);
+    g_assert_cmpuint(sr_intern_pool_size(), ==, 4);
+
+    sr_intern_pool_disable();
+
+    /* Removing the __GI_ prefix must not modify the shared strings. */
+    sr_normalize_gdb_thread(thread);
+    g_assert_cmpstr(thread->frames->function_name, ==, "foo");
+    g_assert_cmpstr(dup->frames->function_name, ==, "__GI_foo");
+    g_assert_cmpstr(dup->frames->next->function_name, ==, "__GI_foo");
+
+    sr_gdb_thread_free(thread);
+    sr_gdb_thread_free(dup);
+    g_assert_cmpuint(sr_intern_pool_size(), ==, 0);
+}
+
 int
 main(int    argc,
      char **argv)
@@ -306,6 +350,7 @@ main(int    argc,
     g_test_add_func("/thread/gdb/normalize/paired-unknown-function-names-3", test_normalize_gdb_paired_unknown_function_names_3);
     g_test_add_func("/thread/gdb/normalize/paired-unknown-function-names-4", test_normalize_gdb_paired_unknown_function_names_4);
     g_test_add_func("/thread/gdb/normalize/jvm-frames", test_normalize_gdb_thread_java_frames);
+    g_test_add_func("/thread/gdb/normalize/interned", test_normalize_gdb_thread_interned);
 
     return g_test_run();
 }
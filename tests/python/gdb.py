@@ -91,6 +91,20 @@ class TestGdbThread(BindingsTestCase):
         self.assertEqual(self.thread.get_duphash(flags=satyr.DUPHASH_NOHASH, frames=3), expected_plain)
         self.assertEqual(self.thread.get_duphash(), '01d2a92281954a81dee9098dc4f8056ef5a5a5e1')
 
+    def test_duphash_fast(self):
+        fast = self.thread.get_duphash(flags=satyr.DUPHASH_FAST)
+        self.assertEqual(len(fast), 32)
+        self.assertNotEqual(fast, self.thread.get_duphash())
+
+    def test_get_duphashes(self):
+        threads = satyr.GdbStacktrace(contents).threads
+        for flags in (satyr.DUPHASH_NORMAL, satyr.DUPHASH_FAST, satyr.DUPHASH_NOHASH):
+            expected = [t.get_duphash(frames=3, flags=flags, prefix='foo') for t in threads]
+            self.assertEqual(satyr.get_duphashes(threads, frames=3, flags=flags, prefix='foo'), expected)
+            self.assertEqual(satyr.get_duphashes(threads, frames=3, flags=flags, prefix='foo', nthreads=2), expected)
+        self.assertEqual(satyr.get_duphashes([]), [])
+        self.assertRaises(TypeError, satyr.get_duphashes, [threads[0].frames[0]])
+
     def test_hash(self):
         self.assertHashable(self.thread)
 
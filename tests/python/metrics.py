@@ -1,5 +1,7 @@
 #!/usr/bin/env python
 
+import os
+import tempfile
 import unittest
 from multiprocessing import Process, Queue
 
@@ -58,21 +60,32 @@ class TestDistances(unittest.TestCase):
         self.assertAlmostEqual(thread1.distance(thread2), 0.8827, places=3)
         self.assertAlmostEqual(thread1.distance(thread2), thread2.distance(thread1))
 
-        # TODO are the same stacktraces supposed to compare at 0.98 ?
-        # I'll just leave the numbers here so we are assured they at least stay the same ...
         self.assertAlmostEqual(
             thread1.distance(thread1, dist_type=satyr.DISTANCE_JARO_WINKLER),
-            0.98,
+            1.0)
+        self.assertAlmostEqual(
+            thread1.distance(thread2, dist_type=satyr.DISTANCE_JARO_WINKLER),
+            0.3608,
             places=3)
         self.assertAlmostEqual(
             thread1.distance(thread2, dist_type=satyr.DISTANCE_JARO_WINKLER),
+            thread2.distance(thread1, dist_type=satyr.DISTANCE_JARO_WINKLER)
+        )
+
+        # The numbers of the older versions, which matched a frame several
+        # times and were not even symmetrical.
+        self.assertAlmostEqual(
+            thread1.distance(thread1, dist_type=satyr.DISTANCE_JARO_WINKLER_COMPAT),
+            0.98,
+            places=3)
+        self.assertAlmostEqual(
+            thread1.distance(thread2, dist_type=satyr.DISTANCE_JARO_WINKLER_COMPAT),
             0.3678,
             places=3)
-        # WTF, not even symmetrical?
-        #self.assertAlmostEqual(
-        #    thread1.distance(thread2, dist_type=satyr.DISTANCE_JARO_WINKLER),
-        #    thread2.distance(thread1, dist_type=satyr.DISTANCE_JARO_WINKLER)
-        #)
+        self.assertAlmostEqual(
+            thread2.distance(thread1, dist_type=satyr.DISTANCE_JARO_WINKLER_COMPAT),
+            0.3032,
+            places=3)
 
         self.assertAlmostEqual(
             thread1.distance(thread1, dist_type=satyr.DISTANCE_JACCARD),
@@ -181,5 +194,150 @@ class TestDistances(unittest.TestCase):
         for n in [1, 2, 3, 4, 5, 6, 7, 8, 16, 32, 9000]:
             do_test(self.threads, n)
 
+    def test_distances_nthreads(self):
+        for nthreads in [0, 1, 2, 3, 8]:
+            distances = satyr.Distances(self.threads, len(self.threads),
+                                        nthreads=nthreads)
+            self.assert_correct_matrix(distances, self.threads)
+
+        self.assertRaises(ValueError, satyr.Distances, self.threads,
+                          len(self.threads), nthreads=-1)
+
+    def test_distances_not_metric(self):
+        for name in ['DISTANCE_JARO_WINKLER', 'DISTANCE_JARO_WINKLER_COMPAT']:
+            with self.assertRaisesRegex(ValueError, name + ' as'):
+                satyr.Distances(self.threads, len(self.threads),
+                                dist_type=getattr(satyr, name))
+
+    def test_dendrogram_linkage(self):
+        distances = satyr.Distances(3, 4)
+        for (i, j, dist) in [(0, 1, 1.0), (0, 2, 0.5), (0, 3, 0.0),
+                             (1, 2, 0.1), (1, 3, 0.3), (2, 3, 0.7)]:
+            distances.set_distance(i, j, dist)
+
+        levels = { satyr.LINKAGE_SINGLE: 0.3,
+                   satyr.LINKAGE_COMPLETE: 1.0,
+                   satyr.LINKAGE_AVERAGE: 0.625,
+                   satyr.LINKAGE_WARD: 0.953939 }
+
+        for (linkage, level) in levels.items():
+            dendrogram = satyr.Dendrogram(distances, linkage=linkage)
+            self.assertEqual([dendrogram.get_object(i) for i in range(4)],
+                             [0, 3, 1, 2])
+            self.assertAlmostEqual(dendrogram.get_merge_level(1), level,
+                                   places=5)
+
+        self.assertAlmostEqual(satyr.Dendrogram(distances).get_merge_level(1),
+                               0.625, places=5)
+        self.assertRaises(ValueError, satyr.Dendrogram, distances, linkage=42)
+
+    def test_storage(self):
+        reference = satyr.Distances(self.threads, len(self.threads))
+        (m, n) = reference.get_size()
+        for storage in [satyr.DISTANCES_FLOAT16, satyr.DISTANCES_UINT8]:
+            distances = satyr.Distances(self.threads, len(self.threads),
+                                        storage=storage)
+            for i in range(m):
+                for j in range(n):
+                    self.assertAlmostEqual(distances.get_distance(i, j),
+                                           reference.get_distance(i, j), places=2)
+
+        distances = satyr.Distances(2, 3, storage=satyr.DISTANCES_UINT8)
+        distances.set_distance(0, 1, 2.0)
+        self.assertEqual(distances.get_distance(0, 1), 1.0)
+        self.assertRaises(ValueError, satyr.Distances, 2, 3, storage=42)
+
+    def test_extend(self):
+        reference = satyr.Distances(self.threads, len(self.threads),
+                                    satyr.DISTANCE_JACCARD)
+        old = satyr.Distances(self.threads[:4], 4, satyr.DISTANCE_JACCARD)
+        extended = old.extend(self.threads[:4], self.threads[4:],
+                              dist_type=satyr.DISTANCE_JACCARD, nthreads=2)
+
+        (m, n) = reference.get_size()
+        self.assertEqual(extended.get_size(), (m, n))
+        for i in range(m):
+            for j in range(n):
+                self.assertAlmostEqual(extended.get_distance(i, j),
+                                       reference.get_distance(i, j))
+
+        self.assertRaises(ValueError, old.extend, self.threads[:3], self.threads[4:])
+        self.assertRaises(ValueError, old.extend, self.threads[:4], self.threads[4:],
+                          dist_type=satyr.DISTANCE_LEVENSHTEIN)
+
+    def test_save_load(self):
+        distances = satyr.Distances(self.threads, len(self.threads),
+                                    satyr.DISTANCE_JACCARD)
+        dendrogram = satyr.Dendrogram(distances)
+
+        (fd, filename) = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            distances.save(filename)
+            loaded = satyr.Distances.load(filename)
+            (m, n) = distances.get_size()
+            self.assertEqual(loaded.get_size(), (m, n))
+            for i in range(m):
+                for j in range(n):
+                    self.assertEqual(loaded.get_distance(i, j),
+                                     distances.get_distance(i, j))
+
+            self.assertRaises(IOError, satyr.Dendrogram.load, filename)
+
+            dendrogram.save(filename)
+            loaded = satyr.Dendrogram.load(filename)
+            self.assertEqual(loaded.get_size(), dendrogram.get_size())
+            self.assertEqual([loaded.get_object(i) for i in range(loaded.get_size())],
+                             [dendrogram.get_object(i) for i in range(dendrogram.get_size())])
+        finally:
+            os.unlink(filename)
+
+        self.assertRaises(IOError, satyr.Distances.load, filename)
+
+    def test_nearest(self):
+        query = self.threads[0]
+        for dist_type in [satyr.DISTANCE_LEVENSHTEIN, satyr.DISTANCE_JACCARD,
+                          satyr.DISTANCE_DAMERAU_LEVENSHTEIN]:
+            expected = sorted((query.distance(t, dist_type=dist_type), i)
+                              for (i, t) in enumerate(self.threads))
+            for nthreads in [1, 2]:
+                found = query.nearest(self.threads, k=3, dist_type=dist_type,
+                                      nthreads=nthreads)
+                self.assertEqual([i for (i, dist) in found],
+                                 [i for (dist, i) in expected[:3]])
+                for ((_, dist), (expected_dist, _)) in zip(found, expected):
+                    self.assertAlmostEqual(dist, expected_dist)
+
+        found = query.nearest(self.threads, dist_type=satyr.DISTANCE_JARO_WINKLER)
+        self.assertEqual(len(found), len(self.threads))
+        self.assertEqual(found[0], (0, 1.0))
+        self.assertEqual(query.nearest(self.threads, k=0), [])
+
+        self.assertRaises(ValueError, query.nearest, self.threads, k=-1)
+        self.assertRaises(TypeError, query.nearest, [42])
+
+    def test_minhash_index(self):
+        index = satyr.MinHashIndex(bands=64, rows=1)
+        for (i, thread) in enumerate(self.threads):
+            self.assertEqual(index.insert(thread), i)
+        self.assertEqual(index.get_size(), len(self.threads))
+
+        candidates = index.query(self.threads[0])
+        self.assertIn(0, candidates)
+        self.assertNotIn(3, candidates)
+        self.assertEqual(candidates, sorted(candidates))
+
+        for thread in self.threads:
+            expected = [(i, t.distance(thread, dist_type=satyr.DISTANCE_JACCARD))
+                        for (i, t) in enumerate(self.threads)
+                        if t.distance(thread, dist_type=satyr.DISTANCE_JACCARD) <= 0.7]
+            found = index.query_distance(thread, 0.7)
+            self.assertEqual([i for (i, dist) in found], [i for (i, dist) in expected])
+            for ((_, dist), (_, expected_dist)) in zip(found, expected):
+                self.assertAlmostEqual(dist, expected_dist)
+
+        self.assertRaises(ValueError, satyr.MinHashIndex, bands=0)
+        self.assertRaises(TypeError, index.insert, 42)
+
 if __name__ == '__main__':
     unittest.main()
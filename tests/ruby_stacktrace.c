@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "ruby/stacktrace.h"
 #include "ruby/frame.h"
 #include "utils.h"
@@ -273,6 +274,24 @@ test_ruby_stacktrace_from_json(void)
     }
 }
 
+static void
+test_ruby_stacktrace_from_json_arena(void)
+{
+    char *error_message = NULL;
+    g_autofree char *expected = sr_file_to_string("ruby_stacktraces/ruby-01-expected-json", &error_message);
+    g_assert_nonnull(expected);
+
+    struct sr_arena *arena = sr_arena_new();
+    struct sr_stacktrace *stacktrace = sr_stacktrace_from_json_text_arena(arena, SR_REPORT_RUBY, expected, &error_message);
+    g_assert_nonnull(stacktrace);
+    g_assert_cmpuint(sr_arena_size(arena), >, 0);
+
+    g_autofree char *json = sr_stacktrace_to_json(stacktrace);
+    g_assert_cmpstr(json, ==, expected);
+
+    sr_arena_free(arena);
+}
+
 int
 main(int    argc,
      char **argv)
@@ -284,6 +303,7 @@ main(int    argc,
     g_test_add_func("/stacktrace/ruby/get-reason", test_ruby_stacktrace_get_reason);
     g_test_add_func("/stacktrace/ruby/to-json", test_ruby_stacktrace_to_json);
     g_test_add_func("/stacktrace/ruby/from-json", test_ruby_stacktrace_from_json);
+    g_test_add_func("/stacktrace/ruby/from-json-arena", test_ruby_stacktrace_from_json_arena);
 
     return g_test_run();
 }
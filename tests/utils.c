@@ -1,5 +1,7 @@
 #include "utils.h"
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <glib.h>
 
 static void
@@ -323,6 +325,50 @@ test_demangle_symbol(void)
     g_assert_null(result);
 }
 
+static void
+test_file_map(void)
+{
+    char *filename, *error_message = NULL;
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t sizes[] = { 0, 1, page_size - 1, page_size, 2 * page_size + 7 };
+
+    int fd = g_file_open_tmp("satyr-file-map-XXXXXX", &filename, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    close(fd);
+
+    for (size_t i = 0; i < G_N_ELEMENTS(sizes); i++)
+    {
+        /* Sizes of whole pages have no room for the terminator in the
+         * last page of the file. */
+        char *expected = g_malloc(sizes[i] + 1);
+        for (size_t j = 0; j < sizes[i]; j++)
+            expected[j] = 'a' + j % 26;
+        expected[sizes[i]] = '\0';
+
+        g_assert_true(sr_string_to_file(filename, expected, &error_message));
+
+        size_t size;
+        const char *contents = sr_file_map(filename, &size, &error_message);
+        g_assert_nonnull(contents);
+        g_assert_cmpuint(size, ==, sizes[i]);
+        g_assert_cmpstr(contents, ==, expected);
+
+        sr_file_unmap(contents, size);
+        g_free(expected);
+    }
+
+    unlink(filename);
+    g_free(filename);
+
+    g_assert_null(sr_file_map("/nonexistent", &(size_t){0}, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+
+    g_assert_null(sr_file_map(".", &(size_t){0}, &error_message));
+    g_assert_nonnull(error_message);
+    g_free(error_message);
+}
+
 int
 main(int    argc,
      char **argv)
@@ -349,6 +395,7 @@ main(int    argc,
     g_test_add_func("/utils/indent", test_indent);
     g_test_add_func("/utils/struniq", test_struniq);
     g_test_add_func("/utils/demangle_symbol", test_demangle_symbol);
+    g_test_add_func("/utils/file_map", test_file_map);
 
     return g_test_run();
 }